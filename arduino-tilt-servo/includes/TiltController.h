@@ -17,8 +17,15 @@ const int ENABLE_PIN = 2;       // Digital pin for enable signal
 const int STATUS_LED_PIN = 13;  // Built-in LED for status indication
 
 // Serial Communication
-const long BAUD_RATE = 9600;
+const long BAUD_RATE = 9600;               // Power-on speed (text commands)
 const unsigned long SERIAL_TIMEOUT = 100;  // ms
+const int BAD_INPUT_LIMIT = 4;             // Bad commands at a fast baud before reverting
+
+// Binary angle frame: <SYNC> <OPCODE> <centidegrees u16 LE> <CRC-16/MODBUS u16 LE>
+// (CRC over opcode and payload)
+const uint8_t FRAME_SYNC = 0xA5;
+const uint8_t FRAME_ANGLE = 0x01;
+const int FRAME_SIZE = 6;
 
 // Servo Configuration
 const int MIN_PULSEWIDTH = 544;   // Minimum pulse width in microseconds
@@ -26,6 +33,11 @@ const int MAX_PULSEWIDTH = 2400;  // Maximum pulse width in microseconds
 const int DEFAULT_ANGLE = 90;     // Default starting angle
 const int MIN_ANGLE = 0;          // Minimum allowed angle
 const int MAX_ANGLE = 180;        // Maximum allowed angle
+const float DEFAULT_SLEW_RATE = 0.0f;       // Degrees per second (0 = jump to the target)
+const unsigned long SERVO_UPDATE_US = 2000;  // Interval between interpolation steps
+
+// Status LED
+const unsigned long LED_BLINK_MS = 100;  // On and off time per blink
 
 // Command Processing
 const int BUFFER_SIZE = 255;
@@ -36,12 +48,21 @@ extern bool commandComplete;
 // Servo object
 extern Servo tiltServo;
 
-// Current angle
+// Current (target) angle
 extern float currentAngle;
 
+// Servo output in microseconds, moving toward the target at slewRate
+extern float currentMicros;
+extern float slewRate;
+
 // Function declarations
 void resetBuffer();
 void blinkLED(int times);
+void updateLED(bool enabled);
+void setTargetAngle(float angle);
+void updateServo();
+float angleToMicros(float angle);
+uint16_t calculateCRC(const uint8_t* data, size_t length);
 void processSerialData();
 void processCommand();
 
@@ -6,6 +6,25 @@ int bufferIndex = 0;
 bool commandComplete = false;
 Servo tiltServo;
 float currentAngle = DEFAULT_ANGLE;
+float currentMicros = 0.0f;
+float slewRate = DEFAULT_SLEW_RATE;
+
+// Binary frame being collected (frameIndex > 0 while inside a frame)
+static uint8_t frameBuffer[FRAME_SIZE];
+static int frameIndex = 0;
+static unsigned long frameStart = 0;
+
+// Link speed and consecutive bad input seen at a fast speed
+static long currentBaud = BAUD_RATE;
+static int badInputCount = 0;
+
+// Servo interpolation
+static float targetMicros = 0.0f;
+static unsigned long lastServoUpdate = 0;
+
+// Pending LED blinks (each blink is an on and an off phase)
+static int ledPhases = 0;
+static unsigned long ledPhaseTime = 0;
 
 void resetBuffer() {
     bufferIndex = 0;
@@ -13,20 +32,158 @@ void resetBuffer() {
     memset(cmdBuffer, 0, BUFFER_SIZE);
 }
 
+// Queue blinks; updateLED() plays them without blocking
 void blinkLED(int times) {
-    for (int i = 0; i < times; i++) {
-        digitalWrite(STATUS_LED_PIN, HIGH);
-        delay(100);
-        digitalWrite(STATUS_LED_PIN, LOW);
-        delay(100);
+    if (ledPhases == 0) {
+        ledPhaseTime = millis();
+    }
+    ledPhases += times * 2;
+}
+
+// Show the enable state, inverted while a blink is on
+void updateLED(bool enabled) {
+    if (ledPhases > 0 && millis() - ledPhaseTime >= LED_BLINK_MS) {
+        ledPhases--;
+        ledPhaseTime = millis();
+    }
+
+    bool blinkOn = ledPhases > 0 && (ledPhases % 2) == 0;
+    digitalWrite(STATUS_LED_PIN, blinkOn ? !enabled : enabled);
+}
+
+float angleToMicros(float angle) {
+    return MIN_PULSEWIDTH +
+           (angle - MIN_ANGLE) * (MAX_PULSEWIDTH - MIN_PULSEWIDTH) / (MAX_ANGLE - MIN_ANGLE);
+}
+
+// Move the output toward the target at slewRate degrees per second
+void updateServo() {
+    unsigned long now = micros();
+    unsigned long elapsed = now - lastServoUpdate;
+    if (elapsed < SERVO_UPDATE_US) {
+        return;
+    }
+    lastServoUpdate = now;
+
+    if (currentMicros == targetMicros) {
+        return;
+    }
+
+    float microsPerDegree = (float)(MAX_PULSEWIDTH - MIN_PULSEWIDTH) / (MAX_ANGLE - MIN_ANGLE);
+    float step = slewRate * microsPerDegree * elapsed / 1000000.0f;
+    float remaining = targetMicros - currentMicros;
+
+    if (slewRate <= 0.0f || fabs(remaining) <= step) {
+        currentMicros = targetMicros;
+    } else {
+        currentMicros += remaining > 0 ? step : -step;
+    }
+
+    tiltServo.writeMicroseconds(int(currentMicros + 0.5f));
+}
+
+// CRC-16/MODBUS, as used by the ClearCore host protocol
+uint16_t calculateCRC(const uint8_t* data, size_t length) {
+    uint16_t crc = 0xFFFF;
+
+    for (size_t i = 0; i < length; i++) {
+        crc ^= data[i];
+        for (int j = 0; j < 8; j++) {
+            if (crc & 0x0001) {
+                crc = (crc >> 1) ^ 0xA001;
+            } else {
+                crc = crc >> 1;
+            }
+        }
+    }
+
+    return crc;
+}
+
+// Set a new target angle (the output follows in updateServo())
+void setTargetAngle(float angle) {
+    // Constrain angle to valid range
+    angle = constrain(angle, MIN_ANGLE, MAX_ANGLE);
+
+    currentAngle = angle;
+    targetMicros = angleToMicros(angle);
+
+    if (slewRate <= 0.0f) {
+        currentMicros = targetMicros;
+        tiltServo.writeMicroseconds(int(currentMicros + 0.5f));
+    }
+
+    if (DEBUG_ENABLED) {
+        Serial.print("Angle set to ");
+        Serial.println(angle);
+    }
+}
+
+// Send acknowledgment and indicate command processed
+static void acknowledge() {
+    Serial.println("OK");
+    badInputCount = 0;
+    blinkLED(1);
+}
+
+// Input that makes no sense at a fast speed usually means the host restarted at the
+// power-on speed, so fall back to it
+static void registerBadInput() {
+    if (currentBaud != BAUD_RATE && ++badInputCount >= BAD_INPUT_LIMIT) {
+        Serial.flush();
+        Serial.begin(BAUD_RATE);
+        currentBaud = BAUD_RATE;
+        badInputCount = 0;
+    }
+}
+
+static bool isSupportedBaud(long baud) {
+    return baud == 9600 || baud == 19200 || baud == 38400 || baud == 57600 || baud == 115200;
+}
+
+static void processFrame() {
+    uint16_t crc = frameBuffer[4] | (uint16_t(frameBuffer[5]) << 8);
+    if (calculateCRC(&frameBuffer[1], 3) != crc) {
+        Serial.println("ERR:CRC");
+        registerBadInput();
+        return;
+    }
+
+    if (frameBuffer[1] == FRAME_ANGLE) {
+        uint16_t centiDegrees = frameBuffer[2] | (uint16_t(frameBuffer[3]) << 8);
+        setTargetAngle(centiDegrees / 100.0f);
+        acknowledge();
+    } else {
+        Serial.println("ERR:OPCODE");
+        registerBadInput();
     }
 }
 
 void processSerialData() {
     while (Serial.available() > 0 && !commandComplete) {
-        char c = Serial.read();
+        uint8_t c = Serial.read();
+
+        // Drop a frame whose remaining bytes never arrived
+        if (frameIndex > 0 && millis() - frameStart > SERIAL_TIMEOUT) {
+            frameIndex = 0;
+            registerBadInput();
+        }
+
+        // Binary angle frame
+        if (frameIndex > 0 || (bufferIndex == 0 && c == FRAME_SYNC)) {
+            if (frameIndex == 0) {
+                frameStart = millis();
+            }
+            frameBuffer[frameIndex++] = c;
+            if (frameIndex == FRAME_SIZE) {
+                frameIndex = 0;
+                processFrame();
+            }
+            continue;
+        }
+
         if (DEBUG_ENABLED) {
-            Serial.print(c);
+            Serial.print(char(c));
         }
 
         // Handle end of command
@@ -41,6 +198,11 @@ void processSerialData() {
                 break;
             }
         }
+        // Line noise (e.g. the host talking at another speed)
+        else if (c < 0x20 || c > 0x7E) {
+            resetBuffer();
+            registerBadInput();
+        }
         // Add character to buffer if not full
         else if (bufferIndex < BUFFER_SIZE - 1) {
             cmdBuffer[bufferIndex++] = c;
@@ -51,24 +213,28 @@ void processSerialData() {
 void processCommand() {
     // Check for ANGLE command
     if (strncmp(cmdBuffer, "ANGLE:", 6) == 0) {
-        // Extract angle value
-        float angle = atof(&cmdBuffer[6]);
-
-        // Constrain angle to valid range
-        angle = constrain(angle, MIN_ANGLE, MAX_ANGLE);
-
-        // Set servo position
-        tiltServo.write(int(angle));
-        currentAngle = angle;
-
-        // Send acknowledgment
-        if (DEBUG_ENABLED) {
-            Serial.print("Angle set to ");
-            Serial.println(angle);
+        setTargetAngle(atof(&cmdBuffer[6]));
+        acknowledge();
+    }
+    // Slew rate in degrees per second (0 = jump to the target)
+    else if (strncmp(cmdBuffer, "SLEW:", 5) == 0) {
+        float rate = atof(&cmdBuffer[5]);
+        slewRate = rate > 0.0f ? rate : 0.0f;
+        acknowledge();
+    }
+    // Link speed: acknowledged at the old speed, then switched
+    else if (strncmp(cmdBuffer, "BAUD:", 5) == 0) {
+        long baud = atol(&cmdBuffer[5]);
+        if (!isSupportedBaud(baud)) {
+            Serial.println("ERR:BAUD");
+            return;
         }
-        Serial.println("OK");
-
-        // Indicate command processed
-        blinkLED(1);
+        acknowledge();
+        Serial.flush();
+        Serial.begin(baud);
+        currentBaud = baud;
+    } else {
+        Serial.println("ERR:UNKNOWN");
+        registerBadInput();
     }
 }
@@ -4,9 +4,13 @@
 * This sketch controls a servo for the tilt function of the Space Maquette.
 * It communicates with the ClearCore controller via hardware serial.
 *
-* Communication Protocol:
+* Communication Protocol (9600 baud at power-on):
 * - Commands: "ANGLE:XX.XX\r\n" - Set servo angle in degrees
-* - Response: "OK\r\n" - Acknowledgment of successful command
+*             "SLEW:XX.X\r\n" - Slew rate in degrees per second (0 = jump)
+*             "BAUD:NNNNN\r\n" - Switch speed (acknowledged at the old speed)
+* - Binary angle frame: 0xA5, 0x01, centidegrees (u16 LE), CRC-16/MODBUS (u16 LE)
+* - Response: "OK\r\n" - Acknowledgment of successful command, "ERR:...\r\n" otherwise
+* - After repeated bad input at a fast speed, the controller returns to 9600 baud
 *
 * Hardware:
 * - Arduino Nano Atmega328 - new bootloader
@@ -19,9 +23,13 @@
 * This sketch controls a servo for the tilt function of the Space Maquette.
 * It communicates with the ClearCore controller via hardware serial.
 *
-* Communication Protocol:
+* Communication Protocol (9600 baud at power-on):
 * - Commands: "ANGLE:XX.XX\r\n" - Set servo angle in degrees
-* - Response: "OK\r\n" - Acknowledgment of successful command
+*             "SLEW:XX.X\r\n" - Slew rate in degrees per second (0 = jump)
+*             "BAUD:NNNNN\r\n" - Switch speed (acknowledged at the old speed)
+* - Binary angle frame: 0xA5, 0x01, centidegrees (u16 LE), CRC-16/MODBUS (u16 LE)
+* - Response: "OK\r\n" - Acknowledgment of successful command, "ERR:...\r\n" otherwise
+* - After repeated bad input at a fast speed, the controller returns to 9600 baud
 *
 * Hardware:
 * - Arduino Nano Atmega328 - new bootloader
@@ -43,7 +51,9 @@ void setup() {
 
     // Initialize servo
     tiltServo.attach(SERVO_PIN, MIN_PULSEWIDTH, MAX_PULSEWIDTH);
-    tiltServo.write(DEFAULT_ANGLE);
+    currentMicros = angleToMicros(DEFAULT_ANGLE);
+    tiltServo.writeMicroseconds(int(currentMicros + 0.5f));
+    setTargetAngle(DEFAULT_ANGLE);
 
     // Indicate ready
     blinkLED(10);
@@ -53,8 +63,11 @@ void loop() {
     // Check if enabled (LOW when enabled due to relay logic)
     bool enabled = (digitalRead(ENABLE_PIN) == LOW);
 
-    // Set status LED based on enabled state
-    digitalWrite(STATUS_LED_PIN, enabled);
+    // Set status LED based on enabled state (and play any blinks)
+    updateLED(enabled);
+
+    // Step the servo toward its target
+    updateServo();
 
     // Process serial data when enabled
     if (enabled && Serial.available()) {
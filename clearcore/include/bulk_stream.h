@@ -0,0 +1,23 @@
+/**
+ * Space Maquette - Bulk Stream
+ *
+ * Stream that can hand over everything it has received in one call,
+ * so readers avoid a per-byte available()/read() round trip, and can tell
+ * writers how much output it can queue.
+ */
+
+#ifndef BULK_STREAM_H
+#define BULK_STREAM_H
+
+#include <Arduino.h>
+
+class BulkStream : public Stream {
+public:
+    // Copy up to size received bytes into buffer without blocking; returns the count
+    virtual int readAvailable(uint8_t* buffer, size_t size) = 0;
+
+    // Bytes that can be written now without dropping output (0 = unknown)
+    virtual int availableForWrite() { return 0; }
+};
+
+#endif  // BULK_STREAM_H
@@ -3,6 +3,13 @@
  *
  * Processes commands received from the host computer
  * and dispatches them to the appropriate subsystems.
+ *
+ * Commands arrive from the control session's parser and from any observer
+ * sessions registered with addObserver(). Each command is answered on the
+ * parser it came from; observers are limited to the read-only commands
+ * marked in the command table and have their own telemetry subscription.
+ * Asynchronous reports (move completion, homing, measurements) go to the
+ * control session.
  */
 
 #pragma once
@@ -11,35 +18,151 @@
 #include "configuration_manager.h"
 #include "emergency.h"
 #include "motion_control.h"
+#include "motion_trace.h"
 #include "rangefinder.h"
+#include "scan_controller.h"
+#include "telemetry.h"
 
 class CommandHandler {
 public:
     // Constructor
     CommandHandler(CommandParser& parser, MotionControl& motion, Rangefinder& rangefinder,
-                   EmergencyStop& estop, ConfigurationManager& config);
+                   EmergencyStop& estop, ConfigurationManager& config, ScanController& scanner,
+                   Telemetry& telemetry);
 
     // Initialize the handler
     void init();
 
+    // Register an observer session (index 1.. in SESSION replies, in order added)
+    void addObserver(CommandParser& parser, Telemetry& telemetry);
+
     // Process a command (called by parser)
     void processCommand(CommandParser& parser);
 
+    // Complete pending measurements and stream range data (call every loop)
+    void update();
+
+    // Apply the per-axis velocity, acceleration and jerk config keys
+    void applyMotionProfiles();
+
+    // Apply the per-axis home sensor and homing speed config keys
+    void applyHomingConfig();
+
+    // Motion trace recorder for the TRACE command (optional)
+    void setMotionTrace(MotionTrace* trace);
+
+    // Apply the trace_* config keys (arms the recorder when trace_enabled)
+    void applyTraceConfig();
+
 private:
     // References to system components
-    CommandParser& _parser;
+    CommandParser& _controlParser;
     MotionControl& _motion;
     Rangefinder& _rangefinder;
     EmergencyStop& _estop;
     ConfigurationManager& _config;
+    ScanController& _scanner;
+    Telemetry& _controlTelemetry;
+
+    // Session being served: the observer's parser and telemetry while one of
+    // its commands runs, the control session's otherwise
+    CommandParser* _parser;
+    Telemetry* _telemetry;
+    uint8_t _session;  // 0 = control, 1.. = observer
+    uint8_t _observerCount;
+
+    // Command table entry: handler plus the checks processCommand runs first
+    struct CommandEntry {
+        const char* name;
+        void (CommandHandler::*handler)();
+        uint8_t minParams;         // Fewer parameters are rejected with missingError
+        bool allowedDuringEstop;   // Accepted while the emergency stop is active
+        bool allowedForObserver;   // Accepted from observer sessions (read-only)
+        const char* missingError;  // Error for too few parameters
+    };
+
+    // Sorted by name (checked at compile time)
+    static const CommandEntry COMMAND_TABLE[];
+    static const size_t COMMAND_COUNT;
+
+    // Command table lookup
+    static const CommandEntry* findCommand(const char* name);
+    static constexpr bool nameLess(const char* a, const char* b);
+    static constexpr bool tableSorted(size_t index);
 
-    // Command processing methods
-    void handleSystemCommands();
-    void handleMotionCommands();
-    void handleRangefinderCommands();
-    void handleServoCommands();
-    void handleConfigCommands();
+    // System commands
+    void cmdEstop();
+    void cmdEstopStatus();
+    void cmdResetEstop();
+    void cmdPerf();
+    void cmdPing();
+    void cmdReset();
+    void cmdStatus();
+    void cmdDebug();
+    void cmdProtocol();
+    void cmdBatch();
+    void cmdSession();
+    void cmdBench();
+
+    // Motion commands
+    void cmdHome();
+    void cmdMove();
+    void cmdMoveQueued();
+    void cmdQueueClear();
+    void cmdQueueStatus();
+    void cmdStop();
+    void cmdVelocity();
+    void cmdProfile();
+    void cmdTrace();
+
+    // Rangefinder commands
+    void cmdMeasure();
+    void cmdMeasureStream();
+    void cmdScan();
+    void cmdScanPause();
+    void cmdScanResume();
+    void cmdScanAbort();
+    void cmdScanStatus();
+
+    // Telemetry commands
+    void cmdSubscribe();
+    void cmdUnsubscribe();
+
+    // Servo commands
+    void cmdTilt();
+    void cmdPan();
+
+    // Configuration commands
+    void cmdConfig();
+    void cmdGet();
+    void cmdSet();
+    void cmdSave();
+
+    // Run an observer session's command against its own parser and telemetry
+    void processObserverCommand(uint8_t session, CommandParser& parser, Telemetry& telemetry);
+
+    // Config key suffix of an axis for the profile keys
+    static const char* profileKeySuffix(char axis);
+
+    // Send buffered streaming range readings as one DATA frame
+    void flushRangeStream();
+
+    // Send the next DATA:TRACE line of a TRACE:GET download
+    void sendTraceChunk();
 
     // System state
     bool _debugMode;
+
+    // Rangefinder request state
+    bool _measurePending;
+    bool _rangeStreaming;
+    unsigned long _lastRangeFrame;
+
+    // Motion trace state
+    MotionTrace* _trace;
+    bool _traceSending;       // TRACE:GET download in progress
+    uint32_t _traceOffset;    // Next blob byte to send
+    uint16_t _traceCapture;   // Capture being downloaded
+    uint16_t _traceReported;  // Last capture announced with INFO:TRACE_DONE
+    bool _traceSaving;        // TRACE:SAVE waiting for its result
 };
\ No newline at end of file
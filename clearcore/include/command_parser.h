@@ -11,6 +11,15 @@
  * - Supports multiple parameters
  * - Provides checksum verification
  * - Allows setting custom command handler callbacks
+ * - Optional binary framing, negotiated per connection with PROTOCOL:BINARY
+ *
+ * Binary frame: <0xA5><LEN u16 LE><OPCODE><PAYLOAD><CRC u16 LE>
+ * LEN counts OPCODE + PAYLOAD, CRC covers OPCODE + PAYLOAD.
+ * Command payloads are int32 LE fields; opcode 0x00 carries a text command.
+ * Responses use the same framing with a status opcode and the text message.
+ *
+ * BATCH:<n> collects the responses of the next n commands into one reply:
+ * OK:BATCH=<n>|<status>:<message>|...
  */
 
 #ifndef COMMAND_PARSER_H
@@ -27,6 +36,8 @@
 #include <Arduino.h>
 // Add other Arduino/ClearCore includes here
 
+#include "bulk_stream.h"
+
 // Forward declaration for command handler callback
 class CommandParser;
 using CommandHandlerCallback = std::function<void(CommandParser&)>;
@@ -37,10 +48,57 @@ public:
     static const int CMD_BUFFER_SIZE = 64;
     static const int PARAM_BUFFER_SIZE = 256;
     static const int MAX_PARAMS = 10;
+    static const int RX_BUFFER_SIZE = 512;  // Received bytes waiting to be parsed
+
+    // Binary framing
+    static const uint8_t FRAME_SYNC = 0xA5;
+    static const int TX_FRAME_SIZE = 600;  // Fits the largest DATA frame (scan batches)
+
+    // Batched commands
+    static const int BATCH_MAX_COMMANDS = 16;
+    static const int BATCH_BUFFER_SIZE = 512;
+    static const unsigned long BATCH_TIMEOUT_MS = 1000;  // Reply with what arrived so far
+
+    // Wire protocol for the current connection
+    enum Protocol { PROTOCOL_TEXT, PROTOCOL_BINARY };
+
+    // Binary command opcodes (commands with string parameters use OP_TEXT)
+    enum Opcode : uint8_t {
+        OP_TEXT = 0x00,  // Payload is a text command line ("CMD:PARAMS")
+        OP_PING = 0x01,
+        OP_STATUS = 0x02,
+        OP_ESTOP = 0x03,
+        OP_RESET_ESTOP = 0x04,
+        OP_STOP = 0x05,
+        OP_MOVE = 0x06,  // x, y, z [, pan, tilt]
+        OP_MOVEQ = 0x07,  // x, y, z [, pan]
+        OP_QUEUE_CLEAR = 0x08,
+        OP_QUEUE_STATUS = 0x09,
+        OP_VELOCITY = 0x0A,  // vx, vy, vz
+        OP_MEASURE = 0x0B,
+        OP_SCAN = 0x0C,  // x1, y1, x2, y2, step
+        OP_SCAN_PAUSE = 0x0D,
+        OP_SCAN_RESUME = 0x0E,
+        OP_SCAN_ABORT = 0x0F,
+        OP_SCAN_STATUS = 0x10,
+        OP_TILT = 0x11,  // angle
+        OP_PAN = 0x12,   // angle
+        OP_PROTOCOL = 0x13,  // 0 = text, 1 = binary
+        OP_BATCH = 0x14,     // n
+        OP_COUNT,
+
+        // Response status opcodes
+        OP_RESP_OK = 0x80,
+        OP_RESP_ERROR = 0x81,
+        OP_RESP_INFO = 0x82,
+        OP_RESP_DATA = 0x83,
+        OP_RESP_TELEMETRY = 0x84  // seq u16, field mask u16, int32 LE per field
+    };
 
     // Constructors
     CommandParser();
     CommandParser(Stream& serial);
+    CommandParser(BulkStream& stream);  // Reads all available bytes per update()
 
     // Initialization
     void init();
@@ -48,7 +106,8 @@ public:
     // Process incoming character
     void processChar(char c);
 
-    // Process all available serial data (more efficient than processChar)
+    // Process all available serial data (more efficient than processChar);
+    // returns true if at least one command was handled
     bool update();
 
     // Check if a complete command is available
@@ -71,40 +130,123 @@ public:
     void sendResponse(const char* status, const char* message);
     void sendFormattedResponse(const char* status, const char* format, ...);
 
+    // Write a binary frame with a raw payload (binary protocol only)
+    void sendFrame(uint8_t opcode, const uint8_t* payload, size_t length);
+
+    // Bytes the connection can queue without dropping output
+    int availableForWrite();
+
     // Set command handler callback
     void setCommandHandler(CommandHandlerCallback handler);
 
+    // Collect the responses of the next count commands into one reply
+    bool beginBatch(int count);
+    bool isBatchActive() const;
+
+    // Select the wire protocol
+    void setProtocol(Protocol protocol);
+    Protocol getProtocol() const;
+
+    // micros() when the bytes of the current command were read from the stream
+    unsigned long getReceiveTime() const { return _receiveTime; }
+
+    // Forget partial input, batches and binary mode (call for each new connection)
+    void resetConnection();
+
 private:
     // Serial connection reference
     Stream* _serial;
 
-    // Buffer for incoming data
+    // Set when the transport supports bulk reads
+    BulkStream* _bulkStream;
+
+    // Received bytes; lines are parsed in place here
+    uint8_t _rxBuffer[RX_BUFFER_SIZE];
+    size_t _rxLength;
+
+    // Buffer for processChar() input and binary frame bodies
     char _buffer[CMD_BUFFER_SIZE];
     int _bufferIndex;
 
     // Flag indicating a complete command has been received
     bool _commandComplete;
 
-    // Parsed command components
-    char _command[CMD_BUFFER_SIZE];
-    char _paramBuffer[PARAM_BUFFER_SIZE];
+    // Parsed command components (point into the parsed line)
+    const char* _command;
+    char _paramBuffer[PARAM_BUFFER_SIZE];  // Text copies of binary parameters
     char* _params[MAX_PARAMS];
     int _paramCount;
 
     // Command handler callback
     CommandHandlerCallback _cmdHandler;
 
+    // Binary framing state
+    enum FrameState {
+        FRAME_WAIT_SYNC,
+        FRAME_LENGTH_LOW,
+        FRAME_LENGTH_HIGH,
+        FRAME_BODY,
+        FRAME_CRC_LOW,
+        FRAME_CRC_HIGH
+    };
+
+    Protocol _protocol;
+    FrameState _frameState;
+    uint16_t _frameLength;
+    uint16_t _frameCRC;  // As received
+    uint16_t _bodyCRC;   // Running CRC of the body bytes so far
+
+    // Running CRC of the processChar() line, up to its first ';'
+    uint16_t _lineCRC;
+    int _lineCRCLength;
+
+    // Numeric parameters of a binary command (used directly by getParamAs*)
+    bool _binaryCommand;
+    int32_t _binaryParams[MAX_PARAMS];
+
+    // Outbound response line or binary frame, written with one write() call
+    uint8_t _txBuffer[TX_FRAME_SIZE];
+
+    // Batch state: entries are appended after room reserved for the reply header
+    static const int BATCH_HEADER_SIZE = 32;
+    char _batchBuffer[BATCH_HEADER_SIZE + BATCH_BUFFER_SIZE];
+    int _batchLength;
+    int _batchTotal;
+    int _batchDone;
+    bool _batchStarting;   // Set by the BATCH command itself, which is not an entry
+    bool _batchTruncated;
+    unsigned long _batchStartTime;
+    bool _inCommand;       // Responses belong to the command being processed
+    int _entryStart;
+    unsigned long _receiveTime;
+
     // Reset the parser state
     void reset();
 
-    // Parse the received command
-    void parseCommand();
+    // Parse a received command line in place
+    void parseCommand(char* line, size_t length);
+
+    // Bulk receive helpers
+    bool processReceived();
+    void processLine(char* line, size_t length);
+
+    // Binary framing helpers
+    void processFrameByte(uint8_t b);
+    void parseFrame();
+    void dispatchCommand();
+    void sendFrame(uint8_t opcode, const char* message);
+
+    // Response helpers
+    void beginCommand();
+    void endCommand();
+    void appendBatchEntry(const char* status, const char* message);
+    void finishBatch();
 
     // Verify checksum (if present)
-    bool verifyChecksum();
+    bool verifyChecksum(const char* line, const char* semicolonPos);
 
-    // Calculate CRC-16 checksum
-    uint16_t calculateCRC(const char* data, size_t length);
+    // Restart the running processChar() line checksum
+    void resetLineCRC();
 };
 
 #endif  // COMMAND_PARSER_H
\ No newline at end of file
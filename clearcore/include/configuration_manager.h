@@ -3,6 +3,16 @@
  *
  * Handles loading and saving configuration data from SD card.
  * Provides a centralized interface for accessing system parameters.
+ *
+ * Keys and values live in fixed-size slots (no heap use after boot) and are
+ * found through an open-addressing hash index. Each value is parsed once,
+ * when it is loaded or set, into cached int, float and bool forms. A key can
+ * be bound once to a ConfigKey handle and then read in O(1) without any
+ * string comparison; handles stay valid across reloads.
+ *
+ * The text file is read once, in blocks, and parsed in place. That parse is
+ * a small fraction of the SD reads it needs, so there is no binary cache:
+ * any cache check would cost at least the same reads.
  */
 
 #ifndef CONFIGURATION_MANAGER_H
@@ -12,9 +22,22 @@
 #include <SD.h>
 #include <SPI.h>
 
+// Storage limits (keys and values longer than these are truncated)
+#define CONFIG_MAX_ITEMS 64
+#define CONFIG_KEY_LENGTH 32
+#define CONFIG_VALUE_LENGTH 48
+#define CONFIG_LINE_LENGTH 96
+
+// Hash index slots (power of two, at least twice CONFIG_MAX_ITEMS)
+#define CONFIG_INDEX_SIZE 128
+
+// Handle to an interned key
+typedef int16_t ConfigKey;
+#define CONFIG_NO_KEY -1
+
 class ConfigurationManager {
 public:
-    // Constructor
+    // Constructor (the path must stay valid, e.g. a string literal)
     ConfigurationManager(const char* configFile = "CONFIG.TXT");
 
     // Initialization
@@ -26,51 +49,74 @@ public:
     // Save configuration to SD card
     bool saveConfig();
 
+    // Intern a key and return its handle (CONFIG_NO_KEY if the table is full).
+    // The key need not have a value yet; reads return the default until it does.
+    ConfigKey bind(const char* key);
+
     // Get configuration values with defaults
     int getInt(const char* key, int defaultValue = 0);
     float getFloat(const char* key, float defaultValue = 0.0f);
     bool getBool(const char* key, bool defaultValue = false);
     String getString(const char* key, const String& defaultValue = "");
 
+    // O(1) reads through a bound handle
+    int getInt(ConfigKey key, int defaultValue = 0) const;
+    float getFloat(ConfigKey key, float defaultValue = 0.0f) const;
+    bool getBool(ConfigKey key, bool defaultValue = false) const;
+    const char* getValue(ConfigKey key, const char* defaultValue = "") const;
+
     // Set configuration values
     void setInt(const char* key, int value);
     void setFloat(const char* key, float value);
     void setBool(const char* key, bool value);
     void setString(const char* key, const String& value);
+    void setString(const char* key, const char* value);
 
     // Check if a key exists
     bool hasKey(const char* key);
 
-    // Clear all configuration
+    // Clear all configuration (bound handles stay valid)
     void clear();
 
+    // Number of keys with a value
+    int getCount() const { return _configCount; }
+
     // Debug - dump all configuration items to Serial
     void dumpConfig();
 
 private:
     // Config file path
-    String _configFilePath;
+    const char* _configFilePath;
 
     // SD card initialized flag
     bool _sdInitialized;
 
     // Configuration data storage
     struct ConfigItem {
-        String key;
-        String value;
+        char key[CONFIG_KEY_LENGTH];
+        char value[CONFIG_VALUE_LENGTH];
+        uint32_t hash;
+        bool present;     // Has a value (cleared by clear() / reload)
+        int8_t boolValue; // 1 / 0, or -1 if the value isn't a boolean word
+        int32_t intValue;
+        float floatValue;
     };
 
-    // Maximum configuration items
-    static const int MAX_CONFIG_ITEMS = 50;
+    // Configuration data array (interned keys, never removed)
+    ConfigItem _configData[CONFIG_MAX_ITEMS];
+    int _itemCount;    // Interned keys
+    int _configCount;  // Keys with a value
 
-    // Configuration data array
-    ConfigItem _configData[MAX_CONFIG_ITEMS];
-    int _configCount;
+    // Hash index: item index + 1 per slot, 0 when empty
+    uint8_t _index[CONFIG_INDEX_SIZE];
 
     // Helper methods
-    int findKey(const char* key);
-    bool parseConfigLine(const String& line);
-    String formatConfigLine(const ConfigItem& item);
+    static uint32_t hashKey(const char* key);
+    int findKey(const char* key) const;
+    int internKey(const char* key);
+    const ConfigItem* presentItem(ConfigKey key) const;
+    void storeValue(int index, const char* value);
+    bool parseConfigLine(char* line);
 };
 
-#endif  // CONFIGURATION_MANAGER_H
\ No newline at end of file
+#endif  // CONFIGURATION_MANAGER_H
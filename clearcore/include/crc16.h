@@ -0,0 +1,31 @@
+/**
+ * Space Maquette - CRC-16
+ *
+ * CRC-16/MODBUS (polynomial 0xA001 reflected, initial value 0xFFFF), shared by
+ * the host protocol and the tilt servo link. Table driven, and usable
+ * incrementally: start from CRC16_INIT and feed bytes as they arrive, so the
+ * check is ready when the last byte lands.
+ */
+
+#ifndef CRC16_H
+#define CRC16_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+#define CRC16_INIT 0xFFFF
+
+extern const uint16_t CRC16_TABLE[256];
+
+// Add one byte to a running CRC
+inline uint16_t crc16Update(uint16_t crc, uint8_t data) {
+    return (crc >> 8) ^ CRC16_TABLE[(crc ^ data) & 0xFF];
+}
+
+// Add a block to a running CRC
+uint16_t crc16Update(uint16_t crc, const uint8_t* data, size_t length);
+
+// CRC of a complete buffer
+uint16_t crc16Modbus(const uint8_t* data, size_t length);
+
+#endif  // CRC16_H
@@ -3,6 +3,10 @@
  *
  * Handles emergency stop functionality, immediately disabling motors
  * while keeping the controller active to communicate with the host.
+ *
+ * In interrupt mode the falling edge of the ESTOP input disables the motors
+ * from the ISR, independent of how long the main loop is blocked; check()
+ * then reports the stop from the loop. Polling remains as a fallback.
  */
 
 #pragma once
@@ -15,11 +19,14 @@ public:
     // Constructor
     EmergencyStop(int estopPin);
 
-    // Initialize the emergency stop system
-    void init();
+    // Initialize the emergency stop system (useInterrupt: disable motors from the ISR)
+    void init(bool useInterrupt = true);
+
+    // Switch between interrupt and polled detection after init()
+    void setInterruptMode(bool useInterrupt);
 
     // Check ESTOP status (call in main loop)
-    // Returns true if newly activated
+    // Returns true if newly activated (including by the ISR since the last call)
     bool check();
 
     // Manually activate ESTOP
@@ -32,13 +39,40 @@ public:
     // Returns true if successfully reset
     bool reset();
 
+    // Trigger-to-disable latency of the last and the slowest activation (microseconds)
+    // Interrupt mode measures from ISR entry; polling measures from the previous poll
+    uint32_t getLastLatencyUs() const { return _lastLatencyUs; }
+    uint32_t getMaxLatencyUs() const { return _maxLatencyUs; }
+    uint32_t getTriggerCount() const { return _triggerCount; }
+    bool isInterruptMode() const { return _interruptMode; }
+
 private:
     // Pin connected to ESTOP circuit
     int _estopPin;
 
-    // Current ESTOP state
-    bool _estopActive;
+    // Current ESTOP state (written by the ISR)
+    volatile bool _estopActive;
+
+    // Interrupt mode state
+    bool _interruptMode;
+    volatile bool _pendingReport;  // ISR activation not yet returned by check()
+
+    // Latency measurement
+    volatile uint32_t _lastLatencyUs;
+    volatile uint32_t _maxLatencyUs;
+    volatile uint32_t _triggerCount;
+    unsigned long _lastPollMicros;
+
+    // Instance served by the ISR
+    static EmergencyStop* _instance;
+    static void handleInterrupt();
+
+    // Record one activation
+    void recordLatency(uint32_t latencyUs);
 
     // Disable all motors
     void disableMotors();
+
+    // Disable all motors without logging (safe in the ISR)
+    static void disableMotorsFast();
 };
\ No newline at end of file
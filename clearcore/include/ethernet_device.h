@@ -5,7 +5,6 @@
 
 // Include STL headers directly
 #include <functional>
-#include <queue>
 
 // Arduino/ClearCore includes
 #include <Arduino.h>
@@ -17,21 +16,117 @@
 #include "EthernetTcpClient.h"
 #include "EthernetTcpServer.h"
 
-// SD Card includes
-#include <SD.h>
+#include "bulk_stream.h"
+#include "event_log.h"
+
+/**
+ * Observer session: an extra connection to the command port. Output is
+ * coalesced like the control session's, but a response that doesn't fit in
+ * the ring is dropped whole rather than stalling the loop, and nothing is
+ * kept once the client disconnects. A full TCP window keeps the queued bytes
+ * for update() to retry; the session is closed only if nothing goes out for
+ * STALL_TIMEOUT_MS.
+ */
+class ObserverSession : public BulkStream {
+public:
+    static const uint16_t TX_RING_SIZE = 1024;
+    static const unsigned long STALL_TIMEOUT_MS = 5000;
+
+    // Constructor
+    ObserverSession();
+
+    // Take over a newly accepted client / close it
+    void attach(const ClearCore::EthernetTcpClient& client);
+    void close();
+
+    // Send output that has been waiting without a newline or behind a full
+    // window; returns false once the client has gone or stalled (the session
+    // is then free again)
+    bool update();
+
+    bool isActive() const { return _active; }
+    unsigned long getConnectedTime() const { return _connectedTime; }
+    uint32_t getBytesSent() const { return _bytesSent; }
+    uint32_t getBytesReceived() const { return _bytesReceived; }
+    uint32_t getDropped() const { return _txDropped; }
+
+    // Stream interface implementation
+    virtual int available() override;
+    virtual int read() override;
+    virtual int peek() override;
+    virtual size_t write(uint8_t data) override;
+    virtual size_t write(const uint8_t* buffer, size_t size) override;
+    virtual void flush() override;
+    virtual int availableForWrite() override;  // Free space in the TX ring
+
+    // Bulk receive
+    virtual int readAvailable(uint8_t* buffer, size_t size) override;
+
+private:
+    ClearCore::EthernetTcpClient _client;
+    bool _active;
+    unsigned long _connectedTime;
+    uint32_t _bytesSent;
+    uint32_t _bytesReceived;
+
+    // Transmit ring
+    uint8_t _txRing[TX_RING_SIZE];
+    uint16_t _txHead;
+    uint16_t _txCount;
+    unsigned long _txOldestTime;
+    uint32_t _txDropped;  // Bytes of responses that didn't fit
+    bool _txStalled;      // The last Send() took nothing
+    unsigned long _txStallTime;
+
+    bool flushTx();
+};
 
 /**
  * Space Maquette - Ethernet Device
  *
  * Handles communication with the host over Ethernet.
- * Implements the Stream interface for compatibility with CommandParser.
+ * Implements the Stream interface for compatibility with CommandParser,
+ * plus BulkStream::readAvailable() for reading a whole TCP receive at once.
  * Includes connection tracking, error logging, and reconnection strategies.
+ *
+ * Bring-up is non-blocking: init() only starts the Ethernet stack, and
+ * update() waits for the PHY link, runs DHCP (falling back to a static IP)
+ * and starts the server, so the rest of the system runs meanwhile.
+ *
+ * The first connection is the control session and is served through the
+ * Stream interface of this class. Connections made while it is taken become
+ * observer sessions (up to MAX_OBSERVERS), each a separate BulkStream with
+ * its own TX ring so every session can have its own CommandParser.
  */
-class EthernetDevice : public Stream {
+class EthernetDevice : public BulkStream {
 public:
     // Default port for the server
     static const uint16_t DEFAULT_PORT = 8080;
 
+    // Transmit ring: writes are coalesced and sent on newline, when
+    // TX_FLUSH_THRESHOLD bytes are waiting, or TX_FLUSH_INTERVAL_MS after the
+    // first unsent byte. Unsent data is kept across reconnects and a full TCP
+    // window; when the ring fills, whole responses are dropped oldest first.
+    static const uint16_t TX_RING_SIZE = 2048;
+    static const uint16_t TX_FLUSH_THRESHOLD = 512;
+    static const unsigned long TX_FLUSH_INTERVAL_MS = 2;
+
+    // Observer sessions allowed next to the control session
+    static const uint8_t MAX_OBSERVERS = 2;
+
+    // Bring-up: PHY link wait, DHCP attempts, then the server is started
+    static const unsigned long LINK_TIMEOUT_MS = 15000;  // Logged, then keeps waiting
+    static const unsigned long DHCP_RETRY_MS = 1000;
+    static const uint8_t DHCP_ATTEMPTS = 3;
+
+    // Bring-up stages
+    enum LinkState {
+        LINK_OFF,       // init() not called yet
+        LINK_WAIT_PHY,  // Waiting for the cable / switch
+        LINK_DHCP,      // Requesting an address
+        LINK_READY      // Address assigned, server listening
+    };
+
     // Connection states for tracking
     enum ConnectionState {
         DISCONNECTED,      // No client connected
@@ -79,18 +174,35 @@ public:
         unsigned long connectionDuration;  // Current connection duration in milliseconds
     };
 
+    // Called when a new client connection is established
+    using ConnectionCallback = std::function<void()>;
+
+    // Called when an observer session connects or disconnects
+    using ObserverCallback = std::function<void(uint8_t index, bool connected)>;
+
     // Constructor
     EthernetDevice(uint16_t port = DEFAULT_PORT);
 
-    // Initialization
+    // Start the Ethernet stack; bring-up continues in update()
     bool init();
 
+    // Bring-up progress
+    LinkState getLinkState() const { return _linkState; }
+    bool isNetworkReady() const { return _linkState == LINK_READY; }
+
     // Configuration
-    void setLogFile(const char* logFilePath);
+    void setLoggingEnabled(bool enabled);  // Records go to the shared EventLogger
     void setLogLevel(LogLevel level);
     void setReconnectEnabled(bool enabled);
+    void setDhcpEnabled(bool enabled);  // false: static IP as soon as the link is up
     void setConnectionTimeout(unsigned long timeoutMs);
     void setHeartbeatInterval(unsigned long intervalMs);
+    void setConnectionCallback(ConnectionCallback callback);
+    void setObserverCallback(ObserverCallback callback);
+
+    // Observer sessions (index 0..MAX_OBSERVERS-1)
+    ObserverSession& getObserver(uint8_t index) { return _observers[index]; }
+    uint8_t getObserverCount() const;
 
     // Stream interface implementation
     virtual int available() override;
@@ -99,6 +211,10 @@ public:
     virtual size_t write(uint8_t data) override;
     virtual size_t write(const uint8_t* buffer, size_t size) override;
     virtual void flush() override;
+    virtual int availableForWrite() override;  // Free space in the TX ring
+
+    // Bulk receive (no per-byte update())
+    virtual int readAvailable(uint8_t* buffer, size_t size) override;
 
     // Connection management
     bool isConnected();
@@ -137,6 +253,13 @@ private:
     uint16_t _port;
     char _ipString[16];  // Buffer to hold IP address string
 
+    // Bring-up state
+    LinkState _linkState;
+    unsigned long _linkStateTime;
+    uint8_t _dhcpAttempts;
+    bool _dhcpEnabled;
+    bool _linkTimeoutLogged;
+
     // Connection state tracking
     ConnectionState _connectionState;
     ErrorCode _lastError;
@@ -166,28 +289,52 @@ private:
     // Statistics
     NetworkStats _stats;
 
+    // New connection handler (resets per-connection state such as the protocol)
+    ConnectionCallback _connectionCallback;
+
+    // Observer sessions
+    ObserverSession _observers[MAX_OBSERVERS];
+    ObserverCallback _observerCallback;
+
     // Logging
     bool _loggingEnabled;
-    char _logFilePath[32];
     LogLevel _logLevel;
 
-    // Pending data queue for reconnection
-    struct PendingData {
-        uint8_t data[64];
-        size_t size;
-    };
-    std::queue<PendingData> _pendingQueue;
-    static const uint8_t MAX_PENDING_ITEMS = 10;
+    // Transmit ring buffer, also the replay buffer across reconnects
+    uint8_t _txRing[TX_RING_SIZE];
+    uint16_t _txHead;   // Oldest unsent byte
+    uint16_t _txCount;  // Unsent bytes
+    unsigned long _txOldestTime;
+    uint32_t _txDropped;  // Bytes of the oldest responses dropped while the ring was full
+
+    // Response boundaries: bit i is set when _txRing[i] starts a response, so a
+    // head that is not a start belongs to a response the client partly received
+    uint8_t _txStarts[TX_RING_SIZE / 8];
+    bool _txAtBoundary;   // The last write ended a response
+    bool _txDiscard;      // Drop the rest of the response being written
+    bool _txSkipPartial;  // New client: skip the rest of a partly sent response
+
+    // Start of a binary response frame (CommandParser::FRAME_SYNC)
+    static const uint8_t FRAME_SYNC = 0xA5;
 
     // Helper methods
-    void logEvent(const char* eventType, LogLevel level, ErrorCode code = ERROR_NONE);
+    void advanceBringUp();
+    void startServer();
+    void logEvent(EventId event, LogLevel level, ErrorCode code = ERROR_NONE);
     void updateConnectionState(ConnectionState newState, ErrorCode errorCode = ERROR_NONE);
     void checkConnectionTimeout();
     unsigned long calculateReconnectDelay();
     bool flushPendingData();
+    size_t queueTx(const uint8_t* buffer, size_t size);
+    bool dropOldestTx();
+    void removeTx(uint16_t offset, uint16_t length);
+    bool isTxStart(uint16_t offset) const;
+    uint16_t nextTxStart(uint16_t offset) const;
+    bool flushTx();
     void trackReceivedData(size_t bytes);
     void trackSentData(size_t bytes);
     void resetReconnectionCounters();
+    void updateObservers();
 };
 
 #endif  // ETHERNET_DEVICE_H
\ No newline at end of file
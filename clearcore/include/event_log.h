@@ -0,0 +1,190 @@
+/**
+ * Space Maquette - Event Log
+ *
+ * Shared, non-blocking event log for all subsystems. log() only appends a
+ * fixed-size binary record to a RAM ring buffer; update(), called from idle
+ * time in loop(), writes whole 512-byte sectors to a log file that stays
+ * open. When the ring is full new records are dropped and counted instead
+ * of blocking the caller.
+ *
+ * Record (16 bytes, little endian):
+ *   <timestamp ms u32><level u8><source u8><event u16><code i32><value i32>
+ * A timed flush pads the last sector with level 0 records, which readers skip;
+ * later flushes rewrite that sector in place until it is full, so a trickle
+ * of events does not grow the file by a sector per flush.
+ */
+
+#ifndef EVENT_LOG_H
+#define EVENT_LOG_H
+
+#include <Arduino.h>
+#include <SD.h>
+
+// Default log file on the SD card
+#define EVENT_LOG_FILE "EVENTS.LOG"
+
+// Ring capacity in records (a multiple of the records per sector)
+#define EVENT_LOG_RECORDS 256
+
+// SD write unit
+#define EVENT_LOG_SECTOR_SIZE 512
+
+// Longest time a record waits in RAM before the (padded) tail sector is written
+#define EVENT_LOG_FLUSH_MS 5000
+
+// Severity (same numbering as EthernetDevice::LogLevel)
+enum EventLevel : uint8_t {
+    EVENT_PADDING = 0,  // Sector padding, not an event
+    EVENT_ERROR = 1,
+    EVENT_WARNING = 2,
+    EVENT_INFO = 3,
+    EVENT_DEBUG = 4
+};
+
+// Subsystem that logged the event
+enum EventSource : uint8_t {
+    SOURCE_SYSTEM,
+    SOURCE_ETHERNET,
+    SOURCE_MOTION,
+    SOURCE_RANGEFINDER,
+    SOURCE_TILT
+};
+
+// Event ids (append only: ids are stored in log files)
+enum EventId : uint16_t {
+    // Ethernet (code = EthernetDevice::ErrorCode, value = connection count where relevant)
+    EVT_ETH_INIT_START,
+    EVT_ETH_LINK_TIMEOUT,
+    EVT_ETH_LINK_ACTIVE,
+    EVT_ETH_DHCP_FAILED,
+    EVT_ETH_STATIC_IP_SET,
+    EVT_ETH_DHCP_SUCCESS,
+    EVT_ETH_SERVER_STARTED,
+    EVT_ETH_CONNECTING,
+    EVT_ETH_CONNECTED,
+    EVT_ETH_DISCONNECTED,
+    EVT_ETH_CLIENT_DISCONNECTED,
+    EVT_ETH_CLIENT_CONNECTED,
+    EVT_ETH_HEARTBEAT_SENT,
+    EVT_ETH_RECONNECT_MAX_ATTEMPTS,
+    EVT_ETH_RECONNECTING,
+    EVT_ETH_RECONNECT_SUCCESS,
+    EVT_ETH_RECONNECT_FAILED,
+    EVT_ETH_CONNECTION_TIMEOUT,
+    EVT_ETH_PENDING_DATA_PARTIAL,
+    EVT_ETH_PENDING_DATA_SENT,
+    EVT_ETH_SEND_FAILED,
+
+    // Motion (code = axis letter)
+    EVT_MOTION_ALERT,           // value = alert register
+    EVT_MOTION_SETTLE_TIMEOUT,
+    EVT_MOTION_FAULT_CLEARED,
+    EVT_MOTION_FAULT_STUCK,
+    EVT_MOTION_HOMED,           // value = position before zeroing
+    EVT_MOTION_TILT_LIMITED,    // value = limit applied
+    EVT_MOTION_TILT_LIMITS_INVALID,  // code = min, value = max
+
+    // Rangefinder (value = distance in 0.1 mm)
+    EVT_RANGE_QUEUE_FULL,
+    EVT_RANGE_FAILED,
+    EVT_RANGE_MEASURED,
+
+    // Tilt servo (value = angle in 0.01 degrees)
+    EVT_TILT_CONSTRAINED,
+    EVT_TILT_SET,
+    EVT_TILT_QUEUE_FULL,
+    EVT_TILT_ACK,
+    EVT_TILT_NO_ACK,            // code = 0 angle / 1 slew, value = centidegrees
+
+    // System
+    EVT_SYS_MEMORY_LOW,         // code = free gap bytes, value = stack peak bytes
+
+    // Tilt link
+    EVT_TILT_LINK_SPEED,        // code = 1 fast / 0 text, value = baud
+    EVT_TILT_LINK_FALLBACK,     // code = 1 stopped answering / 0 negotiation failed, value = baud
+    EVT_MOTION_HOME_FAILED,     // code = axis, value = homing phase (-1 = invalid config)
+    EVT_ETH_OBSERVER_CONNECTED,     // value = connected observers
+    EVT_ETH_OBSERVER_DISCONNECTED,  // value = connected observers
+    EVT_ETH_SESSION_REFUSED,        // Every session slot taken
+    EVT_MOTION_TRACE_CAPTURED,      // code = trigger cause, value = samples
+
+    EVT_COUNT
+};
+
+class EventLog {
+public:
+    // One log record
+    struct Record {
+        uint32_t timestamp;
+        uint8_t level;
+        uint8_t source;
+        uint16_t event;
+        int32_t code;
+        int32_t value;
+    };
+
+    static const int RECORDS_PER_SECTOR = EVENT_LOG_SECTOR_SIZE / sizeof(Record);
+
+    // Constructor
+    EventLog();
+
+    // Open (or create) the log file; records are kept in RAM until then
+    bool begin(const char* path = EVENT_LOG_FILE);
+
+    // Records above this level are ignored
+    void setLevel(uint8_t level);
+    uint8_t getLevel() const { return _level; }
+
+    // Also print each record to Serial (from update(), not from log())
+    void setEcho(bool enable);
+
+    // Queue a record (never blocks; returns false if it was dropped)
+    bool log(EventSource source, uint8_t level, EventId event, int32_t code = 0,
+             int32_t value = 0);
+
+    // Write pending full sectors, or the padded tail once EVENT_LOG_FLUSH_MS passed
+    // (call from idle time in loop())
+    void update();
+
+    // Statistics
+    uint16_t getPending() const { return _count; }
+    uint32_t getDropped() const { return _dropped; }
+    uint32_t getWritten() const { return _written; }
+    bool isOpen() const { return _open; }
+
+    // Event name for decoding and echo
+    static const char* eventName(uint16_t event);
+
+private:
+    File _file;
+    bool _open;
+    uint8_t _level;
+    bool _echo;
+
+    // Ring buffer of pending records
+    Record _ring[EVENT_LOG_RECORDS];
+    uint16_t _head;
+    uint16_t _count;
+    uint16_t _unechoed;  // Newest records not yet echoed
+    unsigned long _oldestTime;
+    unsigned long _lastSync;
+
+    // Staging buffer for one sector (keeps file writes sector sized); between
+    // flushes it keeps the records already written to the partial tail sector
+    Record _sector[RECORDS_PER_SECTOR];
+    uint32_t _tailPosition;  // File offset of the sector being filled
+    uint16_t _tailRecords;   // Records already written to it
+
+    // Statistics
+    uint32_t _dropped;
+    uint32_t _written;
+
+    // Append the oldest records to the tail sector and (re)write it padded
+    void writeSector(int records);
+    void echoRecord(const Record& record);
+};
+
+// Shared instance used by all subsystems
+extern EventLog EventLogger;
+
+#endif  // EVENT_LOG_H
@@ -0,0 +1,87 @@
+/**
+ * Space Maquette - Memory Monitor
+ *
+ * Stack and heap high-water marks for long unattended runs. begin() paints
+ * the unused RAM between the heap top and the stack with a known pattern;
+ * the deepest overwritten word is the stack high-water mark. Heap figures
+ * come from newlib's mallinfo(), and malloc/realloc/free are wrapped at link
+ * time (-Wl,--wrap=...) to count allocations.
+ *
+ * The heap grows up and the stack grows down into the same gap, so the
+ * largest free block is the RAM between the heap top and the stack's lowest
+ * point; free chunks inside the heap arena are reported separately as
+ * fragmented space.
+ *
+ * Built only with -D STACK_MONITORING_ENABLED.
+ */
+
+#ifndef MEMORY_MONITOR_H
+#define MEMORY_MONITOR_H
+
+#include <Arduino.h>
+
+#ifdef STACK_MONITORING_ENABLED
+
+// Warn when the free gap between heap and stack drops below this (bytes)
+#define MEMORY_WARN_BYTES 4096
+
+// Interval between background checks
+#define MEMORY_CHECK_MS 10000
+
+class MemoryMonitor {
+public:
+    struct Stats {
+        uint32_t stackSize;        // Initial stack top to painted bottom
+        uint32_t stackPeak;        // Deepest stack use seen (high-water mark)
+        uint32_t heapUsed;         // Bytes in allocated chunks
+        uint32_t heapFragmented;   // Free chunks inside the heap arena
+        uint32_t largestFree;      // Gap between heap top and stack high-water mark
+        uint32_t allocations;      // malloc/realloc calls that returned memory
+        uint32_t frees;            // free calls with a non-null pointer
+        uint32_t failedAllocations;
+        uint32_t minFree;          // Smallest largestFree seen
+    };
+
+    // Constructor
+    MemoryMonitor();
+
+    // Paint the free stack area (call once, early in setup())
+    void begin();
+
+    // Warning threshold for the free gap (bytes)
+    void setWarningThreshold(uint32_t bytes);
+    uint32_t getWarningThreshold() const { return _warnBytes; }
+
+    // Take a snapshot (scans the painted area)
+    void getStats(Stats& stats);
+
+    // Periodic check; logs a warning once each time the gap drops below the
+    // threshold or an allocation fails
+    void update();
+
+    // True while the last check was below the threshold
+    bool isLow() const { return _lowReported; }
+
+private:
+    uintptr_t _paintBottom;   // Lowest painted address
+    uintptr_t _lowWater;      // Deepest stack address seen
+    uintptr_t _heapPeak;      // Highest heap top seen (scan starts above it)
+    uint32_t _warnBytes;
+    uint32_t _minFree;
+    unsigned long _lastCheck;
+    bool _painted;
+    bool _lowReported;
+
+    // Current heap top
+    static uintptr_t heapTop();
+
+    // Lowest address the stack has written since begin()
+    uintptr_t scanLowWater();
+};
+
+// Shared instance
+extern MemoryMonitor Memory;
+
+#endif  // STACK_MONITORING_ENABLED
+
+#endif  // MEMORY_MONITOR_H
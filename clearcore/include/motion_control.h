@@ -2,9 +2,15 @@
 #ifndef MOTION_CONTROL_H
 #define MOTION_CONTROL_H
 
+#include "macros.h"
+
+// Include STL headers directly
+#include <functional>
+
 #include <Arduino.h>
 
 #include "ClearCore.h"
+#include "event_log.h"
 #include "tilt_servo.h"  // Include the tilt servo header
 
 // Define default velocity and acceleration limits
@@ -18,25 +24,110 @@
 #define MOTOR_PAN_AXIS      ConnectorM3
 #define PAN_HOME_SENSOR_PIN 2  // Replace with actual pin number
 
+// Homing defaults (per-axis values come from CONFIG.TXT)
+#define HOME_SEEK_VELOCITY  5000    // Fast approach to the sensor (steps/s)
+#define HOME_LATCH_VELOCITY 500     // Slow approach that sets zero (steps/s)
+#define HOME_BACKOFF_STEPS  400     // Distance backed off the sensor before latching
+#define HOME_MAX_TRAVEL     200000  // Seek distance before giving up (steps)
+#define HOME_TIMEOUT_MS     60000   // Longest a single axis may take
+
+// Number of step and direction axes driven by the motion engine (X, Y, Z, Pan)
+#define MOTION_AXIS_COUNT 4
+
+// Maximum time to wait for HLFB after the steps of a move complete
+#define MOVE_SETTLE_TIMEOUT_MS 5000
+
+// Interval between acceleration steps of a jerk-limited move, and between the
+// velocity commands of its tapered stop
+#define MOTION_JERK_STEP_MS 5
+#define MOTION_STOP_STEP_MS 1
+
+// Capacity of the on-controller motion segment queue (MOVEQ)
+#define MOTION_QUEUE_SIZE 32
+
+// A MOVEQ arriving this soon after the queue ran dry counts as an underrun
+#define MOTION_UNDERRUN_WINDOW_MS 250
+
+// Per-axis state of the non-blocking motion engine
+enum AxisMoveState {
+    AXIS_IDLE,     // No move in progress
+    AXIS_MOVING,   // Steps are still being generated
+    AXIS_SETTLING  // Steps complete, waiting for HLFB to assert
+};
+
+// Motion limits of one axis
+// With a jerk limit, acceleration is raised in steps at the start of each move
+// (an S-curve onset) instead of jumping to the full limit, and the stop is
+// driven along an S-curve so the axis arrives without a deceleration step
+struct AxisProfile {
+    int32_t velocity;      // Velocity limit (steps/s)
+    int32_t acceleration;  // Acceleration limit (steps/s^2)
+    int32_t jerk;          // Jerk limit (steps/s^3), 0 = trapezoidal
+};
+
+// Live state of one motor connector, sampled from the driver every update()
+// (ClearPath step and direction motors report no encoder position, so the
+// actual position is the commanded one once HLFB confirms the motor is there)
+struct AxisState {
+    int32_t commanded;  // PositionRefCommanded() (steps)
+    int32_t actual;     // Last position confirmed by HLFB (steps)
+    int32_t velocity;   // VelocityRefCommanded() (steps/s)
+    bool hlfb;          // HLFB asserted
+    bool alert;         // Alerts present
+    bool inPosition;    // Steps complete and HLFB asserted: actual == commanded
+};
+
+// Phases of the homing state machine for one axis
+enum HomingPhase {
+    HOME_IDLE,        // Not homing
+    HOME_WAITING,     // Queued behind another axis (sequential homing)
+    HOME_SEEK,        // Fast move toward the sensor
+    HOME_SEEK_STOP,   // Sensor found, decelerating
+    HOME_CLEAR,       // Started on the sensor, moving off it
+    HOME_BACKOFF,     // Backing off the sensor before the latch
+    HOME_LATCH,       // Slow approach; the sensor edge becomes zero
+    HOME_LATCH_STOP,  // Edge latched, stopping
+    HOME_RETURN,      // Moving to the new zero
+    HOME_DONE,        // Homed
+    HOME_FAILED       // Sensor not found, alert, ESTOP or timeout
+};
+
+// Homing setup of one step and direction axis
+struct HomingConfig {
+    int sensorPin;          // Home sensor input, -1 = none (the current position becomes zero)
+    int8_t direction;       // Seek direction, +1 or -1
+    int32_t seekVelocity;   // steps/s
+    int32_t latchVelocity;  // steps/s
+    int32_t backoff;        // steps
+    int32_t maxTravel;      // steps
+};
+
+// Asynchronous motion events reported by update()
+enum MotionEvent {
+    MOTION_EVENT_MOVE_DONE,     // All axes of the move reached their targets
+    MOTION_EVENT_MOVE_FAILED,   // An axis raised an alert or failed to settle
+    MOTION_EVENT_HOME_PHASE,    // An axis entered a new homing phase (getHomingPhase())
+    MOTION_EVENT_HOME_DONE,     // An axis was homed (axis 0: all requested axes homed)
+    MOTION_EVENT_HOME_FAILED    // An axis failed to home (homing of the rest is aborted)
+};
+
+// Callback for motion events (axis is the failing axis, or 0 for MOVE_DONE)
+using MotionEventCallback = std::function<void(MotionEvent event, char axis)>;
+
 class MotionControl {
 private:
     // Define motor status flags
     bool _initialized;
     bool _homed;
 
-    // Current positions for each axis
-    int32_t _currentX;
-    int32_t _currentY;
-    int32_t _currentZ;
-    int32_t _currentPan;
+    // Live position model of the step and direction axes (X, Y, Z, Pan)
+    AxisState _axisState[MOTION_AXIS_COUNT];
+
+    // Last commanded tilt angle (the servo reports no position)
     int32_t _currentTilt;
 
-    // Speed and acceleration parameters
-    int _velocityX;
-    int _velocityY;
-    int _velocityZ;
-    int _velocityPan;
-    int _accelerationLimit;
+    // Velocity, acceleration and jerk limits per axis (X, Y, Z, Pan)
+    AxisProfile _profiles[MOTION_AXIS_COUNT];
 
     // Motor enabled states
     bool _xEnabled;
@@ -53,18 +144,127 @@ private:
     // Pointer to tilt servo interface
     TiltServo *_tiltServo;
 
+    // Move tracking for a single step and direction axis
+    struct AxisMove {
+        MotorDriver *motor;
+        char name;
+        AxisMoveState state;
+        int32_t target;
+        unsigned long settleStartTime;
+
+        // Jerk-limited acceleration ramp of the current move
+        int32_t accelLimit;
+        int32_t jerk;
+        int32_t rampAccel;
+        unsigned long rampStartTime;
+        unsigned long rampStepTime;
+        int32_t lastVelocity;
+
+        // Jerk-limited stop, planned from the speed when it begins: velocity
+        // commands follow the S-curve by remaining distance, then a positional
+        // move covers the last step
+        bool stopping;
+        bool landed;       // Final positional move issued (or the stop left to the driver)
+        int8_t direction;  // Sign of the travel
+        float stopSpeed;   // Speed when the stop was planned (steps/s)
+        float stopJerk;    // Jerk of the stop (steps/s^3)
+        float stopAccel;   // Peak deceleration (steps/s^2)
+        float stopRamp;    // Duration of each jerk phase (s)
+        float stopTail;    // Remaining distance where the deceleration tapers off
+        float stopBrake;   // Remaining distance where the constant deceleration ends
+        float stopLength;  // Total stopping distance
+    };
+    AxisMove _axes[MOTION_AXIS_COUNT];
+
+    // State of the current (possibly multi-axis) move
+    bool _moveActive;
+    bool _moveFailed;
+    char _failedAxis;
+    bool _lastMoveFailed;  // Result of the most recently finished (or stopped) move
+
+    // Coordinated (synchronized arrival) mode for multi-axis moves
+    bool _coordinatedMoves;
+
+    // Queued coordinated move segment (positions < 0 leave the axis unchanged)
+    struct MotionSegment {
+        int32_t x;
+        int32_t y;
+        int32_t z;
+        int32_t pan;
+    };
+
+    // Ring buffer of queued segments
+    MotionSegment _queue[MOTION_QUEUE_SIZE];
+    uint8_t _queueHead;
+    uint8_t _queueCount;
+    bool _queuedMove;  // Current move was fed from the queue
+
+    // Queue statistics for tuning the host streaming rate
+    uint32_t _queueCompleted;
+    uint32_t _queueUnderruns;  // Queue ran dry while the host was still streaming
+    bool _queueDrained;        // Queue ran dry; the next MOVEQ decides if it was mid-path
+    unsigned long _queueDrainTime;
+
+    // Motion event handler
+    MotionEventCallback _eventCallback;
+
+    // Non-blocking motion helpers
+    AxisMove *findAxis(char axis);
+    bool prepareAxisMove(AxisMove &axis);
+    void startAxisMove(AxisMove &axis, int32_t position, const AxisProfile &profile);
+    void shapeAxisMove(AxisMove &axis);
+    void rampAxisAcceleration(AxisMove &axis, unsigned long now, int32_t speed);
+    bool planAxisStop(AxisMove &axis, float speed, float distance);
+    void taperAxisStop(AxisMove &axis, float speed, float distance);
+    static float stopDistance(float speed, float acceleration, float jerk);
+    static float stopSpeedAt(const AxisMove &axis, float distance);
+    void failAxisMove(AxisMove &axis);
+    int axisIndex(char axis);
+    void sampleAxes();
+    void finishMove();
+    void startNextSegment();
+
     // Helper function to check HLFB status
     bool waitForHlfb(MotorDriver &motor, uint32_t timeoutMs = 5000);
 
     // Alert handling functions
-    void printAlerts(MotorDriver &motor);
+    char motorAxisName(MotorDriver &motor);
+    void logAlerts(MotorDriver &motor);
     bool handleAlerts(MotorDriver &motor);
 
-    // Pin for Pan home sensor
-    int _panHomeSensorPin;
-    // Methods for Pan homing
-    bool isPanHomeSensorTriggered();
-    bool homePanAxis();
+    // Homing state machine of one step and direction axis
+    struct AxisHoming {
+        HomingConfig config;
+        HomingPhase phase;
+        unsigned long startTime;
+
+        // Sensor edge, captured by the pin interrupt (or by update() without one)
+        volatile bool armed;
+        volatile bool edgeSeen;
+        volatile int32_t edgePosition;
+    };
+    AxisHoming _homing[MOTION_AXIS_COUNT];
+    bool _homingParallel;  // Home independent axes at the same time
+    bool _homingAll;       // Current homing run sets _homed when it completes
+
+    // Homing helpers
+    bool isHomeSensorActive(int index);
+    void attachHomeSensor(int index);
+    void armHomeEdge(int index);
+    bool takeHomeEdge(int index);
+    void startHoming(int index);
+    void updateHoming(int index);
+    void setHomingPhase(int index, HomingPhase phase);
+    void finishHoming(int index, bool success);
+    void abortHoming();
+
+    // Edge capture from the sensor interrupts
+    static MotionControl *_homingInstance;
+    void captureHomeEdge(int index);
+    static void homeEdgeX();
+    static void homeEdgeY();
+    static void homeEdgeZ();
+    static void homeEdgePan();
 
 public:
     // Constructor
@@ -73,6 +273,9 @@ public:
     // Set the tilt servo instance (should be called before init)
     void setTiltServo(TiltServo *tiltServo);
 
+    // Set handler for asynchronous MOVE_DONE / MOVE_FAILED events
+    void setEventCallback(MotionEventCallback callback);
+
     // Initialization
     bool init();
 
@@ -82,27 +285,55 @@ public:
     bool enableAllMotors();
     bool disableAllMotors();
 
-    // Homing functions
+    // Homing functions (non-blocking: progress is reported through update())
     bool homeAxis(char axis);
     bool homeAllAxes();
+    bool setHomingConfig(char axis, const HomingConfig &config);
+    const HomingConfig *getHomingConfig(char axis);
+    void setParallelHoming(bool enabled) { _homingParallel = enabled; }
+    bool isHoming() const;
+    HomingPhase getHomingPhase(char axis);
+    static const char *getHomingPhaseName(HomingPhase phase);
 
-    // Motion functions
+    // Motion functions (non-blocking: completion is reported through update())
     bool moveAbsolute(char axis, int32_t position);
     bool moveRelative(char axis, int32_t distance);
     bool moveToPosition(int32_t x, int32_t y, int32_t z, int32_t pan = -1, int32_t tilt = -1);
+    bool moveCoordinated(int32_t x, int32_t y, int32_t z, int32_t pan = -1);
     bool stop();
 
+    // Motion queue functions
+    bool queueMove(int32_t x, int32_t y, int32_t z, int32_t pan = -1);
+    void clearQueue();
+    bool isQueueActive() const { return _queuedMove || _queueCount > 0; }
+    int getQueueDepth() const { return _queueCount; }
+    int getQueueCapacity() const { return MOTION_QUEUE_SIZE; }
+    uint32_t getQueueCompleted() const { return _queueCompleted; }
+    uint32_t getQueueUnderruns() const { return _queueUnderruns; }
+
     // Parameter functions
     void setVelocity(int vx, int vy = 0, int vz = 0);
-    void setAcceleration(int acceleration);
-    int getVelocityX() { return _velocityX; }
-    int getVelocityY() { return _velocityY; }
-    int getVelocityZ() { return _velocityZ; }
-    int getAcceleration() { return _accelerationLimit; }
-
-    // Position query functions
-    int32_t getCurrentPosition(char axis);
+    void setAcceleration(int acceleration);  // All axes
+    int getVelocityX() { return _profiles[0].velocity; }
+    int getVelocityY() { return _profiles[1].velocity; }
+    int getVelocityZ() { return _profiles[2].velocity; }
+    int getAcceleration() { return _profiles[0].acceleration; }
+
+    // Per-axis profiles (applied from the next move)
+    bool setAxisProfile(char axis, int32_t velocity, int32_t acceleration, int32_t jerk);
+    const AxisProfile *getAxisProfile(char axis);
+
+    // Select synchronized arrival (default) or independent axes for moveToPosition
+    void setCoordinatedMoves(bool enabled) { _coordinatedMoves = enabled; }
+    bool getCoordinatedMoves() { return _coordinatedMoves; }
+
+    // Position query functions (live: sampled from the drivers every update())
+    int32_t getCurrentPosition(char axis);  // Commanded position
+    int32_t getActualPosition(char axis);
+    int32_t getAxisVelocity(char axis);
+    const AxisState *getAxisState(char axis);
     bool isMoving();
+    bool lastMoveFailed() const { return _lastMoveFailed; }
     bool isHomed();
 
     // Servo-specific functions
@@ -117,14 +348,18 @@ public:
     bool hasError();
     const char *getErrorMessage();
 
-    // Update method for continuous operations
+    // Per-axis status bits (bit 0 = X, 1 = Y, 2 = Z, 3 = Pan)
+    uint8_t getHlfbMask();
+    uint8_t getAlertMask();
+
+    // Advance in-progress moves and report completion (call every loop)
     void update();
 
     // Accessor functions
-    float getPositionX() { return _currentX; }
-    float getPositionY() { return _currentY; }
-    float getPositionZ() { return _currentZ; }
-    float getPanAngle() { return _currentPan; }
+    float getPositionX() { return _axisState[0].commanded; }
+    float getPositionY() { return _axisState[1].commanded; }
+    float getPositionZ() { return _axisState[2].commanded; }
+    float getPanAngle() { return _axisState[3].commanded; }
     float getTiltAngle() { return _currentTilt; }
 };
 
@@ -0,0 +1,198 @@
+/**
+ * Space Maquette - Motion Trace
+ *
+ * Fixed-size RAM recorder for tuning and fault analysis. While armed it
+ * samples the commanded position, HLFB and alert bits of M0-M3 plus the tilt
+ * target every period during moves and homing (and stays silent otherwise),
+ * so it can be left armed in production. A trigger (move start, new alert,
+ * ESTOP, failed move or a manual TRACE:TRIGGER) keeps the history before it,
+ * records the post-trigger samples unconditionally and then freezes the
+ * buffer until it is armed again.
+ *
+ * A frozen trace is read out as one binary blob (little endian):
+ *   header (20 bytes)
+ *     "MTRC" <version u8><sample size u8><count u16><period ms u16>
+ *     <trigger index u16, 0xFFFF = none><armed triggers u8><cause u8>
+ *     <reserved u16><trigger time ms u32>
+ *   count samples, oldest first (32 bytes each)
+ *     <time ms u32><commanded x,y,z,pan i32 x4><alert register x,y,z,pan u16 x4>
+ *     <tilt 0.01 deg i16><hlfb mask u8><flags u8>
+ *   CRC-16/MODBUS of everything before it (u16)
+ * or as CSV rows, and can be written to the SD card a sector per update.
+ */
+
+#ifndef MOTION_TRACE_H
+#define MOTION_TRACE_H
+
+#include <Arduino.h>
+#include <SD.h>
+
+#include "emergency.h"
+#include "motion_control.h"
+
+// Samples kept in RAM (32 bytes each)
+#define TRACE_CAPACITY 256
+
+// Defaults for the trace_period_ms and trace_post_samples config keys
+#define TRACE_DEFAULT_PERIOD_MS 10
+#define TRACE_DEFAULT_POST 64
+#define TRACE_DEFAULT_TRIGGERS "ALERT,ESTOP,FAIL"  // trace_triggers
+
+// Default CSV file for TRACE:SAVE, and the bytes written per updateSave()
+#define TRACE_CSV_FILE "TRACE.CSV"
+#define TRACE_SAVE_SECTOR_SIZE 512
+
+// Trigger sources (armed mask and capture cause)
+#define TRACE_TRIG_MOVE 0x01    // A move or homing started
+#define TRACE_TRIG_ALERT 0x02   // An axis raised a new alert
+#define TRACE_TRIG_ESTOP 0x04   // Emergency stop activated
+#define TRACE_TRIG_FAIL 0x08    // A move failed
+#define TRACE_TRIG_MANUAL 0x80  // trigger() / TRACE:TRIGGER
+
+// Sample flags
+#define TRACE_FLAG_MOVING 0x01
+#define TRACE_FLAG_HOMING 0x02
+#define TRACE_FLAG_ESTOP 0x04
+
+class MotionTrace {
+public:
+    enum State {
+        TRACE_IDLE,       // Not recording
+        TRACE_ARMED,      // Recording moves, waiting for a trigger
+        TRACE_TRIGGERED,  // Recording the post-trigger samples
+        TRACE_DONE        // Frozen, ready for download
+    };
+
+    enum SaveState {
+        SAVE_IDLE,
+        SAVE_RUNNING,
+        SAVE_DONE,
+        SAVE_FAILED
+    };
+
+    // One sample as kept in RAM (same layout as the blob)
+    struct Sample {
+        uint32_t time;
+        int32_t commanded[MOTION_AXIS_COUNT];
+        uint16_t alerts[MOTION_AXIS_COUNT];
+        int16_t tilt;
+        uint8_t hlfb;
+        uint8_t flags;
+    };
+
+    static const size_t HEADER_SIZE = 20;
+    static const size_t SAMPLE_SIZE = 32;
+    static const uint8_t BLOB_VERSION = 1;
+    static const uint16_t NO_TRIGGER = 0xFFFF;
+
+    // Constructor
+    MotionTrace(MotionControl& motion, EmergencyStop& estop);
+
+    // Sample interval and samples kept after the trigger (applied on the next arm)
+    void setPeriod(uint16_t periodMs);
+    void setPostSamples(uint16_t samples);
+    uint16_t getPeriod() const { return _period; }
+    uint16_t getPostSamples() const { return _postSamples; }
+
+    // Start recording with an empty buffer (ends any capture or save)
+    void arm(uint8_t triggers);
+
+    // Trigger now (armed only)
+    bool trigger();
+
+    // Stop recording and discard the buffer
+    void stop();
+
+    // Check triggers and take due samples (call every loop, next to motion.update())
+    void update();
+
+    // Write the next sector of a CSV save (call from idle time in loop())
+    void updateSave();
+
+    // State
+    State getState() const { return _state; }
+    uint8_t getTriggers() const { return _triggers; }
+    uint8_t getCause() const { return _cause; }
+    uint16_t getSampleCount() const { return _count; }
+    uint16_t getCapacity() const { return TRACE_CAPACITY; }
+
+    // Incremented when a capture freezes, so readers can tell a new trace from
+    // the one they started downloading
+    uint16_t getCaptureId() const { return _captureId; }
+
+    // Frozen trace (valid while getState() == TRACE_DONE)
+    uint32_t getBlobSize() const;
+    uint16_t getBlobCRC() const { return _blobCRC; }
+
+    // Copy up to size blob bytes starting at offset; returns the bytes copied
+    size_t readBlob(uint32_t offset, uint8_t* buffer, size_t size) const;
+
+    // CSV header line and sample rows (oldest first, time relative to the
+    // trigger); each ends in "\r\n". Return the length, 0 past the last row
+    static const char* getCsvHeader();
+    int getCsvRow(uint16_t index, char* buffer, size_t size) const;
+
+    // Write the frozen trace to a CSV file on the SD card, one sector per updateSave()
+    bool saveCsv(const char* path = TRACE_CSV_FILE);
+    SaveState getSaveState() const { return _saveState; }
+    const char* getSavePath() const { return _savePath; }
+
+    // Trigger mask from a list of names ("MOVE", "ALERT", "ESTOP", "FAIL");
+    // -1 if a name is unknown
+    static int parseTrigger(const char* name);
+    static int parseTriggers(const char* list);
+
+    // Name of a state ("IDLE", "ARMED", "TRIGGERED", "DONE")
+    static const char* getStateName(State state);
+
+private:
+    MotionControl& _motion;
+    EmergencyStop& _estop;
+
+    State _state;
+    uint8_t _triggers;
+    uint8_t _cause;
+    uint16_t _period;
+    uint16_t _postSamples;
+    uint16_t _captureId;
+
+    // Ring of samples: _head is the next slot, _count the samples held
+    Sample _samples[TRACE_CAPACITY];
+    uint16_t _head;
+    uint16_t _count;
+    uint32_t _total;         // Samples taken since arm()
+    uint32_t _triggerTotal;  // _total when the trigger sample was taken
+    uint16_t _postRemaining;
+    uint32_t _triggerTime;
+    unsigned long _lastSample;
+
+    // Previous values for edge detection
+    bool _wasActive;
+    bool _wasMoving;
+    bool _wasFailed;
+    bool _wasEstop;
+    uint8_t _lastAlerts;
+
+    uint16_t _blobCRC;
+
+    // CSV save
+    File _saveFile;
+    SaveState _saveState;
+    uint16_t _saveRow;  // Next row; 0 = the header line
+    char _savePath[16];
+    char _saveBuffer[TRACE_SAVE_SECTOR_SIZE];
+
+    void takeSample(bool moving, bool homing, bool estop);
+    void startCapture(uint8_t cause, bool moving, bool homing, bool estop);
+    void freeze();
+    void finishSave(bool success);
+
+    // Sample by age (0 = oldest)
+    const Sample& sampleAt(uint16_t index) const;
+    uint16_t triggerIndex() const;
+
+    void writeHeader(uint8_t* out) const;
+    static void writeSample(const Sample& sample, uint8_t* out);
+};
+
+#endif  // MOTION_TRACE_H
@@ -0,0 +1,136 @@
+/**
+ * Space Maquette - Performance Monitor
+ *
+ * Cycle-accurate timing of the main loop stages and of each command, using
+ * the Cortex-M4 DWT cycle counter. Each timed section keeps its count, min,
+ * max, mean and a log2 histogram (bucket n counts durations of 2^n to
+ * 2^(n+1)-1 cycles). Reported by the PERF command and the /perf web page.
+ *
+ * Built only with -D PERF_MONITORING_ENABLED; without it the PERF_* macros
+ * expand to the bare statements and nothing is timed.
+ */
+
+#ifndef PERF_MONITOR_H
+#define PERF_MONITOR_H
+
+#include <Arduino.h>
+
+// Timed main loop stages
+enum PerfStage {
+    PERF_LOOP,       // Full loop() period, entry to entry
+    PERF_ETHERNET,   // ethernetDevice.update()
+    PERF_WEB,        // webServer.update()
+    PERF_ESTOP,      // estop.check() and its handling
+    PERF_PARSER,     // parser.update(), including the commands it runs
+    PERF_MOTION,     // motion.update()
+    PERF_SERIAL,     // serialDevices.update()
+    PERF_COMMANDS,   // cmdHandler.update()
+    PERF_SCANNER,    // scanner.update()
+    PERF_TELEMETRY,  // telemetry.update()
+    PERF_LOG,        // EventLogger.update()
+    PERF_STAGE_COUNT
+};
+
+#ifdef PERF_MONITORING_ENABLED
+
+#include <sam.h>
+
+// Command slots (indexed by the command table)
+#define PERF_MAX_COMMANDS 48
+
+// Histogram buckets (one per bit of a 32-bit cycle count)
+#define PERF_HISTOGRAM_BUCKETS 32
+
+class PerfMonitor {
+public:
+    // Timing of one section
+    struct Stat {
+        uint32_t count;
+        uint32_t minCycles;
+        uint32_t maxCycles;
+        uint64_t totalCycles;
+        uint32_t histogram[PERF_HISTOGRAM_BUCKETS];
+    };
+
+    // Constructor
+    PerfMonitor();
+
+    // Enable the DWT cycle counter (call once from setup())
+    void begin();
+
+    // Current cycle count
+    static inline uint32_t cycles() { return DWT->CYCCNT; }
+
+    // Convert cycles to microseconds
+    static float cyclesToMicros(uint64_t cycles) {
+        return static_cast<float>(cycles) / (F_CPU / 1000000UL);
+    }
+
+    // Record one duration
+    void recordStage(PerfStage stage, uint32_t cycles);
+    void recordCommand(int index, uint32_t cycles);
+
+    // Record the loop period; call at the top of loop()
+    void markLoop();
+
+    // Name a command slot (names must stay valid, e.g. string literals)
+    void setCommandName(int index, const char* name);
+
+    // Stats are numbered stages first, then command slots
+    int getStatCount() const { return PERF_STAGE_COUNT + PERF_MAX_COMMANDS; }
+    const char* getStatName(int index) const;
+    const Stat* getStat(int index) const;
+    int findStat(const char* name) const;
+
+    // Clear every stat
+    void reset();
+
+private:
+    Stat _stages[PERF_STAGE_COUNT];
+    Stat _commands[PERF_MAX_COMMANDS];
+    const char* _commandNames[PERF_MAX_COMMANDS];
+    uint32_t _lastLoop;
+    bool _loopStarted;
+
+    static void record(Stat& stat, uint32_t cycles);
+    static void clear(Stat& stat);
+};
+
+// Shared instance
+extern PerfMonitor Profiler;
+
+// Time a statement as a loop stage / command handler (variadic so the
+// statement may contain commas)
+#define PERF_TIME_STAGE(stage, ...)                                      \
+    do {                                                                 \
+        uint32_t perfStart = PerfMonitor::cycles();                      \
+        __VA_ARGS__;                                                     \
+        Profiler.recordStage(stage, PerfMonitor::cycles() - perfStart);  \
+    } while (0)
+
+#define PERF_TIME_COMMAND(index, ...)                                      \
+    do {                                                                   \
+        uint32_t perfStart = PerfMonitor::cycles();                        \
+        __VA_ARGS__;                                                       \
+        Profiler.recordCommand(index, PerfMonitor::cycles() - perfStart);  \
+    } while (0)
+
+#define PERF_MARK_LOOP() Profiler.markLoop()
+
+#else
+
+#define PERF_TIME_STAGE(stage, ...) \
+    do {                            \
+        __VA_ARGS__;                \
+    } while (0)
+
+#define PERF_TIME_COMMAND(index, ...) \
+    do {                              \
+        __VA_ARGS__;                  \
+    } while (0)
+
+#define PERF_MARK_LOOP()
+
+#endif  // PERF_MONITORING_ENABLED
+
+#endif  // PERF_MONITOR_H
@@ -3,19 +3,55 @@
 
 #include <Arduino.h>
 
+#include "event_log.h"
 #include "serial_devices.h"
 
 class Rangefinder {
 public:
+    // Timestamped measurement result
+    struct Measurement {
+        float distance;          // Distance in mm (0 when invalid)
+        unsigned long timestamp;  // millis() when the reading arrived
+        bool valid;               // False on timeout or out-of-range reading
+    };
+
+    // Number of results buffered between polls
+    static const uint8_t RESULT_BUFFER_SIZE = 8;
+
+    // Time to wait for the sensor to answer a DIST request
+    static const unsigned long MEASUREMENT_TIMEOUT_MS = 1000;
+
+    // COM1 scheduler priority (below tilt commands)
+    static const uint8_t RANGEFINDER_JOB_PRIORITY = 0;
+
     Rangefinder(SerialDevices &serialDevices);
     ~Rangefinder();
 
     // Initialize the rangefinder
     void begin();
 
-    // Take a distance measurement
+    // Take a distance measurement (blocking, up to MEASUREMENT_TIMEOUT_MS)
     float takeMeasurement();
 
+    // Asynchronous API: start a reading, then poll() (or SerialDevices::update())
+    // until isReady()
+    bool startMeasurement();
+    bool poll();
+    bool isReady() const;
+    bool readResult(Measurement &result);
+    void clearResults();
+    bool isBusy() const;
+    uint8_t getResultCount() const;
+    uint32_t getDroppedResults() const;
+
+    // Continuous mode: back-to-back polling, not a sensor-side stream. The DIST
+    // request/response protocol spoken here has no free-running mode, and COM1
+    // is shared with the tilt servo through the relay, so each reading stays a
+    // scheduler job and the next DIST is queued as soon as the previous one
+    // answers. The rate is one round trip per reading, interleaved with tilt jobs
+    void setContinuous(bool enable);
+    bool isContinuous() const;
+
     // Get the last successful measurement
     float getLastMeasurement() const;
 
@@ -26,8 +62,12 @@ private:
     // Parse distance from sensor response
     float parseDistance(const char *buffer);
 
-    // Debug logging
-    void log(const String &message);
+    // COM1 scheduler completion for a DIST request
+    void handleResponse(SerialDevices::JobStatus status, const char *response);
+
+    // Store a finished reading in the result buffer
+    void pushResult(float distance, bool valid);
+
 
     // Reference to the serial device manager
     SerialDevices &_serialDevices;
@@ -35,8 +75,19 @@ private:
     // Last valid measurement
     float _lastMeasurement;
 
+    // In-flight request state
+    bool _pending;
+    bool _continuous;
+    bool _newResult;  // Set when a reading finishes during poll()
+
+    // Ring buffer of finished results
+    Measurement _results[RESULT_BUFFER_SIZE];
+    uint8_t _resultHead;
+    uint8_t _resultCount;
+    uint32_t _droppedResults;
+
     // Debug flag
     bool _debugEnabled;
 };
 
-#endif  // RANGEFINDER_H
\ No newline at end of file
+#endif  // RANGEFINDER_H
@@ -0,0 +1,100 @@
+/**
+ * Space Maquette - Scan Controller
+ *
+ * Runs a raster scan on the controller: moves across a grid with the
+ * non-blocking motion engine, takes a rangefinder reading at each point
+ * and streams the results to the host in batched DATA frames.
+ * Driven incrementally from the main loop via update().
+ */
+
+#pragma once
+
+#include <Arduino.h>
+
+#include "command_parser.h"
+#include "motion_control.h"
+#include "rangefinder.h"
+
+// Number of points sent per DATA frame
+#define SCAN_BATCH_POINTS 16
+
+// Default dwell between arriving at a point and measuring
+#define SCAN_DEFAULT_SETTLE_MS 50
+
+class ScanController {
+public:
+    // Scan states
+    enum ScanState {
+        SCAN_IDLE,       // No scan running
+        SCAN_MOVING,     // Moving to the next grid point
+        SCAN_SETTLING,   // At the point, waiting for the mount to settle
+        SCAN_MEASURING,  // Waiting for the rangefinder reading
+        SCAN_PAUSED      // Paused between points
+    };
+
+    // Constructor
+    ScanController(MotionControl& motion, Rangefinder& rangefinder, CommandParser& parser);
+
+    // Start a scan of the rectangle (x1,y1)-(x2,y2) with the given step
+    bool start(int32_t x1, int32_t y1, int32_t x2, int32_t y2, int32_t step);
+
+    // Pause after the current point / resume / abort immediately
+    bool pause();
+    bool resume();
+    void abort();
+
+    // Advance the scan (call every loop)
+    void update();
+
+    // Dwell time between arrival and measurement
+    void setSettleTime(unsigned long settleMs) { _settleMs = settleMs; }
+
+    // Status
+    bool isActive() const { return _state != SCAN_IDLE; }
+    ScanState getState() const { return _state; }
+    const char* getStateString() const;
+    uint32_t getPointsDone() const { return _pointIndex; }
+    uint32_t getPointsTotal() const { return _pointCount; }
+
+private:
+    // References to system components
+    MotionControl& _motion;
+    Rangefinder& _rangefinder;
+    CommandParser& _parser;
+
+    // Scan state
+    ScanState _state;
+    bool _pauseRequested;
+    unsigned long _settleStart;
+    unsigned long _settleMs;
+
+    // Grid definition
+    int32_t _x1;
+    int32_t _y1;
+    int32_t _stepX;
+    int32_t _stepY;
+    uint32_t _columns;
+    uint32_t _rows;
+    uint32_t _pointCount;
+    uint32_t _pointIndex;
+
+    // Current grid point
+    int32_t _pointX;
+    int32_t _pointY;
+
+    // Batched results waiting to be sent
+    struct ScanPoint {
+        int32_t x;
+        int32_t y;
+        float distance;
+    };
+    ScanPoint _batch[SCAN_BATCH_POINTS];
+    uint8_t _batchCount;
+    uint32_t _batchFirstIndex;
+
+    // Helper methods
+    bool moveToPoint(uint32_t index);
+    void recordPoint(float distance);
+    void flushBatch();
+    void finish(const char* event);
+};
@@ -3,18 +3,43 @@
 
 #include "macros.h"
 
-// Include STL headers directly - no protection needed with our new approach
-// Add any STL includes here
+// Protect STL min/max: this header may be included after Arduino.h
+// (spelled out because GCC ignores the _Pragma("undef") in PROTECT_STD_MINMAX)
+#pragma push_macro("min")
+#pragma push_macro("max")
+#undef min
+#undef max
+#include <functional>
+#pragma pop_macro("max")
+#pragma pop_macro("min")
 
 // Arduino/ClearCore includes
 #include <Arduino.h>
 
 #include "ClearCore.h"
 
+// Scheduler limits
+#define SERIAL_JOB_QUEUE_SIZE   8    // Pending transactions across all devices
+#define SERIAL_JOB_REQUEST_SIZE 32   // Longest request string
+#define SERIAL_RESPONSE_SIZE    32   // Longest response line
+#define SERIAL_RELAY_SETTLE_MS  10   // Relay switch time before talking to a device
+#define SERIAL_MAX_BATCH        4    // Same-device jobs in a row while others wait
+
 class SerialDevices {
 public:
     enum DeviceType { NONE = 0, RANGEFINDER = 1, CAMERA = 2, TILT_SERVO = 3 };
 
+    // Outcome of a scheduled transaction
+    enum JobStatus {
+        JOB_OK,         // Response line received
+        JOB_TIMEOUT,    // No response within the job timeout
+        JOB_EXPIRED,    // Deadline passed before the job could start
+        JOB_CANCELLED   // Removed with cancelJobs()
+    };
+
+    // Completion callback (response is the first non-empty line, "" if none)
+    using JobCallback = std::function<void(JobStatus status, const char *response)>;
+
     // Constructor with ClearCorePins parameter
     SerialDevices(ClearCorePins serialPin);
 
@@ -39,6 +64,34 @@ public:
     // Check if a device is currently active
     bool isDeviceActive(DeviceType device) const;
 
+    // Transaction scheduler: queue a request/response job for a device.
+    // Higher priority runs first; jobs not started by deadlineMs from now expire
+    // (0 = no deadline). The callback runs from update().
+    bool submitJob(DeviceType device, const char *request, JobCallback callback,
+                   uint8_t priority = 0, unsigned long deadlineMs = 0,
+                   unsigned long timeoutMs = 1000);
+
+    // Same for a binary request (may contain any byte; the response is still a line)
+    bool submitJob(DeviceType device, const uint8_t *request, size_t length,
+                   JobCallback callback, uint8_t priority = 0, unsigned long deadlineMs = 0,
+                   unsigned long timeoutMs = 1000);
+
+    // Line speed used while a device is selected (0 = the begin()/init() baud rate).
+    // Applied when the device's next job starts.
+    void setDeviceBaud(DeviceType device, unsigned long baudRate);
+    unsigned long getDeviceBaud(DeviceType device) const;
+
+    // Drop queued (not yet started) jobs for a device
+    void cancelJobs(DeviceType device);
+
+    // Run the scheduler (call every loop)
+    void update();
+
+    // Scheduler status
+    bool isBusy() const;
+    uint8_t getPendingJobs() const;
+    uint32_t getRelaySwitches() const;
+
     // Serial communication methods
     size_t write(uint8_t data);
     size_t write(const uint8_t *buffer, size_t size);
@@ -53,7 +106,47 @@ private:
     int _relayPin;
     DeviceType _currentDevice;
     unsigned long _baudRate;
+    unsigned long _deviceBaud[TILT_SERVO + 1];  // Per-device override, 0 = _baudRate
+    unsigned long _lineBaud;                    // Speed the UART is running at
     ClearCorePins _serialPin;
+
+    // Scheduler states
+    enum SchedulerState {
+        SCHED_IDLE,      // No job running
+        SCHED_SETTLING,  // Relay switched, waiting before sending
+        SCHED_WAITING    // Request sent, collecting the response line
+    };
+
+    // Scheduled transaction
+    struct Job {
+        bool inUse;
+        DeviceType device;
+        uint8_t priority;
+        uint32_t sequence;  // Submission order, for FIFO within a priority
+        unsigned long deadline;
+        unsigned long timeoutMs;
+        char request[SERIAL_JOB_REQUEST_SIZE];
+        uint8_t requestLength;
+        JobCallback callback;
+    };
+
+    Job _jobs[SERIAL_JOB_QUEUE_SIZE];
+    uint32_t _jobSequence;
+    int _activeJob;
+    SchedulerState _schedState;
+    unsigned long _stateTime;
+    uint8_t _batchCount;
+    uint32_t _relaySwitches;
+
+    // Response line being collected
+    char _response[SERIAL_RESPONSE_SIZE];
+    uint8_t _responseIndex;
+
+    // Scheduler helpers
+    int selectNextJob();
+    bool applyDeviceBaud(DeviceType device);
+    void startJob(int index);
+    void completeJob(JobStatus status, const char *response);
 };
 
 #endif  // SERIAL_DEVICES_H
\ No newline at end of file
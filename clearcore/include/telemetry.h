@@ -0,0 +1,90 @@
+/**
+ * Space Maquette - Telemetry
+ *
+ * Pushes the state the host would otherwise poll with STATUS at a fixed
+ * rate. The host picks the fields and the rate with SUBSCRIBE; each frame
+ * carries only the fields that changed since the previous one (plus a full
+ * frame right after subscribing). Driven from the main loop via update().
+ *
+ * Text frame:   DATA:TLM,<seq>,<mask hex>,<value>,...   (values in field order)
+ * Binary frame: OP_RESP_TELEMETRY <seq u16><mask u16><int32 LE per field>
+ */
+
+#pragma once
+
+#include <Arduino.h>
+
+#include "command_parser.h"
+#include "emergency.h"
+#include "motion_control.h"
+#include "rangefinder.h"
+
+// Subscription rate limits
+#define TELEMETRY_MAX_RATE_HZ 100
+
+// Telemetry fields (bit positions in the subscription and frame masks)
+enum TelemetryField {
+    TLM_X,       // Axis positions (steps)
+    TLM_Y,
+    TLM_Z,
+    TLM_PAN,
+    TLM_MOVING,  // 1 while a move is in progress
+    TLM_HLFB,    // HLFB asserted, bit per axis
+    TLM_ALERTS,  // Alerts present, bit per axis
+    TLM_ESTOP,   // 1 while the emergency stop is active
+    TLM_RANGE,   // Last rangefinder reading (0.1 mm)
+    TLM_QUEUE,   // Motion queue depth
+    TLM_FIELD_COUNT
+};
+
+#define TELEMETRY_ALL_FIELDS ((1 << TLM_FIELD_COUNT) - 1)
+
+class Telemetry {
+public:
+    // Constructor
+    Telemetry(CommandParser& parser, MotionControl& motion, Rangefinder& rangefinder,
+              EmergencyStop& estop);
+
+    // Start streaming the given fields at rateHz (1..TELEMETRY_MAX_RATE_HZ)
+    bool subscribe(int rateHz, uint16_t fieldMask);
+
+    // Stop streaming
+    void unsubscribe();
+
+    // Subscription state
+    bool isActive() const { return _fieldMask != 0; }
+    uint16_t getFieldMask() const { return _fieldMask; }
+    int getRate() const { return _rateHz; }
+    uint32_t getFramesSent() const { return _framesSent; }
+
+    // Field bit for a field name ("X", "RANGE", ...), or -1 if unknown
+    static int fieldFromName(const char* name);
+
+    // Send a frame when due and something changed (call every loop)
+    void update();
+
+private:
+    // References to system components
+    CommandParser& _parser;
+    MotionControl& _motion;
+    Rangefinder& _rangefinder;
+    EmergencyStop& _estop;
+
+    // Subscription
+    uint16_t _fieldMask;
+    int _rateHz;
+    unsigned long _interval;
+    unsigned long _lastFrame;
+
+    // Frame state
+    uint16_t _sequence;
+    bool _sendAll;  // Next frame carries every subscribed field
+    int32_t _lastValues[TLM_FIELD_COUNT];
+    uint32_t _framesSent;
+
+    // Read the current value of every field
+    void sample(int32_t values[]);
+
+    // Send the fields in mask
+    void sendFrame(uint16_t mask, const int32_t values[]);
+};
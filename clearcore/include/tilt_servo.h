@@ -3,8 +3,24 @@
 
 #include <Arduino.h>
 
+#include "event_log.h"
 #include "serial_devices.h"
 
+// COM1 scheduler settings for ANGLE commands
+#define TILT_JOB_PRIORITY    1     // Ahead of rangefinder requests
+#define TILT_JOB_DEADLINE_MS 2000  // Give up if COM1 stays busy this long
+#define TILT_ACK_TIMEOUT_MS  1000  // Time for the Arduino to answer OK
+
+// Tilt link: text at TILT_BAUD_RATE until fast mode is negotiated with BAUD:<rate>,
+// then binary angle frames <0xA5> <0x01> <centidegrees u16 LE> <CRC-16 u16 LE>
+#define TILT_BAUD_RATE         9600
+#define TILT_FAST_BAUD         57600
+#define TILT_FRAME_SYNC        0xA5
+#define TILT_FRAME_ANGLE       0x01
+#define TILT_FRAME_SIZE        6
+#define TILT_FAST_ACK_TIMEOUT_MS 100  // ACK time for binary frames (fallback trigger)
+#define TILT_NEGOTIATE_RETRIES 2  // BAUD attempts before staying on text
+
 class TiltServo {
 public:
     TiltServo(SerialDevices &serialDevices, float minAngle = 0.0f, float maxAngle = 180.0f);
@@ -13,9 +29,36 @@ public:
     // Initialize the tilt servo
     void begin();
 
-    // Set the tilt angle (constrained to min/max)
+    // Set the tilt angle (constrained to min/max). Blocks for the Arduino's
+    // acknowledgment unless async mode is on; in async mode it returns once the
+    // target is accepted and the ACK is handled by update()
     bool setAngle(float angle);
 
+    // Async mode: at most one ANGLE command in flight, newer targets replace
+    // any target still waiting to be sent (latest wins)
+    void setAsync(bool enable);
+    bool isAsync() const { return _asyncEnabled; }
+
+    // Send a waiting target once the in-flight command completes (call every loop)
+    void update();
+
+    // True when no command is in flight or waiting and, with a slew rate set,
+    // the expected slew time (|delta angle| / rate) since the ACK has passed;
+    // the Arduino ACKs a slewed move at once and keeps moving. The servo
+    // reached the target if getCurrentAngle() equals getTargetAngle()
+    bool isSettled() const;
+
+    // Targets replaced before they were sent
+    uint32_t getCoalescedCount() const { return _coalescedCount; }
+
+    // Fast mode: negotiate a higher baud and send binary angle frames. Falls back
+    // to text at TILT_BAUD_RATE (and renegotiates) if the servo stops answering.
+    void setFastMode(bool enable, unsigned long baudRate = TILT_FAST_BAUD);
+    bool isFastMode() const { return _fastActive; }
+
+    // Servo slew rate on the Arduino in degrees per second (0 = jump to the target)
+    void setSlewRate(float degreesPerSecond);
+
     // Get the current angle
     float getCurrentAngle() const;
 
@@ -29,11 +72,22 @@ public:
     void setDebug(bool enable);
 
 private:
-    // Wait for acknowledgment from Arduino
-    bool waitForAck();
+    // Queue an ANGLE command (or binary frame in fast mode) on the COM1 scheduler
+    bool sendAngle(float angle);
+
+    // Queue a BAUD or SLEW command, handled by handleLinkAck()
+    bool sendLinkCommand(const char *command, unsigned long baudRate);
+    void handleLinkAck(SerialDevices::JobStatus status, const char *response,
+                       unsigned long baudRate);
+
+    // Drop back to text at TILT_BAUD_RATE after fast mode stopped answering
+    void fallBackToText();
 
-    // Debug logging
-    void log(const String &message);
+    // Scheduler completion for an ANGLE command
+    void handleAck(SerialDevices::JobStatus status, const char *response, float angle);
+
+    // Angle in log record units
+    static int32_t centiDegrees(float angle);
 
     // Reference to the serial device manager
     SerialDevices &_serialDevices;
@@ -46,6 +100,27 @@ private:
     float _currentAngle;
     float _targetAngle;
 
+    // ANGLE command in flight on the scheduler
+    bool _commandPending;
+    bool _commandAcked;
+
+    // Async mode and the target waiting for the in-flight command
+    bool _asyncEnabled;
+    bool _nextPending;
+    float _nextAngle;
+    uint32_t _coalescedCount;
+
+    // Fast mode and link settings waiting to be sent from update()
+    bool _fastRequested;
+    bool _fastActive;
+    unsigned long _fastBaud;
+    uint8_t _negotiateAttempts;
+    bool _negotiatePending;
+    bool _slewPending;
+    float _slewRate;
+    unsigned long _slewUntil;  // millis() when the last ACKed slew ends
+    bool _linkCommandPending;
+
     // Debug flag
     bool _debugEnabled;
 };
@@ -16,11 +16,27 @@
 #include "EthernetTcpServer.h"
 #include "EthernetTcpClient.h"
 
+class MotionTrace;
+
 /**
  * Space Maquette - Web Server
  *
  * Simple HTTP server for browsing SD card contents.
  * Provides read-only access to logs and configuration files.
+ *
+ * Each connection is a small state machine driven from update(): requests
+ * are read into a fixed buffer as bytes arrive, and responses (files,
+ * directory listings, generated pages) are streamed out a chunk at a time
+ * with a shared per-update byte budget, so a large download never holds up
+ * the main loop.
+ *
+ * Files support single "Range: bytes=" requests (206, including suffix
+ * ranges for tail-style reads) and If-None-Match against an ETag built from
+ * the file size and a hash of its last sector (304). Directory listings are
+ * sent with chunked transfer encoding to HTTP/1.1 clients.
+ *
+ * A frozen motion trace is served from RAM as /trace.bin (the binary blob)
+ * and /trace.csv; both answer 503 while the trace is still recording.
  */
 class WebServer {
 public:
@@ -30,8 +46,20 @@ public:
     // Maximum path length
     static const size_t MAX_PATH_LENGTH = 64;
     
-    // Maximum response buffer size
-    static const size_t RESPONSE_BUFFER_SIZE = 2048;
+    // Request line and headers (larger requests get 431)
+    static const size_t REQUEST_BUFFER_SIZE = 512;
+
+    // Largest single Send() / SD read
+    static const size_t SEND_CHUNK_SIZE = 512;
+
+    // Default bytes sent per update() across all connections
+    static const size_t DEFAULT_SEND_BUDGET = 1024;
+
+    // Concurrent connections
+    static const int MAX_CONNECTIONS = 2;
+
+    // Connections with no progress for this long are closed
+    static const unsigned long CONNECTION_TIMEOUT_MS = 5000;
     
     // Constructor
     WebServer(uint16_t port = DEFAULT_PORT);
@@ -39,33 +67,105 @@ public:
     // Initialize the web server
     bool init();
     
-    // Update method (called in main loop)
+    // Update method (called in main loop); never blocks
     void update();
+
+    // Bytes sent per update() across all connections
+    void setSendBudget(size_t bytes);
+    size_t getSendBudget() const { return _sendBudget; }
+
+    // Motion trace served as /trace.bin and /trace.csv (optional)
+    void setMotionTrace(MotionTrace* trace);
+
+    // Connections currently open
+    int getActiveConnections() const;
     
     // Get server's IP address
     const char* getIpAddressString();
     
 private:
+    enum ConnectionState {
+        CONN_IDLE,     // Slot free
+        CONN_READING,  // Collecting the request headers
+        CONN_SENDING,  // Streaming the response
+        CONN_CLOSING   // Response done, close on the next update
+    };
+
+    // One client connection and the response it is receiving
+    struct Connection {
+        ClearCore::EthernetTcpClient client;
+        ConnectionState state;
+        unsigned long lastActivity;
+
+        // Request
+        char request[REQUEST_BUFFER_SIZE];
+        size_t requestLength;
+        uint8_t headerMatch;  // Characters of "\r\n\r\n" matched so far
+
+        // Pending output: staged chunk, then text, then the file or listing
+        uint8_t chunk[SEND_CHUNK_SIZE];
+        size_t chunkLength;
+        size_t chunkSent;
+        String text;
+        size_t textSent;
+        File file;
+        bool sendingFile;
+        uint32_t fileRemaining;  // Bytes of the file (or range) still to send
+        bool chunked;            // Client accepts chunked transfer encoding
+        File dir;
+        bool sendingListing;
+        String listingPath;
+        bool sendingTrace;       // Streaming the motion trace from RAM
+        bool traceCsv;           // As CSV rows rather than the blob
+        uint32_t traceOffset;    // Next blob byte or CSV row
+        uint16_t traceCapture;   // Capture being sent (a re-arm ends the response)
+    };
+
     ClearCore::EthernetTcpServer _server;
-    ClearCore::EthernetTcpClient _client;
+    Connection _connections[MAX_CONNECTIONS];
     bool _initialized;
     uint16_t _port;
+    size_t _sendBudget;
+    int _nextConnection;  // Round-robin start for the send budget
     char _ipString[16]; // Buffer to hold IP address string
+    MotionTrace* _trace;
     
+    // Connection handling
+    void acceptConnections();
+    size_t serviceConnection(Connection& conn, size_t budget);
+    bool readRequest(Connection& conn);
+    size_t sendPending(Connection& conn, size_t budget);
+    bool fillChunk(Connection& conn);
+    void closeConnection(Connection& conn);
+
     // Request parsing
-    void handleClient();
-    void parseRequest(const String& request);
+    void parseRequest(Connection& conn);
     
-    // Response generation
-    void sendResponse(const String& status, const String& contentType, const String& content);
-    void sendFile(const String& path, const String& contentType);
-    void sendDirectoryListing(const String& path);
-    void send404();
+    // Response generation (queued on the connection, sent by update())
+    void sendResponse(Connection& conn, const String& status, const String& contentType,
+                      const String& content);
+    void sendFile(Connection& conn, const String& path, const String& contentType);
+    void sendDirectoryListing(Connection& conn, const String& path);
+    void send404(Connection& conn);
+    void sendTrace(Connection& conn, bool csv);
+#ifdef PERF_MONITORING_ENABLED
+    void sendPerfPage(Connection& conn, bool reset);
+#endif
+
+    // Next directory listing row (or the page footer) as HTML
+    bool nextListingEntry(Connection& conn);
+
+    // Next chunk of the motion trace; false when it is complete
+    bool nextTraceChunk(Connection& conn);
     
     // Helper methods
+    static bool getHeader(const char* request, const char* name, char* value, size_t size);
+    static bool parseRange(const char* value, uint32_t size, uint32_t& first, uint32_t& last);
+    static String fileTag(File& file);
+    static void appendChunk(Connection& conn, const String& data);
     String getContentType(const String& filename);
     String urlDecode(const String& text);
-    String getPath(const String& request);
+    String getPath(const char* request);
 };
 
 #endif // WEB_SERVER_H
@@ -0,0 +1,276 @@
+/**
+ * Space Maquette - Native Arduino Shim
+ *
+ * Just enough of the Arduino core to build the firmware modules on the host
+ * (pio test -e native): timing, digital pins, String, Print/Stream and
+ * buffer-backed serial ports. millis()/micros() follow the host clock plus a
+ * virtual offset; delay() only advances the offset, so code that waits on
+ * timeouts runs instantly. Test hooks live in native_shims.h.
+ */
+
+#pragma once
+
+#include <math.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include <deque>
+#include <string>
+
+// glibc's <sched.h>, pulled in by the C++ headers, defines this; the target's doesn't
+#include <sched.h>
+#undef SCHED_IDLE
+
+typedef uint8_t byte;
+typedef bool boolean;
+
+#define HIGH 1
+#define LOW 0
+#define INPUT 0
+#define OUTPUT 1
+#define INPUT_PULLUP 2
+
+#define DEC 10
+#define HEX 16
+#define BIN 2
+
+#define CHANGE 1
+#define FALLING 2
+#define RISING 3
+
+#define SERIAL_8N1 0
+
+// The target core defines these as macros too (see macros.h)
+#define min(a, b) ((a) < (b) ? (a) : (b))
+#define max(a, b) ((a) > (b) ? (a) : (b))
+#define constrain(amt, low, high) ((amt) < (low) ? (low) : ((amt) > (high) ? (high) : (amt)))
+
+#define F(string) (string)
+#define PROGMEM
+
+// ClearCore connector pins
+enum ClearCorePins {
+    IO0, IO1, IO2, IO3, IO4, IO5,
+    DI6, DI7, DI8,
+    A9, A10, A11, A12,
+    M0, M1, M2, M3,
+    CLEARCORE_PIN_COUNT
+};
+
+// Timing
+unsigned long millis();
+unsigned long micros();
+void delay(unsigned long ms);
+void delayMicroseconds(unsigned int us);
+
+// Digital pins and interrupts
+void pinMode(int pin, int mode);
+void digitalWrite(int pin, int value);
+int digitalRead(int pin);
+int digitalPinToInterrupt(int pin);
+void attachInterrupt(int interrupt, void (*isr)(), int mode);
+void detachInterrupt(int interrupt);
+inline void noInterrupts() {}
+inline void interrupts() {}
+
+class String {
+public:
+    String(const char* text = "") : _s(text ? text : "") {}
+    String(const std::string& text) : _s(text) {}
+    String(char c) : _s(1, c) {}
+    String(int value, unsigned char base = DEC) : _s(format(value, base)) {}
+    String(unsigned int value, unsigned char base = DEC) : _s(format(value, base)) {}
+    String(long value, unsigned char base = DEC) : _s(format(value, base)) {}
+    String(unsigned long value, unsigned char base = DEC) : _s(format(value, base)) {}
+    String(float value, unsigned char decimals = 2) : _s(format((double)value, decimals)) {}
+    String(double value, unsigned char decimals = 2) : _s(format(value, decimals)) {}
+
+    const char* c_str() const { return _s.c_str(); }
+    unsigned int length() const { return _s.size(); }
+    bool reserve(unsigned int size) {
+        _s.reserve(size);
+        return true;
+    }
+
+    char charAt(unsigned int index) const { return index < _s.size() ? _s[index] : 0; }
+    char operator[](unsigned int index) const { return charAt(index); }
+
+    String& operator+=(const String& other) {
+        _s += other._s;
+        return *this;
+    }
+    String& operator+=(const char* other) {
+        _s += other;
+        return *this;
+    }
+    String& operator+=(char other) {
+        _s += other;
+        return *this;
+    }
+    template <typename T>
+    String& operator+=(T value) {
+        return *this += String(value);
+    }
+    bool concat(const String& other) {
+        *this += other;
+        return true;
+    }
+
+    bool operator==(const String& other) const { return _s == other._s; }
+    bool operator==(const char* other) const { return _s == other; }
+    bool operator!=(const String& other) const { return _s != other._s; }
+    bool operator!=(const char* other) const { return _s != other; }
+    bool operator<(const String& other) const { return _s < other._s; }
+    bool equals(const String& other) const { return _s == other._s; }
+    bool equals(const char* other) const { return _s == other; }
+    bool equalsIgnoreCase(const String& other) const;
+
+    int indexOf(char c, unsigned int from = 0) const { return found(_s.find(c, from)); }
+    int indexOf(const char* text, unsigned int from = 0) const { return found(_s.find(text, from)); }
+    int indexOf(const String& text, unsigned int from = 0) const {
+        return found(_s.find(text._s, from));
+    }
+    int lastIndexOf(char c) const { return found(_s.rfind(c)); }
+    int lastIndexOf(const char* text) const { return found(_s.rfind(text)); }
+    int lastIndexOf(const char* text, unsigned int from) const { return found(_s.rfind(text, from)); }
+    bool startsWith(const char* prefix) const { return _s.compare(0, strlen(prefix), prefix) == 0; }
+    bool startsWith(const String& prefix) const { return startsWith(prefix.c_str()); }
+    bool endsWith(const char* suffix) const;
+    bool endsWith(const String& suffix) const { return endsWith(suffix.c_str()); }
+
+    String substring(unsigned int from) const {
+        return from < _s.size() ? String(_s.substr(from)) : String();
+    }
+    String substring(unsigned int from, unsigned int to) const;
+
+    void trim();
+    void toLowerCase();
+    void toUpperCase();
+    void replace(const String& find, const String& replacement);
+    void remove(unsigned int index, unsigned int count = (unsigned int)-1) {
+        if (index < _s.size()) {
+            _s.erase(index, count);
+        }
+    }
+
+    long toInt() const { return atol(_s.c_str()); }
+    float toFloat() const { return (float)atof(_s.c_str()); }
+
+private:
+    std::string _s;
+
+    static int found(size_t position) { return position == std::string::npos ? -1 : (int)position; }
+    static std::string format(long value, unsigned char base);
+    static std::string format(unsigned long value, unsigned char base);
+    static std::string format(int value, unsigned char base) { return format((long)value, base); }
+    static std::string format(unsigned int value, unsigned char base) {
+        return format((unsigned long)value, base);
+    }
+    static std::string format(double value, unsigned char decimals);
+};
+
+String operator+(const String& a, const String& b);
+String operator+(const String& a, const char* b);
+String operator+(const char* a, const String& b);
+String operator+(const String& a, char b);
+template <typename T>
+String operator+(const String& a, T b) {
+    return a + String(b);
+}
+
+class Print {
+public:
+    virtual ~Print() {}
+
+    virtual size_t write(uint8_t data) = 0;
+    virtual size_t write(const uint8_t* buffer, size_t size) {
+        size_t written = 0;
+        while (size--) {
+            written += write(*buffer++);
+        }
+        return written;
+    }
+    size_t write(const char* text) { return text ? write((const uint8_t*)text, strlen(text)) : 0; }
+    size_t write(const char* buffer, size_t size) { return write((const uint8_t*)buffer, size); }
+    virtual int availableForWrite() { return 0; }
+    virtual void flush() {}
+
+    size_t print(const char* text) { return write(text); }
+    size_t print(const String& text) { return write(text.c_str()); }
+    size_t print(char c) { return write((uint8_t)c); }
+    size_t print(unsigned char value, int base = DEC) { return print((unsigned long)value, base); }
+    size_t print(int value, int base = DEC) { return print((long)value, base); }
+    size_t print(unsigned int value, int base = DEC) { return print((unsigned long)value, base); }
+    size_t print(long value, int base = DEC);
+    size_t print(unsigned long value, int base = DEC);
+    size_t print(double value, int decimals = 2);
+
+    size_t println() { return write("\r\n"); }
+    template <typename T>
+    size_t println(T value) {
+        size_t written = print(value);
+        return written + println();
+    }
+    template <typename T>
+    size_t println(T value, int format) {
+        size_t written = print(value, format);
+        return written + println();
+    }
+};
+
+class Stream : public Print {
+public:
+    virtual int available() = 0;
+    virtual int read() = 0;
+    virtual int peek() = 0;
+
+    void setTimeout(unsigned long timeout) { _timeout = timeout; }
+    size_t readBytes(char* buffer, size_t length);
+    size_t readBytes(uint8_t* buffer, size_t length) { return readBytes((char*)buffer, length); }
+    String readStringUntil(char terminator);
+
+protected:
+    unsigned long _timeout = 1000;
+};
+
+// Serial port backed by host buffers: tests inject received bytes and read
+// back what the firmware wrote (capped at OUTPUT_LIMIT bytes)
+class HardwareSerial : public Stream {
+public:
+    static const size_t OUTPUT_LIMIT = 65536;
+
+    void begin(unsigned long baud) { _baud = baud; }
+    void begin(unsigned long baud, int config) {
+        (void)config;
+        _baud = baud;
+    }
+    void end() {}
+    operator bool() const { return true; }
+
+    int available() override { return (int)_rx.size(); }
+    int read() override;
+    int peek() override { return _rx.empty() ? -1 : _rx.front(); }
+    int availableForWrite() override { return 64; }
+    size_t write(uint8_t data) override;
+    size_t write(const uint8_t* buffer, size_t size) override;
+    using Print::write;
+
+    // Test hooks
+    void inject(const char* text) { inject((const uint8_t*)text, strlen(text)); }
+    void inject(const uint8_t* data, size_t size) { _rx.insert(_rx.end(), data, data + size); }
+    const std::string& output() const { return _tx; }
+    void clearOutput() { _tx.clear(); }
+    void clearInput() { _rx.clear(); }
+    unsigned long baud() const { return _baud; }
+
+private:
+    std::deque<uint8_t> _rx;
+    std::string _tx;
+    unsigned long _baud = 0;
+};
+
+extern HardwareSerial Serial;
+extern HardwareSerial Serial1;
@@ -0,0 +1,161 @@
+/**
+ * Space Maquette - Native ClearCore Shim
+ *
+ * Motor connectors M0-M3 and the motor manager. Each MotorDriver is a simple
+ * simulation: an enabled motor asserts HLFB, and a move lands on its target
+ * at once (steps complete by the next query), so motion code can be timed
+ * without the pulse generator. simulateProfile(true) instead runs moves along
+ * a VelMax/AccelMax limited profile in virtual time, for tests that look at
+ * the commanded motion itself.
+ */
+
+#pragma once
+
+#include <Arduino.h>
+
+class Connector {
+public:
+    enum ConnectorModes { CPM_MODE_STEP_AND_DIR };
+};
+
+class MotorDriver {
+public:
+    enum HlfbStates { HLFB_DEASSERTED, HLFB_ASSERTED, HLFB_HAS_MEASUREMENT, HLFB_UNKNOWN };
+    enum HlfbModes { HLFB_MODE_STATIC, HLFB_MODE_HAS_PWM, HLFB_MODE_HAS_BIPOLAR_PWM };
+    enum HlfbCarrierFrequency { HLFB_CARRIER_45_HZ, HLFB_CARRIER_482_HZ };
+    enum MoveTarget { MOVE_TARGET_ABSOLUTE, MOVE_TARGET_REL_END_POSN };
+
+    union StatusRegMotor {
+        uint32_t reg;
+        struct {
+            uint32_t AtTargetPosition : 1;
+            uint32_t StepsActive : 1;
+            uint32_t AtTargetVelocity : 1;
+            uint32_t MoveDirection : 1;
+            uint32_t MotorInFault : 1;
+            uint32_t Enabled : 1;
+            uint32_t PositionalMove : 1;
+            uint32_t HlfbState : 2;
+            uint32_t AlertsPresent : 1;
+            uint32_t Ready : 1;
+            uint32_t Triggering : 1;
+            uint32_t InPositiveLimit : 1;
+            uint32_t InNegativeLimit : 1;
+            uint32_t InEStopSensor : 1;
+        } bit;
+    };
+
+    union AlertRegMotor {
+        uint32_t reg;
+        struct {
+            uint32_t MotionCanceledInAlert : 1;
+            uint32_t MotionCanceledPositiveLimit : 1;
+            uint32_t MotionCanceledNegativeLimit : 1;
+            uint32_t MotionCanceledSensorEStop : 1;
+            uint32_t MotionCanceledMotorDisabled : 1;
+            uint32_t MotorFaulted : 1;
+        } bit;
+    };
+
+    void HlfbMode(HlfbModes mode) { (void)mode; }
+    bool HlfbCarrier(HlfbCarrierFrequency frequency) {
+        (void)frequency;
+        return true;
+    }
+
+    void VelMax(int32_t velocity) { _velMax = velocity; }
+    void AccelMax(int32_t acceleration) { _accelMax = acceleration; }
+    void EStopDecelMax(int32_t deceleration) { (void)deceleration; }
+
+    void EnableRequest(bool enable) { _enabled = enable; }
+    bool EnableRequest() const { return _enabled; }
+
+    bool Move(int32_t distance, MoveTarget target = MOVE_TARGET_REL_END_POSN);
+    bool MoveVelocity(int32_t velocity);
+    void MoveStopAbrupt() { stopProfile(); }
+    void MoveStopDecel(int32_t deceleration = 0) {
+        (void)deceleration;
+        stopProfile();
+    }
+    bool StepsComplete() const {
+        advance();
+        return _velocity == 0 && _profileMode == PROFILE_IDLE;
+    }
+
+    HlfbStates HlfbState() const {
+        // A profiled motor asserts HLFB once it is in position
+        return _enabled && (!_profile || StepsComplete()) ? HLFB_ASSERTED : HLFB_DEASSERTED;
+    }
+    float HlfbPercent() const { return _enabled ? 100.0f : 0.0f; }
+    StatusRegMotor StatusReg() const;
+    AlertRegMotor AlertReg() const {
+        AlertRegMotor alerts;
+        alerts.reg = _alerts;
+        return alerts;
+    }
+    void ClearAlerts(uint32_t mask = UINT32_MAX) { _alerts &= ~mask; }
+
+    void PositionRefSet(int32_t position) {
+        advance();
+        _position = position;
+        _profilePosition = position;
+    }
+    int32_t PositionRefCommanded() const {
+        advance();
+        return _position;
+    }
+    int32_t VelocityRefCommanded() const {
+        advance();
+        return _velocity;
+    }
+
+    // Test hooks
+    void setAlerts(uint32_t alerts) { _alerts = alerts; }
+    int32_t getVelMax() const { return _velMax; }
+    int32_t getAccelMax() const { return _accelMax; }
+    uint32_t getMoveCount() const { return _moves; }
+    void simulateProfile(bool enable) { _profile = enable; }
+
+private:
+    enum ProfileMode { PROFILE_IDLE, PROFILE_POSITION, PROFILE_VELOCITY };
+
+    bool _enabled = false;
+    mutable int32_t _position = 0;
+    mutable int32_t _velocity = 0;  // Only velocity moves keep running (or any, with a profile)
+
+    // Profile simulation (simulateProfile())
+    bool _profile = false;
+    mutable ProfileMode _profileMode = PROFILE_IDLE;
+    mutable double _profilePosition = 0.0;
+    mutable double _profileVelocity = 0.0;
+    mutable unsigned long _profileTime = 0;
+    int32_t _profileTarget = 0;
+    int32_t _profileVelocityTarget = 0;
+
+    void advance() const;
+    void startProfile(ProfileMode mode);
+    void stopProfile();
+    int32_t _velMax = 0;
+    int32_t _accelMax = 0;
+    uint32_t _alerts = 0;
+    uint32_t _moves = 0;
+};
+
+class MotorManager {
+public:
+    enum MotorPair { MOTOR_M0M1, MOTOR_M2M3, MOTOR_ALL };
+    enum MotorClockRates { CLOCK_RATE_LOW, CLOCK_RATE_NORMAL, CLOCK_RATE_HIGH };
+
+    bool MotorInputClocking(MotorClockRates rate) {
+        (void)rate;
+        return true;
+    }
+    bool MotorModeSet(MotorPair pair, Connector::ConnectorModes mode) {
+        (void)pair;
+        (void)mode;
+        return true;
+    }
+};
+
+extern MotorManager MotorMgr;
+extern MotorDriver ConnectorM0, ConnectorM1, ConnectorM2, ConnectorM3;
@@ -0,0 +1,46 @@
+/**
+ * Space Maquette - Native Ethernet Manager Shim
+ *
+ * The link is always up and DHCP always succeeds with 127.0.0.1.
+ */
+
+#pragma once
+
+#include <stdint.h>
+#include <stdio.h>
+
+namespace ClearCore {
+
+class IpAddress {
+public:
+    IpAddress(uint8_t a = 0, uint8_t b = 0, uint8_t c = 0, uint8_t d = 0) {
+        snprintf(_text, sizeof(_text), "%u.%u.%u.%u", a, b, c, d);
+    }
+    const char* StringValue() const { return _text; }
+
+private:
+    char _text[16];
+};
+
+class EthernetManager {
+public:
+    static EthernetManager& Instance();
+
+    void Setup() {}
+    void Refresh() {}
+    bool PhyLinkActive() const { return true; }
+    bool DhcpBegin() {
+        _localIp = IpAddress(127, 0, 0, 1);
+        return true;
+    }
+
+    IpAddress LocalIp() const { return _localIp; }
+    void LocalIp(const IpAddress& ip) { _localIp = ip; }
+    void NetmaskIp(const IpAddress& ip) { (void)ip; }
+    void GatewayIp(const IpAddress& ip) { (void)ip; }
+
+private:
+    IpAddress _localIp;
+};
+
+}  // namespace ClearCore
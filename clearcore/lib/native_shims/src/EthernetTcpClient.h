@@ -0,0 +1,57 @@
+/**
+ * Space Maquette - Native TCP Client Shim
+ *
+ * A client is a handle to a shared in-memory connection, so copies (as
+ * returned by the server) see the same data. Tests drive the host side of
+ * the connection through native::TcpConnection (native_shims.h).
+ */
+
+#pragma once
+
+#include <stddef.h>
+#include <stdint.h>
+
+#include <deque>
+#include <memory>
+#include <string>
+
+namespace native {
+
+// Both directions of one TCP connection
+struct TcpConnection {
+    std::deque<uint8_t> toDevice;  // Bytes the host sent
+    std::string fromDevice;        // Bytes the firmware sent
+    bool open = true;
+    size_t sendLimit = SIZE_MAX;   // Bytes the firmware may still send (simulates a full window)
+
+    void inject(const char* text);
+    void inject(const uint8_t* data, size_t size);
+};
+
+}  // namespace native
+
+namespace ClearCore {
+
+class EthernetTcpClient {
+public:
+    EthernetTcpClient() {}
+    explicit EthernetTcpClient(const std::shared_ptr<native::TcpConnection>& connection)
+        : _connection(connection) {}
+
+    bool Connected() const { return _connection && _connection->open; }
+    int16_t BytesAvailable() const;
+    int16_t Read();
+    int16_t Read(uint8_t* buffer, uint32_t size);
+    int16_t Peek() const;
+    uint32_t Send(uint8_t data) { return Send(&data, 1); }
+    uint32_t Send(const uint8_t* buffer, uint32_t size);
+    uint32_t Send(const char* text);
+    void Flush() {}
+    void FlushInput();
+    void Close();
+
+private:
+    std::shared_ptr<native::TcpConnection> _connection;
+};
+
+}  // namespace ClearCore
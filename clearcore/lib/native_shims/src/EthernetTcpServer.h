@@ -0,0 +1,27 @@
+/**
+ * Space Maquette - Native TCP Server Shim
+ *
+ * Connections opened with native::connect() wait in a per-port backlog
+ * until Accept() (or Available()) hands them out, once each.
+ */
+
+#pragma once
+
+#include "EthernetTcpClient.h"
+
+namespace ClearCore {
+
+class EthernetTcpServer {
+public:
+    EthernetTcpServer(uint16_t port) : _port(port) {}
+
+    void Begin() { _listening = true; }
+    EthernetTcpClient Accept();
+    EthernetTcpClient Available() { return Accept(); }
+
+private:
+    uint16_t _port;
+    bool _listening = false;
+};
+
+}  // namespace ClearCore
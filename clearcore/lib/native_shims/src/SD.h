@@ -0,0 +1,85 @@
+/**
+ * Space Maquette - Native SD Shim
+ *
+ * Flat in-memory file system with the Arduino SD API. Paths are stored
+ * without the leading '/'; "/" (or "") opens the root directory, which lists
+ * every file. FILE_WRITE appends, as on the card.
+ */
+
+#pragma once
+
+#include <Arduino.h>
+
+#include <map>
+#include <memory>
+#include <string>
+
+#define FILE_READ 0x01
+#define FILE_WRITE 0x13
+
+class File : public Stream {
+public:
+    File() {}
+
+    operator bool() const { return _open; }
+    const char* name() const { return _name.c_str(); }
+    bool isDirectory() const { return _open && _directory; }
+
+    int available() override;
+    int read() override;
+    int read(void* buffer, uint16_t size);
+    int peek() override;
+    size_t write(uint8_t data) override { return write(&data, 1); }
+    size_t write(const uint8_t* buffer, size_t size) override;
+    using Print::write;
+    void flush() override {}
+
+    bool seek(uint32_t position);
+    uint32_t position() const { return _position; }
+    uint32_t size() const { return _data ? _data->size() : 0; }
+    void close() { _open = false; }
+
+    // Directory listing
+    File openNextFile(uint8_t mode = FILE_READ);
+    void rewindDirectory() { _position = 0; }
+
+private:
+    friend class SDClass;
+
+    std::shared_ptr<std::string> _data;
+    std::string _name;
+    uint32_t _position = 0;  // Byte offset, or next entry for a directory
+    bool _open = false;
+    bool _writable = false;
+    bool _directory = false;
+};
+
+class SDClass {
+public:
+    bool begin(uint8_t csPin = 0) {
+        (void)csPin;
+        return _present;
+    }
+
+    bool exists(const char* path) const;
+    bool exists(const String& path) const { return exists(path.c_str()); }
+    File open(const char* path, uint8_t mode = FILE_READ);
+    File open(const String& path, uint8_t mode = FILE_READ) { return open(path.c_str(), mode); }
+    bool remove(const char* path);
+    bool remove(const String& path) { return remove(path.c_str()); }
+
+    // Test hooks
+    void setPresent(bool present) { _present = present; }
+    void clear() { _files.clear(); }
+    std::map<std::string, std::shared_ptr<std::string>>& files() { return _files; }
+
+private:
+    friend class File;
+
+    std::map<std::string, std::shared_ptr<std::string>> _files;
+    bool _present = true;
+
+    static std::string normalize(const char* path);
+};
+
+extern SDClass SD;
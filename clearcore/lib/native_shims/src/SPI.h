@@ -0,0 +1,5 @@
+/**
+ * Space Maquette - Native SPI Shim (the SD shim needs no bus)
+ */
+
+#pragma once
@@ -0,0 +1,657 @@
+/**
+ * Space Maquette - Native Shim Implementation
+ */
+
+// Standard headers first: Arduino.h defines min/max as macros
+#include <ctype.h>
+#include <math.h>
+
+#include <chrono>
+#include <iterator>
+#include <vector>
+
+#include "native_shims.h"
+
+#include "EthernetManager.h"
+#include "EthernetTcpServer.h"
+
+HardwareSerial Serial;
+HardwareSerial Serial1;
+MotorManager MotorMgr;
+MotorDriver ConnectorM0, ConnectorM1, ConnectorM2, ConnectorM3;
+SDClass SD;
+
+// Timing
+
+static unsigned long long virtualOffsetUs = 0;
+
+static unsigned long long hostMicros() {
+    static const std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+    return std::chrono::duration_cast<std::chrono::microseconds>(
+               std::chrono::steady_clock::now() - start)
+        .count();
+}
+
+unsigned long micros() {
+    return (unsigned long)(hostMicros() + virtualOffsetUs);
+}
+
+unsigned long millis() {
+    return (unsigned long)((hostMicros() + virtualOffsetUs) / 1000);
+}
+
+void delay(unsigned long ms) {
+    virtualOffsetUs += (unsigned long long)ms * 1000;
+}
+
+void delayMicroseconds(unsigned int us) {
+    virtualOffsetUs += us;
+}
+
+// Digital pins and interrupts
+
+static const int PIN_COUNT = 64;
+
+struct PinState {
+    int mode = INPUT;
+    int level = LOW;
+    void (*isr)() = nullptr;
+    int edge = 0;
+};
+
+static PinState pins[PIN_COUNT];
+
+static PinState* pinState(int pin) {
+    return pin >= 0 && pin < PIN_COUNT ? &pins[pin] : nullptr;
+}
+
+void pinMode(int pin, int mode) {
+    if (PinState* state = pinState(pin)) {
+        state->mode = mode;
+        if (mode == INPUT_PULLUP) {
+            state->level = HIGH;
+        }
+    }
+}
+
+void digitalWrite(int pin, int value) {
+    if (PinState* state = pinState(pin)) {
+        state->level = value ? HIGH : LOW;
+    }
+}
+
+int digitalRead(int pin) {
+    PinState* state = pinState(pin);
+    return state ? state->level : LOW;
+}
+
+int digitalPinToInterrupt(int pin) {
+    return pin;
+}
+
+void attachInterrupt(int interrupt, void (*isr)(), int mode) {
+    if (PinState* state = pinState(interrupt)) {
+        state->isr = isr;
+        state->edge = mode;
+    }
+}
+
+void detachInterrupt(int interrupt) {
+    if (PinState* state = pinState(interrupt)) {
+        state->isr = nullptr;
+    }
+}
+
+// String
+
+std::string String::format(long value, unsigned char base) {
+    if (base == DEC) {
+        return std::to_string(value);
+    }
+    return format((unsigned long)value, base);
+}
+
+std::string String::format(unsigned long value, unsigned char base) {
+    if (base < 2 || base > 16) {
+        base = DEC;
+    }
+    char digits[sizeof(unsigned long) * 8 + 1];
+    int index = sizeof(digits) - 1;
+    digits[index] = '\0';
+    do {
+        digits[--index] = "0123456789abcdef"[value % base];
+        value /= base;
+    } while (value > 0);
+    return std::string(digits + index);
+}
+
+std::string String::format(double value, unsigned char decimals) {
+    char text[64];
+    snprintf(text, sizeof(text), "%.*f", decimals, value);
+    return text;
+}
+
+bool String::equalsIgnoreCase(const String& other) const {
+    if (_s.size() != other._s.size()) {
+        return false;
+    }
+    for (size_t i = 0; i < _s.size(); i++) {
+        if (tolower((unsigned char)_s[i]) != tolower((unsigned char)other._s[i])) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool String::endsWith(const char* suffix) const {
+    size_t length = strlen(suffix);
+    return _s.size() >= length && _s.compare(_s.size() - length, length, suffix) == 0;
+}
+
+String String::substring(unsigned int from, unsigned int to) const {
+    if (from > to) {
+        unsigned int swap = from;
+        from = to;
+        to = swap;
+    }
+    if (from >= _s.size()) {
+        return String();
+    }
+    return String(_s.substr(from, to - from));
+}
+
+void String::trim() {
+    size_t first = 0;
+    while (first < _s.size() && isspace((unsigned char)_s[first])) {
+        first++;
+    }
+    size_t last = _s.size();
+    while (last > first && isspace((unsigned char)_s[last - 1])) {
+        last--;
+    }
+    _s = _s.substr(first, last - first);
+}
+
+void String::toLowerCase() {
+    for (char& c : _s) {
+        c = (char)tolower((unsigned char)c);
+    }
+}
+
+void String::toUpperCase() {
+    for (char& c : _s) {
+        c = (char)toupper((unsigned char)c);
+    }
+}
+
+void String::replace(const String& find, const String& replacement) {
+    if (find._s.empty()) {
+        return;
+    }
+    size_t position = 0;
+    while ((position = _s.find(find._s, position)) != std::string::npos) {
+        _s.replace(position, find._s.size(), replacement._s);
+        position += replacement._s.size();
+    }
+}
+
+String operator+(const String& a, const String& b) {
+    String result(a);
+    result += b;
+    return result;
+}
+
+String operator+(const String& a, const char* b) {
+    String result(a);
+    result += b;
+    return result;
+}
+
+String operator+(const char* a, const String& b) {
+    String result(a);
+    result += b;
+    return result;
+}
+
+String operator+(const String& a, char b) {
+    String result(a);
+    result += b;
+    return result;
+}
+
+// Print / Stream
+
+size_t Print::print(long value, int base) {
+    if (base == DEC) {
+        return print(String(value).c_str());
+    }
+    return print((unsigned long)value, base);
+}
+
+size_t Print::print(unsigned long value, int base) {
+    String text(value, (unsigned char)base);
+    if (base == HEX) {
+        text.toUpperCase();  // Print uses upper-case hex digits
+    }
+    return print(text);
+}
+
+size_t Print::print(double value, int decimals) {
+    return print(String(value, (unsigned char)decimals));
+}
+
+size_t Stream::readBytes(char* buffer, size_t length) {
+    size_t count = 0;
+    while (count < length) {
+        int c = read();
+        if (c < 0) {
+            break;  // Nothing more will arrive while the caller blocks
+        }
+        buffer[count++] = (char)c;
+    }
+    return count;
+}
+
+String Stream::readStringUntil(char terminator) {
+    String result;
+    int c;
+    while ((c = read()) >= 0 && c != terminator) {
+        result += (char)c;
+    }
+    return result;
+}
+
+// Serial ports
+
+int HardwareSerial::read() {
+    if (_rx.empty()) {
+        return -1;
+    }
+    int value = _rx.front();
+    _rx.pop_front();
+    return value;
+}
+
+size_t HardwareSerial::write(uint8_t data) {
+    return write(&data, 1);
+}
+
+size_t HardwareSerial::write(const uint8_t* buffer, size_t size) {
+    size_t room = _tx.size() < OUTPUT_LIMIT ? OUTPUT_LIMIT - _tx.size() : 0;
+    _tx.append((const char*)buffer, size < room ? size : room);
+    return size;
+}
+
+// Motors
+
+bool MotorDriver::Move(int32_t distance, MoveTarget target) {
+    if (!_enabled) {
+        return false;
+    }
+    advance();
+    int32_t position = target == MOVE_TARGET_ABSOLUTE ? distance : _position + distance;
+    _moves++;
+    if (_profile) {
+        _profileTarget = position;
+        startProfile(PROFILE_POSITION);
+    } else {
+        _position = position;
+        _velocity = 0;
+    }
+    return true;
+}
+
+bool MotorDriver::MoveVelocity(int32_t velocity) {
+    if (!_enabled) {
+        return false;
+    }
+    advance();
+    _moves++;
+    if (_profile) {
+        _profileVelocityTarget = velocity;
+        startProfile(PROFILE_VELOCITY);
+    } else {
+        _velocity = velocity;
+    }
+    return true;
+}
+
+void MotorDriver::startProfile(ProfileMode mode) {
+    _profileMode = mode;
+    _profileTime = micros();
+}
+
+void MotorDriver::stopProfile() {
+    advance();
+    _profileMode = PROFILE_IDLE;
+    _profileVelocity = 0.0;
+    _velocity = 0;
+}
+
+// Step the profile to the current virtual time in 50 us slices: positional
+// moves brake on v^2 = 2*a*d toward the target, velocity moves ramp at AccelMax
+void MotorDriver::advance() const {
+    if (!_profile || _profileMode == PROFILE_IDLE) {
+        return;
+    }
+
+    const double slice = 50e-6;
+    unsigned long now = micros();
+    double accel = _accelMax > 0 ? _accelMax : 1e12;
+    double velMax = _velMax > 0 ? _velMax : 1e12;
+
+    while (now - _profileTime >= 50 && _profileMode != PROFILE_IDLE) {
+        _profileTime += 50;
+
+        double wanted = _profileVelocityTarget;
+        if (_profileMode == PROFILE_POSITION) {
+            double remaining = _profileTarget - _profilePosition;
+            wanted = sqrt(2.0 * accel * fabs(remaining));
+            if (wanted > velMax) {
+                wanted = velMax;
+            }
+            if (remaining < 0) {
+                wanted = -wanted;
+            }
+        }
+
+        double change = wanted - _profileVelocity;
+        double limit = accel * slice;
+        if (change > limit) {
+            change = limit;
+        } else if (change < -limit) {
+            change = -limit;
+        }
+        _profileVelocity += change;
+        _profilePosition += _profileVelocity * slice;
+
+        if (_profileMode == PROFILE_POSITION &&
+            fabs(_profileTarget - _profilePosition) < 0.5 &&
+            fabs(_profileVelocity) <= 2.0 * limit) {
+            _profilePosition = _profileTarget;
+            _profileVelocity = 0.0;
+            _profileMode = PROFILE_IDLE;
+        } else if (_profileMode == PROFILE_VELOCITY && _profileVelocityTarget == 0 &&
+                   _profileVelocity == 0.0) {
+            _profileMode = PROFILE_IDLE;
+        }
+    }
+
+    _position = static_cast<int32_t>(lround(_profilePosition));
+    _velocity = static_cast<int32_t>(lround(_profileVelocity));
+}
+
+MotorDriver::StatusRegMotor MotorDriver::StatusReg() const {
+    StatusRegMotor status;
+    status.reg = 0;
+    status.bit.Enabled = _enabled;
+    status.bit.Ready = _enabled;
+    status.bit.StepsActive = !StepsComplete();
+    status.bit.AtTargetPosition = StepsComplete();
+    status.bit.HlfbState = HlfbState();
+    status.bit.AlertsPresent = _alerts != 0;
+    return status;
+}
+
+// Ethernet
+
+namespace ClearCore {
+
+EthernetManager& EthernetManager::Instance() {
+    static EthernetManager instance;
+    return instance;
+}
+
+int16_t EthernetTcpClient::BytesAvailable() const {
+    return Connected() ? (int16_t)_connection->toDevice.size() : 0;
+}
+
+int16_t EthernetTcpClient::Read() {
+    if (!Connected() || _connection->toDevice.empty()) {
+        return -1;
+    }
+    int16_t value = _connection->toDevice.front();
+    _connection->toDevice.pop_front();
+    return value;
+}
+
+int16_t EthernetTcpClient::Read(uint8_t* buffer, uint32_t size) {
+    int16_t count = 0;
+    while (Connected() && count < (int32_t)size && !_connection->toDevice.empty()) {
+        buffer[count++] = _connection->toDevice.front();
+        _connection->toDevice.pop_front();
+    }
+    return count;
+}
+
+int16_t EthernetTcpClient::Peek() const {
+    return Connected() && !_connection->toDevice.empty() ? _connection->toDevice.front() : -1;
+}
+
+uint32_t EthernetTcpClient::Send(const uint8_t* buffer, uint32_t size) {
+    if (!Connected()) {
+        return 0;
+    }
+    uint32_t count = size < _connection->sendLimit ? size : (uint32_t)_connection->sendLimit;
+    _connection->fromDevice.append((const char*)buffer, count);
+    if (_connection->sendLimit != SIZE_MAX) {
+        _connection->sendLimit -= count;
+    }
+    return count;
+}
+
+uint32_t EthernetTcpClient::Send(const char* text) {
+    return Send((const uint8_t*)text, strlen(text));
+}
+
+void EthernetTcpClient::FlushInput() {
+    if (_connection) {
+        _connection->toDevice.clear();
+    }
+}
+
+void EthernetTcpClient::Close() {
+    if (_connection) {
+        _connection->open = false;
+    }
+}
+
+}  // namespace ClearCore
+
+namespace native {
+
+struct PendingConnection {
+    uint16_t port;
+    std::shared_ptr<TcpConnection> connection;
+};
+
+static std::vector<PendingConnection> backlog;
+
+void TcpConnection::inject(const char* text) {
+    inject((const uint8_t*)text, strlen(text));
+}
+
+void TcpConnection::inject(const uint8_t* data, size_t size) {
+    toDevice.insert(toDevice.end(), data, data + size);
+}
+
+std::shared_ptr<TcpConnection> connect(uint16_t port) {
+    std::shared_ptr<TcpConnection> connection = std::make_shared<TcpConnection>();
+    backlog.push_back({port, connection});
+    return connection;
+}
+
+void advanceMillis(unsigned long ms) {
+    virtualOffsetUs += (unsigned long long)ms * 1000;
+}
+
+void advanceMicros(unsigned long us) {
+    virtualOffsetUs += us;
+}
+
+void setInput(int pin, int value) {
+    PinState* state = pinState(pin);
+    if (!state) {
+        return;
+    }
+
+    int previous = state->level;
+    state->level = value ? HIGH : LOW;
+
+    bool rising = previous == LOW && state->level == HIGH;
+    bool falling = previous == HIGH && state->level == LOW;
+    if (state->isr && ((state->edge == RISING && rising) || (state->edge == FALLING && falling) ||
+                       (state->edge == CHANGE && (rising || falling)))) {
+        state->isr();
+    }
+}
+
+int getOutput(int pin) {
+    return digitalRead(pin);
+}
+
+void reset() {
+    Serial.clearInput();
+    Serial.clearOutput();
+    Serial1.clearInput();
+    Serial1.clearOutput();
+    for (PinState& state : pins) {
+        state = PinState();
+    }
+    backlog.clear();
+    ConnectorM0 = MotorDriver();
+    ConnectorM1 = MotorDriver();
+    ConnectorM2 = MotorDriver();
+    ConnectorM3 = MotorDriver();
+    SD.clear();
+    SD.setPresent(true);
+}
+
+}  // namespace native
+
+namespace ClearCore {
+
+EthernetTcpClient EthernetTcpServer::Accept() {
+    if (!_listening) {
+        return EthernetTcpClient();
+    }
+    for (size_t i = 0; i < native::backlog.size(); i++) {
+        if (native::backlog[i].port == _port) {
+            EthernetTcpClient client(native::backlog[i].connection);
+            native::backlog.erase(native::backlog.begin() + i);
+            return client;
+        }
+    }
+    return EthernetTcpClient();
+}
+
+}  // namespace ClearCore
+
+// SD card
+
+std::string SDClass::normalize(const char* path) {
+    while (path && *path == '/') {
+        path++;
+    }
+    return path ? path : "";
+}
+
+bool SDClass::exists(const char* path) const {
+    std::string name = normalize(path);
+    return name.empty() || _files.count(name) > 0;
+}
+
+File SDClass::open(const char* path, uint8_t mode) {
+    File file;
+    if (!_present) {
+        return file;
+    }
+
+    std::string name = normalize(path);
+    if (name.empty()) {
+        file._directory = true;
+        file._open = true;
+        file._name = "/";
+        return file;
+    }
+
+    auto entry = _files.find(name);
+    if (entry == _files.end()) {
+        if (!(mode & 0x02)) {
+            return file;  // Opening a missing file for reading fails
+        }
+        entry = _files.emplace(name, std::make_shared<std::string>()).first;
+    }
+
+    file._data = entry->second;
+    file._name = name;
+    file._open = true;
+    file._writable = (mode & 0x02) != 0;
+    file._position = file._writable ? file._data->size() : 0;  // FILE_WRITE appends
+    return file;
+}
+
+bool SDClass::remove(const char* path) {
+    return _files.erase(normalize(path)) > 0;
+}
+
+int File::available() {
+    if (!_open || _directory || !_data) {
+        return 0;
+    }
+    return _position < _data->size() ? (int)(_data->size() - _position) : 0;
+}
+
+int File::read() {
+    if (available() <= 0) {
+        return -1;
+    }
+    return (uint8_t)(*_data)[_position++];
+}
+
+int File::read(void* buffer, uint16_t size) {
+    int count = available();
+    if (count <= 0) {
+        return count < 0 ? -1 : 0;
+    }
+    if (count > size) {
+        count = size;
+    }
+    memcpy(buffer, _data->data() + _position, count);
+    _position += count;
+    return count;
+}
+
+int File::peek() {
+    return available() > 0 ? (uint8_t)(*_data)[_position] : -1;
+}
+
+size_t File::write(const uint8_t* buffer, size_t size) {
+    if (!_open || !_writable || !_data) {
+        return 0;
+    }
+    if (_position > _data->size()) {
+        _position = _data->size();
+    }
+    _data->replace(_position, size < _data->size() - _position ? size : _data->size() - _position,
+                   (const char*)buffer, size);
+    _position += size;
+    return size;
+}
+
+bool File::seek(uint32_t position) {
+    if (!_open || !_data || position > _data->size()) {
+        return false;
+    }
+    _position = position;
+    return true;
+}
+
+File File::openNextFile(uint8_t mode) {
+    if (!_open || !_directory || _position >= SD._files.size()) {
+        return File();
+    }
+    auto entry = SD._files.begin();
+    std::advance(entry, _position++);
+    return SD.open(entry->first.c_str(), mode);
+}
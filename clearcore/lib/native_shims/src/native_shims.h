@@ -0,0 +1,37 @@
+/**
+ * Space Maquette - Native Shim Test Hooks
+ *
+ * Controls for the host build: virtual time, digital inputs, interrupts and
+ * TCP connections. The serial ports, motors and SD card expose their own
+ * hooks (HardwareSerial::inject(), MotorDriver::setAlerts(), SD.files()).
+ */
+
+#pragma once
+
+#include <Arduino.h>
+
+#include <memory>
+
+#include "ClearCore.h"
+#include "EthernetTcpClient.h"
+#include "SD.h"
+
+namespace native {
+
+// Move millis()/micros() forward without waiting
+void advanceMillis(unsigned long ms);
+void advanceMicros(unsigned long us);
+
+// Drive an input pin; an attached interrupt fires on a matching edge
+void setInput(int pin, int value);
+
+// Level last written to an output pin
+int getOutput(int pin);
+
+// Open a connection to a server port (handed out by the next Accept())
+std::shared_ptr<TcpConnection> connect(uint16_t port);
+
+// Clear serial buffers, pins, pending connections, motors and files
+void reset();
+
+}  // namespace native
@@ -4,28 +4,289 @@
 
 #include "command_handler.h"
 
+#include "memory_monitor.h"
+#include "perf_monitor.h"
+
 CommandHandler::CommandHandler(CommandParser& parser, MotionControl& motion,
                                Rangefinder& rangefinder, EmergencyStop& estop,
-                               ConfigurationManager& config)
-    : _parser(parser),
+                               ConfigurationManager& config, ScanController& scanner,
+                               Telemetry& telemetry)
+    : _controlParser(parser),
       _motion(motion),
       _rangefinder(rangefinder),
       _estop(estop),
       _config(config),
-      _debugMode(false) {}
+      _scanner(scanner),
+      _controlTelemetry(telemetry),
+      _parser(&parser),
+      _telemetry(&telemetry),
+      _session(0),
+      _observerCount(0),
+      _debugMode(false),
+      _measurePending(false),
+      _rangeStreaming(false),
+      _lastRangeFrame(0),
+      _trace(nullptr),
+      _traceSending(false),
+      _traceOffset(0),
+      _traceCapture(0),
+      _traceReported(0),
+      _traceSaving(false) {}
 
 void CommandHandler::init() {
     // Register this handler with the parser
-    _parser.setCommandHandler(
+    _controlParser.setCommandHandler(
         [this](CommandParser& parser) -> void { this->processCommand(parser); });
 
+    // Report completion of non-blocking moves to the host
+    _motion.setEventCallback([this](MotionEvent event, char axis) -> void {
+        // Homing progress
+        if (event == MOTION_EVENT_HOME_PHASE) {
+            _parser->sendFormattedResponse(
+                "INFO", "HOMING:%c,%s", axis,
+                MotionControl::getHomingPhaseName(_motion.getHomingPhase(axis)));
+            return;
+        } else if (event == MOTION_EVENT_HOME_DONE) {
+            if (axis != 0) {
+                _parser->sendFormattedResponse("INFO", "HOMED:%c", axis);
+            } else {
+                _parser->sendResponse("INFO", "HOMING_DONE");
+            }
+            return;
+        } else if (event == MOTION_EVENT_HOME_FAILED) {
+            _parser->sendFormattedResponse("INFO", "HOMING_FAILED:%c", axis);
+            return;
+        }
+
+        // Scan moves are reported through the scan's own DATA/INFO frames
+        if (_scanner.isActive()) {
+            return;
+        }
+
+        if (event == MOTION_EVENT_MOVE_DONE) {
+            _parser->sendResponse("INFO", "MOVE_DONE");
+        } else if (axis != 0) {
+            _parser->sendFormattedResponse("INFO", "MOVE_FAILED:%c", axis);
+        } else {
+            _parser->sendResponse("INFO", "MOVE_FAILED");
+        }
+    });
+
+#ifdef PERF_MONITORING_ENABLED
+    // Per-command timing slots follow the command table
+    for (size_t i = 0; i < COMMAND_COUNT; i++) {
+        Profiler.setCommandName(i, COMMAND_TABLE[i].name);
+    }
+#endif
+
 #ifdef DEBUG
     Serial.println("Command handler initialized");
 #endif
 }
 
+// Streaming range frames are sent at least this often while readings arrive
+#define RANGE_STREAM_INTERVAL_MS 100
+
+// Blob bytes per DATA:TRACE line (256 characters of base64)
+#define TRACE_CHUNK_BYTES 192
+
+// Room a DATA:TRACE line needs in the connection's TX ring
+#define TRACE_LINE_SIZE 280
+
+void CommandHandler::update() {
+    // Answer a pending MEASURE once the reading is in
+    if (_measurePending) {
+        Rangefinder::Measurement result;
+        if (_rangefinder.readResult(result)) {
+            _measurePending = false;
+            if (result.valid) {
+                _parser->sendFormattedResponse("OK", "%.3f", result.distance);
+            } else {
+                _parser->sendResponse("ERROR", "MEASUREMENT_FAILED");
+            }
+        }
+    }
+
+    // Batch continuous readings into DATA frames
+    if (_rangeStreaming && _rangefinder.isReady() &&
+        (_rangefinder.getResultCount() >= Rangefinder::RESULT_BUFFER_SIZE / 2 ||
+         millis() - _lastRangeFrame >= RANGE_STREAM_INTERVAL_MS)) {
+        flushRangeStream();
+    }
+
+    if (_trace) {
+        // Announce each new capture once
+        if (_trace->getState() == MotionTrace::TRACE_DONE &&
+            _trace->getCaptureId() != _traceReported) {
+            _traceReported = _trace->getCaptureId();
+            _controlParser.sendFormattedResponse("INFO", "TRACE_DONE,%02X,%u", _trace->getCause(),
+                                                 _trace->getSampleCount());
+        }
+
+        // One download line per update, and only when the TX ring can take it whole
+        if (_traceSending && _controlParser.availableForWrite() >= TRACE_LINE_SIZE) {
+            sendTraceChunk();
+        }
+
+        if (_traceSaving && _trace->getSaveState() != MotionTrace::SAVE_RUNNING) {
+            _traceSaving = false;
+            if (_trace->getSaveState() == MotionTrace::SAVE_DONE) {
+                _controlParser.sendFormattedResponse("INFO", "TRACE_SAVED,%s",
+                                                     _trace->getSavePath());
+            } else {
+                _controlParser.sendResponse("INFO", "TRACE_SAVE_FAILED");
+            }
+        }
+    }
+}
+
+// Format: DATA:RANGE;<timestamp>,<distance>;...  (distance -1 for a failed reading)
+void CommandHandler::flushRangeStream() {
+    char frame[16 + Rangefinder::RESULT_BUFFER_SIZE * 24];
+    int length = snprintf(frame, sizeof(frame), "RANGE");
+
+    Rangefinder::Measurement result;
+    while (length < (int)sizeof(frame) && _rangefinder.readResult(result)) {
+        length += snprintf(frame + length, sizeof(frame) - length, ";%lu,%.3f",
+                           (unsigned long)result.timestamp, result.valid ? result.distance : -1.0f);
+    }
+
+    _parser->sendResponse("DATA", frame);
+    _lastRangeFrame = millis();
+}
+
+static const char BASE64_ALPHABET[] =
+    "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+// Standard base64 with padding; out needs 4 * ceil(length / 3) + 1 bytes
+static size_t base64Encode(const uint8_t* data, size_t length, char* out) {
+    size_t used = 0;
+    for (size_t i = 0; i < length; i += 3) {
+        uint32_t group = (uint32_t)data[i] << 16;
+        if (i + 1 < length) {
+            group |= (uint32_t)data[i + 1] << 8;
+        }
+        if (i + 2 < length) {
+            group |= data[i + 2];
+        }
+        out[used++] = BASE64_ALPHABET[(group >> 18) & 0x3F];
+        out[used++] = BASE64_ALPHABET[(group >> 12) & 0x3F];
+        out[used++] = i + 1 < length ? BASE64_ALPHABET[(group >> 6) & 0x3F] : '=';
+        out[used++] = i + 2 < length ? BASE64_ALPHABET[group & 0x3F] : '=';
+    }
+    out[used] = '\0';
+    return used;
+}
+
+// Format: DATA:TRACE,<offset>,<base64 blob bytes>; INFO:TRACE_SENT,<bytes> after the last
+void CommandHandler::sendTraceChunk() {
+    // Re-armed (or stopped) since TRACE:GET: the blob is gone
+    if (_trace->getState() != MotionTrace::TRACE_DONE || _trace->getCaptureId() != _traceCapture) {
+        _traceSending = false;
+        _controlParser.sendResponse("INFO", "TRACE_GET_ABORTED");
+        return;
+    }
+
+    uint8_t bytes[TRACE_CHUNK_BYTES];
+    size_t length = _trace->readBlob(_traceOffset, bytes, sizeof(bytes));
+    if (length == 0) {
+        _traceSending = false;
+        _controlParser.sendFormattedResponse("INFO", "TRACE_SENT,%lu", (unsigned long)_traceOffset);
+        return;
+    }
+
+    char line[24 + (TRACE_CHUNK_BYTES / 3) * 4];
+    int used = snprintf(line, sizeof(line), "TRACE,%lu,", (unsigned long)_traceOffset);
+    base64Encode(bytes, length, line + used);
+    _controlParser.sendResponse("DATA", line);
+    _traceOffset += length;
+}
+
+// Command table, sorted by name for binary search. Handlers run only after the
+// ESTOP and parameter count checks have passed.
+constexpr CommandHandler::CommandEntry CommandHandler::COMMAND_TABLE[] = {
+    // name            handler                             params  ESTOP  OBSERVER  missing error
+    {"BATCH",          &CommandHandler::cmdBatch,          1,      true,  true,     "MISSING_PARAM"},
+    {"BENCH",          &CommandHandler::cmdBench,          0,      true,  true,     nullptr},
+    {"CONFIG",         &CommandHandler::cmdConfig,         1,      false, false,    "MISSING_CONFIG_COMMAND"},
+    {"DEBUG",          &CommandHandler::cmdDebug,          1,      false, false,    "MISSING_PARAM"},
+    {"ESTOP",          &CommandHandler::cmdEstop,          0,      true,  true,     nullptr},
+    {"ESTOP_STATUS",   &CommandHandler::cmdEstopStatus,    0,      true,  true,     nullptr},
+    {"GET",            &CommandHandler::cmdGet,            1,      false, true,     "MISSING_KEY"},
+    {"HOME",           &CommandHandler::cmdHome,           1,      false, false,    "MISSING_PARAM"},
+    {"MEASURE",        &CommandHandler::cmdMeasure,        0,      false, false,    nullptr},
+    {"MEASURE_STREAM", &CommandHandler::cmdMeasureStream,  1,      false, false,    "MISSING_PARAM"},
+    {"MOVE",           &CommandHandler::cmdMove,           3,      false, false,    "MISSING_PARAMS"},
+    {"MOVEQ",          &CommandHandler::cmdMoveQueued,     3,      false, false,    "MISSING_PARAMS"},
+    {"PAN",            &CommandHandler::cmdPan,            1,      false, false,    "MISSING_PARAM"},
+    {"PERF",           &CommandHandler::cmdPerf,           0,      true,  true,     nullptr},
+    {"PING",           &CommandHandler::cmdPing,           0,      false, true,     nullptr},
+    {"PROFILE",        &CommandHandler::cmdProfile,        1,      false, false,    "MISSING_PARAM"},
+    {"PROTOCOL",       &CommandHandler::cmdProtocol,       1,      false, true,     "MISSING_PARAM"},
+    {"QUEUE_CLEAR",    &CommandHandler::cmdQueueClear,     0,      false, false,    nullptr},
+    {"QUEUE_STATUS",   &CommandHandler::cmdQueueStatus,    0,      false, true,     nullptr},
+    {"RESET",          &CommandHandler::cmdReset,          0,      false, false,    nullptr},
+    {"RESET_ESTOP",    &CommandHandler::cmdResetEstop,     0,      true,  false,    nullptr},
+    {"SAVE",           &CommandHandler::cmdSave,           0,      false, false,    nullptr},
+    {"SCAN",           &CommandHandler::cmdScan,           5,      false, false,    "MISSING_PARAMS"},
+    {"SCAN_ABORT",     &CommandHandler::cmdScanAbort,      0,      false, false,    nullptr},
+    {"SCAN_PAUSE",     &CommandHandler::cmdScanPause,      0,      false, false,    nullptr},
+    {"SCAN_RESUME",    &CommandHandler::cmdScanResume,     0,      false, false,    nullptr},
+    {"SCAN_STATUS",    &CommandHandler::cmdScanStatus,     0,      false, true,     nullptr},
+    {"SESSION",        &CommandHandler::cmdSession,        0,      true,  true,     nullptr},
+    {"SET",            &CommandHandler::cmdSet,            2,      false, false,    "MISSING_PARAMS"},
+    {"STATUS",         &CommandHandler::cmdStatus,         0,      true,  true,     nullptr},
+    {"STOP",           &CommandHandler::cmdStop,           0,      false, false,    nullptr},
+    {"SUBSCRIBE",      &CommandHandler::cmdSubscribe,      2,      true,  true,     "MISSING_PARAMS"},
+    {"TILT",           &CommandHandler::cmdTilt,           1,      false, false,    "MISSING_PARAM"},
+    {"TRACE",          &CommandHandler::cmdTrace,          1,      true,  false,    "MISSING_PARAM"},
+    {"UNSUBSCRIBE",    &CommandHandler::cmdUnsubscribe,    0,      true,  true,     nullptr},
+    {"VELOCITY",       &CommandHandler::cmdVelocity,       3,      false, false,    "MISSING_PARAMS"},
+};
+
+constexpr size_t CommandHandler::COMMAND_COUNT =
+    sizeof(CommandHandler::COMMAND_TABLE) / sizeof(CommandHandler::COMMAND_TABLE[0]);
+
+// Compile-time check that the table stays sorted (single-return form for C++11 constexpr)
+constexpr bool CommandHandler::nameLess(const char* a, const char* b) {
+    return (*a == *b && *a != '\0') ? nameLess(a + 1, b + 1)
+                                    : static_cast<unsigned char>(*a) < static_cast<unsigned char>(*b);
+}
+
+constexpr bool CommandHandler::tableSorted(size_t index) {
+    return index >= COMMAND_COUNT ||
+           (nameLess(COMMAND_TABLE[index - 1].name, COMMAND_TABLE[index].name) &&
+            tableSorted(index + 1));
+}
+
+// Binary search of the command table
+const CommandHandler::CommandEntry* CommandHandler::findCommand(const char* name) {
+    static_assert(tableSorted(1), "COMMAND_TABLE must be sorted by name");
+#ifdef PERF_MONITORING_ENABLED
+    static_assert(COMMAND_COUNT <= PERF_MAX_COMMANDS, "PERF_MAX_COMMANDS is below the command count");
+#endif
+
+    size_t low = 0;
+    size_t high = COMMAND_COUNT;
+
+    while (low < high) {
+        size_t mid = (low + high) / 2;
+        int order = strcmp(name, COMMAND_TABLE[mid].name);
+
+        if (order == 0) {
+            return &COMMAND_TABLE[mid];
+        } else if (order < 0) {
+            high = mid;
+        } else {
+            low = mid + 1;
+        }
+    }
+
+    return nullptr;
+}
+
 void CommandHandler::processCommand(CommandParser& parser) {
-    const char* cmd = _parser.getCommand();
+    const char* cmd = _parser->getCommand();
     if (!cmd)
         return;
 
@@ -34,315 +295,823 @@ void CommandHandler::processCommand(CommandParser& parser) {
     Serial.println(cmd);
 #endif
 
-    // Check for ESTOP first
-    if (strcmp(cmd, "ESTOP") == 0) {
-        _estop.activate();
-        _parser.sendResponse("OK", "ESTOP_ACTIVATED");
+    const CommandEntry* entry = findCommand(cmd);
+    if (!entry) {
+        _parser->sendResponse("ERROR", "UNKNOWN_COMMAND");
         return;
     }
 
-    // If ESTOP is active, only allow certain commands
-    if (_estop.isActive() && strcmp(cmd, "STATUS") != 0 && strcmp(cmd, "RESET_ESTOP") != 0) {
-        _parser.sendResponse("ERROR", "ESTOP_ACTIVE");
+    // Observers may only query state (and trigger an emergency stop)
+    if (_session != 0 && !entry->allowedForObserver) {
+        _parser->sendResponse("ERROR", "READ_ONLY_SESSION");
         return;
     }
 
-    // Handle RESET_ESTOP
-    if (strcmp(cmd, "RESET_ESTOP") == 0) {
-        bool success = _estop.reset();
-        if (success) {
-            _parser.sendResponse("OK", "ESTOP_RESET");
-        } else {
-            _parser.sendResponse("ERROR", "ESTOP_STILL_ACTIVE");
-        }
+    // If ESTOP is active, only allow certain commands
+    if (_estop.isActive() && !entry->allowedDuringEstop) {
+        _parser->sendResponse("ERROR", "ESTOP_ACTIVE");
         return;
     }
 
-    // Process command by category
-    if (strcmp(cmd, "PING") == 0) {
-        _parser.sendResponse("OK", "PONG");
-    } else if (strcmp(cmd, "RESET") == 0 || strcmp(cmd, "STATUS") == 0 ||
-               strcmp(cmd, "DEBUG") == 0) {
-        handleSystemCommands();
-    } else if (strcmp(cmd, "HOME") == 0 || strcmp(cmd, "MOVE") == 0 || strcmp(cmd, "STOP") == 0 ||
-               strcmp(cmd, "VELOCITY") == 0) {
-        handleMotionCommands();
-    } else if (strcmp(cmd, "MEASURE") == 0 || strcmp(cmd, "SCAN") == 0) {
-        handleRangefinderCommands();
-    } else if (strcmp(cmd, "TILT") == 0 || strcmp(cmd, "PAN") == 0) {
-        handleServoCommands();
-    } else if (strcmp(cmd, "CONFIG") == 0 || strcmp(cmd, "GET") == 0 || strcmp(cmd, "SET") == 0 ||
-               strcmp(cmd, "SAVE") == 0) {
-        handleConfigCommands();
-    } else {
-        _parser.sendResponse("ERROR", "UNKNOWN_COMMAND");
+    if (_parser->getParamCount() < entry->minParams) {
+        _parser->sendResponse("ERROR", entry->missingError);
+        return;
     }
+
+    PERF_TIME_COMMAND(entry - COMMAND_TABLE, (this->*entry->handler)());
 }
-void CommandHandler::handleSystemCommands() {
-    const char* cmd = _parser.getCommand();
 
-    if (strcmp(cmd, "PING") == 0) {
-        _parser.sendResponse("OK", "PONG");
-    } else if (strcmp(cmd, "RESET") == 0) {
-        // Soft reset functionality
-        _parser.sendResponse("OK", "RESETTING");
+void CommandHandler::addObserver(CommandParser& parser, Telemetry& telemetry) {
+    uint8_t session = ++_observerCount;
+    parser.setCommandHandler([this, session, &telemetry](CommandParser& source) -> void {
+        this->processObserverCommand(session, source, telemetry);
+    });
+}
 
-        // Reset subsystems
-        _motion.stop();
+// Swap the observer in for one command, then restore the control session so
+// asynchronous reports keep going to the controller
+void CommandHandler::processObserverCommand(uint8_t session, CommandParser& parser,
+                                            Telemetry& telemetry) {
+    _parser = &parser;
+    _telemetry = &telemetry;
+    _session = session;
 
-#ifdef DEBUG
-        Serial.println("System reset");
-#endif
-    } else if (strcmp(cmd, "STATUS") == 0) {
-        // Get current system status
-        char statusBuffer[128];
-        sprintf(statusBuffer, "X=%.2f,Y=%.2f,Z=%.2f,PAN=%.2f,TILT=%.2f,ESTOP=%d,MOVING=%d,HOMED=%d",
-                _motion.getPositionX(), _motion.getPositionY(), _motion.getPositionZ(),
-                _motion.getPanAngle(), _motion.getTiltAngle(), _estop.isActive() ? 1 : 0,
-                _motion.isMoving() ? 1 : 0, _motion.isHomed() ? 1 : 0);
-
-        _parser.sendResponse("OK", statusBuffer);
-    } else if (strcmp(cmd, "DEBUG") == 0) {
-        if (_parser.getParamCount() > 0) {
-            const char* mode = _parser.getParam(0);
-            if (strcmp(mode, "ON") == 0) {
-                _debugMode = true;
-                _rangefinder.setDebug(
-                    true);  // Assuming this method exists based on _debugEnabled in rangefinder.cpp
-                _parser.sendResponse("OK", "DEBUG_ENABLED");
-            } else if (strcmp(mode, "OFF") == 0) {
-                _debugMode = false;
-                _parser.sendResponse("OK", "DEBUG_DISABLED");
-            } else {
-                _parser.sendResponse("ERROR", "INVALID_PARAM");
-            }
-        } else {
-            _parser.sendResponse("ERROR", "MISSING_PARAM");
-        }
+    processCommand(parser);
+
+    _parser = &_controlParser;
+    _telemetry = &_controlTelemetry;
+    _session = 0;
+}
+
+// System commands
+
+void CommandHandler::cmdEstop() {
+    _estop.activate();
+    _scanner.abort();
+    _motion.stop();
+    _parser->sendResponse("OK", "ESTOP_ACTIVATED");
+}
+
+// Report the ESTOP mode and the measured trigger-to-disable latency
+void CommandHandler::cmdEstopStatus() {
+    _parser->sendFormattedResponse("OK", "ACTIVE=%d,MODE=%s,COUNT=%lu,LAST_US=%lu,MAX_US=%lu",
+                                  _estop.isActive() ? 1 : 0,
+                                  _estop.isInterruptMode() ? "IRQ" : "POLL",
+                                  (unsigned long)_estop.getTriggerCount(),
+                                  (unsigned long)_estop.getLastLatencyUs(),
+                                  (unsigned long)_estop.getMaxLatencyUs());
+}
+
+void CommandHandler::cmdResetEstop() {
+    bool success = _estop.reset();
+    if (success) {
+        _parser->sendResponse("OK", "ESTOP_RESET");
+    } else {
+        _parser->sendResponse("ERROR", "ESTOP_STILL_ACTIVE");
     }
 }
 
-void CommandHandler::handleMotionCommands() {
-    const char* cmd = _parser.getCommand();
+// PERF                 timing summary of every section that has run
+// PERF:HIST,<name>     log2 histogram of one section
+// PERF:RESET           clear all timings
+void CommandHandler::cmdPerf() {
+#ifdef PERF_MONITORING_ENABLED
+    const char* mode = _parser->getParam(0);
 
-    if (strcmp(cmd, "HOME") == 0) {
-        if (_parser.getParamCount() > 0) {
-            const char* axis = _parser.getParam(0);
-            bool success = false;
+    if (strcmp(mode, "RESET") == 0) {
+        Profiler.reset();
+        _parser->sendResponse("OK", "PERF_RESET");
+        return;
+    }
 
-            if (strcmp(axis, "ALL") == 0) {
-                success = _motion.homeAllAxes();
-            } else if (strcmp(axis, "X") == 0) {
-                success = _motion.homeAxis('X');
-            } else if (strcmp(axis, "Y") == 0) {
-                success = _motion.homeAxis('Y');
-            } else if (strcmp(axis, "Z") == 0) {
-                success = _motion.homeAxis('Z');
-            } else {
-                _parser.sendResponse("ERROR", "INVALID_AXIS");
-                return;
-            }
+    if (strcmp(mode, "HIST") == 0) {
+        int index = Profiler.findStat(_parser->getParam(1));
+        if (index < 0) {
+            _parser->sendResponse("ERROR", "UNKNOWN_SECTION");
+            return;
+        }
 
-            if (success) {
-                _parser.sendResponse("OK", "HOMING_STARTED");
-            } else {
-                _parser.sendResponse("ERROR", "HOMING_FAILED");
+        // DATA:HIST,<name>,<first bucket>,<count>,...  (bucket n = 2^n cycles)
+        const PerfMonitor::Stat* stat = Profiler.getStat(index);
+        int first = 0;
+        int last = -1;
+        for (int i = 0; i < PERF_HISTOGRAM_BUCKETS; i++) {
+            if (stat->histogram[i]) {
+                if (last < 0) {
+                    first = i;
+                }
+                last = i;
             }
-        } else {
-            _parser.sendResponse("ERROR", "MISSING_PARAM");
         }
-    } else if (strcmp(cmd, "MOVE") == 0) {
-        if (_parser.getParamCount() >= 3) {
-            float x = _parser.getParamAsFloat(0);
-            float y = _parser.getParamAsFloat(1);
-            float z = _parser.getParamAsFloat(2);
-            float pan =
-                _parser.getParamCount() > 3 ? _parser.getParamAsFloat(3) : _motion.getPanAngle();
-            float tilt =
-                _parser.getParamCount() > 4 ? _parser.getParamAsFloat(4) : _motion.getTiltAngle();
-
-            bool success = _motion.moveToPosition(x, y, z, pan, tilt);
-
-            if (success) {
-                _parser.sendResponse("OK", "MOVE_STARTED");
-            } else {
-                _parser.sendResponse("ERROR", "MOVE_FAILED");
-            }
-        } else {
-            _parser.sendResponse("ERROR", "MISSING_PARAMS");
+
+        char frame[32 + PERF_HISTOGRAM_BUCKETS * 11];
+        int length = snprintf(frame, sizeof(frame), "HIST,%s,%d", Profiler.getStatName(index),
+                              first);
+        for (int i = first; i <= last; i++) {
+            length += snprintf(frame + length, sizeof(frame) - length, ",%lu",
+                               (unsigned long)stat->histogram[i]);
         }
-    } else if (strcmp(cmd, "STOP") == 0) {
-        _motion.stop();
-        _parser.sendResponse("OK", "MOTION_STOPPED");
-    } else if (strcmp(cmd, "VELOCITY") == 0) {
-        if (_parser.getParamCount() >= 3) {
-            float vx = _parser.getParamAsFloat(0);
-            float vy = _parser.getParamAsFloat(1);
-            float vz = _parser.getParamAsFloat(2);
-
-            _motion.setVelocity(vx, vy, vz);
-            _parser.sendResponse("OK", "VELOCITY_SET");
-        } else {
-            _parser.sendResponse("ERROR", "MISSING_PARAMS");
+        _parser->sendResponse("DATA", frame);
+        _parser->sendResponse("OK", "PERF_HIST");
+        return;
+    }
+
+    if (mode[0] != '\0') {
+        _parser->sendResponse("ERROR", "INVALID_PARAM");
+        return;
+    }
+
+    // DATA:PERF,<name>,<count>,<min us>,<mean us>,<max us>
+    int reported = 0;
+    for (int i = 0; i < Profiler.getStatCount(); i++) {
+        const PerfMonitor::Stat* stat = Profiler.getStat(i);
+        if (stat->count == 0) {
+            continue;
         }
+
+        char frame[64];
+        snprintf(frame, sizeof(frame), "PERF,%s,%lu,%.1f,%.1f,%.1f", Profiler.getStatName(i),
+                 (unsigned long)stat->count, PerfMonitor::cyclesToMicros(stat->minCycles),
+                 PerfMonitor::cyclesToMicros(stat->totalCycles) / stat->count,
+                 PerfMonitor::cyclesToMicros(stat->maxCycles));
+        _parser->sendResponse("DATA", frame);
+        reported++;
     }
+
+#ifdef STACK_MONITORING_ENABLED
+    // DATA:MEM,<stack peak>,<stack size>,<heap used>,<fragmented>,<free>,<min free>,
+    //          <allocations>,<frees>,<failed>
+    MemoryMonitor::Stats memory;
+    Memory.getStats(memory);
+    // Nine counters outgrow the sendFormattedResponse() buffer
+    char frame[128];
+    snprintf(frame, sizeof(frame), "MEM,%lu,%lu,%lu,%lu,%lu,%lu,%lu,%lu,%lu",
+             (unsigned long)memory.stackPeak, (unsigned long)memory.stackSize,
+             (unsigned long)memory.heapUsed, (unsigned long)memory.heapFragmented,
+             (unsigned long)memory.largestFree, (unsigned long)memory.minFree,
+             (unsigned long)memory.allocations, (unsigned long)memory.frees,
+             (unsigned long)memory.failedAllocations);
+    _parser->sendResponse("DATA", frame);
+#endif
+
+    _parser->sendFormattedResponse("OK", "PERF=%d", reported);
+#else
+    _parser->sendResponse("ERROR", "PERF_DISABLED");
+#endif
+}
+
+void CommandHandler::cmdPing() {
+    _parser->sendResponse("OK", "PONG");
 }
 
-void CommandHandler::handleRangefinderCommands() {
-    const char* cmd = _parser.getCommand();
+void CommandHandler::cmdReset() {
+    // Soft reset functionality
+    _parser->sendResponse("OK", "RESETTING");
 
-    if (strcmp(cmd, "MEASURE") == 0) {
-        float distance = _rangefinder.takeMeasurement();
+    // Reset subsystems
+    _scanner.abort();
+    _motion.stop();
 
-        if (distance >= 0) {
-            _parser.sendFormattedResponse("OK", "%.3f", distance);
-        } else if (distance == -2.0) {
-            _parser.sendResponse("ERROR", "OUT_OF_RANGE");
-        } else {
-            _parser.sendResponse("ERROR", "MEASUREMENT_FAILED");
-        }
-    } else if (strcmp(cmd, "SCAN") == 0) {
-        if (_parser.getParamCount() >= 5) {
 #ifdef DEBUG
-            float x1 = _parser.getParamAsFloat(0);
-            float y1 = _parser.getParamAsFloat(1);
-            float x2 = _parser.getParamAsFloat(2);
-            float y2 = _parser.getParamAsFloat(3);
-            float step = _parser.getParamAsFloat(4);
+    Serial.println("System reset");
 #endif
+}
 
-            // Start scan operation
-            // This would typically be implemented as a state machine
-            // that executes over multiple loop iterations
+void CommandHandler::cmdStatus() {
+    // Axes whose latest commanded position is confirmed by HLFB (bit 0 = X ... bit 3 = Pan)
+    const char axes[] = {'X', 'Y', 'Z', 'P'};
+    unsigned inPosition = 0;
+    for (int i = 0; i < 4; i++) {
+        const AxisState* state = _motion.getAxisState(axes[i]);
+        if (state && state->inPosition) {
+            inPosition |= 1 << i;
+        }
+    }
 
-            _parser.sendResponse("OK", "SCAN_STARTED");
+    // Get current system status
+    char statusBuffer[192];
+    snprintf(statusBuffer, sizeof(statusBuffer),
+             "X=%.2f,Y=%.2f,Z=%.2f,PAN=%.2f,TILT=%.2f,ESTOP=%d,MOVING=%d,HOMED=%d,INPOS=%X",
+             _motion.getPositionX(), _motion.getPositionY(), _motion.getPositionZ(),
+             _motion.getPanAngle(), _motion.getTiltAngle(), _estop.isActive() ? 1 : 0,
+             _motion.isMoving() ? 1 : 0, _motion.isHomed() ? 1 : 0, inPosition);
 
-#ifdef DEBUG
-            Serial.print("Scan requested: (");
-            Serial.print(x1);
-            Serial.print(",");
-            Serial.print(y1);
-            Serial.print(") to (");
-            Serial.print(x2);
-            Serial.print(",");
-            Serial.print(y2);
-            Serial.print(") with step ");
-            Serial.println(step);
+#ifdef STACK_MONITORING_ENABLED
+    // Stack high-water mark and free RAM between heap and stack
+    MemoryMonitor::Stats memory;
+    Memory.getStats(memory);
+    size_t length = strlen(statusBuffer);
+    snprintf(statusBuffer + length, sizeof(statusBuffer) - length, ",STACK=%lu,FREE=%lu",
+             (unsigned long)memory.stackPeak, (unsigned long)memory.largestFree);
 #endif
-        } else {
-            _parser.sendResponse("ERROR", "MISSING_PARAMS");
+
+    _parser->sendResponse("OK", statusBuffer);
+}
+
+void CommandHandler::cmdDebug() {
+    const char* mode = _parser->getParam(0);
+    if (strcmp(mode, "ON") == 0) {
+        _debugMode = true;
+        _rangefinder.setDebug(
+            true);  // Assuming this method exists based on _debugEnabled in rangefinder.cpp
+        _parser->sendResponse("OK", "DEBUG_ENABLED");
+    } else if (strcmp(mode, "OFF") == 0) {
+        _debugMode = false;
+        _parser->sendResponse("OK", "DEBUG_DISABLED");
+    } else {
+        _parser->sendResponse("ERROR", "INVALID_PARAM");
+    }
+}
+
+void CommandHandler::cmdProtocol() {
+    // Acknowledge in the current framing, then switch (binary frames send 0/1)
+    const char* mode = _parser->getParam(0);
+    if (strcmp(mode, "BINARY") == 0 || strcmp(mode, "1") == 0) {
+        _parser->sendResponse("OK", "PROTOCOL=BINARY");
+        _parser->setProtocol(CommandParser::PROTOCOL_BINARY);
+    } else if (strcmp(mode, "TEXT") == 0 || strcmp(mode, "0") == 0) {
+        _parser->sendResponse("OK", "PROTOCOL=TEXT");
+        _parser->setProtocol(CommandParser::PROTOCOL_TEXT);
+    } else {
+        _parser->sendResponse("ERROR", "INVALID_PARAM");
+    }
+}
+
+void CommandHandler::cmdBatch() {
+    // Nothing is sent now: the next n commands are answered together
+    if (_parser->isBatchActive()) {
+        _parser->sendResponse("ERROR", "BATCH_ACTIVE");
+    } else if (!_parser->beginBatch(_parser->getParamAsInt(0))) {
+        _parser->sendResponse("ERROR", "INVALID_PARAM");
+    }
+}
+
+// Which session this is and its role
+void CommandHandler::cmdSession() {
+    _parser->sendFormattedResponse("OK", "SESSION=%u,ROLE=%s", _session,
+                                   _session == 0 ? "CONTROL" : "OBSERVER");
+}
+
+// Benchmark echo: the controller's clock at dispatch and the time since the
+// command was read, so a host can tell network time from firmware time
+void CommandHandler::cmdBench() {
+#ifdef PERF_MONITORING_ENABLED
+    uint32_t clock = PerfMonitor::cycles();
+    uint32_t clockHz = F_CPU;
+#else
+    uint32_t clock = micros();
+    uint32_t clockHz = 1000000UL;
+#endif
+    unsigned long sinceReceive = micros() - _parser->getReceiveTime();
+
+    const char* token = _parser->getParamCount() > 0 ? _parser->getParam(0) : "0";
+    _parser->sendFormattedResponse("OK", "BENCH=%.16s,CLK=%lu,HZ=%lu,RX_US=%lu", token,
+                                   static_cast<unsigned long>(clock),
+                                   static_cast<unsigned long>(clockHz), sinceReceive);
+}
+
+// Motion commands
+
+void CommandHandler::cmdHome() {
+    const char* axis = _parser->getParam(0);
+    bool success = false;
+
+    if (_scanner.isActive()) {
+        _parser->sendResponse("ERROR", "SCAN_ACTIVE");
+        return;
+    }
+    if (_motion.isHoming()) {
+        _parser->sendResponse("ERROR", "HOMING_ACTIVE");
+        return;
+    }
+
+    // Homing runs in the background; INFO:HOMING/HOMED/HOMING_DONE report progress
+    if (strcmp(axis, "ALL") == 0) {
+        success = _motion.homeAllAxes();
+    } else if (strcmp(axis, "X") == 0 || strcmp(axis, "Y") == 0 || strcmp(axis, "Z") == 0 ||
+               strcmp(axis, "P") == 0 || strcmp(axis, "T") == 0) {
+        success = _motion.homeAxis(axis[0]);
+    } else {
+        _parser->sendResponse("ERROR", "INVALID_AXIS");
+        return;
+    }
+
+    if (success) {
+        _parser->sendResponse("OK", "HOMING_STARTED");
+    } else {
+        _parser->sendResponse("ERROR", "HOMING_FAILED");
+    }
+}
+
+void CommandHandler::cmdMove() {
+    if (_scanner.isActive()) {
+        _parser->sendResponse("ERROR", "SCAN_ACTIVE");
+        return;
+    }
+
+    if (_motion.isQueueActive()) {
+        // Direct moves would fight the queued path
+        _parser->sendResponse("ERROR", "QUEUE_ACTIVE");
+        return;
+    }
+
+    float x = _parser->getParamAsFloat(0);
+    float y = _parser->getParamAsFloat(1);
+    float z = _parser->getParamAsFloat(2);
+    float pan = _parser->getParamCount() > 3 ? _parser->getParamAsFloat(3) : _motion.getPanAngle();
+    float tilt =
+        _parser->getParamCount() > 4 ? _parser->getParamAsFloat(4) : _motion.getTiltAngle();
+
+    // Coordinated by default: all axes start together and arrive together
+    bool success = _motion.moveToPosition(x, y, z, pan, tilt);
+
+    if (success) {
+        _parser->sendResponse("OK", "MOVE_STARTED");
+    } else {
+        _parser->sendResponse("ERROR", "MOVE_FAILED");
+    }
+}
+
+void CommandHandler::cmdMoveQueued() {
+    if (_scanner.isActive()) {
+        _parser->sendResponse("ERROR", "SCAN_ACTIVE");
+        return;
+    }
+
+    float x = _parser->getParamAsFloat(0);
+    float y = _parser->getParamAsFloat(1);
+    float z = _parser->getParamAsFloat(2);
+    float pan = _parser->getParamCount() > 3 ? _parser->getParamAsFloat(3) : -1;
+
+    if (_motion.queueMove(x, y, z, pan)) {
+        _parser->sendFormattedResponse("OK", "QUEUED,DEPTH=%d", _motion.getQueueDepth());
+    } else {
+        _parser->sendResponse("ERROR", "QUEUE_FULL");
+    }
+}
+
+void CommandHandler::cmdQueueClear() {
+    _motion.clearQueue();
+    _parser->sendResponse("OK", "QUEUE_CLEARED");
+}
+
+void CommandHandler::cmdQueueStatus() {
+    _parser->sendFormattedResponse("OK", "DEPTH=%d,CAPACITY=%d,DONE=%lu,UNDERRUNS=%lu",
+                                  _motion.getQueueDepth(), _motion.getQueueCapacity(),
+                                  (unsigned long)_motion.getQueueCompleted(),
+                                  (unsigned long)_motion.getQueueUnderruns());
+}
+
+void CommandHandler::cmdStop() {
+    _scanner.abort();
+    _motion.stop();
+    _parser->sendResponse("OK", "MOTION_STOPPED");
+}
+
+void CommandHandler::cmdVelocity() {
+    float vx = _parser->getParamAsFloat(0);
+    float vy = _parser->getParamAsFloat(1);
+    float vz = _parser->getParamAsFloat(2);
+
+    _motion.setVelocity(vx, vy, vz);
+    _parser->sendResponse("OK", "VELOCITY_SET");
+}
+
+// PROFILE:<axis>                          report the axis limits
+// PROFILE:<axis>,<vel>,<accel>[,<jerk>]   set them (kept as config keys for SAVE)
+void CommandHandler::cmdProfile() {
+    const char* axisName = _parser->getParam(0);
+    char axis = axisName[0];
+    const char* suffix = profileKeySuffix(axis);
+    if (!suffix || axisName[1] != '\0') {
+        _parser->sendResponse("ERROR", "INVALID_AXIS");
+        return;
+    }
+
+    if (_parser->getParamCount() >= 3) {
+        int32_t velocity = _parser->getParamAsInt(1);
+        int32_t acceleration = _parser->getParamAsInt(2);
+        int32_t jerk = _parser->getParamCount() > 3 ? _parser->getParamAsInt(3) : 0;
+
+        if (!_motion.setAxisProfile(axis, velocity, acceleration, jerk)) {
+            _parser->sendResponse("ERROR", "INVALID_PARAM");
+            return;
         }
+
+        char key[16];
+        snprintf(key, sizeof(key), "velocity_%s", suffix);
+        _config.setInt(key, velocity);
+        snprintf(key, sizeof(key), "accel_%s", suffix);
+        _config.setInt(key, acceleration);
+        snprintf(key, sizeof(key), "jerk_%s", suffix);
+        _config.setInt(key, jerk);
+    } else if (_parser->getParamCount() == 2) {
+        _parser->sendResponse("ERROR", "MISSING_PARAMS");
+        return;
     }
+
+    const AxisProfile* profile = _motion.getAxisProfile(axis);
+    _parser->sendFormattedResponse("OK", "AXIS=%c,VEL=%ld,ACCEL=%ld,JERK=%ld", toupper(axis),
+                                  (long)profile->velocity, (long)profile->acceleration,
+                                  (long)profile->jerk);
 }
 
-void CommandHandler::handleServoCommands() {
-    const char* cmd = _parser.getCommand();
+// TRACE:STATUS                      recorder state and settings
+// TRACE:ARM[,MOVE,ALERT,ESTOP,FAIL]  start recording (default triggers: trace_triggers)
+// TRACE:TRIGGER                     capture now
+// TRACE:STOP                        stop recording
+// TRACE:GET                         download the frozen trace as DATA:TRACE lines
+// TRACE:SAVE[,<file>]               write it to the SD card as CSV
+void CommandHandler::cmdTrace() {
+    if (!_trace) {
+        _parser->sendResponse("ERROR", "TRACE_DISABLED");
+        return;
+    }
 
-    if (strcmp(cmd, "TILT") == 0) {
-        if (_parser.getParamCount() > 0) {
-            float angle = _parser.getParamAsFloat(0);
-            bool success = _motion.setPanAngle(static_cast<int32_t>(angle));
+    const char* mode = _parser->getParam(0);
 
-            if (success) {
-                _parser.sendResponse("OK", "TILT_SET");
-            } else {
-                _parser.sendResponse("ERROR", "TILT_FAILED");
+    if (strcmp(mode, "STATUS") == 0) {
+        char reply[96];
+        snprintf(reply, sizeof(reply),
+                 "TRACE=%s,SAMPLES=%u,CAP=%u,PERIOD=%u,POST=%u,TRIG=%02X,CAUSE=%02X",
+                 MotionTrace::getStateName(_trace->getState()), _trace->getSampleCount(),
+                 _trace->getCapacity(), _trace->getPeriod(), _trace->getPostSamples(),
+                 _trace->getTriggers(), _trace->getCause());
+        _parser->sendResponse("OK", reply);
+    } else if (strcmp(mode, "ARM") == 0) {
+        int triggers = 0;
+        if (_parser->getParamCount() > 1) {
+            for (int i = 1; i < _parser->getParamCount(); i++) {
+                int trigger = MotionTrace::parseTrigger(_parser->getParam(i));
+                if (trigger < 0) {
+                    _parser->sendResponse("ERROR", "INVALID_TRIGGER");
+                    return;
+                }
+                triggers |= trigger;
             }
         } else {
-            _parser.sendResponse("ERROR", "MISSING_PARAM");
-        }
-    } else if (strcmp(cmd, "PAN") == 0) {
-        if (_parser.getParamCount() > 0) {
-            float angle = _parser.getParamAsFloat(0);
-            bool success = _motion.setPanAngle(
-                static_cast<int32_t>(angle));  // angle is float, but method expects int32_t
-
-            if (success) {
-                _parser.sendResponse("OK", "PAN_SET");
-            } else {
-                _parser.sendResponse("ERROR", "PAN_FAILED");
+            triggers = MotionTrace::parseTriggers(
+                _config.getString("trace_triggers", TRACE_DEFAULT_TRIGGERS).c_str());
+            if (triggers < 0) {
+                triggers = MotionTrace::parseTriggers(TRACE_DEFAULT_TRIGGERS);
             }
+        }
+
+        _trace->arm(triggers);
+        _parser->sendFormattedResponse("OK", "TRACE_ARMED,TRIG=%02X", triggers);
+    } else if (strcmp(mode, "TRIGGER") == 0) {
+        if (_trace->trigger()) {
+            _parser->sendResponse("OK", "TRACE_TRIGGERED");
         } else {
-            _parser.sendResponse("ERROR", "MISSING_PARAM");
+            _parser->sendResponse("ERROR", "TRACE_NOT_ARMED");
+        }
+    } else if (strcmp(mode, "STOP") == 0) {
+        _trace->stop();
+        _parser->sendResponse("OK", "TRACE_STOPPED");
+    } else if (strcmp(mode, "GET") == 0) {
+        if (_trace->getState() != MotionTrace::TRACE_DONE) {
+            _parser->sendResponse("ERROR", "TRACE_NOT_READY");
+            return;
         }
+
+        // The blob follows from update(), a line at a time
+        _traceSending = true;
+        _traceOffset = 0;
+        _traceCapture = _trace->getCaptureId();
+        _parser->sendFormattedResponse("OK", "TRACE_GET=%lu,CRC=%04X",
+                                       (unsigned long)_trace->getBlobSize(), _trace->getBlobCRC());
+    } else if (strcmp(mode, "SAVE") == 0) {
+        if (_trace->getState() != MotionTrace::TRACE_DONE) {
+            _parser->sendResponse("ERROR", "TRACE_NOT_READY");
+            return;
+        }
+
+        const char* path = _parser->getParamCount() > 1 ? _parser->getParam(1) : TRACE_CSV_FILE;
+        if (!_trace->saveCsv(path)) {
+            _parser->sendResponse("ERROR", "TRACE_SAVE_FAILED");
+            return;
+        }
+        _traceSaving = true;
+        _parser->sendResponse("OK", "TRACE_SAVING");
+    } else {
+        _parser->sendResponse("ERROR", "INVALID_PARAM");
     }
 }
 
-void CommandHandler::handleConfigCommands() {
-    const char* cmd = _parser.getCommand();
+// Config key suffix of an axis ("x", "y", "z", "pan"), or nullptr
+const char* CommandHandler::profileKeySuffix(char axis) {
+    switch (axis) {
+        case 'X':
+        case 'x':
+            return "x";
+        case 'Y':
+        case 'y':
+            return "y";
+        case 'Z':
+        case 'z':
+            return "z";
+        case 'P':
+        case 'p':
+            return "pan";
+        default:
+            return nullptr;
+    }
+}
 
-    if (strcmp(cmd, "CONFIG") == 0) {
-        if (_parser.getParamCount() > 0) {
-            const char* subCmd = _parser.getParam(0);
+// Apply the velocity_*, accel_* and jerk_* keys (accel_* defaults to "acceleration")
+void CommandHandler::applyMotionProfiles() {
+    const char axes[] = {'X', 'Y', 'Z', 'P'};
+    int acceleration = _config.getInt("acceleration", DEFAULT_ACCELERATION_LIMIT);
 
-            if (strcmp(subCmd, "LOAD") == 0) {
-                bool success = _config.loadConfig();
-                if (success) {
-                    _parser.sendResponse("OK", "CONFIG_LOADED");
-                } else {
-                    _parser.sendResponse("ERROR", "CONFIG_LOAD_FAILED");
-                }
-            } else if (strcmp(subCmd, "SAVE") == 0) {
-                bool success = _config.saveConfig();
-                if (success) {
-                    _parser.sendResponse("OK", "CONFIG_SAVED");
-                } else {
-                    _parser.sendResponse("ERROR", "CONFIG_SAVE_FAILED");
-                }
-            } else if (strcmp(subCmd, "LIST") == 0) {
-                // This would require adding a method to list all configuration items
-                // For now, just acknowledge the command
-                _parser.sendResponse("OK", "CONFIG_LIST_NOT_IMPLEMENTED");
-            } else {
-                _parser.sendResponse("ERROR", "INVALID_CONFIG_COMMAND");
-            }
-        } else {
-            _parser.sendResponse("ERROR", "MISSING_CONFIG_COMMAND");
+    for (int i = 0; i < 4; i++) {
+        const char* suffix = profileKeySuffix(axes[i]);
+        char velocityKey[16];
+        char accelKey[16];
+        char jerkKey[16];
+        snprintf(velocityKey, sizeof(velocityKey), "velocity_%s", suffix);
+        snprintf(accelKey, sizeof(accelKey), "accel_%s", suffix);
+        snprintf(jerkKey, sizeof(jerkKey), "jerk_%s", suffix);
+
+        _motion.setAxisProfile(axes[i], _config.getInt(velocityKey, DEFAULT_VELOCITY_LIMIT),
+                               _config.getInt(accelKey, acceleration),
+                               _config.getInt(jerkKey, 0));
+    }
+}
+
+void CommandHandler::applyHomingConfig() {
+    const char axes[] = {'X', 'Y', 'Z', 'P'};
+
+    for (int i = 0; i < 4; i++) {
+        const char* suffix = profileKeySuffix(axes[i]);
+        HomingConfig config = *_motion.getHomingConfig(axes[i]);
+        char key[24];
+
+        snprintf(key, sizeof(key), "home_sensor_%s", suffix);
+        config.sensorPin = _config.getInt(key, config.sensorPin);
+        snprintf(key, sizeof(key), "home_dir_%s", suffix);
+        config.direction = _config.getInt(key, config.direction) < 0 ? -1 : 1;
+        snprintf(key, sizeof(key), "home_seek_%s", suffix);
+        config.seekVelocity = _config.getInt(key, config.seekVelocity);
+        snprintf(key, sizeof(key), "home_latch_%s", suffix);
+        config.latchVelocity = _config.getInt(key, config.latchVelocity);
+        snprintf(key, sizeof(key), "home_backoff_%s", suffix);
+        config.backoff = _config.getInt(key, config.backoff);
+        snprintf(key, sizeof(key), "home_travel_%s", suffix);
+        config.maxTravel = _config.getInt(key, config.maxTravel);
+
+        if (!_motion.setHomingConfig(axes[i], config)) {
+            EventLogger.log(SOURCE_MOTION, EVENT_WARNING, EVT_MOTION_HOME_FAILED, axes[i], -1);
         }
-    } else if (strcmp(cmd, "GET") == 0) {
-        if (_parser.getParamCount() > 0) {
-            const char* key = _parser.getParam(0);
+    }
 
-            if (_config.hasKey(key)) {
-                String value = _config.getString(key, "");
-                _parser.sendResponse("OK", value.c_str());
-            } else {
-                _parser.sendResponse("ERROR", "KEY_NOT_FOUND");
-            }
+    _motion.setParallelHoming(_config.getBool("home_parallel", false));
+}
+
+void CommandHandler::setMotionTrace(MotionTrace* trace) {
+    _trace = trace;
+}
+
+void CommandHandler::applyTraceConfig() {
+    if (!_trace) {
+        return;
+    }
+
+    _trace->setPeriod(_config.getInt("trace_period_ms", TRACE_DEFAULT_PERIOD_MS));
+    _trace->setPostSamples(_config.getInt("trace_post_samples", TRACE_DEFAULT_POST));
+
+    if (!_config.getBool("trace_enabled", true)) {
+        _trace->stop();
+        return;
+    }
+
+    int triggers =
+        MotionTrace::parseTriggers(_config.getString("trace_triggers", TRACE_DEFAULT_TRIGGERS).c_str());
+    if (triggers < 0) {
+        triggers = MotionTrace::parseTriggers(TRACE_DEFAULT_TRIGGERS);
+    }
+
+    // A frozen capture is kept until it is re-armed by hand
+    MotionTrace::State state = _trace->getState();
+    if (state == MotionTrace::TRACE_IDLE ||
+        (state == MotionTrace::TRACE_ARMED && triggers != _trace->getTriggers())) {
+        _trace->arm(triggers);
+    }
+}
+
+// Rangefinder commands
+
+void CommandHandler::cmdMeasure() {
+    // The reply is sent from update() when the reading arrives
+    if (_scanner.isActive() || _rangeStreaming) {
+        _parser->sendResponse("ERROR", "RANGEFINDER_BUSY");
+    } else if (_measurePending) {
+        _parser->sendResponse("ERROR", "MEASUREMENT_PENDING");
+    } else {
+        _rangefinder.clearResults();
+        if (_rangefinder.startMeasurement()) {
+            _measurePending = true;
         } else {
-            _parser.sendResponse("ERROR", "MISSING_KEY");
+            _parser->sendResponse("ERROR", "MEASUREMENT_FAILED");
         }
-    } else if (strcmp(cmd, "SET") == 0) {
-        if (_parser.getParamCount() >= 2) {
-            const char* key = _parser.getParam(0);
-            const char* value = _parser.getParam(1);
-
-            _config.setString(key, value);
-            _parser.sendResponse("OK", "VALUE_SET");
-
-            // Apply certain configuration values immediately
-            if (strcmp(key, "tilt_min") == 0) {
-                _motion.setTiltLimits(_config.getInt("tilt_min", 45),
-                                      _config.getInt("tilt_max", 135));
-            } else if (strcmp(key, "tilt_max") == 0) {
-                _motion.setTiltLimits(_config.getInt("tilt_min", 45),
-                                      _config.getInt("tilt_max", 135));
-            } else if (strcmp(key, "velocity_x") == 0) {
-                _motion.setVelocity(_config.getInt("velocity_x", DEFAULT_VELOCITY_LIMIT),
-                                    _config.getInt("velocity_y", DEFAULT_VELOCITY_LIMIT),
-                                    _config.getInt("velocity_z", DEFAULT_VELOCITY_LIMIT));
-            }
-            // Add more immediate application cases as needed
+    }
+}
 
+void CommandHandler::cmdMeasureStream() {
+    const char* mode = _parser->getParam(0);
+    if (strcmp(mode, "ON") == 0) {
+        if (_scanner.isActive() || _measurePending) {
+            _parser->sendResponse("ERROR", "RANGEFINDER_BUSY");
         } else {
-            _parser.sendResponse("ERROR", "MISSING_PARAMS");
+            _rangefinder.clearResults();
+            _rangefinder.setContinuous(true);
+            _rangeStreaming = true;
+            _lastRangeFrame = millis();
+            _parser->sendResponse("OK", "STREAM_STARTED");
+        }
+    } else if (strcmp(mode, "OFF") == 0) {
+        _rangeStreaming = false;
+        _rangefinder.setContinuous(false);
+        _parser->sendResponse("OK", "STREAM_STOPPED");
+    } else {
+        _parser->sendResponse("ERROR", "INVALID_PARAM");
+    }
+}
+
+void CommandHandler::cmdScan() {
+    int32_t x1 = static_cast<int32_t>(_parser->getParamAsFloat(0));
+    int32_t y1 = static_cast<int32_t>(_parser->getParamAsFloat(1));
+    int32_t x2 = static_cast<int32_t>(_parser->getParamAsFloat(2));
+    int32_t y2 = static_cast<int32_t>(_parser->getParamAsFloat(3));
+    int32_t step = static_cast<int32_t>(_parser->getParamAsFloat(4));
+
+    if (_scanner.isActive()) {
+        _parser->sendResponse("ERROR", "SCAN_ACTIVE");
+    } else if (_motion.isQueueActive()) {
+        _parser->sendResponse("ERROR", "QUEUE_ACTIVE");
+    } else if (_rangeStreaming || _measurePending) {
+        _parser->sendResponse("ERROR", "RANGEFINDER_BUSY");
+    } else if (step <= 0) {
+        _parser->sendResponse("ERROR", "INVALID_PARAM");
+    } else if (_scanner.start(x1, y1, x2, y2, step)) {
+        // Points stream back as DATA frames; completion is reported with INFO
+        _parser->sendFormattedResponse("OK", "SCAN_STARTED,%lu",
+                                      (unsigned long)_scanner.getPointsTotal());
+    } else {
+        _parser->sendResponse("ERROR", "SCAN_FAILED");
+    }
+}
+
+void CommandHandler::cmdScanPause() {
+    if (_scanner.pause()) {
+        _parser->sendResponse("OK", "SCAN_PAUSING");
+    } else {
+        _parser->sendResponse("ERROR", "SCAN_NOT_RUNNING");
+    }
+}
+
+void CommandHandler::cmdScanResume() {
+    if (_scanner.resume()) {
+        _parser->sendResponse("OK", "SCAN_RESUMED");
+    } else {
+        _parser->sendResponse("ERROR", "SCAN_NOT_PAUSED");
+    }
+}
+
+void CommandHandler::cmdScanAbort() {
+    _scanner.abort();
+    _parser->sendResponse("OK", "SCAN_ABORTED");
+}
+
+void CommandHandler::cmdScanStatus() {
+    _parser->sendFormattedResponse("OK", "STATE=%s,DONE=%lu,TOTAL=%lu", _scanner.getStateString(),
+                                  (unsigned long)_scanner.getPointsDone(),
+                                  (unsigned long)_scanner.getPointsTotal());
+}
+
+// Telemetry commands
+
+// SUBSCRIBE:<rate_hz>,<field>[,<field>...]  (field ALL selects every field)
+void CommandHandler::cmdSubscribe() {
+    int rate = _parser->getParamAsInt(0);
+    uint16_t mask = 0;
+
+    for (int i = 1; i < _parser->getParamCount(); i++) {
+        const char* name = _parser->getParam(i);
+        if (strcmp(name, "ALL") == 0) {
+            mask |= TELEMETRY_ALL_FIELDS;
+            continue;
+        }
+
+        int field = Telemetry::fieldFromName(name);
+        if (field < 0) {
+            _parser->sendResponse("ERROR", "INVALID_FIELD");
+            return;
         }
-    } else if (strcmp(cmd, "SAVE") == 0) {
-        bool success = _config.saveConfig();
+        mask |= 1 << field;
+    }
+
+    if (!_telemetry->subscribe(rate, mask)) {
+        _parser->sendResponse("ERROR", "INVALID_RATE");
+        return;
+    }
+
+    _parser->sendFormattedResponse("OK", "SUBSCRIBED,RATE=%d,FIELDS=%X", rate, mask);
+}
+
+void CommandHandler::cmdUnsubscribe() {
+    _telemetry->unsubscribe();
+    _parser->sendResponse("OK", "UNSUBSCRIBED");
+}
+
+// Servo commands
+
+void CommandHandler::cmdTilt() {
+    float angle = _parser->getParamAsFloat(0);
+    bool success = _motion.setPanAngle(static_cast<int32_t>(angle));
+
+    if (success) {
+        _parser->sendResponse("OK", "TILT_SET");
+    } else {
+        _parser->sendResponse("ERROR", "TILT_FAILED");
+    }
+}
+
+void CommandHandler::cmdPan() {
+    float angle = _parser->getParamAsFloat(0);
+    bool success = _motion.setPanAngle(
+        static_cast<int32_t>(angle));  // angle is float, but method expects int32_t
+
+    if (success) {
+        _parser->sendResponse("OK", "PAN_SET");
+    } else {
+        _parser->sendResponse("ERROR", "PAN_FAILED");
+    }
+}
+
+// Configuration commands
+
+void CommandHandler::cmdConfig() {
+    const char* subCmd = _parser->getParam(0);
+
+    if (strcmp(subCmd, "LOAD") == 0) {
+        bool success = _config.loadConfig();
         if (success) {
-            _parser.sendResponse("OK", "CONFIG_SAVED");
+            _parser->sendResponse("OK", "CONFIG_LOADED");
         } else {
-            _parser.sendResponse("ERROR", "CONFIG_SAVE_FAILED");
+            _parser->sendResponse("ERROR", "CONFIG_LOAD_FAILED");
         }
+    } else if (strcmp(subCmd, "SAVE") == 0) {
+        cmdSave();
+    } else if (strcmp(subCmd, "LIST") == 0) {
+        // This would require adding a method to list all configuration items
+        // For now, just acknowledge the command
+        _parser->sendResponse("OK", "CONFIG_LIST_NOT_IMPLEMENTED");
+    } else {
+        _parser->sendResponse("ERROR", "INVALID_CONFIG_COMMAND");
+    }
+}
+
+void CommandHandler::cmdGet() {
+    const char* key = _parser->getParam(0);
+
+    if (_config.hasKey(key)) {
+        String value = _config.getString(key, "");
+        _parser->sendResponse("OK", value.c_str());
+    } else {
+        _parser->sendResponse("ERROR", "KEY_NOT_FOUND");
     }
-}
\ No newline at end of file
+}
+
+void CommandHandler::cmdSet() {
+    const char* key = _parser->getParam(0);
+    const char* value = _parser->getParam(1);
+
+    _config.setString(key, value);
+    _parser->sendResponse("OK", "VALUE_SET");
+
+    // Apply certain configuration values immediately
+    if (strcmp(key, "tilt_min") == 0) {
+        _motion.setTiltLimits(_config.getInt("tilt_min", 45), _config.getInt("tilt_max", 135));
+    } else if (strcmp(key, "tilt_max") == 0) {
+        _motion.setTiltLimits(_config.getInt("tilt_min", 45), _config.getInt("tilt_max", 135));
+    } else if (strncmp(key, "velocity_", 9) == 0 || strncmp(key, "accel", 5) == 0 ||
+               strncmp(key, "jerk_", 5) == 0) {
+        applyMotionProfiles();
+    } else if (strcmp(key, "coordinated_moves") == 0) {
+        _motion.setCoordinatedMoves(_config.getBool("coordinated_moves", true));
+    } else if (strncmp(key, "home_", 5) == 0) {
+        applyHomingConfig();
+    } else if (strncmp(key, "trace_", 6) == 0) {
+        applyTraceConfig();
+    }
+    // Add more immediate application cases as needed
+}
+
+void CommandHandler::cmdSave() {
+    bool success = _config.saveConfig();
+    if (success) {
+        _parser->sendResponse("OK", "CONFIG_SAVED");
+    } else {
+        _parser->sendResponse("ERROR", "CONFIG_SAVE_FAILED");
+    }
+}
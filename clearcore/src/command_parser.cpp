@@ -6,41 +6,116 @@
 
 #include <stdarg.h>
 
+#include "crc16.h"
+
+// Command names for binary opcodes, indexed by opcode (OP_TEXT has none)
+static const char* const OPCODE_NAMES[CommandParser::OP_COUNT] = {
+    nullptr,        "PING",        "STATUS",       "ESTOP",      "RESET_ESTOP",
+    "STOP",         "MOVE",        "MOVEQ",        "QUEUE_CLEAR", "QUEUE_STATUS",
+    "VELOCITY",     "MEASURE",     "SCAN",         "SCAN_PAUSE", "SCAN_RESUME",
+    "SCAN_ABORT",   "SCAN_STATUS", "TILT",         "PAN",        "PROTOCOL",
+    "BATCH"};
+
 // Default constructor (implementation needed for the header declaration)
-CommandParser::CommandParser() : _bufferIndex(0), _commandComplete(false), _paramCount(0) {
-    _serial = nullptr;
-}
+CommandParser::CommandParser()
+    : _serial(nullptr),
+      _bulkStream(nullptr),
+      _rxLength(0),
+      _bufferIndex(0),
+      _commandComplete(false),
+      _command(""),
+      _paramCount(0),
+      _protocol(PROTOCOL_TEXT),
+      _frameState(FRAME_WAIT_SYNC),
+      _frameLength(0),
+      _frameCRC(0),
+      _bodyCRC(CRC16_INIT),
+      _lineCRC(CRC16_INIT),
+      _lineCRCLength(0),
+      _binaryCommand(false),
+      _batchLength(0),
+      _batchTotal(0),
+      _batchDone(0),
+      _batchStarting(false),
+      _batchTruncated(false),
+      _batchStartTime(0),
+      _inCommand(false),
+      _entryStart(0),
+      _receiveTime(0) {}
 
 CommandParser::CommandParser(Stream& serial)
-    : _bufferIndex(0), _commandComplete(false), _paramCount(0) {
-    _serial = &serial;
+    : _serial(&serial),
+      _bulkStream(nullptr),
+      _rxLength(0),
+      _bufferIndex(0),
+      _commandComplete(false),
+      _command(""),
+      _paramCount(0),
+      _protocol(PROTOCOL_TEXT),
+      _frameState(FRAME_WAIT_SYNC),
+      _frameLength(0),
+      _frameCRC(0),
+      _bodyCRC(CRC16_INIT),
+      _lineCRC(CRC16_INIT),
+      _lineCRCLength(0),
+      _binaryCommand(false),
+      _batchLength(0),
+      _batchTotal(0),
+      _batchDone(0),
+      _batchStarting(false),
+      _batchTruncated(false),
+      _batchStartTime(0),
+      _inCommand(false),
+      _entryStart(0),
+      _receiveTime(0) {}
+
+CommandParser::CommandParser(BulkStream& stream) : CommandParser(static_cast<Stream&>(stream)) {
+    _bulkStream = &stream;
 }
 
 void CommandParser::processChar(char c) {
+    if (_protocol == PROTOCOL_BINARY) {
+        processFrameByte(static_cast<uint8_t>(c));
+        return;
+    }
+
     // Handle backspace
     if (c == '\b' && _bufferIndex > 0) {
         _bufferIndex--;
+
+        // The running checksum can't drop a byte: redo it over what is left
+        if (_lineCRCLength > _bufferIndex) {
+            _lineCRC = crc16Update(CRC16_INIT, reinterpret_cast<const uint8_t*>(_buffer),
+                                   _bufferIndex);
+            _lineCRCLength = _bufferIndex;
+        }
     }
     // Handle end of command (newline)
     else if (c == '\n' || c == '\r') {
         if (_bufferIndex > 0) {
+            _receiveTime = micros();
             _buffer[_bufferIndex] = '\0';
-            parseCommand();
-
-            // Call command handler if registered
-            if (_commandComplete && _cmdHandler) {
-                _cmdHandler(*this);
-            }
-
-            reset();
+            processLine(_buffer, _bufferIndex);
+            _bufferIndex = 0;
         }
+        resetLineCRC();
     }
     // Add character to buffer if not full
     else if (_bufferIndex < CMD_BUFFER_SIZE - 1) {
+        // Checksum the data part as it arrives, so it is ready at the newline
+        if (_lineCRCLength == _bufferIndex && c != ';') {
+            _lineCRC = crc16Update(_lineCRC, static_cast<uint8_t>(c));
+            _lineCRCLength++;
+        }
         _buffer[_bufferIndex++] = c;
     }
 }
 
+void CommandParser::resetLineCRC() {
+    _lineCRC = CRC16_INIT;
+    _lineCRCLength = 0;
+}
+
 bool CommandParser::hasCommand() const {
     return _commandComplete;
 }
@@ -59,18 +134,94 @@ bool CommandParser::update() {
         return false;
     }
 
-    // Process incoming serial data
-    while (_serial->available() > 0) {
-        char c = _serial->read();
-        processChar(c);
+    // Answer a batch whose commands stopped arriving
+    if (_batchTotal > 0 && millis() - _batchStartTime >= BATCH_TIMEOUT_MS) {
+        finishBatch();
+    }
+
+    // Pull everything available into the receive buffer in one call when the
+    // transport supports it, otherwise byte by byte
+    size_t room = RX_BUFFER_SIZE - 1 - _rxLength;
+    if (_bulkStream) {
+        int received = _bulkStream->readAvailable(_rxBuffer + _rxLength, room);
+        if (received > 0) {
+            _rxLength += received;
+            _receiveTime = micros();
+        }
+    } else {
+        size_t before = _rxLength;
+        while (room > 0 && _serial->available() > 0) {
+            int c = _serial->read();
+            if (c < 0) {
+                break;
+            }
+            _rxBuffer[_rxLength++] = static_cast<uint8_t>(c);
+            room--;
+        }
+        if (_rxLength > before) {
+            _receiveTime = micros();
+        }
+    }
+
+    return processReceived();
+}
+
+// Handle every complete line or frame in the receive buffer
+bool CommandParser::processReceived() {
+    bool processed = false;
+    size_t start = 0;
+
+    while (start < _rxLength) {
+        // The protocol can change between commands (PROTOCOL:BINARY)
+        if (_protocol == PROTOCOL_BINARY) {
+            FrameState before = _frameState;
+            processFrameByte(_rxBuffer[start++]);
+            processed |= (before == FRAME_CRC_HIGH);
+            continue;
+        }
+
+        char* line = reinterpret_cast<char*>(_rxBuffer + start);
+        size_t remaining = _rxLength - start;
 
-        // If a complete command was found and processed, return true
-        if (_commandComplete) {
-            return true;
+        // Lines end with \n, \r or \r\n
+        char* end = static_cast<char*>(memchr(line, '\n', remaining));
+        char* cr = static_cast<char*>(memchr(line, '\r', end ? end - line : remaining));
+        if (cr) {
+            end = cr;
+        }
+        if (!end) {
+            break;
         }
+
+        *end = '\0';
+        size_t length = end - line;
+        start += length + 1;
+
+        if (length > 0) {
+            processLine(line, length);
+            processed = true;
+        }
+    }
+
+    // Keep a partial line or frame for the next read
+    if (start > 0) {
+        memmove(_rxBuffer, _rxBuffer + start, _rxLength - start);
+        _rxLength -= start;
+    } else if (_rxLength >= RX_BUFFER_SIZE - 1) {
+        // No line end in a full buffer
+        _rxLength = 0;
+        sendResponse("ERROR", "LINE_TOO_LONG");
     }
 
-    return false;
+    return processed;
+}
+
+// Parse and dispatch one text command line (modified in place)
+void CommandParser::processLine(char* line, size_t length) {
+    beginCommand();
+    parseCommand(line, length);
+    dispatchCommand();
+    endCommand();
 }
 
 void CommandParser::sendResponse(const char* status, const char* message) {
@@ -78,9 +229,30 @@ void CommandParser::sendResponse(const char* status, const char* message) {
         return;
     }
 
-    _serial->print(status);
-    _serial->print(":");
-    _serial->println(message);
+    if (_batchTotal > 0 && _inCommand) {
+        appendBatchEntry(status, message);
+    } else if (_protocol == PROTOCOL_BINARY) {
+        uint8_t opcode = OP_RESP_INFO;
+        if (strcmp(status, "OK") == 0) {
+            opcode = OP_RESP_OK;
+        } else if (strcmp(status, "ERROR") == 0) {
+            opcode = OP_RESP_ERROR;
+        } else if (strcmp(status, "DATA") == 0) {
+            opcode = OP_RESP_DATA;
+        }
+        sendFrame(opcode, message);
+    } else {
+        // Coalesce "STATUS:message\r\n" into one write
+        int length = snprintf(reinterpret_cast<char*>(_txBuffer), TX_FRAME_SIZE, "%s:%s\r\n",
+                              status, message);
+        if (length > 0 && length < TX_FRAME_SIZE) {
+            _serial->write(_txBuffer, length);
+        } else {
+            _serial->print(status);
+            _serial->print(":");
+            _serial->println(message);
+        }
+    }
 
 #ifdef DEBUG
     Serial.print("Response: ");
@@ -90,30 +262,27 @@ void CommandParser::sendResponse(const char* status, const char* message) {
 #endif
 }
 
+// Plain streams block on write rather than drop, so any response fits
+int CommandParser::availableForWrite() {
+    if (!_serial) {
+        return 0;
+    }
+    return _bulkStream ? _bulkStream->availableForWrite() : TX_FRAME_SIZE;
+}
+
 void CommandParser::sendFormattedResponse(const char* status, const char* format, ...) {
     if (!_serial) {
         return;
     }
 
-    // Print status part
-    _serial->print(status);
-    _serial->print(":");
-
-    // Format and print data part
+    // Format data part
     char buffer[CMD_BUFFER_SIZE];
     va_list args;
     va_start(args, format);
     vsnprintf(buffer, CMD_BUFFER_SIZE, format, args);
     va_end(args);
 
-    _serial->println(buffer);
-
-#ifdef DEBUG
-    Serial.print("Response: ");
-    Serial.print(status);
-    Serial.print(":");
-    Serial.println(buffer);
-#endif
+    sendResponse(status, buffer);
 }
 
 const char* CommandParser::getCommand() const {
@@ -132,10 +301,16 @@ const char* CommandParser::getParam(int index) const {
 }
 
 float CommandParser::getParamAsFloat(int index) const {
+    if (_binaryCommand && index >= 0 && index < _paramCount) {
+        return static_cast<float>(_binaryParams[index]);
+    }
     return atof(getParam(index));
 }
 
 int CommandParser::getParamAsInt(int index) const {
+    if (_binaryCommand && index >= 0 && index < _paramCount) {
+        return _binaryParams[index];
+    }
     return atoi(getParam(index));
 }
 
@@ -143,60 +318,313 @@ void CommandParser::setCommandHandler(CommandHandlerCallback handler) {
     _cmdHandler = handler;
 }
 
-void CommandParser::reset() {
+bool CommandParser::beginBatch(int count) {
+    if (_batchTotal > 0 || count <= 0 || count > BATCH_MAX_COMMANDS) {
+        return false;
+    }
+
+    _batchTotal = count;
+    _batchDone = 0;
+    _batchLength = 0;
+    _batchStarting = true;
+    _batchTruncated = false;
+    _batchStartTime = millis();
+    return true;
+}
+
+bool CommandParser::isBatchActive() const {
+    return _batchTotal > 0;
+}
+
+// Mark the start of one received command (its responses may join a batch)
+void CommandParser::beginCommand() {
+    reset();
+    _inCommand = true;
+    _entryStart = _batchLength;
+}
+
+// Close the batch entry for the command just processed
+void CommandParser::endCommand() {
+    _inCommand = false;
+
+    if (_batchTotal == 0) {
+        return;
+    }
+
+    if (_batchStarting) {
+        _batchStarting = false;
+        return;
+    }
+
+    // Replies that come later (e.g. MEASURE) are sent on their own
+    if (_batchLength == _entryStart) {
+        appendBatchEntry("OK", "PENDING");
+    }
+
+    if (++_batchDone >= _batchTotal) {
+        finishBatch();
+    }
+}
+
+// Append "|STATUS:message" to the batch reply
+void CommandParser::appendBatchEntry(const char* status, const char* message) {
+    char* entries = _batchBuffer + BATCH_HEADER_SIZE;
+    int room = BATCH_BUFFER_SIZE - _batchLength;
+    int length = snprintf(entries + _batchLength, room, "|%s:%s", status, message);
+
+    if (length < 0 || length >= room) {
+        entries[_batchLength] = '\0';
+        _batchTruncated = true;
+        return;
+    }
+
+    _batchLength += length;
+}
+
+// Send the aggregated reply: OK:BATCH=<n>|... (ERROR:BATCH_INCOMPLETE=<done>/<n>|... on timeout)
+void CommandParser::finishBatch() {
+    bool complete = _batchDone >= _batchTotal;
+    char header[BATCH_HEADER_SIZE];
+    int headerLength;
+
+    if (complete) {
+        headerLength = snprintf(header, sizeof(header), "BATCH=%d%s", _batchTotal,
+                                _batchTruncated ? ",TRUNCATED" : "");
+    } else {
+        headerLength = snprintf(header, sizeof(header), "BATCH_INCOMPLETE=%d/%d", _batchDone,
+                                _batchTotal);
+    }
+
+    // Place the header directly in front of the entries so the reply is one string
+    char* reply = _batchBuffer + BATCH_HEADER_SIZE - headerLength;
+    memcpy(reply, header, headerLength);
+    _batchBuffer[BATCH_HEADER_SIZE + _batchLength] = '\0';
+
+    _batchTotal = 0;
+    _batchStarting = false;
+
+    bool inCommand = _inCommand;
+    _inCommand = false;
+    sendResponse(complete ? "OK" : "ERROR", reply);
+    _inCommand = inCommand;
+}
+
+void CommandParser::setProtocol(Protocol protocol) {
+    _protocol = protocol;
+    _frameState = FRAME_WAIT_SYNC;
     _bufferIndex = 0;
+    resetLineCRC();
+    reset();
+
+#ifdef DEBUG
+    Serial.print("Protocol: ");
+    Serial.println(protocol == PROTOCOL_BINARY ? "BINARY" : "TEXT");
+#endif
+}
+
+CommandParser::Protocol CommandParser::getProtocol() const {
+    return _protocol;
+}
+
+void CommandParser::resetConnection() {
+    _rxLength = 0;
+    _batchTotal = 0;
+    _batchStarting = false;
+    setProtocol(PROTOCOL_TEXT);
+}
+
+void CommandParser::reset() {
+    _command = "";
     _commandComplete = false;
     _paramCount = 0;
+    _binaryCommand = false;
+}
+
+// Hand a parsed command to the handler (it stays readable until the next one)
+void CommandParser::dispatchCommand() {
+    if (_commandComplete && _cmdHandler) {
+        _cmdHandler(*this);
+    }
+}
+
+// Binary receive state machine: one byte at a time, resyncing on FRAME_SYNC
+void CommandParser::processFrameByte(uint8_t b) {
+    switch (_frameState) {
+        case FRAME_WAIT_SYNC:
+            if (b == FRAME_SYNC) {
+                _frameState = FRAME_LENGTH_LOW;
+            }
+            break;
+
+        case FRAME_LENGTH_LOW:
+            _frameLength = b;
+            _frameState = FRAME_LENGTH_HIGH;
+            break;
+
+        case FRAME_LENGTH_HIGH:
+            _frameLength |= static_cast<uint16_t>(b) << 8;
+            if (_frameLength == 0 || _frameLength > CMD_BUFFER_SIZE - 1) {
+                sendResponse("ERROR", "INVALID_FRAME");
+                _frameState = FRAME_WAIT_SYNC;
+            } else {
+                _bufferIndex = 0;
+                _bodyCRC = CRC16_INIT;
+                _frameState = FRAME_BODY;
+            }
+            break;
+
+        case FRAME_BODY:
+            _buffer[_bufferIndex++] = static_cast<char>(b);
+            _bodyCRC = crc16Update(_bodyCRC, b);
+            if (_bufferIndex == _frameLength) {
+                _frameState = FRAME_CRC_LOW;
+            }
+            break;
+
+        case FRAME_CRC_LOW:
+            _frameCRC = b;
+            _frameState = FRAME_CRC_HIGH;
+            break;
+
+        case FRAME_CRC_HIGH:
+            _frameCRC |= static_cast<uint16_t>(b) << 8;
+            _frameState = FRAME_WAIT_SYNC;
+            beginCommand();
+            parseFrame();
+            dispatchCommand();
+            endCommand();
+            break;
+    }
 }
 
-void CommandParser::parseCommand() {
+// Decode a complete binary frame held in _buffer (opcode + payload)
+void CommandParser::parseFrame() {
+    // The body was checksummed as it arrived
+    if (_bodyCRC != _frameCRC) {
+        sendResponse("ERROR", "CHECKSUM_MISMATCH");
+        return;
+    }
+
+    uint8_t opcode = static_cast<uint8_t>(_buffer[0]);
+    size_t payloadLength = _frameLength - 1;
+
+    // Text command carried in a frame: parse it like a received line
+    if (opcode == OP_TEXT) {
+        _buffer[_frameLength] = '\0';
+        if (payloadLength > 0) {
+            parseCommand(_buffer + 1, payloadLength);
+        }
+        return;
+    }
+
+    if (opcode >= OP_COUNT) {
+        sendResponse("ERROR", "UNKNOWN_OPCODE");
+        return;
+    }
+
+    if (payloadLength % 4 != 0 || payloadLength / 4 > MAX_PARAMS) {
+        sendResponse("ERROR", "INVALID_FRAME");
+        return;
+    }
+
+    _command = OPCODE_NAMES[opcode];
+
+    // Fixed-width little-endian int32 fields; keep a text copy for getParam()
+    _paramCount = payloadLength / 4;
+    for (int i = 0; i < _paramCount; i++) {
+        const uint8_t* field = reinterpret_cast<const uint8_t*>(_buffer) + 1 + i * 4;
+        _binaryParams[i] = static_cast<int32_t>(
+            static_cast<uint32_t>(field[0]) | (static_cast<uint32_t>(field[1]) << 8) |
+            (static_cast<uint32_t>(field[2]) << 16) | (static_cast<uint32_t>(field[3]) << 24));
+
+        _params[i] = _paramBuffer + i * 12;
+        snprintf(_params[i], 12, "%ld", static_cast<long>(_binaryParams[i]));
+    }
+
+    _binaryCommand = true;
+    _commandComplete = true;
+}
+
+// Write one response frame with a single write() call
+void CommandParser::sendFrame(uint8_t opcode, const char* message) {
+    sendFrame(opcode, reinterpret_cast<const uint8_t*>(message), strlen(message));
+}
+
+// Write a frame with a raw payload (truncated to fit TX_FRAME_SIZE)
+void CommandParser::sendFrame(uint8_t opcode, const uint8_t* payload, size_t length) {
+    if (!_serial) {
+        return;
+    }
+
+    size_t bodyLength = length + 1;
+
+    // Keep one frame per response: truncate payloads that do not fit
+    if (bodyLength + 5 > TX_FRAME_SIZE) {
+        bodyLength = TX_FRAME_SIZE - 5;
+        length = bodyLength - 1;
+    }
+
+    _txBuffer[0] = FRAME_SYNC;
+    _txBuffer[1] = bodyLength & 0xFF;
+    _txBuffer[2] = bodyLength >> 8;
+    _txBuffer[3] = opcode;
+    memcpy(_txBuffer + 4, payload, length);
+
+    uint16_t crc = crc16Modbus(_txBuffer + 3, bodyLength);
+    _txBuffer[3 + bodyLength] = crc & 0xFF;
+    _txBuffer[4 + bodyLength] = crc >> 8;
+
+    _serial->write(_txBuffer, bodyLength + 5);
+
+    // Frames have no newline to trigger a send on buffered transports
+    _serial->flush();
+}
+
+// Parse a null-terminated line in place: the command and parameters point into it
+void CommandParser::parseCommand(char* line, size_t length) {
     // Format: <CMD>:<PARAMS>;<CRC>\n
 
 #ifdef DEBUG
     Serial.print("Parsing command: ");
-    Serial.println(_buffer);
+    Serial.println(line);
 #endif
 
-    // Find command-parameter separator
-    char* colonPos = strchr(_buffer, ':');
+    // Find checksum separator; verify before the separators below are overwritten
+    char* semicolonPos = static_cast<char*>(memchr(line, ';', length));
+    if (semicolonPos && !verifyChecksum(line, semicolonPos)) {
+        sendResponse("ERROR", "CHECKSUM_MISMATCH");
+        _commandComplete = false;
+        return;
+    }
 
-    // Find checksum separator
-    char* semicolonPos = strchr(_buffer, ';');
+    if (semicolonPos) {
+        *semicolonPos = '\0';
+    }
+
+    // Find command-parameter separator
+    char* colonPos = strchr(line, ':');
+    _command = line;
+    _paramCount = 0;
 
-    // Extract command
     if (colonPos) {
         // Command is everything before the colon
-        size_t cmdLength = colonPos - _buffer;
-        strncpy(_command, _buffer, cmdLength);
-        _command[cmdLength] = '\0';
-
-        // Parameters are between colon and semicolon (or end if no semicolon)
-        char* paramsStart = colonPos + 1;
-        char* paramsEnd = semicolonPos ? semicolonPos : _buffer + _bufferIndex;
-
-        // Copy parameters to buffer
-        size_t paramsLength = paramsEnd - paramsStart;
-        strncpy(_paramBuffer, paramsStart, paramsLength);
-        _paramBuffer[paramsLength] = '\0';
-
-        // Split parameters by comma
-        char* token = strtok(_paramBuffer, ",");
-        _paramCount = 0;
-
-        while (token && _paramCount < MAX_PARAMS) {
-            _params[_paramCount++] = token;
-            token = strtok(NULL, ",");
+        *colonPos = '\0';
+
+        // Split parameters by comma (empty fields are skipped)
+        char* param = colonPos + 1;
+        while (*param && _paramCount < MAX_PARAMS) {
+            char* comma = strchr(param, ',');
+            if (comma) {
+                *comma = '\0';
+            }
+            if (*param) {
+                _params[_paramCount++] = param;
+            }
+            if (!comma) {
+                break;
+            }
+            param = comma + 1;
         }
-    } else {
-        // No parameters, command is the entire buffer
-        strcpy(_command, _buffer);
-    }
-
-    // Verify checksum if present
-    if (semicolonPos && !verifyChecksum()) {
-        sendResponse("ERROR", "CHECKSUM_MISMATCH");
-        _commandComplete = false;
-        return;
     }
 
     _commandComplete = true;
@@ -215,22 +643,21 @@ void CommandParser::parseCommand() {
 #endif
 }
 
-bool CommandParser::verifyChecksum() {
+bool CommandParser::verifyChecksum(const char* line, const char* semicolonPos) {
     // Format: <CMD>:<PARAMS>;<CRC>\n
 
-    // Find checksum separator
-    char* semicolonPos = strchr(_buffer, ';');
-    if (!semicolonPos) {
-        return true;  // No checksum provided, assume valid
+    // Checksum of the data before the semicolon: processChar() lines have it
+    // already, received blocks are checksummed here in one pass
+    int dataLength = semicolonPos - line;
+    uint16_t calculatedCRC;
+    if (line == _buffer && dataLength == _lineCRCLength) {
+        calculatedCRC = _lineCRC;
+    } else {
+        calculatedCRC = crc16Modbus(reinterpret_cast<const uint8_t*>(line), dataLength);
     }
 
-    // Calculate checksum on data before semicolon
-    size_t dataLength = semicolonPos - _buffer;
-    uint16_t calculatedCRC = calculateCRC(_buffer, dataLength);
-
     // Extract received checksum (hexadecimal after semicolon)
-    uint16_t receivedCRC = 0;
-    sscanf(semicolonPos + 1, "%hx", &receivedCRC);  // Use %hx for uint16_t
+    uint16_t receivedCRC = static_cast<uint16_t>(strtoul(semicolonPos + 1, nullptr, 16));
 
 #ifdef DEBUG
     Serial.print("Checksum: calculated=0x");
@@ -241,21 +668,3 @@ bool CommandParser::verifyChecksum() {
 
     return calculatedCRC == receivedCRC;
 }
-
-uint16_t CommandParser::calculateCRC(const char* data, size_t length) {
-    // Simple CRC-16 implementation
-    uint16_t crc = 0xFFFF;
-
-    for (size_t i = 0; i < length; i++) {
-        crc ^= (uint8_t)data[i];
-        for (int j = 0; j < 8; j++) {
-            if (crc & 0x0001) {
-                crc = (crc >> 1) ^ 0xA001;
-            } else {
-                crc = crc >> 1;
-            }
-        }
-    }
-
-    return crc;
-}
\ No newline at end of file
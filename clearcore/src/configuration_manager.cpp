@@ -14,7 +14,12 @@ RESTORE_MINMAX
 
 // Constructor
 ConfigurationManager::ConfigurationManager(const char* configFile)
-    : _configFilePath(configFile), _sdInitialized(false), _configCount(0) {}
+    : _configFilePath(configFile),
+      _sdInitialized(false),
+      _itemCount(0),
+      _configCount(0) {
+    memset(_index, 0, sizeof(_index));
+}
 
 // Initialize the configuration manager
 bool ConfigurationManager::init() {
@@ -67,23 +72,45 @@ bool ConfigurationManager::loadConfig() {
     Serial.println(_configFilePath);
 #endif
 
-    // Read and parse each line
-    while (configFile.available() && _configCount < MAX_CONFIG_ITEMS) {
-        String line = configFile.readStringUntil('\n');
-        line.trim();
-
-        // Skip empty lines and comments
-        if (line.length() == 0 || line.startsWith("#")) {
-            continue;
-        }
+    // Read the file in blocks and split it into lines in a fixed buffer
+    char line[CONFIG_LINE_LENGTH];
+    size_t lineLength = 0;
+    bool lineTooLong = false;
 
-        // Parse config line
-        if (!parseConfigLine(line)) {
+    auto endLine = [&]() {
+        line[lineLength] = '\0';
+        if (lineTooLong) {
+#ifdef DEBUG
+            Serial.print("Config line too long: ");
+            Serial.println(line);
+#endif
+        } else if (!parseConfigLine(line)) {
 #ifdef DEBUG
             Serial.print("Failed to parse config line: ");
             Serial.println(line);
 #endif
         }
+        lineLength = 0;
+        lineTooLong = false;
+    };
+
+    uint8_t block[64];
+    int bytesRead;
+    while ((bytesRead = configFile.read(block, sizeof(block))) > 0) {
+        for (int i = 0; i < bytesRead; i++) {
+            if (block[i] == '\n') {
+                endLine();
+            } else if (lineLength < sizeof(line) - 1) {
+                line[lineLength++] = block[i];
+            } else {
+                lineTooLong = true;
+            }
+        }
+    }
+
+    // Last line without a newline
+    if (lineLength > 0) {
+        endLine();
     }
 
     configFile.close();
@@ -129,12 +156,17 @@ bool ConfigurationManager::saveConfig() {
 
     // Write header
     configFile.println("# Space Maquette Configuration");
-    configFile.println("# Generated: " + String(millis()));
+    configFile.print("# Generated: ");
+    configFile.println(millis());
     configFile.println();
 
     // Write all configuration items
-    for (int i = 0; i < _configCount; i++) {
-        configFile.println(formatConfigLine(_configData[i]));
+    for (int i = 0; i < _itemCount; i++) {
+        if (_configData[i].present) {
+            configFile.print(_configData[i].key);
+            configFile.print('=');
+            configFile.println(_configData[i].value);
+        }
     }
 
     configFile.close();
@@ -148,175 +180,241 @@ bool ConfigurationManager::saveConfig() {
     return true;
 }
 
+// Intern a key and return its handle
+ConfigKey ConfigurationManager::bind(const char* key) {
+    int index = internKey(key);
+    return index >= 0 ? static_cast<ConfigKey>(index) : CONFIG_NO_KEY;
+}
+
 // Get integer value
 int ConfigurationManager::getInt(const char* key, int defaultValue) {
-    int index = findKey(key);
-    if (index < 0) {
-        return defaultValue;
-    }
-
-    return _configData[index].value.toInt();
+    return getInt(static_cast<ConfigKey>(findKey(key)), defaultValue);
 }
 
 // Get float value
 float ConfigurationManager::getFloat(const char* key, float defaultValue) {
-    int index = findKey(key);
-    if (index < 0) {
-        return defaultValue;
-    }
-
-    return _configData[index].value.toFloat();
+    return getFloat(static_cast<ConfigKey>(findKey(key)), defaultValue);
 }
 
 // Get boolean value
 bool ConfigurationManager::getBool(const char* key, bool defaultValue) {
-    int index = findKey(key);
-    if (index < 0) {
-        return defaultValue;
-    }
+    return getBool(static_cast<ConfigKey>(findKey(key)), defaultValue);
+}
 
-    String value = _configData[index].value;
-    value.toLowerCase();
+// Get string value
+String ConfigurationManager::getString(const char* key, const String& defaultValue) {
+    const ConfigItem* item = presentItem(static_cast<ConfigKey>(findKey(key)));
+    return item ? String(item->value) : defaultValue;
+}
 
-    if (value == "true" || value == "1" || value == "yes" || value == "on") {
-        return true;
-    } else if (value == "false" || value == "0" || value == "no" || value == "off") {
-        return false;
-    }
+int ConfigurationManager::getInt(ConfigKey key, int defaultValue) const {
+    const ConfigItem* item = presentItem(key);
+    return item ? item->intValue : defaultValue;
+}
 
-    return defaultValue;
+float ConfigurationManager::getFloat(ConfigKey key, float defaultValue) const {
+    const ConfigItem* item = presentItem(key);
+    return item ? item->floatValue : defaultValue;
 }
 
-// Get string value
-String ConfigurationManager::getString(const char* key, const String& defaultValue) {
-    int index = findKey(key);
-    if (index < 0) {
+bool ConfigurationManager::getBool(ConfigKey key, bool defaultValue) const {
+    const ConfigItem* item = presentItem(key);
+    if (!item || item->boolValue < 0) {
         return defaultValue;
     }
+    return item->boolValue != 0;
+}
 
-    return _configData[index].value;
+const char* ConfigurationManager::getValue(ConfigKey key, const char* defaultValue) const {
+    const ConfigItem* item = presentItem(key);
+    return item ? item->value : defaultValue;
 }
 
 // Set integer value
 void ConfigurationManager::setInt(const char* key, int value) {
-    int index = findKey(key);
-
-    if (index >= 0) {
-        // Update existing item
-        _configData[index].value = String(value);
-    } else if (_configCount < MAX_CONFIG_ITEMS) {
-        // Add new item
-        _configData[_configCount].key = String(key);
-        _configData[_configCount].value = String(value);
-        _configCount++;
-    }
+    char text[12];
+    snprintf(text, sizeof(text), "%d", value);
+    setString(key, text);
 }
 
 // Set float value
 void ConfigurationManager::setFloat(const char* key, float value) {
-    int index = findKey(key);
-
-    if (index >= 0) {
-        // Update existing item
-        _configData[index].value = String(value);
-    } else if (_configCount < MAX_CONFIG_ITEMS) {
-        // Add new item
-        _configData[_configCount].key = String(key);
-        _configData[_configCount].value = String(value);
-        _configCount++;
-    }
+    char text[24];
+    snprintf(text, sizeof(text), "%.2f", value);  // Same precision as String(float)
+    setString(key, text);
 }
 
 // Set boolean value
 void ConfigurationManager::setBool(const char* key, bool value) {
-    int index = findKey(key);
-
-    if (index >= 0) {
-        // Update existing item
-        _configData[index].value = value ? "true" : "false";
-    } else if (_configCount < MAX_CONFIG_ITEMS) {
-        // Add new item
-        _configData[_configCount].key = String(key);
-        _configData[_configCount].value = value ? "true" : "false";
-        _configCount++;
-    }
+    setString(key, value ? "true" : "false");
 }
 
 // Set string value
 void ConfigurationManager::setString(const char* key, const String& value) {
-    int index = findKey(key);
+    setString(key, value.c_str());
+}
 
+void ConfigurationManager::setString(const char* key, const char* value) {
+    int index = internKey(key);
     if (index >= 0) {
-        // Update existing item
-        _configData[index].value = value;
-    } else if (_configCount < MAX_CONFIG_ITEMS) {
-        // Add new item
-        _configData[_configCount].key = String(key);
-        _configData[_configCount].value = value;
-        _configCount++;
+        storeValue(index, value);
     }
 }
 
 // Check if key exists
 bool ConfigurationManager::hasKey(const char* key) {
-    return findKey(key) >= 0;
+    return presentItem(static_cast<ConfigKey>(findKey(key))) != nullptr;
 }
 
-// Clear all configuration
+// Clear all configuration (keys stay interned so bound handles survive a reload)
 void ConfigurationManager::clear() {
+    for (int i = 0; i < _itemCount; i++) {
+        _configData[i].present = false;
+    }
     _configCount = 0;
 }
 
-// Find key in configuration data
-int ConfigurationManager::findKey(const char* key) {
-    for (int i = 0; i < _configCount; i++) {
-        if (_configData[i].key.equals(key)) {
-            return i;
+// FNV-1a hash of a key, over the characters that are stored (longer keys are
+// truncated by internKey(), so lookups must hash the same prefix)
+uint32_t ConfigurationManager::hashKey(const char* key) {
+    uint32_t hash = 2166136261UL;
+    for (size_t i = 0; i < CONFIG_KEY_LENGTH - 1 && key[i]; i++) {
+        hash = (hash ^ static_cast<uint8_t>(key[i])) * 16777619UL;
+    }
+    return hash;
+}
+
+// Find key in configuration data (-1 if it was never interned)
+int ConfigurationManager::findKey(const char* key) const {
+    uint32_t hash = hashKey(key);
+
+    // Linear probing; the index is never more than half full
+    for (uint32_t slot = hash & (CONFIG_INDEX_SIZE - 1);; slot = (slot + 1) & (CONFIG_INDEX_SIZE - 1)) {
+        uint8_t entry = _index[slot];
+        if (entry == 0) {
+            return -1;
+        }
+
+        const ConfigItem& item = _configData[entry - 1];
+        if (item.hash == hash && strncmp(item.key, key, CONFIG_KEY_LENGTH - 1) == 0) {
+            return entry - 1;
         }
     }
+}
+
+// Find or add a key; -1 if the table is full
+int ConfigurationManager::internKey(const char* key) {
+    int index = findKey(key);
+    if (index >= 0) {
+        return index;
+    }
+
+    if (_itemCount >= CONFIG_MAX_ITEMS) {
+#ifdef DEBUG
+        Serial.print("Config table full, ignoring key: ");
+        Serial.println(key);
+#endif
+        return -1;
+    }
+
+    index = _itemCount++;
+    ConfigItem& item = _configData[index];
+    strncpy(item.key, key, CONFIG_KEY_LENGTH - 1);
+    item.key[CONFIG_KEY_LENGTH - 1] = '\0';
+    item.hash = hashKey(item.key);
+    item.present = false;
+    item.value[0] = '\0';
+
+    uint32_t slot = item.hash & (CONFIG_INDEX_SIZE - 1);
+    while (_index[slot] != 0) {
+        slot = (slot + 1) & (CONFIG_INDEX_SIZE - 1);
+    }
+    _index[slot] = index + 1;
+
+    return index;
+}
+
+// Item behind a handle, or nullptr if it has no value
+const ConfigurationManager::ConfigItem* ConfigurationManager::presentItem(ConfigKey key) const {
+    if (key < 0 || key >= _itemCount || !_configData[key].present) {
+        return nullptr;
+    }
+    return &_configData[key];
+}
+
+// Store a value and cache its typed forms
+void ConfigurationManager::storeValue(int index, const char* value) {
+    ConfigItem& item = _configData[index];
+    strncpy(item.value, value, CONFIG_VALUE_LENGTH - 1);
+    item.value[CONFIG_VALUE_LENGTH - 1] = '\0';
+
+    if (!item.present) {
+        item.present = true;
+        _configCount++;
+    }
+
+    // Same conversions as String::toInt() / toFloat()
+    item.intValue = atol(item.value);
+    item.floatValue = atof(item.value);
+
+    if (strcasecmp(item.value, "true") == 0 || strcmp(item.value, "1") == 0 ||
+        strcasecmp(item.value, "yes") == 0 || strcasecmp(item.value, "on") == 0) {
+        item.boolValue = 1;
+    } else if (strcasecmp(item.value, "false") == 0 || strcmp(item.value, "0") == 0 ||
+               strcasecmp(item.value, "no") == 0 || strcasecmp(item.value, "off") == 0) {
+        item.boolValue = 0;
+    } else {
+        item.boolValue = -1;
+    }
+}
 
-    return -1;
+// Trim leading and trailing whitespace in place
+static char* trimInPlace(char* text) {
+    while (isspace(static_cast<unsigned char>(*text))) {
+        text++;
+    }
+    char* end = text + strlen(text);
+    while (end > text && isspace(static_cast<unsigned char>(end[-1]))) {
+        *--end = '\0';
+    }
+    return text;
 }
 
-// Parse a configuration line
-bool ConfigurationManager::parseConfigLine(const String& line) {
+// Parse a configuration line (modified in place)
+bool ConfigurationManager::parseConfigLine(char* line) {
+    line = trimInPlace(line);
+
+    // Skip empty lines and comments
+    if (line[0] == '\0' || line[0] == '#') {
+        return true;
+    }
+
     // Find key-value separator
-    int separatorPos = line.indexOf('=');
-    if (separatorPos <= 0) {
+    char* separator = strchr(line, '=');
+    if (!separator || separator == line) {
         return false;
     }
 
     // Extract key and value
-    String key = line.substring(0, separatorPos);
-    String value = line.substring(separatorPos + 1);
-
-    // Trim whitespace
-    key.trim();
-    value.trim();
+    *separator = '\0';
+    char* key = trimInPlace(line);
+    char* value = trimInPlace(separator + 1);
 
     // Validate key
-    if (key.length() == 0) {
+    if (key[0] == '\0') {
         return false;
     }
 
-    // Check if we have room for another item
-    if (_configCount >= MAX_CONFIG_ITEMS) {
+    // Store key-value pair (a repeated key keeps the last value)
+    int index = internKey(key);
+    if (index < 0) {
         return false;
     }
-
-    // Store key-value pair
-    _configData[_configCount].key = key;
-    _configData[_configCount].value = value;
-    _configCount++;
+    storeValue(index, value);
 
     return true;
 }
 
-// Format a configuration item as a string
-String ConfigurationManager::formatConfigLine(const ConfigItem& item) {
-    return item.key + "=" + item.value;
-}
-
 void ConfigurationManager::dumpConfig() {
 #ifdef DEBUG
     Serial.println("\nConfiguration Settings:");
@@ -330,7 +428,8 @@ void ConfigurationManager::dumpConfig() {
 
     if (_configCount == 0) {
         Serial.println("WARNING: No configuration items loaded!");
-        Serial.println("Check if file exists: " + _configFilePath);
+        Serial.print("Check if file exists: ");
+        Serial.println(_configFilePath);
 
         // Check if the file exists
         if (_sdInitialized) {
@@ -355,10 +454,12 @@ void ConfigurationManager::dumpConfig() {
     }
 
     // Print all configuration items
-    for (int i = 0; i < _configCount; i++) {
-        Serial.print(_configData[i].key);
-        Serial.print(" = ");
-        Serial.println(_configData[i].value);
+    for (int i = 0; i < _itemCount; i++) {
+        if (_configData[i].present) {
+            Serial.print(_configData[i].key);
+            Serial.print(" = ");
+            Serial.println(_configData[i].value);
+        }
     }
 
     Serial.println("------------------------");
@@ -4,9 +4,19 @@
 
 #include "../include/emergency.h"
 
-EmergencyStop::EmergencyStop(int estopPin) : _estopPin(estopPin), _estopActive(false) {}
-
-void EmergencyStop::init() {
+EmergencyStop* EmergencyStop::_instance = nullptr;
+
+EmergencyStop::EmergencyStop(int estopPin)
+    : _estopPin(estopPin),
+      _estopActive(false),
+      _interruptMode(false),
+      _pendingReport(false),
+      _lastLatencyUs(0),
+      _maxLatencyUs(0),
+      _triggerCount(0),
+      _lastPollMicros(0) {}
+
+void EmergencyStop::init(bool useInterrupt) {
     // Configure ESTOP input pin with pull-up
     // Using Arduino-compatible syntax
     pinMode(_estopPin, INPUT_PULLUP);
@@ -23,18 +33,83 @@ void EmergencyStop::init() {
 #endif
     }
 
+    // Falling edge = ESTOP pressed (active low)
+    _interruptMode = useInterrupt;
+    if (_interruptMode) {
+        _instance = this;
+        attachInterrupt(digitalPinToInterrupt(_estopPin), handleInterrupt, FALLING);
+    }
+    _lastPollMicros = micros();
+
 #ifdef DEBUG
-    Serial.println("Emergency stop system initialized");
+    Serial.print("Emergency stop system initialized (");
+    Serial.print(_interruptMode ? "interrupt" : "polled");
+    Serial.println(")");
 #endif
 }
 
+void EmergencyStop::setInterruptMode(bool useInterrupt) {
+    if (useInterrupt == _interruptMode) {
+        return;
+    }
+
+    if (useInterrupt) {
+        _instance = this;
+        attachInterrupt(digitalPinToInterrupt(_estopPin), handleInterrupt, FALLING);
+    } else {
+        detachInterrupt(digitalPinToInterrupt(_estopPin));
+    }
+    _interruptMode = useInterrupt;
+    _lastPollMicros = micros();
+}
+
+// ISR: cut motor enables first, leave reporting and logging to check()
+void EmergencyStop::handleInterrupt() {
+    uint32_t start = micros();
+    EmergencyStop* estop = _instance;
+    if (estop == nullptr || estop->_estopActive) {
+        return;
+    }
+
+    disableMotorsFast();
+    estop->_estopActive = true;
+    estop->_pendingReport = true;
+    estop->recordLatency(micros() - start);
+}
+
 bool EmergencyStop::check() {
-    // Read ESTOP input (active low)
+    unsigned long now = micros();
+    unsigned long sinceLastPoll = now - _lastPollMicros;
+    _lastPollMicros = now;
+
+    // Activation already handled by the ISR
+    if (_pendingReport) {
+        noInterrupts();
+        _pendingReport = false;
+        interrupts();
+
+#ifdef DEBUG
+        Serial.print("EMERGENCY STOP ACTIVATED (interrupt, ");
+        Serial.print(_lastLatencyUs);
+        Serial.println(" us to disable)");
+#endif
+        return true;
+    }
+
+    // Read ESTOP input (active low); also the fallback if an edge was missed
     bool estopTriggered = !digitalRead(_estopPin);
 
     // If ESTOP newly activated
     if (estopTriggered && !_estopActive) {
-        activate();
+        // The input changed at some point since the previous poll
+        _estopActive = true;
+        disableMotorsFast();
+        recordLatency(sinceLastPoll + (micros() - now));
+
+#ifdef DEBUG
+        Serial.println("All motors disabled");
+        Serial.println("EMERGENCY STOP ACTIVATED");
+#endif
         return true;
     }
 
@@ -42,13 +117,17 @@ bool EmergencyStop::check() {
 }
 
 void EmergencyStop::activate() {
+    uint32_t start = micros();
+
     // Set ESTOP flag
     _estopActive = true;
 
     // Immediately disable all motors
-    disableMotors();
+    disableMotorsFast();
+    recordLatency(micros() - start);
 
 #ifdef DEBUG
+    Serial.println("All motors disabled");
     Serial.println("EMERGENCY STOP ACTIVATED");
 #endif
 }
@@ -67,7 +146,10 @@ bool EmergencyStop::reset() {
     }
 
     // Reset ESTOP state
+    noInterrupts();
     _estopActive = false;
+    _pendingReport = false;
+    interrupts();
 
 #ifdef DEBUG
     Serial.println("Emergency stop reset");
@@ -79,15 +161,28 @@ bool EmergencyStop::reset() {
     return true;
 }
 
+// Record the latency of one activation and keep the slowest
+void EmergencyStop::recordLatency(uint32_t latencyUs) {
+    _lastLatencyUs = latencyUs;
+    if (latencyUs > _maxLatencyUs) {
+        _maxLatencyUs = latencyUs;
+    }
+    _triggerCount++;
+}
+
 void EmergencyStop::disableMotors() {
+    disableMotorsFast();
+
+#ifdef DEBUG
+    Serial.println("All motors disabled");
+#endif
+}
+
+void EmergencyStop::disableMotorsFast() {
     // Disable all motors by removing enable signal
     // Using direct connector access for motor control
     ConnectorM0.EnableRequest(false);
     ConnectorM1.EnableRequest(false);
     ConnectorM2.EnableRequest(false);
     ConnectorM3.EnableRequest(false);
-
-#ifdef DEBUG
-    Serial.println("All motors disabled");
-#endif
-}
\ No newline at end of file
+}
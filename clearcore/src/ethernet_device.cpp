@@ -1,10 +1,17 @@
 #include "ethernet_device.h"
 
+#include "memory_monitor.h"
+
 // Constructor
 EthernetDevice::EthernetDevice(uint16_t port)
     : _server(port),
       _initialized(false),
       _port(port),
+      _linkState(LINK_OFF),
+      _linkStateTime(0),
+      _dhcpAttempts(0),
+      _dhcpEnabled(true),
+      _linkTimeoutLogged(false),
       _connectionState(DISCONNECTED),
       _lastError(ERROR_NONE),
       _lastActivityTime(0),
@@ -20,10 +27,18 @@ EthernetDevice::EthernetDevice(uint16_t port)
       _reconnectAttempts(0),
       _commandBufferIndex(0),
       _loggingEnabled(false),
-      _logLevel(LOG_WARNING) {
+      _logLevel(LOG_WARNING),
+      _txHead(0),
+      _txCount(0),
+      _txOldestTime(0),
+      _txDropped(0),
+      _txAtBoundary(true),
+      _txDiscard(false),
+      _txSkipPartial(false) {
+    memset(_txStarts, 0, sizeof(_txStarts));
+
     // Initialize IP string buffer
     _ipString[0] = '\0';
-    _logFilePath[0] = '\0';
 
     // Initialize statistics
     memset(&_stats, 0, sizeof(_stats));
@@ -36,107 +51,108 @@ EthernetDevice::EthernetDevice(uint16_t port)
     _reconnectBackoff[4] = 30000;  // 30 seconds
 }
 
-// Initialize the Ethernet device
+// Start the Ethernet stack (link and DHCP are handled by update())
 bool EthernetDevice::init() {
     _initializationTime = millis();
 
-    // Get the Ethernet Manager instance
-    ClearCore::EthernetManager& ethernetManager = ClearCore::EthernetManager::Instance();
-
     // Initialize the Ethernet stack
-    ethernetManager.Setup();
+    ClearCore::EthernetManager::Instance().Setup();
 
     // Log initialization start
-    logEvent("INIT_START", LOG_INFO);
-
-    // Wait for the physical link to be active before proceeding
-    uint8_t linkAttempts = 0;
-    while (!ethernetManager.PhyLinkActive()) {
-        if (linkAttempts++ > 30) {
-            updateConnectionState(CONNECTION_ERROR, ERROR_LINK_DOWN);
-            logEvent("LINK_TIMEOUT", LOG_ERROR, ERROR_LINK_DOWN);
-            return false;
-        }
-        delay(500);
-    }
+    logEvent(EVT_ETH_INIT_START, LOG_INFO);
+
+    _linkState = LINK_WAIT_PHY;
+    _linkStateTime = _initializationTime;
+    _linkTimeoutLogged = false;
+    return true;
+}
+
+// One bring-up step; never waits
+void EthernetDevice::advanceBringUp() {
+    ClearCore::EthernetManager& ethernetManager = ClearCore::EthernetManager::Instance();
+    unsigned long now = millis();
+
+    switch (_linkState) {
+        case LINK_WAIT_PHY:
+            // Wait for the physical link to be active before proceeding
+            if (!ethernetManager.PhyLinkActive()) {
+                if (!_linkTimeoutLogged && now - _linkStateTime > LINK_TIMEOUT_MS) {
+                    updateConnectionState(CONNECTION_ERROR, ERROR_LINK_DOWN);
+                    logEvent(EVT_ETH_LINK_TIMEOUT, LOG_ERROR, ERROR_LINK_DOWN);
+                    _linkTimeoutLogged = true;
+                }
+                return;
+            }
 
-    logEvent("LINK_ACTIVE", LOG_INFO);
+            logEvent(EVT_ETH_LINK_ACTIVE, LOG_INFO);
+            _linkState = LINK_DHCP;
+            _dhcpAttempts = 0;
+            _linkStateTime = now - DHCP_RETRY_MS;  // First attempt right away
+            return;
 
-    // Try to get an IP address via DHCP with timeout
-    bool dhcpSuccess = false;
-    uint8_t dhcpAttempts = 0;
+        case LINK_DHCP: {
+            if (now - _linkStateTime < DHCP_RETRY_MS) {
+                return;
+            }
+            _linkStateTime = now;
 
-    while (!dhcpSuccess && dhcpAttempts < 3) {
-        dhcpSuccess = ethernetManager.DhcpBegin();
-        if (!dhcpSuccess) {
-            delay(1000);
-            dhcpAttempts++;
-        }
-    }
+            // Try to get an IP address via DHCP, a limited number of times
+            if (_dhcpEnabled && ethernetManager.DhcpBegin()) {
+                logEvent(EVT_ETH_DHCP_SUCCESS, LOG_INFO);
+                startServer();
+                return;
+            }
+            if (_dhcpEnabled && ++_dhcpAttempts < DHCP_ATTEMPTS) {
+                return;
+            }
+
+            // If DHCP fails (or is disabled), set a static IP
+            if (_dhcpEnabled) {
+                logEvent(EVT_ETH_DHCP_FAILED, LOG_WARNING, ERROR_DHCP_FAILED);
+            }
 
-    // If DHCP fails, set a static IP
-    if (!dhcpSuccess) {
-        logEvent("DHCP_FAILED", LOG_WARNING, ERROR_DHCP_FAILED);
+            // Use a default static IP configuration
+            ethernetManager.LocalIp(ClearCore::IpAddress(192, 168, 1, 177));
+            ethernetManager.NetmaskIp(ClearCore::IpAddress(255, 255, 255, 0));
+            ethernetManager.GatewayIp(ClearCore::IpAddress(192, 168, 1, 1));
 
-        // Use a default static IP configuration
-        ethernetManager.LocalIp(ClearCore::IpAddress(192, 168, 1, 177));
-        ethernetManager.NetmaskIp(ClearCore::IpAddress(255, 255, 255, 0));
-        ethernetManager.GatewayIp(ClearCore::IpAddress(192, 168, 1, 1));
+            logEvent(EVT_ETH_STATIC_IP_SET, LOG_INFO);
+            startServer();
+            return;
+        }
 
-        logEvent("STATIC_IP_SET", LOG_INFO);
-    } else {
-        logEvent("DHCP_SUCCESS", LOG_INFO);
+        default:
+            return;
     }
+}
 
+// Address assigned: start listening
+void EthernetDevice::startServer() {
     // Format the IP address as a string
-    ClearCore::IpAddress ip = ethernetManager.LocalIp();
+    ClearCore::IpAddress ip = ClearCore::EthernetManager::Instance().LocalIp();
     // Use the StringValue method to get a string representation of the IP address
     strncpy(_ipString, ip.StringValue(), sizeof(_ipString) - 1);
     _ipString[sizeof(_ipString) - 1] = '\0';  // Ensure null termination
 
     // Start the server
     _server.Begin();
-    logEvent("SERVER_STARTED", LOG_INFO);
+    logEvent(EVT_ETH_SERVER_STARTED, LOG_INFO);
 
     _initialized = true;
+    _linkState = LINK_READY;
     updateConnectionState(DISCONNECTED);
-    return true;
-}
-
-// Set log file
-void EthernetDevice::setLogFile(const char* logFilePath) {
-    strncpy(_logFilePath, logFilePath, sizeof(_logFilePath) - 1);
-    _logFilePath[sizeof(_logFilePath) - 1] = '\0';
-    _loggingEnabled = true;
-
-#ifdef DEBUG
-    Serial.print("Log file set to: ");
-    Serial.println(_logFilePath);
-#endif
 
-    // Create log file with header if it doesn't exist
-    if (SD.exists(_logFilePath)) {
 #ifdef DEBUG
-        Serial.println("Log file exists, will append to it");
+    Serial.print("Ethernet ready after ");
+    Serial.print(millis() - _initializationTime);
+    Serial.print(" ms. IP: ");
+    Serial.println(_ipString);
 #endif
-        return;  // File exists, we'll append to it
-    }
+}
 
-    File logFile = SD.open(_logFilePath, FILE_WRITE);
-    if (logFile) {
-        logFile.println("# Space Maquette Ethernet Log");
-        logFile.println("# Timestamp,LogLevel,Event,IP,ErrorCode,Details");
-        logFile.println("# ----------------------------------");
-        logFile.close();
-#ifdef DEBUG
-        Serial.println("Created new log file with header");
-#endif
-    } else {
-#ifdef DEBUG
-        Serial.print("ERROR: Failed to create log file: ");
-        Serial.println(_logFilePath);
-#endif
-    }
+// Enable event logging
+void EthernetDevice::setLoggingEnabled(bool enabled) {
+    _loggingEnabled = enabled;
 }
 
 // Set log level
@@ -145,11 +161,34 @@ void EthernetDevice::setLogLevel(LogLevel level) {
 }
 
 // Set reconnect enabled
+void EthernetDevice::setDhcpEnabled(bool enabled) {
+    _dhcpEnabled = enabled;
+}
+
 void EthernetDevice::setReconnectEnabled(bool enabled) {
     _reconnectEnabled = enabled;
 }
 
+// Set new connection handler
+void EthernetDevice::setConnectionCallback(ConnectionCallback callback) {
+    _connectionCallback = callback;
+}
+
 // Set connection timeout
+void EthernetDevice::setObserverCallback(ObserverCallback callback) {
+    _observerCallback = callback;
+}
+
+uint8_t EthernetDevice::getObserverCount() const {
+    uint8_t count = 0;
+    for (uint8_t i = 0; i < MAX_OBSERVERS; i++) {
+        if (_observers[i].isActive()) {
+            count++;
+        }
+    }
+    return count;
+}
+
 void EthernetDevice::setConnectionTimeout(unsigned long timeoutMs) {
     _connectionTimeout = timeoutMs;
 }
@@ -170,8 +209,6 @@ int EthernetDevice::available() {
 }
 
 int EthernetDevice::read() {
-    update();
-
     if (_client.Connected()) {
         int value = _client.Read();
         if (value >= 0) {
@@ -184,98 +221,65 @@ int EthernetDevice::read() {
 }
 
 int EthernetDevice::peek() {
-    update();
-
     if (_client.Connected()) {
         return _client.Peek();
     }
     return -1;
 }
 
-size_t EthernetDevice::write(uint8_t data) {
-    update();
-
-    if (_client.Connected()) {
-        size_t written = _client.Send(data);
-        if (written > 0) {
-            trackSentData(written);
-            _lastActivityTime = millis();
-        } else {
-            // Store data for potential reconnection
-            if (_reconnectEnabled && _pendingQueue.size() < MAX_PENDING_ITEMS) {
-                PendingData pending;
-                pending.data[0] = data;
-                pending.size = 1;
-                _pendingQueue.push(pending);
-            }
+// Read everything the client has buffered, up to size bytes
+int EthernetDevice::readAvailable(uint8_t* buffer, size_t size) {
+    if (!_client.Connected() || size == 0) {
+        return 0;
+    }
 
-            updateConnectionState(CONNECTION_ERROR, ERROR_SEND_FAILED);
-            logEvent("SEND_FAILED", LOG_ERROR, ERROR_SEND_FAILED);
+    int16_t available = _client.BytesAvailable();
+    if (available <= 0) {
+        return 0;
+    }
+    if ((size_t)available > size) {
+        available = size;
+    }
 
-            // Try to reconnect
-            if (_reconnectEnabled) {
-                reconnect();
-            }
-        }
-        return written;
-    } else if (_reconnectEnabled && _pendingQueue.size() < MAX_PENDING_ITEMS) {
-        // Store for reconnection
-        PendingData pending;
-        pending.data[0] = data;
-        pending.size = 1;
-        _pendingQueue.push(pending);
-        return 1;  // Pretend we wrote it
+    int16_t received = _client.Read(buffer, available);
+    if (received > 0) {
+        trackReceivedData(received);
+        _lastActivityTime = millis();
     }
-    return 0;
+    return received > 0 ? received : 0;
 }
 
-size_t EthernetDevice::write(const uint8_t* buffer, size_t size) {
-    update();
+size_t EthernetDevice::write(uint8_t data) {
+    return write(&data, 1);
+}
 
-    if (_client.Connected()) {
-        size_t written = _client.Send(buffer, size);
-        if (written > 0) {
-            trackSentData(written);
-            _lastActivityTime = millis();
-        } else if (size > 0) {
-            // Store data for potential reconnection
-            if (_reconnectEnabled && _pendingQueue.size() < MAX_PENDING_ITEMS &&
-                size <= sizeof(PendingData::data)) {
-                PendingData pending;
-                memcpy(pending.data, buffer, size);
-                pending.size = size;
-                _pendingQueue.push(pending);
-            }
+// Queue data in the TX ring; the newline at the end of a response sends it
+size_t EthernetDevice::write(const uint8_t* buffer, size_t size) {
+    if (!_client.Connected() && !_reconnectEnabled) {
+        return 0;
+    }
 
-            updateConnectionState(CONNECTION_ERROR, ERROR_SEND_FAILED);
-            logEvent("SEND_FAILED", LOG_ERROR, ERROR_SEND_FAILED);
+    size_t queued = queueTx(buffer, size);
 
-            // Try to reconnect
-            if (_reconnectEnabled) {
-                reconnect();
-            }
-        }
-        return written;
-    } else if (_reconnectEnabled && _pendingQueue.size() < MAX_PENDING_ITEMS &&
-               size <= sizeof(PendingData::data)) {
-        // Store for reconnection
-        PendingData pending;
-        memcpy(pending.data, buffer, size);
-        pending.size = size;
-        _pendingQueue.push(pending);
-        return size;  // Pretend we wrote it
+    if (_client.Connected() &&
+        (memchr(buffer, '\n', size) != nullptr || _txCount >= TX_FLUSH_THRESHOLD)) {
+        flushTx();
     }
-    return 0;
+
+    return queued;
 }
 
 void EthernetDevice::flush() {
-    update();
-
     if (_client.Connected()) {
+        flushTx();
         _client.Flush();
     }
 }
 
+int EthernetDevice::availableForWrite() {
+    return TX_RING_SIZE - _txCount;
+}
+
 // Connection management
 bool EthernetDevice::isConnected() {
     update();
@@ -288,10 +292,10 @@ bool EthernetDevice::connect() {
     }
 
     updateConnectionState(CONNECTING);
-    logEvent("CONNECTING", LOG_INFO);
+    logEvent(EVT_ETH_CONNECTING, LOG_INFO);
 
     // Try to get a client from the server
-    _client = _server.Available();
+    _client = _server.Accept();
 
     if (_client.Connected()) {
         updateConnectionState(CONNECTED);
@@ -299,7 +303,7 @@ bool EthernetDevice::connect() {
         _lastActivityTime = _connectionStartTime;
         _stats.connectionCount++;
 
-        logEvent("CONNECTED", LOG_INFO);
+        logEvent(EVT_ETH_CONNECTED, LOG_INFO);
 
         // Send any pending data
         flushPendingData();
@@ -314,7 +318,7 @@ bool EthernetDevice::connect() {
 void EthernetDevice::disconnect() {
     if (_client.Connected()) {
         _client.Close();
-        logEvent("DISCONNECTED", LOG_INFO);
+        logEvent(EVT_ETH_DISCONNECTED, LOG_INFO);
     }
 
     updateConnectionState(DISCONNECTED);
@@ -329,6 +333,12 @@ void EthernetDevice::update() {
     // Update the Ethernet manager
     ClearCore::EthernetManager::Instance().Refresh();
 
+    // Still bringing the link up: nothing to serve yet
+    if (_linkState != LINK_READY) {
+        advanceBringUp();
+        return;
+    }
+
     // Check for connection timeout
     checkConnectionTimeout();
 
@@ -343,7 +353,7 @@ void EthernetDevice::update() {
         // If we had a client before, log the disconnection
         if (_connectionState == CONNECTED) {
             updateConnectionState(DISCONNECTED);
-            logEvent("CLIENT_DISCONNECTED", LOG_WARNING, ERROR_CLIENT_DISCONNECTED);
+            logEvent(EVT_ETH_CLIENT_DISCONNECTED, LOG_WARNING, ERROR_CLIENT_DISCONNECTED);
 
             // Try to reconnect if enabled
             if (_reconnectEnabled) {
@@ -351,8 +361,9 @@ void EthernetDevice::update() {
             }
         }
 
-        // Check for a new client
-        _client = _server.Available();
+        // Check for a new client (Accept() hands out each connection once, so a
+        // connected observer is never picked up as the control session)
+        _client = _server.Accept();
 
         // If we got a new client
         if (_client.Connected()) {
@@ -361,17 +372,30 @@ void EthernetDevice::update() {
             _lastActivityTime = _connectionStartTime;
             _stats.connectionCount++;
 
-            logEvent("CLIENT_CONNECTED", LOG_INFO);
+            logEvent(EVT_ETH_CLIENT_CONNECTED, LOG_INFO);
 
             // Send any pending data from previous connection
             flushPendingData();
         }
     }
+
+    // Send output that has been waiting without a newline
+    if (_txCount > 0 && _client.Connected() &&
+        millis() - _txOldestTime >= TX_FLUSH_INTERVAL_MS) {
+        flushTx();
+    }
+
+    updateObservers();
 }
 
 // Heartbeat mechanism
 void EthernetDevice::sendHeartbeat() {
     if (_client.Connected()) {
+        // Keep the heartbeat between complete responses
+        if (!flushTx() || !_txAtBoundary) {
+            return;
+        }
+
         // Simple heartbeat packet
         const uint8_t heartbeat[] = {0xFF, 0xFE, 0xFD, 0xFC};
         size_t written = _client.Send(heartbeat, sizeof(heartbeat));
@@ -379,7 +403,7 @@ void EthernetDevice::sendHeartbeat() {
         if (written == sizeof(heartbeat)) {
             _lastHeartbeatSent = millis();
             trackSentData(written);
-            logEvent("HEARTBEAT_SENT", LOG_DEBUG);
+            logEvent(EVT_ETH_HEARTBEAT_SENT, LOG_DEBUG);
         }
     }
 }
@@ -406,7 +430,7 @@ bool EthernetDevice::reconnect() {
 
     // Check if we've hit maximum reconnect attempts
     if (_reconnectAttempts >= MAX_RECONNECT_ATTEMPTS) {
-        logEvent("RECONNECT_MAX_ATTEMPTS", LOG_WARNING, ERROR_RECONNECT_FAILED);
+        logEvent(EVT_ETH_RECONNECT_MAX_ATTEMPTS, LOG_WARNING, ERROR_RECONNECT_FAILED);
         updateConnectionState(DISCONNECTED);
         resetReconnectionCounters();
         return false;
@@ -424,10 +448,10 @@ bool EthernetDevice::reconnect() {
     _reconnectAttempts++;
 
     updateConnectionState(RECONNECTING);
-    logEvent("RECONNECTING", LOG_INFO);
+    logEvent(EVT_ETH_RECONNECTING, LOG_INFO);
 
     // Try to get a client from the server
-    _client = _server.Available();
+    _client = _server.Accept();
 
     if (_client.Connected()) {
         updateConnectionState(CONNECTED);
@@ -436,7 +460,7 @@ bool EthernetDevice::reconnect() {
         _stats.connectionCount++;
         _stats.reconnectSuccess++;
 
-        logEvent("RECONNECT_SUCCESS", LOG_INFO);
+        logEvent(EVT_ETH_RECONNECT_SUCCESS, LOG_INFO);
 
         // Send any pending data from previous connection
         flushPendingData();
@@ -445,7 +469,7 @@ bool EthernetDevice::reconnect() {
         return true;
     }
 
-    logEvent("RECONNECT_FAILED", LOG_WARNING, ERROR_RECONNECT_FAILED);
+    logEvent(EVT_ETH_RECONNECT_FAILED, LOG_WARNING, ERROR_RECONNECT_FAILED);
     updateConnectionState(DISCONNECTED);
 
     return false;
@@ -557,6 +581,7 @@ String EthernetDevice::getDiagnosticInfo() {
     NetworkStats stats = getNetworkStats();
     info += "Uptime: " + String(stats.uptime / 1000) + " seconds\n";
     info += "Connections: " + String(stats.connectionCount) + "\n";
+    info += "Observers: " + String(getObserverCount()) + "/" + String(MAX_OBSERVERS) + "\n";
     info += "Sent: " + String(stats.totalBytesSent) + " bytes\n";
     info += "Received: " + String(stats.totalBytesReceived) + " bytes\n";
     info += "Errors: " + String(stats.errorCount) + "\n";
@@ -579,86 +604,71 @@ String EthernetDevice::getDiagnosticInfo() {
         }
     }
 
-    // Pending queue size
-    info += "Pending data: " + String(_pendingQueue.size()) + " items\n";
+    // Unsent output
+    info += "Pending data: " + String((unsigned long)_txCount) + " bytes";
+    if (_txDropped > 0) {
+        info += " (" + String((unsigned long)_txDropped) + " dropped)";
+    }
+    info += "\n";
 
     // Logging status
     info += "Logging: " + String(_loggingEnabled ? "Enabled" : "Disabled");
     if (_loggingEnabled) {
-        info += " (Level: " + String((int)_logLevel) + ", File: " + String(_logFilePath) + ")";
+        info += " (Level: " + String((int)_logLevel) +
+                ", Pending: " + String(EventLogger.getPending()) +
+                ", Dropped: " + String((unsigned long)EventLogger.getDropped()) + ")";
     }
     info += "\n";
 
+#ifdef STACK_MONITORING_ENABLED
+    // Memory high-water marks
+    MemoryMonitor::Stats memory;
+    Memory.getStats(memory);
+    info += "Stack: " + String(memory.stackPeak) + " of " + String(memory.stackSize) +
+            " bytes peak\n";
+    info += "Heap: " + String(memory.heapUsed) + " used, " + String(memory.heapFragmented) +
+            " fragmented, " + String(memory.largestFree) + " free block (min " +
+            String(memory.minFree) + ")\n";
+    info += "Allocations: " + String(memory.allocations) + ", frees " + String(memory.frees) +
+            ", failed " + String(memory.failedAllocations) +
+            (Memory.isLow() ? " (LOW MEMORY)" : "") + "\n";
+#endif
+
     return info;
 }
 
 // Log event with log level and optional error code
-void EthernetDevice::logEvent(const char* eventType, LogLevel level, ErrorCode code) {
+// Only queues a record: the SD write happens later from EventLogger.update()
+void EthernetDevice::logEvent(EventId event, LogLevel level, ErrorCode code) {
     // Skip logging if level is higher than configured level
-    if (!_loggingEnabled || _logFilePath[0] == '\0' || level > _logLevel) {
-        return;
-    }
-
-#ifdef DEBUG
-    Serial.print("Logging event: ");
-    Serial.print(eventType);
-    Serial.print(" (level ");
-    Serial.print((int)level);
-    Serial.print(") to ");
-    Serial.println(_logFilePath);
-#endif
-
-    File logFile = SD.open(_logFilePath, FILE_WRITE);
-    if (!logFile) {
-#ifdef DEBUG
-        Serial.print("ERROR: Failed to open log file: ");
-        Serial.println(_logFilePath);
-#endif
+    if (!_loggingEnabled || level > _logLevel) {
         return;
     }
 
-    // Format: timestamp,level,event,ip,error_code,details
-    logFile.print(millis());
-    logFile.print(",");
-    logFile.print(level);
-    logFile.print(",");
-    logFile.print(eventType);
-    logFile.print(",");
-    logFile.print(_ipString);
-    logFile.print(",");
-    logFile.print((int)code);
-    logFile.print(",");
-
-    // Add details based on event type and error code
-    if (code != ERROR_NONE) {
-        logFile.print(getErrorString(code));
-    }
-
-    // Add connection stats for certain events
-    if (strcmp(eventType, "CLIENT_CONNECTED") == 0 ||
-        strcmp(eventType, "CLIENT_DISCONNECTED") == 0 ||
-        strcmp(eventType, "RECONNECT_SUCCESS") == 0) {
-        logFile.print(" (Connections:");
-        logFile.print(_stats.connectionCount);
-        logFile.print(",Errors:");
-        logFile.print(_stats.errorCount);
-        logFile.print(")");
+    // Connection events carry the connection count
+    int32_t value = 0;
+    if (event == EVT_ETH_CLIENT_CONNECTED || event == EVT_ETH_CLIENT_DISCONNECTED ||
+        event == EVT_ETH_RECONNECT_SUCCESS) {
+        value = _stats.connectionCount;
+    } else if (event == EVT_ETH_OBSERVER_CONNECTED || event == EVT_ETH_OBSERVER_DISCONNECTED) {
+        value = getObserverCount();
     }
 
-    logFile.println();
-
-    // Close file immediately to ensure data is written
-    logFile.close();
-
-#ifdef DEBUG
-    Serial.println("Log entry written and file closed");
-#endif
+    EventLogger.log(SOURCE_ETHERNET, level, event, code, value);
 }
 
 // Update connection state and track errors
 void EthernetDevice::updateConnectionState(ConnectionState newState, ErrorCode errorCode) {
+    bool newConnection = newState == CONNECTED && _connectionState != CONNECTED;
     _connectionState = newState;
 
+    if (newConnection) {
+        _txSkipPartial = true;
+    }
+    if (newConnection && _connectionCallback) {
+        _connectionCallback();
+    }
+
     if (errorCode != ERROR_NONE) {
         _lastError = errorCode;
         _stats.errorCount++;
@@ -674,7 +684,7 @@ void EthernetDevice::updateConnectionState(ConnectionState newState, ErrorCode e
 void EthernetDevice::checkConnectionTimeout() {
     if (_connectionState == CONNECTED && (millis() - _lastActivityTime > _connectionTimeout)) {
         updateConnectionState(TIMEOUT, ERROR_TIMEOUT);
-        logEvent("CONNECTION_TIMEOUT", LOG_WARNING, ERROR_TIMEOUT);
+        logEvent(EVT_ETH_CONNECTION_TIMEOUT, LOG_WARNING, ERROR_TIMEOUT);
 
         // Try to reconnect if enabled
         if (_reconnectEnabled) {
@@ -693,33 +703,162 @@ unsigned long EthernetDevice::calculateReconnectDelay() {
 
 // Flush pending data after reconnection
 bool EthernetDevice::flushPendingData() {
-    if (!_client.Connected() || _pendingQueue.empty()) {
+    if (!_client.Connected() || _txCount == 0) {
         return false;
     }
 
-    bool success = true;
+    bool success = flushTx();
+
+    if (_txCount > 0) {
+        logEvent(EVT_ETH_PENDING_DATA_PARTIAL, LOG_WARNING);
+    } else if (success) {
+        logEvent(EVT_ETH_PENDING_DATA_SENT, LOG_INFO);
+    }
+
+    return success;
+}
 
-    // Try to send all pending data
-    while (!_pendingQueue.empty()) {
-        PendingData& pending = _pendingQueue.front();
-        size_t written = _client.Send(pending.data, pending.size);
+// Append one write to the TX ring, dropping the oldest responses when it is full.
+// A write at a boundary starts a response; a frame (one write) or a write ending
+// in a newline ends it
+size_t EthernetDevice::queueTx(const uint8_t* buffer, size_t size) {
+    if (size == 0) {
+        return 0;
+    }
+    if (_txCount == 0) {
+        _txOldestTime = millis();
+    }
 
-        if (written == pending.size) {
-            trackSentData(written);
-            _pendingQueue.pop();
+    bool start = _txAtBoundary;
+    _txAtBoundary = false;
+
+    for (size_t i = 0; i < size; i++) {
+        if (!_txDiscard && _txCount == TX_RING_SIZE) {
+            // Make room by sending if we can, otherwise drop the oldest response
+            if (!_client.Connected() || !flushTx() || _txCount == TX_RING_SIZE) {
+                if (!dropOldestTx()) {
+                    // Only a partly sent response is queued (longer than the ring)
+                    _txDiscard = true;
+                }
+            }
+        }
+
+        if (_txDiscard) {
+            _txDropped++;
+            continue;
+        }
+
+        uint16_t index = (_txHead + _txCount) % TX_RING_SIZE;
+        uint8_t mask = 1 << (index % 8);
+        _txRing[index] = buffer[i];
+        if (start && i == 0) {
+            _txStarts[index / 8] |= mask;
         } else {
-            success = false;
-            break;
+            _txStarts[index / 8] &= ~mask;
         }
+        _txCount++;
     }
 
-    if (!_pendingQueue.empty()) {
-        logEvent("PENDING_DATA_PARTIAL", LOG_WARNING);
-    } else if (success) {
-        logEvent("PENDING_DATA_SENT", LOG_INFO);
+    _txAtBoundary = (start && buffer[0] == FRAME_SYNC) || buffer[size - 1] == '\n';
+    if (_txAtBoundary) {
+        _txDiscard = false;
     }
+    return size;
+}
 
-    return success;
+// Drop the oldest response that has not started to go out. A partly sent head
+// response is kept (the client already has its start) and the one after it is
+// dropped instead; false when there is nothing else to drop
+bool EthernetDevice::dropOldestTx() {
+    uint16_t start = isTxStart(0) ? 0 : nextTxStart(1);
+    if (start >= _txCount) {
+        return false;
+    }
+
+    removeTx(start, nextTxStart(start + 1) - start);
+    return true;
+}
+
+// Remove length bytes starting offset bytes after the head, moving the bytes
+// before them up to close the gap
+void EthernetDevice::removeTx(uint16_t offset, uint16_t length) {
+    // The response still being written loses the rest of its bytes too
+    if (offset + length == _txCount && !_txAtBoundary) {
+        _txDiscard = true;
+    }
+
+    for (uint16_t i = offset; i > 0; i--) {
+        uint16_t from = (_txHead + i - 1) % TX_RING_SIZE;
+        uint16_t to = (from + length) % TX_RING_SIZE;
+        uint8_t mask = 1 << (to % 8);
+        _txRing[to] = _txRing[from];
+        if (_txStarts[from / 8] & (1 << (from % 8))) {
+            _txStarts[to / 8] |= mask;
+        } else {
+            _txStarts[to / 8] &= ~mask;
+        }
+    }
+
+    _txHead = (_txHead + length) % TX_RING_SIZE;
+    _txCount -= length;
+    _txDropped += length;
+}
+
+// True when the byte offset bytes after the head starts a response
+bool EthernetDevice::isTxStart(uint16_t offset) const {
+    uint16_t index = (_txHead + offset) % TX_RING_SIZE;
+    return offset < _txCount && (_txStarts[index / 8] & (1 << (index % 8)));
+}
+
+// Offset of the first response start at or after offset (_txCount if none)
+uint16_t EthernetDevice::nextTxStart(uint16_t offset) const {
+    while (offset < _txCount && !isTxStart(offset)) {
+        offset++;
+    }
+    return offset;
+}
+
+// Send the TX ring contents in at most two contiguous Send() calls
+bool EthernetDevice::flushTx() {
+    // A new client has no use for the rest of a response the last one partly received
+    if (_txSkipPartial) {
+        _txSkipPartial = false;
+        if (!isTxStart(0)) {
+            removeTx(0, _txCount > 0 ? nextTxStart(1) : 0);
+        }
+    }
+
+    while (_txCount > 0) {
+        uint16_t span = TX_RING_SIZE - _txHead;
+        if (span > _txCount) {
+            span = _txCount;
+        }
+
+        size_t written = _client.Send(_txRing + _txHead, span);
+        if (written == 0 && _client.Connected()) {
+            // Full window: keep the data, update() tries again
+            return false;
+        }
+        if (written == 0) {
+            // Keep the data for the next connection
+            updateConnectionState(CONNECTION_ERROR, ERROR_SEND_FAILED);
+            logEvent(EVT_ETH_SEND_FAILED, LOG_ERROR, ERROR_SEND_FAILED);
+
+            if (_reconnectEnabled) {
+                reconnect();
+            }
+            return false;
+        }
+
+        trackSentData(written);
+        _lastActivityTime = millis();
+        _txHead = (_txHead + written) % TX_RING_SIZE;
+        _txCount -= written;
+        _txOldestTime = _lastActivityTime;
+    }
+
+    _txHead = 0;  // Empty: restart at the front so the next response is contiguous
+    return true;
 }
 
 // Track received data for statistics
@@ -738,4 +877,207 @@ void EthernetDevice::trackSentData(size_t bytes) {
 void EthernetDevice::resetReconnectionCounters() {
     _reconnectAttempts = 0;
     _lastReconnectTime = 0;
-}
\ No newline at end of file
+}
+
+// Drop observers that went away, then hand further connections to free
+// observer slots while the control session is taken
+void EthernetDevice::updateObservers() {
+    for (uint8_t i = 0; i < MAX_OBSERVERS; i++) {
+        if (_observers[i].isActive() && !_observers[i].update()) {
+            logEvent(EVT_ETH_OBSERVER_DISCONNECTED, LOG_INFO);
+            if (_observerCallback) {
+                _observerCallback(i, false);
+            }
+        }
+    }
+
+    if (_connectionState != CONNECTED || !_client.Connected()) {
+        return;  // The next connection becomes the control session
+    }
+
+    ClearCore::EthernetTcpClient client = _server.Accept();
+    if (!client.Connected()) {
+        return;
+    }
+
+    for (uint8_t i = 0; i < MAX_OBSERVERS; i++) {
+        if (!_observers[i].isActive()) {
+            _observers[i].attach(client);
+            logEvent(EVT_ETH_OBSERVER_CONNECTED, LOG_INFO);
+            if (_observerCallback) {
+                _observerCallback(i, true);
+            }
+            return;
+        }
+    }
+
+    // Every slot taken: tell the client why before closing
+    client.Send("ERROR:SESSION_LIMIT\r\n");
+    client.Close();
+    logEvent(EVT_ETH_SESSION_REFUSED, LOG_WARNING);
+}
+
+// Observer session
+
+ObserverSession::ObserverSession()
+    : _active(false),
+      _connectedTime(0),
+      _bytesSent(0),
+      _bytesReceived(0),
+      _txHead(0),
+      _txCount(0),
+      _txOldestTime(0),
+      _txDropped(0),
+      _txStalled(false),
+      _txStallTime(0) {}
+
+void ObserverSession::attach(const ClearCore::EthernetTcpClient& client) {
+    _client = client;
+    _active = true;
+    _connectedTime = millis();
+    _bytesSent = 0;
+    _bytesReceived = 0;
+    _txHead = 0;
+    _txCount = 0;
+    _txDropped = 0;
+    _txStalled = false;
+}
+
+void ObserverSession::close() {
+    if (_client.Connected()) {
+        _client.Close();
+    }
+    _active = false;
+    _txCount = 0;
+}
+
+bool ObserverSession::update() {
+    if (!_active) {
+        return false;
+    }
+
+    if (!_client.Connected()) {
+        close();
+        return false;
+    }
+
+    if (_txCount > 0 && millis() - _txOldestTime >= EthernetDevice::TX_FLUSH_INTERVAL_MS) {
+        flushTx();
+    }
+
+    // A client that stopped reading: give up on it
+    if (_txStalled && millis() - _txStallTime >= STALL_TIMEOUT_MS) {
+        close();
+        return false;
+    }
+    return true;
+}
+
+int ObserverSession::available() {
+    return _active && _client.Connected() ? _client.BytesAvailable() : 0;
+}
+
+int ObserverSession::read() {
+    if (!_active || !_client.Connected()) {
+        return -1;
+    }
+
+    int value = _client.Read();
+    if (value >= 0) {
+        _bytesReceived++;
+    }
+    return value;
+}
+
+int ObserverSession::peek() {
+    return _active && _client.Connected() ? _client.Peek() : -1;
+}
+
+int ObserverSession::readAvailable(uint8_t* buffer, size_t size) {
+    if (!_active || !_client.Connected() || size == 0) {
+        return 0;
+    }
+
+    int16_t available = _client.BytesAvailable();
+    if (available <= 0) {
+        return 0;
+    }
+    if ((size_t)available > size) {
+        available = size;
+    }
+
+    int16_t received = _client.Read(buffer, available);
+    if (received > 0) {
+        _bytesReceived += received;
+    }
+    return received > 0 ? received : 0;
+}
+
+size_t ObserverSession::write(uint8_t data) {
+    return write(&data, 1);
+}
+
+// Queue a whole response; one that doesn't fit after sending what is waiting is dropped
+size_t ObserverSession::write(const uint8_t* buffer, size_t size) {
+    if (!_active || !_client.Connected()) {
+        return 0;
+    }
+
+    if (_txCount + size > TX_RING_SIZE && (!flushTx() || _txCount + size > TX_RING_SIZE)) {
+        _txDropped += size;
+        return 0;
+    }
+
+    if (_txCount == 0) {
+        _txOldestTime = millis();
+    }
+    for (size_t i = 0; i < size; i++) {
+        _txRing[(_txHead + _txCount) % TX_RING_SIZE] = buffer[i];
+        _txCount++;
+    }
+
+    if (memchr(buffer, '\n', size) != nullptr ||
+        _txCount >= EthernetDevice::TX_FLUSH_THRESHOLD) {
+        flushTx();
+    }
+    return size;
+}
+
+void ObserverSession::flush() {
+    if (_active && _client.Connected()) {
+        flushTx();
+        _client.Flush();
+    }
+}
+
+int ObserverSession::availableForWrite() {
+    return _active ? TX_RING_SIZE - _txCount : 0;
+}
+
+// Send the TX ring contents; a full window keeps the rest for update() to retry
+bool ObserverSession::flushTx() {
+    while (_txCount > 0) {
+        uint16_t span = TX_RING_SIZE - _txHead;
+        if (span > _txCount) {
+            span = _txCount;
+        }
+
+        size_t written = _client.Send(_txRing + _txHead, span);
+        if (written == 0) {
+            if (!_txStalled) {
+                _txStalled = true;
+                _txStallTime = millis();
+            }
+            return false;
+        }
+
+        _txStalled = false;
+        _bytesSent += written;
+        _txHead = (_txHead + written) % TX_RING_SIZE;
+        _txCount -= written;
+        _txOldestTime = millis();
+    }
+
+    _txHead = 0;
+    return true;
+}
@@ -0,0 +1,223 @@
+/**
+ * Space Maquette - Event Log Implementation
+ */
+
+#include "event_log.h"
+
+EventLog EventLogger;
+
+// Names for decoding, in EventId order
+static const char* const EVENT_NAMES[EVT_COUNT] = {
+    "INIT_START",
+    "LINK_TIMEOUT",
+    "LINK_ACTIVE",
+    "DHCP_FAILED",
+    "STATIC_IP_SET",
+    "DHCP_SUCCESS",
+    "SERVER_STARTED",
+    "CONNECTING",
+    "CONNECTED",
+    "DISCONNECTED",
+    "CLIENT_DISCONNECTED",
+    "CLIENT_CONNECTED",
+    "HEARTBEAT_SENT",
+    "RECONNECT_MAX_ATTEMPTS",
+    "RECONNECTING",
+    "RECONNECT_SUCCESS",
+    "RECONNECT_FAILED",
+    "CONNECTION_TIMEOUT",
+    "PENDING_DATA_PARTIAL",
+    "PENDING_DATA_SENT",
+    "SEND_FAILED",
+    "MOTION_ALERT",
+    "MOTION_SETTLE_TIMEOUT",
+    "MOTION_FAULT_CLEARED",
+    "MOTION_FAULT_STUCK",
+    "MOTION_HOMED",
+    "MOTION_TILT_LIMITED",
+    "MOTION_TILT_LIMITS_INVALID",
+    "RANGE_QUEUE_FULL",
+    "RANGE_FAILED",
+    "RANGE_MEASURED",
+    "TILT_CONSTRAINED",
+    "TILT_SET",
+    "TILT_QUEUE_FULL",
+    "TILT_ACK",
+    "TILT_NO_ACK",
+    "SYS_MEMORY_LOW",
+    "TILT_LINK_SPEED",
+    "TILT_LINK_FALLBACK",
+    "MOTION_HOME_FAILED",
+    "OBSERVER_CONNECTED",
+    "OBSERVER_DISCONNECTED",
+    "SESSION_REFUSED",
+    "MOTION_TRACE_CAPTURED",
+};
+
+static const char* const SOURCE_NAMES[] = {"SYSTEM", "ETHERNET", "MOTION", "RANGEFINDER",
+                                           "TILT"};
+
+static_assert(EVENT_LOG_RECORDS % (EVENT_LOG_SECTOR_SIZE / sizeof(EventLog::Record)) == 0,
+              "EVENT_LOG_RECORDS must be a whole number of sectors");
+static_assert(sizeof(EventLog::Record) == 16, "EventLog::Record must stay 16 bytes");
+
+EventLog::EventLog()
+    : _open(false),
+      _level(EVENT_WARNING),
+      _echo(false),
+      _head(0),
+      _count(0),
+      _unechoed(0),
+      _oldestTime(0),
+      _lastSync(0),
+      _tailPosition(0),
+      _tailRecords(0),
+      _dropped(0),
+      _written(0) {}
+
+bool EventLog::begin(const char* path) {
+    if (_open) {
+        _file.close();
+    }
+
+    // Opened once for appending; update() only writes and syncs it
+    _file = SD.open(path, FILE_WRITE);
+    _open = static_cast<bool>(_file);
+    _lastSync = millis();
+
+    // New records start a fresh sector after whatever the file already holds
+    _tailPosition = _open ? _file.size() : 0;
+    _tailRecords = 0;
+
+#ifdef DEBUG
+    Serial.print(_open ? "Event log opened: " : "ERROR: Failed to open event log: ");
+    Serial.println(path);
+#endif
+
+    return _open;
+}
+
+void EventLog::setLevel(uint8_t level) {
+    _level = level;
+}
+
+void EventLog::setEcho(bool enable) {
+    _echo = enable;
+    _unechoed = 0;
+}
+
+bool EventLog::log(EventSource source, uint8_t level, EventId event, int32_t code,
+                   int32_t value) {
+    if (level == EVENT_PADDING || level > _level) {
+        return true;
+    }
+
+    if (_count >= EVENT_LOG_RECORDS) {
+        _dropped++;
+        return false;
+    }
+
+    if (_count == 0) {
+        _oldestTime = millis();
+    }
+
+    Record& record = _ring[(_head + _count) % EVENT_LOG_RECORDS];
+    record.timestamp = millis();
+    record.level = level;
+    record.source = source;
+    record.event = event;
+    record.code = code;
+    record.value = value;
+    _count++;
+
+    if (_echo && _unechoed < _count) {
+        _unechoed++;
+    }
+    return true;
+}
+
+void EventLog::update() {
+    // Echo what arrived since the last call (Serial output stays out of log())
+    while (_unechoed > 0) {
+        echoRecord(_ring[(_head + _count - _unechoed) % EVENT_LOG_RECORDS]);
+        _unechoed--;
+    }
+
+    if (!_open || _count == 0) {
+        return;
+    }
+
+    unsigned long now = millis();
+
+    // At most one sector per call keeps the time spent here bounded
+    int space = RECORDS_PER_SECTOR - _tailRecords;
+    if (_count >= space) {
+        writeSector(space);
+    } else if (now - _oldestTime >= EVENT_LOG_FLUSH_MS) {
+        writeSector(_count);
+    } else {
+        return;
+    }
+
+    // Sync the directory entry periodically rather than after every sector
+    if (_count == 0 || now - _lastSync >= EVENT_LOG_FLUSH_MS) {
+        _file.flush();
+        _lastSync = now;
+    }
+
+    if (_count > 0) {
+        _oldestTime = _ring[_head].timestamp;
+    }
+}
+
+void EventLog::writeSector(int records) {
+    int filled = _tailRecords + records;
+    for (int i = _tailRecords; i < RECORDS_PER_SECTOR; i++) {
+        if (i < filled) {
+            _sector[i] = _ring[(_head + i - _tailRecords) % EVENT_LOG_RECORDS];
+        } else {
+            memset(&_sector[i], 0, sizeof(Record));  // EVENT_PADDING
+        }
+    }
+
+    // A partial tail already on the card is overwritten rather than followed
+    // by another padded sector
+    bool positioned = _file.position() == _tailPosition || _file.seek(_tailPosition);
+    size_t written =
+        positioned ? _file.write(reinterpret_cast<const uint8_t*>(_sector), sizeof(_sector)) : 0;
+
+    if (filled == RECORDS_PER_SECTOR) {
+        _tailPosition += sizeof(_sector);
+        _tailRecords = 0;
+    } else {
+        _tailRecords = filled;
+    }
+
+    // Records leave the ring either way: a failing card must not stall the callers
+    _head = (_head + records) % EVENT_LOG_RECORDS;
+    _count -= records;
+    if (written == sizeof(_sector)) {
+        _written += records;
+    } else {
+        _dropped += records;
+    }
+}
+
+const char* EventLog::eventName(uint16_t event) {
+    return event < EVT_COUNT ? EVENT_NAMES[event] : "UNKNOWN";
+}
+
+void EventLog::echoRecord(const Record& record) {
+    Serial.print("[");
+    Serial.print(record.timestamp);
+    Serial.print("] ");
+    Serial.print(record.source < sizeof(SOURCE_NAMES) / sizeof(SOURCE_NAMES[0])
+                     ? SOURCE_NAMES[record.source]
+                     : "?");
+    Serial.print(" ");
+    Serial.print(eventName(record.event));
+    Serial.print(" code=");
+    Serial.print(record.code);
+    Serial.print(" value=");
+    Serial.println(record.value);
+}
@@ -17,9 +17,15 @@
 #include "configuration_manager.h"
 #include "emergency.h"
 #include "ethernet_device.h"
+#include "event_log.h"
+#include "memory_monitor.h"
 #include "motion_control.h"
+#include "motion_trace.h"
+#include "perf_monitor.h"
 #include "rangefinder.h"
+#include "scan_controller.h"
 #include "serial_devices.h"
+#include "telemetry.h"
 #include "tilt_servo.h"
 #include "web_server.h"
 
@@ -34,7 +40,6 @@
 // Ethernet configuration
 #define ETHERNET_PORT     8080
 #define WEBSERVER_PORT    8000
-#define ETHERNET_LOG_FILE "ETHERNET.LOG"
 
 // Create system objects
 EthernetDevice ethernetDevice(ETHERNET_PORT);     // Using Ethernet for host communication
@@ -46,7 +51,40 @@ TiltServo tiltServo(serialDevices);
 MotionControl motion;  // Standard initialization, tilt servo handled separately
 EmergencyStop estop(ESTOP_PIN);
 ConfigurationManager config("CONFIG.TXT");
-CommandHandler cmdHandler(parser, motion, rangefinder, estop, config);
+ScanController scanner(motion, rangefinder, parser);
+Telemetry telemetry(parser, motion, rangefinder, estop);
+CommandHandler cmdHandler(parser, motion, rangefinder, estop, config, scanner, telemetry);
+MotionTrace motionTrace(motion, estop);  // Motion recorder for TRACE and /trace.bin
+
+// Observer sessions: own parser and telemetry subscription each (one entry per
+// EthernetDevice::MAX_OBSERVERS)
+CommandParser observerParsers[EthernetDevice::MAX_OBSERVERS] = {
+    CommandParser(ethernetDevice.getObserver(0)), CommandParser(ethernetDevice.getObserver(1))};
+Telemetry observerTelemetry[EthernetDevice::MAX_OBSERVERS] = {
+    Telemetry(observerParsers[0], motion, rangefinder, estop),
+    Telemetry(observerParsers[1], motion, rangefinder, estop)};
+
+// Sessions serviced per loop, control first; the start rotates each loop
+static const uint8_t SESSION_COUNT = 1 + EthernetDevice::MAX_OBSERVERS;
+static uint8_t nextSession = 0;
+
+static CommandParser& sessionParser(uint8_t session) {
+    return session == 0 ? parser : observerParsers[session - 1];
+}
+
+// Give every session one read of its input, starting one session later each
+// loop so a busy session can't keep the others waiting
+static bool serviceSessions() {
+    bool handled = false;
+    for (uint8_t i = 0; i < SESSION_COUNT; i++) {
+        uint8_t session = (nextSession + i) % SESSION_COUNT;
+        if (session == 0 || ethernetDevice.getObserver(session - 1).isActive()) {
+            handled |= sessionParser(session).update();
+        }
+    }
+    nextSession = (nextSession + 1) % SESSION_COUNT;
+    return handled;
+}
 
 // Print Ethernet diagnostics to Serial debug output
 void printEthernetDiagnostics() {
@@ -121,23 +159,93 @@ void printEthernetDiagnostics() {
         Serial.println(" seconds");
     }
 
+#ifdef STACK_MONITORING_ENABLED
+    MemoryMonitor::Stats memory;
+    Memory.getStats(memory);
+
+    Serial.println("Memory:");
+    Serial.print("  Stack: peak=");
+    Serial.print(memory.stackPeak);
+    Serial.print(" of ");
+    Serial.print(memory.stackSize);
+    Serial.println(" bytes");
+
+    Serial.print("  Heap: used=");
+    Serial.print(memory.heapUsed);
+    Serial.print(", fragmented=");
+    Serial.print(memory.heapFragmented);
+    Serial.println(" bytes");
+
+    Serial.print("  Free block: ");
+    Serial.print(memory.largestFree);
+    Serial.print(" bytes (min ");
+    Serial.print(memory.minFree);
+    Serial.println(")");
+
+    Serial.print("  Allocations: ");
+    Serial.print(memory.allocations);
+    Serial.print(", frees ");
+    Serial.print(memory.frees);
+    Serial.print(", failed ");
+    Serial.println(memory.failedAllocations);
+
+    if (Memory.isLow()) {
+        Serial.println("  WARNING: free memory below threshold");
+    }
+#endif
+
     Serial.println("---------------------");
 #endif
 }
 
+// Web server waits for the Ethernet link (started from loop())
+bool webServerPending = false;
+
 void setup() {
-    // Initialize USB serial for debugging
+#ifdef STACK_MONITORING_ENABLED
+    // Paint the free stack area before anything else uses it
+    Memory.begin();
+#endif
+
+    // Initialize USB serial for debugging (no wait: safety comes first)
     Serial.begin(115200);
-    delay(2000);  // Allow time for USB connection if debugging
+
+#ifdef PERF_MONITORING_ENABLED
+    // Start the cycle counter used by the loop and command profiler
+    Profiler.begin();
+#endif
+
+    // Stage 1: safety and motion, with built-in defaults
+    // ESTOP is armed before anything that can take time
+    estop.init(true);
+
+    // Initialize serial devices module (controls COM1 access)
+    serialDevices.init(9600);  // Initialize COM1 for both rangefinder and tilt servo
+
+    tiltServo.begin();                // Using begin() instead of init()
+    motion.setTiltServo(&tiltServo);  // Connect the tilt servo to motion control
+    motion.init();
+    rangefinder.begin();  // Using begin() instead of init()
+
+#ifdef WAIT_FOR_USB_SERIAL
+    // Bench builds only (-D WAIT_FOR_USB_SERIAL): give a USB host a moment to attach so
+    // the boot log isn't lost. Never in production, where it would delay the network
+    unsigned long serialWaitStart = millis();
+    while (!Serial && millis() - serialWaitStart < 2000) {
+    }
+#endif
 
     Serial.println("Space Maquette Controller v1.0 (Ethernet)");
     Serial.println("----------------------------------");
 
-    // Initialize config first so we can load Ethernet settings
+    // Stage 2: configuration
+    unsigned long configStart = millis();
     bool configLoaded = config.init();
 #ifdef DEBUG
     if (configLoaded) {
-        Serial.println("Configuration loaded successfully");
+        Serial.print("Configuration loaded successfully in ");
+        Serial.print(millis() - configStart);
+        Serial.println(" ms");
         config.dumpConfig();  // Dump configuration to serial
     } else {
         Serial.println("Using default configuration");
@@ -146,13 +254,18 @@ void setup() {
     }
 #endif
 
-    // Configure Ethernet logging if SD card is available
+    // Open the shared event log if SD card is available
+    // (records are buffered in RAM and written to the card from loop())
     if (configLoaded) {
+        String logFile = config.getString("log_file", EVENT_LOG_FILE);
+        EventLogger.begin(logFile.c_str());
+        EventLogger.setLevel(config.getInt("log_level", EVENT_INFO));
+        EventLogger.setEcho(config.getBool("log_echo", false));
+
         // Enable Ethernet logging if configured
         bool loggingEnabled = config.getBool("ethernet_logging", false);
         if (loggingEnabled) {
-            String logFile = config.getString("ethernet_log_file", ETHERNET_LOG_FILE);
-            ethernetDevice.setLogFile(logFile.c_str());
+            ethernetDevice.setLoggingEnabled(true);
 
             int logLevel = config.getInt("ethernet_log_level", EthernetDevice::LOG_WARNING);
             ethernetDevice.setLogLevel(static_cast<EthernetDevice::LogLevel>(logLevel));
@@ -162,29 +275,74 @@ void setup() {
         }
     }
 
-    // Initialize Ethernet for host communication
-    Serial.println("Initializing Ethernet...");
-    bool ethernetInitSuccess = ethernetDevice.init();
+    // Polled ESTOP only if configured
+    estop.setInterruptMode(config.getBool("estop_interrupt", true));
 
-#ifdef DEBUG
-    if (ethernetInitSuccess) {
-        Serial.print("Ethernet initialized successfully. IP: ");
-        Serial.println(ethernetDevice.getIpAddressString());
-        Serial.print("Listening on port: ");
-        Serial.println(ETHERNET_PORT);
-    } else {
-        Serial.println("ERROR: Failed to initialize Ethernet");
-        Serial.print("Last error: ");
-        Serial.println(ethernetDevice.getErrorString(ethernetDevice.getLastError()));
-        Serial.println("Check Ethernet cable and network settings");
-
-        // PhyLinkActive state
-        bool linkActive = ClearCore::EthernetManager::Instance().PhyLinkActive();
-        Serial.print("Physical link active: ");
-        Serial.println(linkActive ? "YES" : "NO");
+    // Tilt updates without waiting for each ACK
+    tiltServo.setAsync(config.getBool("tilt_async", true));
+
+    // Faster tilt link (needs the matching Arduino firmware) and smoothed servo motion
+    if (config.getBool("tilt_fast_mode", false)) {
+        tiltServo.setFastMode(true, config.getInt("tilt_fast_baud", TILT_FAST_BAUD));
+    }
+    if (config.hasKey("tilt_slew_rate")) {
+        tiltServo.setSlewRate(config.getFloat("tilt_slew_rate", 0.0f));
+    }
+
+    // Tilt servo limits
+    tiltServo.setLimits(config.getInt("tilt_min", 45), config.getInt("tilt_max", 135));
+
+    // Apply configuration to subsystems
+    if (configLoaded) {
+        // Set per-axis velocity, acceleration and jerk limits
+        cmdHandler.applyMotionProfiles();
+
+        // Home sensors and homing speeds
+        cmdHandler.applyHomingConfig();
+
+        // Synchronized arrival for multi-axis MOVE commands
+        motion.setCoordinatedMoves(config.getBool("coordinated_moves", true));
+
+        // Dwell at each scan point before measuring
+        scanner.setSettleTime(config.getInt("scan_settle_ms", SCAN_DEFAULT_SETTLE_MS));
+
+        // Set tilt limits
+        motion.setTiltLimits(config.getInt("tilt_min", 45), config.getInt("tilt_max", 135));
+
+#ifdef STACK_MONITORING_ENABLED
+        // Free RAM below which a low-memory warning is logged
+        Memory.setWarningThreshold(config.getInt("memory_warn_bytes", MEMORY_WARN_BYTES));
+#endif
     }
 
-    // Apply any Ethernet configuration values
+    // Stage 3: command processing
+    parser.init();
+
+    // Every new host connection starts out on the text protocol with empty buffers
+    ethernetDevice.setConnectionCallback([]() {
+        parser.resetConnection();
+        telemetry.unsubscribe();
+    });
+
+    // Observers start like a new host connection and lose their subscription on disconnect
+    for (uint8_t i = 0; i < EthernetDevice::MAX_OBSERVERS; i++) {
+        observerParsers[i].init();
+        cmdHandler.addObserver(observerParsers[i], observerTelemetry[i]);
+    }
+    ethernetDevice.setObserverCallback([](uint8_t index, bool /* connected */) {
+        observerParsers[index].resetConnection();
+        observerTelemetry[index].unsubscribe();
+    });
+
+    // Initialize command handler after configuration is loaded
+    cmdHandler.init();
+
+    // Motion trace, armed from the trace_* keys (defaults when there is no config)
+    cmdHandler.setMotionTrace(&motionTrace);
+    webServer.setMotionTrace(&motionTrace);
+    cmdHandler.applyTraceConfig();
+
+    // Stage 4: network. Link, DHCP and the server come up in the background from loop()
     if (configLoaded) {
         // Configure connection timeout
         int timeout = config.getInt("ethernet_timeout", 60000);
@@ -198,6 +356,10 @@ void setup() {
         bool reconnect = config.getBool("ethernet_reconnect", true);
         ethernetDevice.setReconnectEnabled(reconnect);
 
+        // Skip DHCP and use the static address as soon as the link is up
+        ethernetDevice.setDhcpEnabled(config.getBool("ethernet_dhcp", true));
+
+#ifdef DEBUG
         Serial.print("Ethernet timeout: ");
         Serial.print(timeout / 1000);
         Serial.println(" seconds");
@@ -208,76 +370,43 @@ void setup() {
 
         Serial.print("Auto reconnect: ");
         Serial.println(reconnect ? "Enabled" : "Disabled");
-    }
 #endif
+    }
 
-    // Initialize web server if enabled
-    bool webServerEnabled = config.getBool("webserver_enabled", true);
-    if (webServerEnabled) {
-        Serial.println("Initializing Web Server...");
-        bool webServerInitSuccess = webServer.init();
+    Serial.println("Starting Ethernet...");
+    ethernetDevice.init();
 
-#ifdef DEBUG
-        if (webServerInitSuccess) {
-            Serial.print("Web server initialized successfully. ");
-            Serial.print("Access at http://");
-            Serial.print(webServer.getIpAddressString());
-            Serial.print(":");
-            Serial.println(WEBSERVER_PORT);
-        } else {
-            Serial.println("WARNING: Failed to initialize web server");
-        }
-#endif
-    }
+    // Initialize web server once the link is up, if enabled
+    webServerPending = config.getBool("webserver_enabled", true);
 
-    // Initialize serial devices module (controls COM1 access)
-    serialDevices.init();
-    Serial1.begin(9600);  // Initialize COM1 for both rangefinder and tilt servo
+    Serial.print("System initialization complete in ");
+    Serial.print(millis());
+    Serial.println(" ms (network continues in the background)");
+    Serial.println("----------------------------------");
+}
 
-    // Initialize system components
-    parser.init();
-    motion.setTiltServo(&tiltServo);  // Connect the tilt servo to motion control
-    motion.init();
-    rangefinder.begin();  // Using begin() instead of init()
-    estop.init();
+// Start the web server once Ethernet has an address
+void startWebServer() {
+    Serial.println("Initializing Web Server...");
+    bool webServerInitSuccess = webServer.init();
 
-    // Initialize tilt servo with configuration parameters
-    tiltServo.begin();  // Using begin() instead of init()
-    tiltServo.setLimits(config.getInt("tilt_min", 45), config.getInt("tilt_max", 135));
-    bool tiltInitSuccess = true;
+    // Bytes streamed to browsers per loop() (bounds the time downloads take from motion)
+    webServer.setSendBudget(config.getInt("web_send_budget", WebServer::DEFAULT_SEND_BUDGET));
 
 #ifdef DEBUG
-    if (tiltInitSuccess) {
-        Serial.println("Tilt servo initialized successfully");
+    if (webServerInitSuccess) {
+        Serial.print("Web server initialized successfully. ");
+        Serial.print("Access at http://");
+        Serial.print(webServer.getIpAddressString());
+        Serial.print(":");
+        Serial.println(WEBSERVER_PORT);
     } else {
-        Serial.println("WARNING: Failed to initialize tilt servo");
-    }
-#endif
-
-    // Apply configuration to subsystems
-    if (configLoaded) {
-        // Set motor velocities
-        motion.setVelocity(config.getInt("velocity_x", DEFAULT_VELOCITY_LIMIT),
-                           config.getInt("velocity_y", DEFAULT_VELOCITY_LIMIT),
-                           config.getInt("velocity_z", DEFAULT_VELOCITY_LIMIT));
-
-        // Set motor acceleration
-        motion.setAcceleration(config.getInt("acceleration", DEFAULT_ACCELERATION_LIMIT));
-
-        // Set tilt limits
-        motion.setTiltLimits(config.getInt("tilt_min", 45), config.getInt("tilt_max", 135));
+        Serial.println("WARNING: Failed to initialize web server");
     }
 
-    // Initialize command handler after configuration is loaded
-    cmdHandler.init();
-
     // Print initial Ethernet diagnostics
-#ifdef DEBUG
     printEthernetDiagnostics();
 #endif
-
-    Serial.println("System initialization complete");
-    Serial.println("----------------------------------");
 }
 
 // Variables for periodic status reporting
@@ -285,26 +414,74 @@ unsigned long lastStatusTime = 0;
 const unsigned long STATUS_INTERVAL = 30000;  // 30 seconds
 
 void loop() {
+    // Loop period and per-stage timing (no-ops unless PERF_MONITORING_ENABLED)
+    PERF_MARK_LOOP();
+
     // Update Ethernet connection
-    ethernetDevice.update();
+    PERF_TIME_STAGE(PERF_ETHERNET, ethernetDevice.update());
 
-    // Update web server
-    webServer.update();
+    // Update web server (started once the network is up)
+    if (webServerPending && ethernetDevice.isNetworkReady()) {
+        webServerPending = false;
+        startWebServer();
+    }
+    PERF_TIME_STAGE(PERF_WEB, webServer.update());
 
     // Check for emergency stop condition
-    if (estop.check()) {
-        // ESTOP newly activated
-        parser.sendResponse("INFO", "ESTOP_ACTIVATED");
-    }
+    PERF_TIME_STAGE(PERF_ESTOP, {
+        if (estop.check()) {
+            // ESTOP newly activated: drop any scan or queued path so nothing restarts motion
+            scanner.abort();
+            motion.stop();
+            for (uint8_t i = 0; i < SESSION_COUNT; i++) {
+                sessionParser(i).sendResponse("INFO", "ESTOP_ACTIVATED");
+            }
+        }
+    });
 
     // Process incoming commands
-    parser.update();
+    bool commandsHandled = false;
+    PERF_TIME_STAGE(PERF_PARSER, commandsHandled = serviceSessions());
 
-    // Update motion state if moving
-    if (motion.isMoving() && !estop.isActive()) {
+    // Advance non-blocking moves (also reports moves aborted by ESTOP), then
+    // sample them for the motion trace
+    PERF_TIME_STAGE(PERF_MOTION, {
         motion.update();
+        motionTrace.update();
+    });
+
+    // Run the COM1 scheduler (rangefinder and tilt jobs), then finish MEASURE / stream readings
+    PERF_TIME_STAGE(PERF_SERIAL, {
+        serialDevices.update();
+        tiltServo.update();
+    });
+    PERF_TIME_STAGE(PERF_COMMANDS, cmdHandler.update());
+
+    // Advance a running SCAN (moves, measurements and batched result frames)
+    PERF_TIME_STAGE(PERF_SCANNER, scanner.update());
+
+    // Push subscribed telemetry fields that changed
+    PERF_TIME_STAGE(PERF_TELEMETRY, {
+        telemetry.update();
+        for (uint8_t i = 0; i < EthernetDevice::MAX_OBSERVERS; i++) {
+            observerTelemetry[i].update();
+        }
+    });
+
+    // Write buffered log records (and a sector of a TRACE:SAVE) to the SD card
+    // when no commands were waiting (or the log buffer is filling up)
+    if (!commandsHandled || EventLogger.getPending() >= EVENT_LOG_RECORDS / 2) {
+        PERF_TIME_STAGE(PERF_LOG, {
+            EventLogger.update();
+            motionTrace.updateSave();
+        });
     }
 
+#ifdef STACK_MONITORING_ENABLED
+    // Periodic stack/heap high-water check
+    Memory.update();
+#endif
+
     // Periodic status reporting
 #ifdef DEBUG
     unsigned long currentTime = millis();
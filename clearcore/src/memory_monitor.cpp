@@ -0,0 +1,171 @@
+/**
+ * Space Maquette - Memory Monitor Implementation
+ */
+
+#include "memory_monitor.h"
+
+#ifdef STACK_MONITORING_ENABLED
+
+#include <malloc.h>
+#include <unistd.h>
+
+#include "event_log.h"
+
+// Word written over the unused stack area
+#define STACK_PAINT_PATTERN 0xA5A5A5A5UL
+
+// Bytes left unpainted above the heap and below the caller's frame
+#define STACK_PAINT_GUARD 128
+
+// Initial stack pointer (linker script)
+extern "C" char __StackTop;
+
+MemoryMonitor Memory;
+
+// Allocation counters, updated by the malloc wrappers
+static volatile uint32_t allocationCount = 0;
+static volatile uint32_t freeCount = 0;
+static volatile uint32_t failedCount = 0;
+
+// Link-time wrappers (-Wl,--wrap=malloc,--wrap=realloc,--wrap=free); operator new,
+// String and std containers all allocate through these
+extern "C" {
+void* __real_malloc(size_t size);
+void* __real_realloc(void* ptr, size_t size);
+void __real_free(void* ptr);
+
+void* __wrap_malloc(size_t size) {
+    void* ptr = __real_malloc(size);
+    if (ptr) {
+        allocationCount++;
+    } else {
+        failedCount++;
+    }
+    return ptr;
+}
+
+void* __wrap_realloc(void* ptr, size_t size) {
+    void* result = __real_realloc(ptr, size);
+    if (result) {
+        allocationCount++;
+    } else if (size) {
+        failedCount++;
+    }
+    return result;
+}
+
+void __wrap_free(void* ptr) {
+    if (ptr) {
+        freeCount++;
+    }
+    __real_free(ptr);
+}
+}
+
+MemoryMonitor::MemoryMonitor()
+    : _paintBottom(0),
+      _lowWater(0),
+      _heapPeak(0),
+      _warnBytes(MEMORY_WARN_BYTES),
+      _minFree(UINT32_MAX),
+      _lastCheck(0),
+      _painted(false),
+      _lowReported(false) {}
+
+uintptr_t MemoryMonitor::heapTop() {
+    return reinterpret_cast<uintptr_t>(sbrk(0));
+}
+
+void MemoryMonitor::begin() {
+    // Paint from just above the heap to just below this frame
+    volatile uint32_t marker = 0;
+    uintptr_t top = (reinterpret_cast<uintptr_t>(&marker) - STACK_PAINT_GUARD) & ~3UL;
+    uintptr_t bottom = (heapTop() + STACK_PAINT_GUARD + 3) & ~3UL;
+
+    for (uintptr_t address = bottom; address < top; address += 4) {
+        *reinterpret_cast<volatile uint32_t*>(address) = STACK_PAINT_PATTERN;
+    }
+
+    _paintBottom = bottom;
+    _lowWater = top;
+    _heapPeak = heapTop();
+    _painted = true;
+
+#ifdef DEBUG
+    Serial.print("Memory monitor: painted ");
+    Serial.print((unsigned long)(top - bottom));
+    Serial.println(" bytes of stack");
+#endif
+}
+
+void MemoryMonitor::setWarningThreshold(uint32_t bytes) {
+    _warnBytes = bytes;
+}
+
+// Scan up from the highest heap top seen; the first overwritten word is the new low-water mark
+uintptr_t MemoryMonitor::scanLowWater() {
+    uintptr_t heap = heapTop();
+    if (heap > _heapPeak) {
+        _heapPeak = heap;
+    }
+
+    uintptr_t address = (_heapPeak > _paintBottom ? (_heapPeak + 3) & ~3UL : _paintBottom);
+    for (; address < _lowWater; address += 4) {
+        if (*reinterpret_cast<volatile uint32_t*>(address) != STACK_PAINT_PATTERN) {
+            _lowWater = address;
+            break;
+        }
+    }
+
+    return _lowWater;
+}
+
+void MemoryMonitor::getStats(Stats& stats) {
+    uintptr_t stackTop = reinterpret_cast<uintptr_t>(&__StackTop);
+    uintptr_t heap = heapTop();
+    uintptr_t lowWater = _painted ? scanLowWater() : stackTop;
+    struct mallinfo info = mallinfo();
+
+    stats.stackSize = _painted ? stackTop - _paintBottom : 0;
+    stats.stackPeak = stackTop - lowWater;
+    stats.heapUsed = info.uordblks;
+    stats.heapFragmented = info.fordblks;
+    stats.largestFree = lowWater > heap ? lowWater - heap : 0;
+    stats.allocations = allocationCount;
+    stats.frees = freeCount;
+    stats.failedAllocations = failedCount;
+
+    if (stats.largestFree < _minFree) {
+        _minFree = stats.largestFree;
+    }
+    stats.minFree = _minFree;
+}
+
+void MemoryMonitor::update() {
+    unsigned long now = millis();
+    if (!_painted || now - _lastCheck < MEMORY_CHECK_MS) {
+        return;
+    }
+    _lastCheck = now;
+
+    Stats stats;
+    getStats(stats);
+
+    // Warn once per dip below the threshold
+    bool low = stats.largestFree < _warnBytes || stats.failedAllocations > 0;
+    if (low && !_lowReported) {
+        EventLogger.log(SOURCE_SYSTEM, EVENT_WARNING, EVT_SYS_MEMORY_LOW, stats.largestFree,
+                        stats.stackPeak);
+#ifdef DEBUG
+        Serial.print("WARNING: free memory low: ");
+        Serial.print((unsigned long)stats.largestFree);
+        Serial.print(" bytes, stack peak ");
+        Serial.print((unsigned long)stats.stackPeak);
+        Serial.print(", failed allocations ");
+        Serial.println((unsigned long)stats.failedAllocations);
+#endif
+    }
+    _lowReported = low;
+}
+
+#endif  // STACK_MONITORING_ENABLED
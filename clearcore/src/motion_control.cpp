@@ -18,17 +18,14 @@ MotionControl::MotionControl() {
     _initialized = false;
     _homed = false;
 
-    _currentX = 0;
-    _currentY = 0;
-    _currentZ = 0;
-    _currentPan = 0;
+    memset(_axisState, 0, sizeof(_axisState));
     _currentTilt = 0;
 
-    _velocityX = DEFAULT_VELOCITY_LIMIT;
-    _velocityY = DEFAULT_VELOCITY_LIMIT;
-    _velocityZ = DEFAULT_VELOCITY_LIMIT;
-    _velocityPan = DEFAULT_VELOCITY_LIMIT;
-    _accelerationLimit = DEFAULT_ACCELERATION_LIMIT;
+    for (int i = 0; i < MOTION_AXIS_COUNT; i++) {
+        _profiles[i].velocity = DEFAULT_VELOCITY_LIMIT;
+        _profiles[i].acceleration = DEFAULT_ACCELERATION_LIMIT;
+        _profiles[i].jerk = 0;
+    }
 
     _xEnabled = false;
     _yEnabled = false;
@@ -43,8 +40,56 @@ MotionControl::MotionControl() {
 
     _tiltServo = nullptr;  // Initialize to nullptr
 
-    // Set default for pan home sensor pin
-    _panHomeSensorPin = PAN_HOME_SENSOR_PIN;
+    // Homing: only Pan has a sensor by default; the others zero in place
+    for (int i = 0; i < MOTION_AXIS_COUNT; i++) {
+        HomingConfig &config = _homing[i].config;
+        config.sensorPin = (i == 3) ? PAN_HOME_SENSOR_PIN : -1;
+        config.direction = 1;
+        config.seekVelocity = HOME_SEEK_VELOCITY;
+        config.latchVelocity = HOME_LATCH_VELOCITY;
+        config.backoff = HOME_BACKOFF_STEPS;
+        config.maxTravel = HOME_MAX_TRAVEL;
+        _homing[i].phase = HOME_IDLE;
+        _homing[i].startTime = 0;
+        _homing[i].armed = false;
+        _homing[i].edgeSeen = false;
+        _homing[i].edgePosition = 0;
+    }
+    _homingParallel = false;
+    _homingAll = false;
+
+    // Set up move tracking for each step and direction axis
+    MotorDriver *motors[MOTION_AXIS_COUNT] = {&MOTOR_X_AXIS, &MOTOR_Y_AXIS, &MOTOR_Z_AXIS,
+                                              &MOTOR_PAN_AXIS};
+    const char names[MOTION_AXIS_COUNT] = {'X', 'Y', 'Z', 'P'};
+    for (int i = 0; i < MOTION_AXIS_COUNT; i++) {
+        _axes[i].motor = motors[i];
+        _axes[i].name = names[i];
+        _axes[i].state = AXIS_IDLE;
+        _axes[i].target = 0;
+        _axes[i].settleStartTime = 0;
+        _axes[i].accelLimit = 0;
+        _axes[i].jerk = 0;
+        _axes[i].rampAccel = 0;
+        _axes[i].rampStartTime = 0;
+        _axes[i].rampStepTime = 0;
+        _axes[i].lastVelocity = 0;
+    }
+
+    _moveActive = false;
+    _moveFailed = false;
+    _failedAxis = 0;
+    _lastMoveFailed = false;
+
+    _coordinatedMoves = true;
+
+    _queueHead = 0;
+    _queueCount = 0;
+    _queuedMove = false;
+    _queueCompleted = 0;
+    _queueUnderruns = 0;
+    _queueDrained = false;
+    _queueDrainTime = 0;
 }
 
 // Set the tilt servo instance
@@ -52,6 +97,11 @@ void MotionControl::setTiltServo(TiltServo *tiltServo) {
     _tiltServo = tiltServo;
 }
 
+// Set the motion event handler
+void MotionControl::setEventCallback(MotionEventCallback callback) {
+    _eventCallback = callback;
+}
+
 // Initialize the motion control system
 bool MotionControl::init() {
     if (_initialized) {
@@ -77,14 +127,15 @@ bool MotionControl::init() {
     MOTOR_PAN_AXIS.HlfbCarrier(MotorDriver::HLFB_CARRIER_482_HZ);
 
     // Set velocity and acceleration limits for each motor
-    MOTOR_X_AXIS.VelMax(_velocityX);
-    MOTOR_X_AXIS.AccelMax(_accelerationLimit);
-    MOTOR_Y_AXIS.VelMax(_velocityY);
-    MOTOR_Y_AXIS.AccelMax(_accelerationLimit);
-    MOTOR_Z_AXIS.VelMax(_velocityZ);
-    MOTOR_Z_AXIS.AccelMax(_accelerationLimit);
-    MOTOR_PAN_AXIS.VelMax(_velocityPan);
-    MOTOR_PAN_AXIS.AccelMax(_accelerationLimit);
+    for (int i = 0; i < MOTION_AXIS_COUNT; i++) {
+        _axes[i].motor->VelMax(_profiles[i].velocity);
+        _axes[i].motor->AccelMax(_profiles[i].acceleration);
+    }
+
+    // Home sensor inputs
+    for (int i = 0; i < MOTION_AXIS_COUNT; i++) {
+        attachHomeSensor(i);
+    }
 
     // Initialize tilt servo if available
     if (_tiltServo != nullptr) {
@@ -93,6 +144,7 @@ bool MotionControl::init() {
     }
 
     _initialized = true;
+    sampleAxes();
     return true;
 }
 
@@ -209,282 +261,424 @@ bool MotionControl::disableAllMotors() {
     return true;
 }
 
-bool MotionControl::isPanHomeSensorTriggered() {
-    // Read the optical sensor pin
-    // Return true if the sensor is triggered (flag detected)
-    return digitalRead(_panHomeSensorPin) == HIGH;  // Adjust logic level as needed
+// Home sensor input level (HIGH = flag detected)
+bool MotionControl::isHomeSensorActive(int index) {
+    return digitalRead(_homing[index].config.sensorPin) == HIGH;  // Adjust logic level as needed
 }
 
-bool MotionControl::homePanAxis() {
-    if (!_panEnabled) {
-        return false;
+// Capture the next sensor edge
+void MotionControl::armHomeEdge(int index) {
+    AxisHoming &home = _homing[index];
+    noInterrupts();
+    home.edgeSeen = false;
+    home.armed = true;
+    interrupts();
+}
+
+// True once the armed edge was seen. Without an interrupt on the pin, the edge is taken
+// here from the polled sensor (one loop of latency)
+bool MotionControl::takeHomeEdge(int index) {
+    AxisHoming &home = _homing[index];
+    if (home.armed && isHomeSensorActive(index)) {
+        captureHomeEdge(index);
     }
+    return home.edgeSeen;
+}
 
-    // Store initial sensor state
-    bool initialSensorState = isPanHomeSensorTriggered();
+// Record the commanded position at the sensor edge (interrupt or polled)
+void MotionControl::captureHomeEdge(int index) {
+    AxisHoming &home = _homing[index];
+    noInterrupts();
+    if (home.armed && isHomeSensorActive(index)) {
+        home.edgePosition = _axes[index].motor->PositionRefCommanded();
+        home.edgeSeen = true;
+        home.armed = false;
+    }
+    interrupts();
+}
 
-    // Set a slow homing velocity
-    int savedVelocity = _velocityPan;
-    MOTOR_PAN_AXIS.VelMax(5000);  // Slower speed for homing
+MotionControl *MotionControl::_homingInstance = nullptr;
 
-    // First, safely disable the motor to prepare for homing
-    MOTOR_PAN_AXIS.EnableRequest(false);
-    delay(100);  // Give time for motor to disengage
+void MotionControl::homeEdgeX() {
+    _homingInstance->captureHomeEdge(0);
+}
+
+void MotionControl::homeEdgeY() {
+    _homingInstance->captureHomeEdge(1);
+}
 
-    // Re-enable the motor to start homing
-    MOTOR_PAN_AXIS.EnableRequest(true);
+void MotionControl::homeEdgeZ() {
+    _homingInstance->captureHomeEdge(2);
+}
+
+void MotionControl::homeEdgePan() {
+    _homingInstance->captureHomeEdge(3);
+}
 
-    // Wait for HLFB to assert (motor ready)
-    if (!waitForHlfb(MOTOR_PAN_AXIS, 3000)) {
-        // Could not enable motor for homing
+// Set an axis's home sensor and homing speeds
+bool MotionControl::setHomingConfig(char axis, const HomingConfig &config) {
+    int index = axisIndex(axis);
+    if (index < 0 || isHoming() || (config.direction != 1 && config.direction != -1) ||
+        config.seekVelocity <= 0 || config.latchVelocity <= 0 || config.backoff <= 0 ||
+        config.maxTravel <= 0) {
         return false;
     }
 
-    if (initialSensorState) {
-        // Sensor already triggered, need to rotate a full 360°
-        // We'll move in the positive direction until sensor is not triggered
-        while (isPanHomeSensorTriggered() && !MOTOR_PAN_AXIS.StatusReg().bit.AlertsPresent) {
-            MOTOR_PAN_AXIS.Move(1000, MotorDriver::MOVE_TARGET_REL_END_POSN);
-            while (!MOTOR_PAN_AXIS.StepsComplete()) {
-                if (!isPanHomeSensorTriggered()) {
-                    break;
-                }
-                delay(10);
-            }
-            if (!isPanHomeSensorTriggered()) {
-                break;
-            }
-        }
+    AxisHoming &home = _homing[index];
+    int oldPin = home.config.sensorPin;
+    if (oldPin >= 0 && oldPin != config.sensorPin && digitalPinToInterrupt(oldPin) >= 0) {
+        detachInterrupt(digitalPinToInterrupt(oldPin));
+    }
 
-        // Now continue until sensor triggers again
-        while (!isPanHomeSensorTriggered() && !MOTOR_PAN_AXIS.StatusReg().bit.AlertsPresent) {
-            MOTOR_PAN_AXIS.Move(1000, MotorDriver::MOVE_TARGET_REL_END_POSN);
-            while (!MOTOR_PAN_AXIS.StepsComplete()) {
-                if (isPanHomeSensorTriggered()) {
-                    break;
-                }
-                delay(10);
-            }
-            if (isPanHomeSensorTriggered()) {
-                break;
-            }
-        }
-    } else {
-        // Sensor not triggered, rotate until it triggers
-        while (!isPanHomeSensorTriggered() && !MOTOR_PAN_AXIS.StatusReg().bit.AlertsPresent) {
-            MOTOR_PAN_AXIS.Move(1000, MotorDriver::MOVE_TARGET_REL_END_POSN);
-            while (!MOTOR_PAN_AXIS.StepsComplete()) {
-                if (isPanHomeSensorTriggered()) {
-                    break;
-                }
-                delay(10);
-            }
-            if (isPanHomeSensorTriggered()) {
-                break;
-            }
-        }
+    home.config = config;
+    if (_initialized) {
+        attachHomeSensor(index);
     }
 
-    // Stop motion when sensor is triggered
-    MOTOR_PAN_AXIS.MoveStopAbrupt();
+    return true;
+}
 
-#ifdef DEBUG
-    // Get the current encoder position before resetting (for debug only)
-    int32_t encoderPos = MOTOR_PAN_AXIS.PositionRefCommanded();
-    Serial.print("Pan axis homed. Encoder position before reset: ");
-    Serial.println(encoderPos);
-#endif
+const HomingConfig *MotionControl::getHomingConfig(char axis) {
+    int index = axisIndex(axis);
+    return index >= 0 ? &_homing[index].config : nullptr;
+}
 
-    // Properly zero the encoder and commanded position
-    MOTOR_PAN_AXIS.EnableRequest(false);  // Disable motor first
-    delay(50);                            // Brief delay
+// Set up the sensor input; edges are captured on an interrupt when the pin supports one
+void MotionControl::attachHomeSensor(int index) {
+    static void (*const handlers[MOTION_AXIS_COUNT])() = {homeEdgeX, homeEdgeY, homeEdgeZ,
+                                                           homeEdgePan};
+    int pin = _homing[index].config.sensorPin;
+    if (pin < 0) {
+        return;
+    }
 
-    // Reset the encoder to zero and the commanded position
-    // Note: For ClearCore, we use PositionRefSet(0) rather than EncoderIn.Position(0)
-    MOTOR_PAN_AXIS.PositionRefSet(0);                           // Set reference position to zero
-    MOTOR_PAN_AXIS.Move(0, MotorDriver::MOVE_TARGET_ABSOLUTE);  // Set commanded position to zero
+    pinMode(pin, INPUT);
+    if (digitalPinToInterrupt(pin) >= 0) {
+        _homingInstance = this;
+        attachInterrupt(digitalPinToInterrupt(pin), handlers[index], CHANGE);
+    }
+}
 
-    // Re-enable the motor
-    MOTOR_PAN_AXIS.EnableRequest(true);
-    waitForHlfb(MOTOR_PAN_AXIS, 3000);  // Wait for motor to be ready
+// Begin homing one axis
+void MotionControl::startHoming(int index) {
+    AxisHoming &home = _homing[index];
+    AxisMove &axis = _axes[index];
+    MotorDriver *motor = axis.motor;
+    const HomingConfig &config = home.config;
 
-    // Reset our internal tracking
-    _currentPan = 0;
+    home.startTime = millis();
+    home.armed = false;
+    home.edgeSeen = false;
 
-    // Restore original velocity
-    MOTOR_PAN_AXIS.VelMax(savedVelocity);
-    _velocityPan = savedVelocity;
+    if (!prepareAxisMove(axis)) {
+        finishHoming(index, false);
+        return;
+    }
 
-    // Check if any alerts occurred during homing
-    if (MOTOR_PAN_AXIS.StatusReg().bit.AlertsPresent) {
-        printAlerts(MOTOR_PAN_AXIS);
-        return handleAlerts(MOTOR_PAN_AXIS);
+    if (config.sensorPin < 0) {
+        // No sensor: the current position becomes zero
+        int32_t homePosition = motor->PositionRefCommanded();
+        motor->PositionRefSet(0);
+        EventLogger.log(SOURCE_MOTION, EVENT_INFO, EVT_MOTION_HOMED, axis.name, homePosition);
+        finishHoming(index, true);
+        return;
     }
 
-#ifdef DEBUG
-    Serial.println("Pan axis successfully homed and zeroed");
-#endif
+    motor->AccelMax(_profiles[index].acceleration);
 
-    return true;
+    if (isHomeSensorActive(index)) {
+        // Already on the sensor: move off it first
+        motor->VelMax(config.latchVelocity);
+        motor->Move(-config.direction * config.maxTravel, MotorDriver::MOVE_TARGET_REL_END_POSN);
+        setHomingPhase(index, HOME_CLEAR);
+    } else {
+        motor->VelMax(config.seekVelocity);
+        armHomeEdge(index);
+        motor->Move(config.direction * config.maxTravel, MotorDriver::MOVE_TARGET_REL_END_POSN);
+        setHomingPhase(index, HOME_SEEK);
+    }
 }
 
-// Home a specific axis
-bool MotionControl::homeAxis(char axis) {
-    bool success = true;
+// Advance one axis's homing (fast seek, back-off, slow latch, return to zero)
+void MotionControl::updateHoming(int index) {
+    AxisHoming &home = _homing[index];
+    MotorDriver *motor = _axes[index].motor;
+    const HomingConfig &config = home.config;
 
-    switch (axis) {
-        case 'X':
-        case 'x':
-            if (_xEnabled) {
-                _currentX = 0;
-            } else {
-                success = false;
+    // Alerts (including motors disabled by ESTOP) abort homing
+    if (motor->StatusReg().bit.AlertsPresent) {
+        logAlerts(*motor);
+        finishHoming(index, false);
+        return;
+    }
+
+    if (millis() - home.startTime > HOME_TIMEOUT_MS) {
+        finishHoming(index, false);
+        return;
+    }
+
+    switch (home.phase) {
+        case HOME_SEEK:
+            if (takeHomeEdge(index)) {
+                motor->MoveStopDecel();
+                setHomingPhase(index, HOME_SEEK_STOP);
+            } else if (motor->StepsComplete()) {
+                finishHoming(index, false);  // Whole travel without finding the sensor
             }
             break;
-        case 'Y':
-        case 'y':
-            if (_yEnabled) {
-                _currentY = 0;
-            } else {
-                success = false;
+
+        case HOME_CLEAR:
+            if (!isHomeSensorActive(index)) {
+                home.edgePosition = motor->PositionRefCommanded();
+                motor->MoveStopDecel();
+                setHomingPhase(index, HOME_SEEK_STOP);
+            } else if (motor->StepsComplete()) {
+                finishHoming(index, false);  // Never left the sensor
             }
             break;
-        case 'Z':
-        case 'z':
-            if (_zEnabled) {
-                _currentZ = 0;
-            } else {
-                success = false;
+
+        case HOME_SEEK_STOP:
+            // Back off to a fixed distance before the edge, whatever the stopping distance was
+            if (motor->StepsComplete()) {
+                motor->VelMax(config.seekVelocity);
+                motor->Move(home.edgePosition - config.direction * config.backoff,
+                            MotorDriver::MOVE_TARGET_ABSOLUTE);
+                setHomingPhase(index, HOME_BACKOFF);
             }
             break;
-        case 'P':
-        case 'p':
-            return homePanAxis();  // Use the specialized pan homing
-        case 'T':
-        case 't':
-            if (_tiltEnabled && _tiltServo != nullptr) {
-                success = setTiltAngle(_tiltHomeAngle);
-            } else {
-                success = false;
+
+        case HOME_BACKOFF:
+            if (motor->StepsComplete()) {
+                if (isHomeSensorActive(index)) {
+                    finishHoming(index, false);  // Back-off shorter than the sensor flag
+                    break;
+                }
+                motor->VelMax(config.latchVelocity);
+                armHomeEdge(index);
+                motor->Move(config.direction * config.backoff * 2,
+                            MotorDriver::MOVE_TARGET_REL_END_POSN);
+                setHomingPhase(index, HOME_LATCH);
+            }
+            break;
+
+        case HOME_LATCH:
+            if (takeHomeEdge(index)) {
+                motor->MoveStopAbrupt();  // Slow enough to stop at once
+                setHomingPhase(index, HOME_LATCH_STOP);
+            } else if (motor->StepsComplete()) {
+                finishHoming(index, false);
             }
             break;
+
+        case HOME_LATCH_STOP:
+            if (motor->StepsComplete()) {
+                // The latched edge becomes zero; the motor stopped just past it
+                int32_t homePosition = home.edgePosition;
+                motor->PositionRefSet(motor->PositionRefCommanded() - homePosition);
+                motor->VelMax(config.latchVelocity);
+                motor->Move(0, MotorDriver::MOVE_TARGET_ABSOLUTE);
+                EventLogger.log(SOURCE_MOTION, EVENT_INFO, EVT_MOTION_HOMED, _axes[index].name,
+                                homePosition);
+                setHomingPhase(index, HOME_RETURN);
+            }
+            break;
+
+        case HOME_RETURN:
+            if (motor->StepsComplete() && motor->HlfbState() == MotorDriver::HLFB_ASSERTED) {
+                finishHoming(index, true);
+            }
+            break;
+
         default:
-            success = false;
+            break;
     }
+}
 
-    return success;
+// Enter a phase and report it
+void MotionControl::setHomingPhase(int index, HomingPhase phase) {
+    _homing[index].phase = phase;
+    if (_eventCallback) {
+        _eventCallback(MOTION_EVENT_HOME_PHASE, _axes[index].name);
+    }
 }
 
-// Home all axes
-bool MotionControl::homeAllAxes() {
-    bool success = true;
+// End one axis's homing; a failure stops the whole homing run
+void MotionControl::finishHoming(int index, bool success) {
+    AxisHoming &home = _homing[index];
+    MotorDriver *motor = _axes[index].motor;
+
+    home.armed = false;
+    motor->VelMax(_profiles[index].velocity);
+
+    if (!success) {
+        motor->MoveStopAbrupt();
+        EventLogger.log(SOURCE_MOTION, EVENT_ERROR, EVT_MOTION_HOME_FAILED, _axes[index].name,
+                        home.phase);
+        home.phase = HOME_FAILED;
+
+        // Stop the other axes of this run
+        for (int i = 0; i < MOTION_AXIS_COUNT; i++) {
+            if (i != index && _homing[i].phase >= HOME_WAITING && _homing[i].phase < HOME_DONE) {
+                _homing[i].armed = false;
+                _axes[i].motor->MoveStopAbrupt();
+                _axes[i].motor->VelMax(_profiles[i].velocity);
+                _homing[i].phase = HOME_IDLE;
+            }
+        }
+        _homingAll = false;
+        sampleAxes();
 
-    success &= homeAxis('X');
-    success &= homeAxis('Y');
-    success &= homeAxis('Z');
-    success &= homeAxis('P');
-    success &= homeAxis('T');
+        if (_eventCallback) {
+            _eventCallback(MOTION_EVENT_HOME_FAILED, _axes[index].name);
+        }
+        return;
+    }
 
-    if (success) {
-        _homed = true;
+    home.phase = HOME_DONE;
+    sampleAxes();
+    if (_eventCallback) {
+        _eventCallback(MOTION_EVENT_HOME_DONE, _axes[index].name);
     }
 
-    return success;
+    // Last axis of the run
+    if (!isHoming()) {
+        if (_homingAll) {
+            _homed = true;
+            _homingAll = false;
+        }
+        if (_eventCallback) {
+            _eventCallback(MOTION_EVENT_HOME_DONE, 0);
+        }
+    }
 }
 
-// Move an axis to an absolute position
-bool MotionControl::moveAbsolute(char axis, int32_t position) {
+// Stop homing in progress (STOP, ESTOP); reported as a failure of the interrupted axis
+void MotionControl::abortHoming() {
+    for (int i = 0; i < MOTION_AXIS_COUNT; i++) {
+        if (_homing[i].phase > HOME_WAITING && _homing[i].phase < HOME_DONE) {
+            finishHoming(i, false);
+            return;
+        }
+    }
+
+    // Only queued axes left
+    for (int i = 0; i < MOTION_AXIS_COUNT; i++) {
+        if (_homing[i].phase == HOME_WAITING) {
+            _homing[i].phase = HOME_IDLE;
+        }
+    }
+    _homingAll = false;
+}
+
+bool MotionControl::isHoming() const {
+    for (int i = 0; i < MOTION_AXIS_COUNT; i++) {
+        if (_homing[i].phase >= HOME_WAITING && _homing[i].phase < HOME_DONE) {
+            return true;
+        }
+    }
+    return false;
+}
+
+HomingPhase MotionControl::getHomingPhase(char axis) {
+    int index = axisIndex(axis);
+    return index >= 0 ? _homing[index].phase : HOME_IDLE;
+}
+
+const char *MotionControl::getHomingPhaseName(HomingPhase phase) {
+    static const char *const names[] = {"IDLE",  "WAITING",    "SEEK",   "SEEK_STOP",
+                                        "CLEAR", "BACKOFF",    "LATCH",  "LATCH_STOP",
+                                        "RETURN", "DONE",      "FAILED"};
+    return phase <= HOME_FAILED ? names[phase] : "UNKNOWN";
+}
+
+// Home a specific axis
+// Starts homing and returns immediately; update() runs it to completion
+bool MotionControl::homeAxis(char axis) {
     if (!_initialized) {
         return false;
     }
 
-    bool success = true;
-    MotorDriver *motor = nullptr;
+    if (axis == 'T' || axis == 't') {
+        // The servo has no sensor: homing moves it to the safe angle
+        return _tiltEnabled && _tiltServo != nullptr && setTiltAngle(_tiltHomeAngle);
+    }
 
-    // Select the appropriate motor connector based on the axis
-    switch (axis) {
-        case 'X':
-        case 'x':
-            if (!_xEnabled)
-                return false;
-            motor = &MOTOR_X_AXIS;
-            break;
-        case 'Y':
-        case 'y':
-            if (!_yEnabled)
-                return false;
-            motor = &MOTOR_Y_AXIS;
-            break;
-        case 'Z':
-        case 'z':
-            if (!_zEnabled)
-                return false;
-            motor = &MOTOR_Z_AXIS;
-            break;
-        case 'P':
-        case 'p':
-            if (!_panEnabled)
-                return false;
-            motor = &MOTOR_PAN_AXIS;
-            break;
-        case 'T':
-        case 't':
-            if (!_tiltEnabled)
-                return false;
-            // For tilt servo (using position as angle)
-            return setTiltAngle(position);
-        default:
-            return false;
+    int index = axisIndex(axis);
+    if (index < 0 || !isEnabled(axis) || _moveActive || isHoming()) {
+        return false;
     }
 
-    // Check if motor has any alerts
-    if (motor->StatusReg().bit.AlertsPresent) {
-        printAlerts(*motor);
-        success = handleAlerts(*motor);
-        if (!success) {
+    for (int i = 0; i < MOTION_AXIS_COUNT; i++) {
+        _homing[i].phase = HOME_IDLE;
+    }
+    _homingAll = false;
+
+    startHoming(index);
+    return _homing[index].phase != HOME_FAILED;
+}
+
+// Home all axes, one after another or (with parallel homing) all at once
+bool MotionControl::homeAllAxes() {
+    if (!_initialized || _moveActive || isHoming()) {
+        return false;
+    }
+
+    for (int i = 0; i < MOTION_AXIS_COUNT; i++) {
+        if (!isEnabled(_axes[i].name)) {
             return false;
         }
     }
 
-    // Command the absolute move
-    motor->Move(position, MotorDriver::MOVE_TARGET_ABSOLUTE);
+    _homed = false;
+    _homingAll = true;
 
-    // Wait for the move to complete and HLFB to assert
-    while ((!motor->StepsComplete() || motor->HlfbState() != MotorDriver::HLFB_ASSERTED) &&
-           !motor->StatusReg().bit.AlertsPresent) {
-        // Could add a timeout here if needed
-        delay(10);
+    if (_tiltEnabled && _tiltServo != nullptr) {
+        setTiltAngle(_tiltHomeAngle);
     }
 
-    // Check if any alerts occurred during the move
-    if (motor->StatusReg().bit.AlertsPresent) {
-        printAlerts(*motor);
-        success = handleAlerts(*motor);
+    for (int i = 0; i < MOTION_AXIS_COUNT; i++) {
+        _homing[i].phase = HOME_WAITING;
     }
 
-    // Update the current position if move was successful
-    if (success) {
-        switch (axis) {
-            case 'X':
-            case 'x':
-                _currentX = position;
-                break;
-            case 'Y':
-            case 'y':
-                _currentY = position;
-                break;
-            case 'Z':
-            case 'z':
-                _currentZ = position;
-                break;
-            case 'P':
-            case 'p':
-                _currentPan = position;
+    // Sequential homing starts the next axis from update()
+    for (int i = 0; i < MOTION_AXIS_COUNT && _homingAll; i++) {
+        if (_homing[i].phase == HOME_WAITING) {
+            startHoming(i);
+            if (!_homingParallel) {
                 break;
+            }
         }
     }
 
-    return success;
+    return _homingAll || _homed;
+}
+
+// Move an axis to an absolute position
+// Starts the move and returns immediately; update() tracks it to completion
+bool MotionControl::moveAbsolute(char axis, int32_t position) {
+    if (!_initialized || isHoming()) {
+        return false;
+    }
+
+    // Tilt servo is not part of the step and direction motion engine
+    if (axis == 'T' || axis == 't') {
+        if (!_tiltEnabled)
+            return false;
+        // For tilt servo (using position as angle)
+        return setTiltAngle(position);
+    }
+
+    AxisMove *move = findAxis(axis);
+    if (move == nullptr || !isEnabled(move->name)) {
+        return false;
+    }
+
+    if (!prepareAxisMove(*move)) {
+        return false;
+    }
+
+    startAxisMove(*move, position, _profiles[move - _axes]);
+    return true;
 }
 
 // Move an axis by a relative distance
@@ -494,23 +688,28 @@ bool MotionControl::moveRelative(char axis, int32_t distance) {
 }
 
 // Move to a specified position (multi-axis)
+// All axes start together; MOVE_DONE is reported once the last one arrives
 bool MotionControl::moveToPosition(int32_t x, int32_t y, int32_t z, int32_t pan, int32_t tilt) {
     bool success = true;
 
-    if (x >= 0) {
-        success &= moveAbsolute('X', x);
-    }
+    if (_coordinatedMoves) {
+        success &= moveCoordinated(x, y, z, pan);
+    } else {
+        if (x >= 0) {
+            success &= moveAbsolute('X', x);
+        }
 
-    if (y >= 0) {
-        success &= moveAbsolute('Y', y);
-    }
+        if (y >= 0) {
+            success &= moveAbsolute('Y', y);
+        }
 
-    if (z >= 0) {
-        success &= moveAbsolute('Z', z);
-    }
+        if (z >= 0) {
+            success &= moveAbsolute('Z', z);
+        }
 
-    if (pan >= 0) {
-        success &= moveAbsolute('P', pan);
+        if (pan >= 0) {
+            success &= moveAbsolute('P', pan);
+        }
     }
 
     if (tilt >= 0) {
@@ -520,64 +719,221 @@ bool MotionControl::moveToPosition(int32_t x, int32_t y, int32_t z, int32_t pan,
     return success;
 }
 
+// Move the step and direction axes so that they all arrive at the same time
+// Each axis gets VelMax/AccelMax proportional to its share of the path, so the
+// axes follow one scaled trapezoidal profile (linear interpolation).
+// Positions < 0 leave the axis where it is, as in moveToPosition().
+bool MotionControl::moveCoordinated(int32_t x, int32_t y, int32_t z, int32_t pan) {
+    if (!_initialized || isHoming()) {
+        return false;
+    }
+
+    const int32_t targets[MOTION_AXIS_COUNT] = {x, y, z, pan};
+    uint32_t distances[MOTION_AXIS_COUNT] = {0, 0, 0, 0};
+
+    // Normalized path profile, in path fractions per second (per second^2, ^3)
+    float pathVelocity = 0.0f;
+    float pathAcceleration = 0.0f;
+    float pathJerk = 0.0f;  // 0 = no axis of the move is jerk limited
+    bool haveProfile = false;
+
+    // Validate every axis and find the limiting profile before moving anything
+    for (int i = 0; i < MOTION_AXIS_COUNT; i++) {
+        if (targets[i] < 0) {
+            continue;
+        }
+
+        AxisMove &axis = _axes[i];
+        if (!isEnabled(axis.name) || !prepareAxisMove(axis)) {
+            return false;
+        }
+
+        int32_t start = axis.motor->PositionRefCommanded();
+        distances[i] = static_cast<uint32_t>(abs(targets[i] - start));
+        if (distances[i] == 0) {
+            continue;
+        }
+
+        const AxisProfile &profile = _profiles[i];
+        float axisVelocity = static_cast<float>(profile.velocity) / distances[i];
+        float axisAcceleration = static_cast<float>(profile.acceleration) / distances[i];
+
+        if (!haveProfile || axisVelocity < pathVelocity) {
+            pathVelocity = axisVelocity;
+        }
+        if (!haveProfile || axisAcceleration < pathAcceleration) {
+            pathAcceleration = axisAcceleration;
+        }
+        if (profile.jerk > 0) {
+            float axisJerk = static_cast<float>(profile.jerk) / distances[i];
+            if (pathJerk == 0.0f || axisJerk < pathJerk) {
+                pathJerk = axisJerk;
+            }
+        }
+        haveProfile = true;
+    }
+
+    // Command every axis in the same pass so they start together
+    for (int i = 0; i < MOTION_AXIS_COUNT; i++) {
+        if (targets[i] < 0) {
+            continue;
+        }
+
+        AxisMove &axis = _axes[i];
+        AxisProfile profile = _profiles[i];
+
+        if (haveProfile && distances[i] > 0) {
+            profile.velocity = static_cast<int32_t>(lroundf(pathVelocity * distances[i]));
+            profile.acceleration = static_cast<int32_t>(lroundf(pathAcceleration * distances[i]));
+            profile.jerk = static_cast<int32_t>(lroundf(pathJerk * distances[i]));
+
+            // Drivers reject zero limits on very short axis moves
+            if (profile.velocity < 1) {
+                profile.velocity = 1;
+            }
+            if (profile.acceleration < 1) {
+                profile.acceleration = 1;
+            }
+            if (pathJerk > 0.0f && profile.jerk < 1) {
+                profile.jerk = 1;
+            }
+        }
+
+        startAxisMove(axis, targets[i], profile);
+    }
+
+    return true;
+}
+
 // Stop all motion
 bool MotionControl::stop() {
+    if (isHoming()) {
+        abortHoming();
+    }
+
     MOTOR_X_AXIS.MoveStopAbrupt();
     MOTOR_Y_AXIS.MoveStopAbrupt();
     MOTOR_Z_AXIS.MoveStopAbrupt();
     MOTOR_PAN_AXIS.MoveStopAbrupt();
 
+    // Abandon any tracked move and queued path; the caller reports the stop to the host
+    for (int i = 0; i < MOTION_AXIS_COUNT; i++) {
+        _axes[i].state = AXIS_IDLE;
+    }
+    clearQueue();
+    _queuedMove = false;
+    _moveActive = false;
+    _moveFailed = false;
+    _failedAxis = 0;
+    _lastMoveFailed = true;  // A stopped move did not reach its target
+
+    // Report where the axes actually stopped, not the abandoned targets
+    if (_initialized) {
+        sampleAxes();
+    }
+
+    return true;
+}
+
+// Append a coordinated segment to the motion queue
+// update() starts it as soon as the preceding segment completes
+bool MotionControl::queueMove(int32_t x, int32_t y, int32_t z, int32_t pan) {
+    if (!_initialized || _queueCount >= MOTION_QUEUE_SIZE) {
+        return false;
+    }
+
+    // The host was still streaming the path when the queue ran dry
+    if (_queueDrained && !isQueueActive() &&
+        millis() - _queueDrainTime <= MOTION_UNDERRUN_WINDOW_MS) {
+        _queueUnderruns++;
+    }
+    _queueDrained = false;
+
+    MotionSegment &segment = _queue[(_queueHead + _queueCount) % MOTION_QUEUE_SIZE];
+    segment.x = x;
+    segment.y = y;
+    segment.z = z;
+    segment.pan = pan;
+    _queueCount++;
+
     return true;
 }
 
-// Set velocity for all motors
+// Discard queued segments (the segment in progress runs to completion)
+void MotionControl::clearQueue() {
+    _queueHead = 0;
+    _queueCount = 0;
+    _queueDrained = false;
+}
+
+// Set velocity for the X, Y and Z motors (Pan keeps its own profile)
 void MotionControl::setVelocity(int vx, int vy, int vz) {
-    _velocityX = vx;
-    _velocityY = vy;
-    _velocityZ = vz;
+    const int velocities[3] = {vx, vy, vz};
 
-    if (_initialized) {
-        MOTOR_X_AXIS.VelMax(_velocityX);
-        MOTOR_Y_AXIS.VelMax(_velocityY);
-        MOTOR_Z_AXIS.VelMax(_velocityZ);
-        // Pan uses X velocity by default
-        MOTOR_PAN_AXIS.VelMax(_velocityX);
+    for (int i = 0; i < 3; i++) {
+        _profiles[i].velocity = velocities[i];
+        if (_initialized) {
+            _axes[i].motor->VelMax(velocities[i]);
+        }
     }
 }
 
 // Set acceleration for all motors
 void MotionControl::setAcceleration(int acceleration) {
-    _accelerationLimit = acceleration;
+    for (int i = 0; i < MOTION_AXIS_COUNT; i++) {
+        _profiles[i].acceleration = acceleration;
+        if (_initialized) {
+            _axes[i].motor->AccelMax(acceleration);
+        }
+    }
+}
 
-    if (_initialized) {
-        MOTOR_X_AXIS.AccelMax(_accelerationLimit);
-        MOTOR_Y_AXIS.AccelMax(_accelerationLimit);
-        MOTOR_Z_AXIS.AccelMax(_accelerationLimit);
-        MOTOR_PAN_AXIS.AccelMax(_accelerationLimit);
+// Set the velocity, acceleration and jerk limits of one axis
+bool MotionControl::setAxisProfile(char axis, int32_t velocity, int32_t acceleration,
+                                   int32_t jerk) {
+    int index = axisIndex(axis);
+    if (index < 0 || velocity <= 0 || acceleration <= 0 || jerk < 0) {
+        return false;
     }
+
+    _profiles[index].velocity = velocity;
+    _profiles[index].acceleration = acceleration;
+    _profiles[index].jerk = jerk;
+    return true;
+}
+
+// Get the limits of one axis
+const AxisProfile *MotionControl::getAxisProfile(char axis) {
+    int index = axisIndex(axis);
+    return index >= 0 ? &_profiles[index] : nullptr;
 }
 
-// Get current position of an axis
+// Get current (commanded) position of an axis
 int32_t MotionControl::getCurrentPosition(char axis) {
-    switch (axis) {
-        case 'X':
-        case 'x':
-            return _currentX;
-        case 'Y':
-        case 'y':
-            return _currentY;
-        case 'Z':
-        case 'z':
-            return _currentZ;
-        case 'P':
-        case 'p':
-            return _currentPan;
-        case 'T':
-        case 't':
-            return _currentTilt;
-        default:
-            return 0;
+    if (axis == 'T' || axis == 't') {
+        return _currentTilt;
     }
+
+    int index = axisIndex(axis);
+    return index >= 0 ? _axisState[index].commanded : 0;
+}
+
+// Get the last position of an axis confirmed by HLFB
+int32_t MotionControl::getActualPosition(char axis) {
+    int index = axisIndex(axis);
+    return index >= 0 ? _axisState[index].actual : 0;
+}
+
+// Get the commanded velocity of an axis (steps/s)
+int32_t MotionControl::getAxisVelocity(char axis) {
+    int index = axisIndex(axis);
+    return index >= 0 ? _axisState[index].velocity : 0;
+}
+
+// Get the full sampled state of an axis
+const AxisState *MotionControl::getAxisState(char axis) {
+    int index = axisIndex(axis);
+    return index >= 0 ? &_axisState[index] : nullptr;
 }
 
 // Set the tilt servo angle limits
@@ -590,19 +946,10 @@ void MotionControl::setTiltLimits(int minAngle, int maxAngle) {
         if (_tiltServo != nullptr) {
             _tiltServo->setLimits(minAngle, maxAngle);
         }
-
-#ifdef DEBUG
-        Serial.print("Tilt limits set to min=");
-        Serial.print(_tiltMinAngle);
-        Serial.print(", max=");
-        Serial.println(_tiltMaxAngle);
-#endif
-    }
-#ifdef DEBUG
-    else {
-        Serial.println("ERROR: Invalid tilt limits");
+    } else {
+        EventLogger.log(SOURCE_MOTION, EVENT_WARNING, EVT_MOTION_TILT_LIMITS_INVALID, minAngle,
+                        maxAngle);
     }
-#endif
 }
 
 // Set the tilt servo angle
@@ -614,16 +961,10 @@ bool MotionControl::setTiltAngle(int angle) {
     // Enforce hard limits for safety
     if (angle < _tiltMinAngle) {
         angle = _tiltMinAngle;
-#ifdef DEBUG
-        Serial.print("WARNING: Tilt angle limited to minimum: ");
-        Serial.println(_tiltMinAngle);
-#endif
+        EventLogger.log(SOURCE_MOTION, EVENT_WARNING, EVT_MOTION_TILT_LIMITED, 'T', angle);
     } else if (angle > _tiltMaxAngle) {
         angle = _tiltMaxAngle;
-#ifdef DEBUG
-        Serial.print("WARNING: Tilt angle limited to maximum: ");
-        Serial.println(_tiltMaxAngle);
-#endif
+        EventLogger.log(SOURCE_MOTION, EVENT_WARNING, EVT_MOTION_TILT_LIMITED, 'T', angle);
     }
 
     bool success = _tiltServo->setAngle(angle);
@@ -645,6 +986,15 @@ bool MotionControl::isMoving() {
         return false;
     }
 
+    if (_moveActive || isHoming()) {
+        return true;
+    }
+
+    // An async tilt command not yet acknowledged counts as motion
+    if (_tiltServo != nullptr && !_tiltServo->isSettled()) {
+        return true;
+    }
+
     return !MOTOR_X_AXIS.StepsComplete() || !MOTOR_Y_AXIS.StepsComplete() ||
            !MOTOR_Z_AXIS.StepsComplete() || !MOTOR_PAN_AXIS.StepsComplete();
 }
@@ -689,10 +1039,468 @@ bool MotionControl::hasError() {
            MOTOR_PAN_AXIS.StatusReg().bit.AlertsPresent;
 }
 
-// Update method for continuous operations
+// Axes whose HLFB is asserted (move complete / in position)
+uint8_t MotionControl::getHlfbMask() {
+    uint8_t mask = 0;
+    if (!_initialized) {
+        return mask;
+    }
+
+    for (int i = 0; i < MOTION_AXIS_COUNT; i++) {
+        if (_axisState[i].hlfb) {
+            mask |= 1 << i;
+        }
+    }
+    return mask;
+}
+
+// Axes with alerts present
+uint8_t MotionControl::getAlertMask() {
+    uint8_t mask = 0;
+    if (!_initialized) {
+        return mask;
+    }
+
+    for (int i = 0; i < MOTION_AXIS_COUNT; i++) {
+        if (_axisState[i].alert) {
+            mask |= 1 << i;
+        }
+    }
+    return mask;
+}
+
+// Advance the non-blocking motion engine
 void MotionControl::update() {
-    // This method can be used for continuous operations
-    // like checking for limit switches, updating status, etc.
+    if (!_initialized) {
+        return;
+    }
+
+    sampleAxes();
+
+    if (_moveActive) {
+        bool axesActive = false;
+        bool axesMoving = false;
+
+        for (int i = 0; i < MOTION_AXIS_COUNT; i++) {
+            AxisMove &axis = _axes[i];
+            if (axis.state == AXIS_IDLE) {
+                continue;
+            }
+
+            MotorDriver *motor = axis.motor;
+
+            // Alerts (including motors disabled by ESTOP) abort the axis move
+            if (motor->StatusReg().bit.AlertsPresent) {
+                logAlerts(*motor);
+                failAxisMove(axis);
+                continue;
+            }
+
+            if (axis.state == AXIS_MOVING && axis.jerk > 0 && !axis.landed) {
+                shapeAxisMove(axis);
+            }
+
+            if (axis.state == AXIS_MOVING && motor->StepsComplete()) {
+                axis.state = AXIS_SETTLING;
+                axis.settleStartTime = millis();
+            }
+
+            if (axis.state == AXIS_SETTLING) {
+                if (motor->HlfbState() == MotorDriver::HLFB_ASSERTED) {
+                    axis.state = AXIS_IDLE;
+                } else if (millis() - axis.settleStartTime > MOVE_SETTLE_TIMEOUT_MS) {
+                    EventLogger.log(SOURCE_MOTION, EVENT_ERROR, EVT_MOTION_SETTLE_TIMEOUT,
+                                    axis.name);
+                    failAxisMove(axis);
+                    continue;
+                }
+            }
+
+            if (axis.state == AXIS_MOVING) {
+                axesMoving = true;
+            }
+            if (axis.state != AXIS_IDLE) {
+                axesActive = true;
+            }
+        }
+
+        if (!axesActive) {
+            finishMove();
+        } else if (_queuedMove && !axesMoving && !_moveFailed && _queueCount > 0) {
+            // Lookahead: all steps of this segment are out, so start the next one while
+            // the motors settle instead of leaving a gap between queued waypoints
+            for (int i = 0; i < MOTION_AXIS_COUNT; i++) {
+                if (_axes[i].state == AXIS_SETTLING) {
+                    _axes[i].state = AXIS_IDLE;
+                }
+            }
+            _moveActive = false;
+            _queueCompleted++;
+            startNextSegment();
+        }
+    }
+
+    // Homing runs instead of moves
+    if (isHoming()) {
+        bool running = false;
+        for (int i = 0; i < MOTION_AXIS_COUNT; i++) {
+            if (_homing[i].phase > HOME_WAITING && _homing[i].phase < HOME_DONE) {
+                updateHoming(i);
+                running |= _homing[i].phase > HOME_WAITING && _homing[i].phase < HOME_DONE;
+            }
+        }
+
+        // Sequential homing: start the next axis once the previous one is done
+        for (int i = 0; i < MOTION_AXIS_COUNT && !running; i++) {
+            if (_homing[i].phase == HOME_WAITING) {
+                startHoming(i);
+                running = true;
+            }
+        }
+        return;
+    }
+
+    // Feed the next queued segment as soon as the motion engine is free
+    if (!_moveActive && _queueCount > 0) {
+        startNextSegment();
+    }
+}
+
+// Find the move tracking entry for a step and direction axis
+MotionControl::AxisMove *MotionControl::findAxis(char axis) {
+    switch (axis) {
+        case 'X':
+        case 'x':
+            return &_axes[0];
+        case 'Y':
+        case 'y':
+            return &_axes[1];
+        case 'Z':
+        case 'z':
+            return &_axes[2];
+        case 'P':
+        case 'p':
+            return &_axes[3];
+        default:
+            return nullptr;
+    }
+}
+
+// Clear any alerts on an axis before commanding a move
+bool MotionControl::prepareAxisMove(AxisMove &axis) {
+    MotorDriver *motor = axis.motor;
+
+    if (motor->StatusReg().bit.AlertsPresent) {
+        logAlerts(*motor);
+        return handleAlerts(*motor);
+    }
+
+    return true;
+}
+
+// Command a move on one axis with the given limits and start tracking it
+void MotionControl::startAxisMove(AxisMove &axis, int32_t position, const AxisProfile &profile) {
+    MotorDriver *motor = axis.motor;
+
+    axis.accelLimit = profile.acceleration;
+    axis.jerk = profile.jerk;
+    axis.rampAccel = profile.acceleration;
+
+    // Jerk limited: start with one step's worth of acceleration, update() raises it
+    if (profile.jerk > 0) {
+        int64_t firstStep = static_cast<int64_t>(profile.jerk) * MOTION_JERK_STEP_MS / 1000;
+        if (firstStep < 1) {
+            firstStep = 1;
+        }
+        if (firstStep < profile.acceleration) {
+            axis.rampAccel = static_cast<int32_t>(firstStep);
+        }
+    }
+    axis.rampStartTime = millis();
+    axis.rampStepTime = axis.rampStartTime;
+    axis.lastVelocity = 0;
+    axis.stopping = false;
+    axis.landed = false;
+    axis.direction = position >= motor->PositionRefCommanded() ? 1 : -1;
+
+    // Limits are latched when the move is commanded
+    motor->VelMax(profile.velocity);
+    motor->AccelMax(axis.rampAccel);
+
+    // Command the absolute move
+    motor->Move(position, MotorDriver::MOVE_TARGET_ABSOLUTE);
+
+    axis.target = position;
+    axis.state = AXIS_MOVING;
+
+    // A new axis joins the current move; a fresh move starts with a clean result
+    if (!_moveActive) {
+        _moveActive = true;
+        _moveFailed = false;
+        _failedAxis = 0;
+        _lastMoveFailed = false;
+    }
+}
+
+// Shape a jerk-limited move every MOTION_JERK_STEP_MS (MOTION_STOP_STEP_MS
+// while stopping): raise the acceleration
+// at the start, then take the stop over from the driver once the remaining
+// distance is down to the S-curve stopping distance
+void MotionControl::shapeAxisMove(AxisMove &axis) {
+    unsigned long now = millis();
+    if (now - axis.rampStepTime < (axis.stopping ? MOTION_STOP_STEP_MS : MOTION_JERK_STEP_MS)) {
+        return;
+    }
+    axis.rampStepTime = now;
+
+    MotorDriver *motor = axis.motor;
+    int32_t speed = abs(motor->VelocityRefCommanded());
+    float distance =
+        static_cast<float>(axis.target - motor->PositionRefCommanded()) * axis.direction;
+
+    if (!axis.stopping && speed > 0) {
+        // One step ahead, so the stop begins before the driver starts its own
+        float lookahead = speed * (MOTION_JERK_STEP_MS / 1000.0f);
+        if (speed < axis.lastVelocity ||
+            distance <= stopDistance(speed, axis.accelLimit, axis.jerk) + lookahead) {
+            axis.stopping = planAxisStop(axis, speed, distance);
+            if (!axis.stopping) {
+                axis.landed = true;  // Too late to taper: the driver's trapezoid finishes
+                return;
+            }
+        }
+    }
+
+    if (axis.stopping) {
+        taperAxisStop(axis, speed, distance);
+    } else if (axis.rampAccel < axis.accelLimit) {
+        rampAxisAcceleration(axis, now, speed);
+    }
+}
+
+// Raise the acceleration of a jerk-limited move by one step
+// The new limit is applied on the fly by re-issuing the move to the same target
+void MotionControl::rampAxisAcceleration(AxisMove &axis, unsigned long now, int32_t speed) {
+    MotorDriver *motor = axis.motor;
+
+    // The driver has started to slow down: no more onset steps
+    if (speed < axis.lastVelocity) {
+        axis.rampAccel = axis.accelLimit;
+        return;
+    }
+    axis.lastVelocity = speed;
+
+    int64_t accel = static_cast<int64_t>(axis.jerk) * (now - axis.rampStartTime) / 1000;
+    if (accel >= axis.accelLimit) {
+        accel = axis.accelLimit;
+    }
+    if (accel <= axis.rampAccel) {
+        return;
+    }
+
+    axis.rampAccel = static_cast<int32_t>(accel);
+    motor->AccelMax(axis.rampAccel);
+    motor->Move(axis.target, MotorDriver::MOVE_TARGET_ABSOLUTE);
+}
+
+// Distance of a symmetric jerk-limited stop from speed: the deceleration ramps
+// up, holds (when the peak reaches the limit) and ramps down again
+float MotionControl::stopDistance(float speed, float acceleration, float jerk) {
+    float peak = sqrtf(speed * jerk);
+    if (peak > acceleration) {
+        peak = acceleration;
+    }
+    return speed * 0.5f * (speed / peak + peak / jerk);
+}
+
+// Plan the stop from the current speed over the remaining distance. A stop that
+// begins late (a short move, or the driver already slowing) uses the jerk that
+// fits the distance; false if not even the acceleration limit fits any more
+bool MotionControl::planAxisStop(AxisMove &axis, float speed, float distance) {
+    float acceleration = axis.accelLimit;
+    float jerk = axis.jerk;
+
+    if (stopDistance(speed, acceleration, jerk) > distance) {
+        if (distance * acceleration <= 0.5f * speed * speed) {
+            return false;
+        }
+        if (distance * acceleration <= speed * speed) {
+            jerk = speed * acceleration / (2.0f * distance - speed * speed / acceleration);
+        } else {
+            jerk = speed * speed * speed / (distance * distance);
+        }
+    }
+
+    float peak = sqrtf(speed * jerk);
+    if (peak > acceleration) {
+        peak = acceleration;
+    }
+    float ramp = peak / jerk;
+    float rampSpeed = 0.5f * jerk * ramp * ramp;  // Speed lost in each jerk phase
+    float brakeSpeed = speed - rampSpeed;
+
+    axis.stopSpeed = speed;
+    axis.stopJerk = jerk;
+    axis.stopAccel = peak;
+    axis.stopRamp = ramp;
+    axis.stopTail = jerk * ramp * ramp * ramp / 6.0f;
+    axis.stopBrake =
+        axis.stopTail + (brakeSpeed * brakeSpeed - rampSpeed * rampSpeed) / (2.0f * peak);
+    axis.stopLength = axis.stopBrake + speed * ramp - jerk * ramp * ramp * ramp / 6.0f;
+    return true;
+}
+
+// Speed of the planned stop at a remaining distance
+float MotionControl::stopSpeedAt(const AxisMove &axis, float distance) {
+    float jerk = axis.stopJerk;
+
+    if (distance <= 0.0f) {
+        return 0.0f;
+    }
+    if (distance < axis.stopTail) {
+        // Deceleration ramping down to zero at the target
+        float time = cbrtf(6.0f * distance / jerk);
+        return 0.5f * jerk * time * time;
+    }
+    if (distance < axis.stopBrake) {
+        float tailSpeed = 0.5f * jerk * axis.stopRamp * axis.stopRamp;
+        return sqrtf(tailSpeed * tailSpeed + 2.0f * axis.stopAccel * (distance - axis.stopTail));
+    }
+    if (distance < axis.stopLength) {
+        // Deceleration ramping up: solve for the time since the stop began
+        float travelled = axis.stopLength - distance;
+        float time = travelled / axis.stopSpeed;
+        for (int i = 0; i < 4; i++) {
+            float error = axis.stopSpeed * time - jerk * time * time * time / 6.0f - travelled;
+            time -= error / (axis.stopSpeed - 0.5f * jerk * time * time);
+        }
+        if (time > axis.stopRamp) {
+            time = axis.stopRamp;
+        }
+        return axis.stopSpeed - 0.5f * jerk * time * time;
+    }
+    return axis.stopSpeed;
+}
+
+// Follow the planned stop with velocity commands, each reaching the speed due
+// one step ahead at the deceleration that gets there; the last step is a
+// positional move at crawl speed, which lands on the target exactly
+void MotionControl::taperAxisStop(AxisMove &axis, float speed, float distance) {
+    MotorDriver *motor = axis.motor;
+    const float step = MOTION_STOP_STEP_MS / 1000.0f;
+
+    if (distance <= speed * step + 1.0f) {
+        motor->VelMax(speed >= 1.0f ? static_cast<int32_t>(speed) : 1);
+        motor->AccelMax(axis.accelLimit);
+        motor->Move(axis.target, MotorDriver::MOVE_TARGET_ABSOLUTE);
+        axis.stopping = false;
+        axis.landed = true;
+        return;
+    }
+
+    float next = stopSpeedAt(axis, distance - speed * step);
+    if (next >= speed) {
+        return;  // Not on the curve yet: the positional move keeps cruising
+    }
+    if (next < 1.0f) {
+        next = 1.0f;
+    }
+
+    float decel = (speed - next) / step;
+    if (decel > axis.accelLimit) {
+        decel = axis.accelLimit;
+    }
+    if (decel < 1.0f) {
+        decel = 1.0f;
+    }
+
+    motor->AccelMax(static_cast<int32_t>(decel));
+    motor->MoveVelocity(static_cast<int32_t>(next) * axis.direction);
+}
+
+// Mark an axis move as failed
+void MotionControl::failAxisMove(AxisMove &axis) {
+    axis.state = AXIS_IDLE;
+    if (!_moveFailed) {
+        _moveFailed = true;
+        _failedAxis = axis.name;
+    }
+}
+
+// Index of a step and direction axis in _axes / _axisState, or -1
+int MotionControl::axisIndex(char axis) {
+    AxisMove *move = findAxis(axis);
+    return move ? static_cast<int>(move - _axes) : -1;
+}
+
+// Refresh the live position model from the drivers
+void MotionControl::sampleAxes() {
+    for (int i = 0; i < MOTION_AXIS_COUNT; i++) {
+        MotorDriver *motor = _axes[i].motor;
+        AxisState &state = _axisState[i];
+
+        state.commanded = motor->PositionRefCommanded();
+        state.velocity = motor->VelocityRefCommanded();
+        state.hlfb = motor->HlfbState() == MotorDriver::HLFB_ASSERTED;
+        state.alert = motor->StatusReg().bit.AlertsPresent;
+        state.inPosition = state.hlfb && !state.alert && motor->StepsComplete();
+        if (state.inPosition) {
+            state.actual = state.commanded;
+        }
+    }
+}
+
+// All axes of the current move are idle: report the result
+void MotionControl::finishMove() {
+    _moveActive = false;
+
+    if (_queuedMove) {
+        if (_moveFailed) {
+            // A failed segment invalidates the rest of the queued path
+            clearQueue();
+        } else {
+            _queueCompleted++;
+            if (_queueCount > 0) {
+                // More segments pending: update() feeds the next one, nothing to report yet
+                return;
+            }
+            // Queue ran dry: an underrun only if the next MOVEQ follows closely
+            _queueDrained = true;
+            _queueDrainTime = millis();
+        }
+        _queuedMove = false;
+    }
+
+    _lastMoveFailed = _moveFailed;
+
+    if (_eventCallback) {
+        if (_moveFailed) {
+            _eventCallback(MOTION_EVENT_MOVE_FAILED, _failedAxis);
+        } else {
+            _eventCallback(MOTION_EVENT_MOVE_DONE, 0);
+        }
+    }
+
+    _moveFailed = false;
+    _failedAxis = 0;
+}
+
+// Pop the next queued segment and start it as a coordinated move
+void MotionControl::startNextSegment() {
+    MotionSegment segment = _queue[_queueHead];
+    _queueHead = (_queueHead + 1) % MOTION_QUEUE_SIZE;
+    _queueCount--;
+    _queuedMove = true;
+
+    if (!moveCoordinated(segment.x, segment.y, segment.z, segment.pan)) {
+        // Nothing was commanded (moveCoordinated validates all axes first)
+        _moveFailed = true;
+        _failedAxis = 0;
+        finishMove();
+    } else if (!_moveActive) {
+        // Segment did not move any axis
+        finishMove();
+    }
 }
 
 // Helper function to wait for HLFB to assert
@@ -708,46 +1516,33 @@ bool MotionControl::waitForHlfb(MotorDriver &motor, uint32_t timeoutMs) {
     }
 
     if (motor.StatusReg().bit.AlertsPresent) {
-        printAlerts(motor);
+        logAlerts(motor);
         return handleAlerts(motor);
     }
 
     return true;
 }
 
-// Print any active alerts for a motor
-void MotionControl::printAlerts(MotorDriver &motor) {
-#ifdef DEBUG
-    Serial.println("Alerts present: ");
-    if (motor.AlertReg().bit.MotionCanceledInAlert) {
-        Serial.println("    MotionCanceledInAlert");
-    }
-    if (motor.AlertReg().bit.MotionCanceledPositiveLimit) {
-        Serial.println("    MotionCanceledPositiveLimit");
-    }
-    if (motor.AlertReg().bit.MotionCanceledNegativeLimit) {
-        Serial.println("    MotionCanceledNegativeLimit");
-    }
-    if (motor.AlertReg().bit.MotionCanceledSensorEStop) {
-        Serial.println("    MotionCanceledSensorEStop");
-    }
-    if (motor.AlertReg().bit.MotionCanceledMotorDisabled) {
-        Serial.println("    MotionCanceledMotorDisabled");
-    }
-    if (motor.AlertReg().bit.MotorFaulted) {
-        Serial.println("    MotorFaulted");
+// Axis letter of a motor connector (for log records)
+char MotionControl::motorAxisName(MotorDriver &motor) {
+    for (int i = 0; i < MOTION_AXIS_COUNT; i++) {
+        if (_axes[i].motor == &motor) {
+            return _axes[i].name;
+        }
     }
-#endif
+    return '?';
+}
+
+// Log the active alerts of a motor (value = alert register bits)
+void MotionControl::logAlerts(MotorDriver &motor) {
+    EventLogger.log(SOURCE_MOTION, EVENT_WARNING, EVT_MOTION_ALERT, motorAxisName(motor),
+                    motor.AlertReg().reg);
 }
 
 // Handle motor alerts
 bool MotionControl::handleAlerts(MotorDriver &motor) {
     if (motor.AlertReg().bit.MotorFaulted) {
-// Clear motor fault by cycling enable
-#ifdef DEBUG
-        Serial.println("Faults present. Cycling enable signal to motor to clear faults.");
-#endif
-
+        // Clear motor fault by cycling enable
         motor.EnableRequest(false);
         delay(10);
         motor.EnableRequest(true);
@@ -760,17 +1555,14 @@ bool MotionControl::handleAlerts(MotorDriver &motor) {
         }
 
         if (motor.HlfbState() != MotorDriver::HLFB_ASSERTED) {
-#ifdef DEBUG
-            Serial.println("Failed to clear motor fault");
-#endif
+            EventLogger.log(SOURCE_MOTION, EVENT_ERROR, EVT_MOTION_FAULT_STUCK,
+                            motorAxisName(motor));
             return false;
         }
+        EventLogger.log(SOURCE_MOTION, EVENT_INFO, EVT_MOTION_FAULT_CLEARED, motorAxisName(motor));
     }
 
-// Clear any remaining alerts
-#ifdef DEBUG
-    Serial.println("Clearing alerts");
-#endif
+    // Clear any remaining alerts
     motor.ClearAlerts();
 
     return true;
@@ -0,0 +1,451 @@
+/**
+ * Space Maquette - Motion Trace Implementation
+ */
+
+#include "motion_trace.h"
+
+#include "crc16.h"
+#include "event_log.h"
+
+static_assert(sizeof(MotionTrace::Sample) == MotionTrace::SAMPLE_SIZE,
+              "MotionTrace::Sample must stay 32 bytes");
+static_assert(TRACE_DEFAULT_POST < TRACE_CAPACITY, "TRACE_DEFAULT_POST must leave room for history");
+
+// Little endian field writers for the blob
+static uint8_t* putU16(uint8_t* out, uint16_t value) {
+    out[0] = value & 0xFF;
+    out[1] = value >> 8;
+    return out + 2;
+}
+
+static uint8_t* putU32(uint8_t* out, uint32_t value) {
+    for (int i = 0; i < 4; i++) {
+        out[i] = (value >> (8 * i)) & 0xFF;
+    }
+    return out + 4;
+}
+
+// Alert register of a motor connector (the low 16 bits carry every alert)
+static uint16_t alertBits(int axis) {
+    switch (axis) {
+        case 0:
+            return MOTOR_X_AXIS.AlertReg().reg & 0xFFFF;
+        case 1:
+            return MOTOR_Y_AXIS.AlertReg().reg & 0xFFFF;
+        case 2:
+            return MOTOR_Z_AXIS.AlertReg().reg & 0xFFFF;
+        default:
+            return MOTOR_PAN_AXIS.AlertReg().reg & 0xFFFF;
+    }
+}
+
+static const char AXIS_LETTERS[MOTION_AXIS_COUNT] = {'X', 'Y', 'Z', 'P'};
+
+MotionTrace::MotionTrace(MotionControl& motion, EmergencyStop& estop)
+    : _motion(motion),
+      _estop(estop),
+      _state(TRACE_IDLE),
+      _triggers(0),
+      _cause(0),
+      _period(TRACE_DEFAULT_PERIOD_MS),
+      _postSamples(TRACE_DEFAULT_POST),
+      _captureId(0),
+      _head(0),
+      _count(0),
+      _total(0),
+      _triggerTotal(0),
+      _postRemaining(0),
+      _triggerTime(0),
+      _lastSample(0),
+      _wasActive(false),
+      _wasMoving(false),
+      _wasFailed(false),
+      _wasEstop(false),
+      _lastAlerts(0),
+      _blobCRC(0),
+      _saveState(SAVE_IDLE),
+      _saveRow(0) {
+    _savePath[0] = '\0';
+}
+
+void MotionTrace::setPeriod(uint16_t periodMs) {
+    _period = periodMs > 0 ? periodMs : 1;
+}
+
+void MotionTrace::setPostSamples(uint16_t samples) {
+    // At least the trigger sample itself stays in the buffer
+    _postSamples = samples < TRACE_CAPACITY ? samples : TRACE_CAPACITY - 1;
+}
+
+void MotionTrace::arm(uint8_t triggers) {
+    if (_saveState == SAVE_RUNNING) {
+        finishSave(false);
+    }
+
+    _triggers = triggers;
+    _cause = 0;
+    _head = 0;
+    _count = 0;
+    _total = 0;
+    _triggerTotal = 0;
+    _postRemaining = 0;
+    _triggerTime = 0;
+    _lastSample = millis();
+
+    // Conditions already present when armed are not edges
+    _wasMoving = _motion.isMoving();
+    _wasActive = _wasMoving || _motion.isHoming();
+    _wasFailed = _motion.lastMoveFailed();
+    _wasEstop = _estop.isActive();
+    _lastAlerts = _motion.getAlertMask();
+
+    _state = TRACE_ARMED;
+
+#ifdef DEBUG
+    Serial.print("Motion trace armed, triggers 0x");
+    Serial.println(triggers, HEX);
+#endif
+}
+
+bool MotionTrace::trigger() {
+    if (_state != TRACE_ARMED) {
+        return false;
+    }
+
+    bool moving = _motion.isMoving();
+    startCapture(TRACE_TRIG_MANUAL, moving, _motion.isHoming(), _estop.isActive());
+    return true;
+}
+
+void MotionTrace::stop() {
+    if (_saveState == SAVE_RUNNING) {
+        finishSave(false);
+    }
+
+    _state = TRACE_IDLE;
+    _count = 0;
+    _cause = 0;
+}
+
+void MotionTrace::update() {
+    if (_state != TRACE_ARMED && _state != TRACE_TRIGGERED) {
+        return;
+    }
+
+    bool moving = _motion.isMoving();
+    bool homing = _motion.isHoming();
+    bool active = moving || homing;
+    bool estop = _estop.isActive();
+    bool failed = _motion.lastMoveFailed();
+    uint8_t alerts = _motion.getAlertMask();
+    unsigned long now = millis();
+
+    if (_state == TRACE_ARMED) {
+        uint8_t cause = 0;
+        if (active && !_wasActive) {
+            cause |= TRACE_TRIG_MOVE;
+        }
+        if (alerts & ~_lastAlerts) {
+            cause |= TRACE_TRIG_ALERT;
+        }
+        if (estop && !_wasEstop) {
+            cause |= TRACE_TRIG_ESTOP;
+        }
+        // A move that ends failed, even right after another failure
+        if (failed && (!_wasFailed || (_wasMoving && !moving))) {
+            cause |= TRACE_TRIG_FAIL;
+        }
+        cause &= _triggers;
+
+        if (cause) {
+            startCapture(cause, moving, homing, estop);
+        } else if (active && (!_wasActive || now - _lastSample >= _period)) {
+            takeSample(moving, homing, estop);
+        } else if (!active && _wasActive) {
+            // Where the motion ended
+            takeSample(moving, homing, estop);
+        }
+    } else if (now - _lastSample >= _period) {
+        takeSample(moving, homing, estop);
+        if (--_postRemaining == 0) {
+            freeze();
+        }
+    }
+
+    _wasActive = active;
+    _wasMoving = moving;
+    _wasFailed = failed;
+    _wasEstop = estop;
+    _lastAlerts = alerts;
+}
+
+void MotionTrace::takeSample(bool moving, bool homing, bool estop) {
+    Sample& sample = _samples[_head];
+    sample.time = millis();
+    for (int i = 0; i < MOTION_AXIS_COUNT; i++) {
+        const AxisState* state = _motion.getAxisState(AXIS_LETTERS[i]);
+        sample.commanded[i] = state ? state->commanded : 0;
+        sample.alerts[i] = alertBits(i);
+    }
+    sample.tilt = (int16_t)(_motion.getTiltAngle() * 100.0f);
+    sample.hlfb = _motion.getHlfbMask();
+    sample.flags = (moving ? TRACE_FLAG_MOVING : 0) | (homing ? TRACE_FLAG_HOMING : 0) |
+                   (estop ? TRACE_FLAG_ESTOP : 0);
+
+    _head = (_head + 1) % TRACE_CAPACITY;
+    if (_count < TRACE_CAPACITY) {
+        _count++;
+    }
+    _total++;
+    _lastSample = sample.time;
+}
+
+void MotionTrace::startCapture(uint8_t cause, bool moving, bool homing, bool estop) {
+    _cause = cause;
+    _state = TRACE_TRIGGERED;
+
+    takeSample(moving, homing, estop);
+    _triggerTotal = _total - 1;
+    _triggerTime = _lastSample;
+    _postRemaining = _postSamples;
+
+    if (_postRemaining == 0) {
+        freeze();
+    }
+}
+
+void MotionTrace::freeze() {
+    _state = TRACE_DONE;
+
+    // The CRC is fixed once frozen; readers only copy bytes
+    uint8_t block[SAMPLE_SIZE];
+    writeHeader(block);
+    uint16_t crc = crc16Update(CRC16_INIT, block, HEADER_SIZE);
+    for (uint16_t i = 0; i < _count; i++) {
+        writeSample(sampleAt(i), block);
+        crc = crc16Update(crc, block, SAMPLE_SIZE);
+    }
+    _blobCRC = crc;
+    _captureId++;
+
+    EventLogger.log(SOURCE_MOTION, EVENT_INFO, EVT_MOTION_TRACE_CAPTURED, _cause, _count);
+
+#ifdef DEBUG
+    Serial.print("Motion trace captured: ");
+    Serial.print(_count);
+    Serial.print(" samples, cause 0x");
+    Serial.println(_cause, HEX);
+#endif
+}
+
+const MotionTrace::Sample& MotionTrace::sampleAt(uint16_t index) const {
+    return _samples[(_head + TRACE_CAPACITY - _count + index) % TRACE_CAPACITY];
+}
+
+uint16_t MotionTrace::triggerIndex() const {
+    if (_cause == 0) {
+        return NO_TRIGGER;
+    }
+    return (uint16_t)(_triggerTotal - (_total - _count));
+}
+
+uint32_t MotionTrace::getBlobSize() const {
+    return HEADER_SIZE + (uint32_t)_count * SAMPLE_SIZE + 2;
+}
+
+void MotionTrace::writeHeader(uint8_t* out) const {
+    memcpy(out, "MTRC", 4);
+    out[4] = BLOB_VERSION;
+    out[5] = SAMPLE_SIZE;
+    uint8_t* p = putU16(out + 6, _count);
+    p = putU16(p, _period);
+    p = putU16(p, triggerIndex());
+    *p++ = _triggers;
+    *p++ = _cause;
+    p = putU16(p, 0);
+    putU32(p, _triggerTime);
+}
+
+void MotionTrace::writeSample(const Sample& sample, uint8_t* out) {
+    uint8_t* p = putU32(out, sample.time);
+    for (int i = 0; i < MOTION_AXIS_COUNT; i++) {
+        p = putU32(p, (uint32_t)sample.commanded[i]);
+    }
+    for (int i = 0; i < MOTION_AXIS_COUNT; i++) {
+        p = putU16(p, sample.alerts[i]);
+    }
+    p = putU16(p, (uint16_t)sample.tilt);
+    *p++ = sample.hlfb;
+    *p = sample.flags;
+}
+
+size_t MotionTrace::readBlob(uint32_t offset, uint8_t* buffer, size_t size) const {
+    uint32_t samplesEnd = HEADER_SIZE + (uint32_t)_count * SAMPLE_SIZE;
+    uint8_t block[SAMPLE_SIZE];
+    size_t copied = 0;
+
+    // Serialize the header, sample or CRC holding offset, then copy from it
+    while (copied < size && offset < samplesEnd + 2) {
+        uint32_t start;
+        size_t length;
+        if (offset < HEADER_SIZE) {
+            writeHeader(block);
+            start = 0;
+            length = HEADER_SIZE;
+        } else if (offset < samplesEnd) {
+            uint16_t index = (offset - HEADER_SIZE) / SAMPLE_SIZE;
+            writeSample(sampleAt(index), block);
+            start = HEADER_SIZE + (uint32_t)index * SAMPLE_SIZE;
+            length = SAMPLE_SIZE;
+        } else {
+            putU16(block, _blobCRC);
+            start = samplesEnd;
+            length = 2;
+        }
+
+        size_t count = start + length - offset;
+        if (count > size - copied) {
+            count = size - copied;
+        }
+        memcpy(buffer + copied, block + (offset - start), count);
+        copied += count;
+        offset += count;
+    }
+
+    return copied;
+}
+
+const char* MotionTrace::getCsvHeader() {
+    return "t_ms,x,y,z,pan,tilt,hlfb,alert_x,alert_y,alert_z,alert_pan,flags\r\n";
+}
+
+int MotionTrace::getCsvRow(uint16_t index, char* buffer, size_t size) const {
+    if (index >= _count) {
+        return 0;
+    }
+
+    // Times relative to the trigger (to the first sample without one)
+    const Sample& sample = sampleAt(index);
+    uint32_t origin = _cause ? _triggerTime : sampleAt(0).time;
+    int length = snprintf(buffer, size, "%ld,%ld,%ld,%ld,%ld,%.2f,%X,%04X,%04X,%04X,%04X,%X\r\n",
+                          (long)(int32_t)(sample.time - origin), (long)sample.commanded[0],
+                          (long)sample.commanded[1], (long)sample.commanded[2],
+                          (long)sample.commanded[3], sample.tilt / 100.0f, sample.hlfb,
+                          sample.alerts[0], sample.alerts[1], sample.alerts[2], sample.alerts[3],
+                          sample.flags);
+    return length > 0 && length < (int)size ? length : 0;
+}
+
+bool MotionTrace::saveCsv(const char* path) {
+    if (_state != TRACE_DONE || _saveState == SAVE_RUNNING) {
+        return false;
+    }
+
+    strncpy(_savePath, path, sizeof(_savePath) - 1);
+    _savePath[sizeof(_savePath) - 1] = '\0';
+
+    // FILE_WRITE appends, so replace any earlier trace
+    if (SD.exists(_savePath)) {
+        SD.remove(_savePath);
+    }
+    _saveFile = SD.open(_savePath, FILE_WRITE);
+    if (!_saveFile) {
+        _saveState = SAVE_FAILED;
+        return false;
+    }
+
+    _saveRow = 0;
+    _saveState = SAVE_RUNNING;
+    return true;
+}
+
+void MotionTrace::updateSave() {
+    if (_saveState != SAVE_RUNNING) {
+        return;
+    }
+
+    // Whole rows up to one sector per call
+    size_t used = 0;
+    char row[96];
+    while (_saveRow <= _count) {
+        int length = _saveRow == 0 ? (int)strlen(getCsvHeader())
+                                   : getCsvRow(_saveRow - 1, row, sizeof(row));
+        if (used + length > sizeof(_saveBuffer)) {
+            break;
+        }
+        memcpy(_saveBuffer + used, _saveRow == 0 ? getCsvHeader() : row, length);
+        used += length;
+        _saveRow++;
+    }
+
+    if (used > 0 && _saveFile.write(reinterpret_cast<const uint8_t*>(_saveBuffer), used) != used) {
+        finishSave(false);
+        return;
+    }
+
+    if (_saveRow > _count) {
+        finishSave(true);
+    }
+}
+
+void MotionTrace::finishSave(bool success) {
+    _saveFile.close();
+    _saveState = success ? SAVE_DONE : SAVE_FAILED;
+
+#ifdef DEBUG
+    Serial.print(success ? "Motion trace saved: " : "ERROR: Motion trace save failed: ");
+    Serial.println(_savePath);
+#endif
+}
+
+int MotionTrace::parseTrigger(const char* name) {
+    if (strcmp(name, "MOVE") == 0) {
+        return TRACE_TRIG_MOVE;
+    } else if (strcmp(name, "ALERT") == 0) {
+        return TRACE_TRIG_ALERT;
+    } else if (strcmp(name, "ESTOP") == 0) {
+        return TRACE_TRIG_ESTOP;
+    } else if (strcmp(name, "FAIL") == 0) {
+        return TRACE_TRIG_FAIL;
+    }
+    return -1;
+}
+
+int MotionTrace::parseTriggers(const char* list) {
+    int mask = 0;
+    char name[8];
+
+    while (*list) {
+        const char* end = strchr(list, ',');
+        size_t length = end ? (size_t)(end - list) : strlen(list);
+        if (length >= sizeof(name)) {
+            return -1;
+        }
+        memcpy(name, list, length);
+        name[length] = '\0';
+
+        if (length > 0) {
+            int trigger = parseTrigger(name);
+            if (trigger < 0) {
+                return -1;
+            }
+            mask |= trigger;
+        }
+        list += end ? length + 1 : length;
+    }
+
+    return mask;
+}
+
+const char* MotionTrace::getStateName(State state) {
+    switch (state) {
+        case TRACE_ARMED:
+            return "ARMED";
+        case TRACE_TRIGGERED:
+            return "TRIGGERED";
+        case TRACE_DONE:
+            return "DONE";
+        default:
+            return "IDLE";
+    }
+}
@@ -0,0 +1,121 @@
+/**
+ * Space Maquette - Performance Monitor Implementation
+ */
+
+#include "perf_monitor.h"
+
+#ifdef PERF_MONITORING_ENABLED
+
+PerfMonitor Profiler;
+
+// Stage names, in PerfStage order
+static const char* const STAGE_NAMES[PERF_STAGE_COUNT] = {
+    "LOOP", "ETHERNET", "WEB", "ESTOP", "PARSER", "MOTION",
+    "SERIAL", "COMMANDS", "SCANNER", "TELEMETRY", "LOG"};
+
+PerfMonitor::PerfMonitor() : _lastLoop(0), _loopStarted(false) {
+    for (int i = 0; i < PERF_MAX_COMMANDS; i++) {
+        _commandNames[i] = nullptr;
+    }
+    reset();
+}
+
+void PerfMonitor::begin() {
+    // Enable trace, then the free-running cycle counter
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CYCCNT = 0;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+    _loopStarted = false;
+}
+
+void PerfMonitor::recordStage(PerfStage stage, uint32_t cycles) {
+    if (stage < PERF_STAGE_COUNT) {
+        record(_stages[stage], cycles);
+    }
+}
+
+void PerfMonitor::recordCommand(int index, uint32_t cycles) {
+    if (index >= 0 && index < PERF_MAX_COMMANDS) {
+        record(_commands[index], cycles);
+    }
+}
+
+void PerfMonitor::markLoop() {
+    uint32_t now = cycles();
+    if (_loopStarted) {
+        record(_stages[PERF_LOOP], now - _lastLoop);
+    }
+    _lastLoop = now;
+    _loopStarted = true;
+}
+
+void PerfMonitor::setCommandName(int index, const char* name) {
+    if (index >= 0 && index < PERF_MAX_COMMANDS) {
+        _commandNames[index] = name;
+    }
+}
+
+const char* PerfMonitor::getStatName(int index) const {
+    if (index < 0) {
+        return nullptr;
+    }
+    if (index < PERF_STAGE_COUNT) {
+        return STAGE_NAMES[index];
+    }
+    index -= PERF_STAGE_COUNT;
+    return index < PERF_MAX_COMMANDS ? _commandNames[index] : nullptr;
+}
+
+const PerfMonitor::Stat* PerfMonitor::getStat(int index) const {
+    if (index < 0) {
+        return nullptr;
+    }
+    if (index < PERF_STAGE_COUNT) {
+        return &_stages[index];
+    }
+    index -= PERF_STAGE_COUNT;
+    return index < PERF_MAX_COMMANDS ? &_commands[index] : nullptr;
+}
+
+// Index of a stage or command by name, or -1
+int PerfMonitor::findStat(const char* name) const {
+    for (int i = 0; i < getStatCount(); i++) {
+        const char* statName = getStatName(i);
+        if (statName && strcmp(statName, name) == 0) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+void PerfMonitor::reset() {
+    for (int i = 0; i < PERF_STAGE_COUNT; i++) {
+        clear(_stages[i]);
+    }
+    for (int i = 0; i < PERF_MAX_COMMANDS; i++) {
+        clear(_commands[i]);
+    }
+    _loopStarted = false;
+}
+
+void PerfMonitor::record(Stat& stat, uint32_t cycles) {
+    stat.count++;
+    stat.totalCycles += cycles;
+    if (cycles < stat.minCycles) {
+        stat.minCycles = cycles;
+    }
+    if (cycles > stat.maxCycles) {
+        stat.maxCycles = cycles;
+    }
+
+    // log2 bucket: index of the highest set bit (0 and 1 cycle share bucket 0)
+    int bucket = cycles ? 31 - __builtin_clz(cycles) : 0;
+    stat.histogram[bucket]++;
+}
+
+void PerfMonitor::clear(Stat& stat) {
+    memset(&stat, 0, sizeof(stat));
+    stat.minCycles = UINT32_MAX;
+}
+
+#endif  // PERF_MONITORING_ENABLED
@@ -10,7 +10,15 @@ RESTORE_MINMAX
 #include "serial_devices.h"  // Make sure it's explicitly included
 
 Rangefinder::Rangefinder(SerialDevices &serialDevices)
-    : _serialDevices(serialDevices), _lastMeasurement(0.0f), _debugEnabled(false) {
+    : _serialDevices(serialDevices),
+      _lastMeasurement(0.0f),
+      _pending(false),
+      _continuous(false),
+      _newResult(false),
+      _resultHead(0),
+      _resultCount(0),
+      _droppedResults(0),
+      _debugEnabled(false) {
     // Initialization logic
 }
 
@@ -23,57 +31,130 @@ void Rangefinder::begin() {
 }
 
 float Rangefinder::takeMeasurement() {
-    log("=== Starting Measurement ===");
+    // Readings are already flowing in continuous mode
+    if (_continuous) {
+        return _lastMeasurement;
+    }
+
+    // Wait for any reading already in flight before issuing ours
+    while (_pending) {
+        poll();
+    }
 
-    // Select rangefinder device
-    if (!_serialDevices.selectDevice(SerialDevices::DeviceType::RANGEFINDER)) {
-        log("Failed to select rangefinder device");
+    // Discard stale results so we return the reading for this request
+    clearResults();
+
+    if (!startMeasurement()) {
         return _lastMeasurement;
     }
-    log("Selected rangefinder device");
-
-    // Send measurement command
-    _serialDevices.write("DIST\r\n");
-    log("Sent DIST command");
-
-    // Wait for response with timeout
-    unsigned long startTime = millis();
-    const unsigned long timeout = 1000;  // 1 second timeout
-
-    // Buffer for response
-    char buffer[32];
-    size_t bufferIndex = 0;
-
-    while (millis() - startTime < timeout) {
-        if (_serialDevices.available()) {
-            char c = _serialDevices.read();
-
-            if (c == '\n' || c == '\r') {
-                if (bufferIndex > 0) {
-                    // Null terminate the string
-                    buffer[bufferIndex] = '\0';
-
-                    // Parse the distance value
-                    float distance = parseDistance(buffer);
-
-                    if (distance > 0) {
-                        _lastMeasurement = distance;
-                        log("Measurement successful: " + String(distance, 2) + "mm");
-                        return distance;
-                    }
-                }
-                // Reset buffer for next line
-                bufferIndex = 0;
-            } else if (bufferIndex < sizeof(buffer) - 1) {
-                // Add character to buffer
-                buffer[bufferIndex++] = c;
-            }
-        }
+
+    while (!isReady()) {
+        poll();
     }
 
-    log("Measurement timeout or error");
+    Measurement result;
+    readResult(result);
+
     // Return last valid measurement on error
-    return _lastMeasurement;
+    return result.valid ? result.distance : _lastMeasurement;
+}
+
+// Queue a DIST request on the COM1 scheduler without waiting for the answer
+bool Rangefinder::startMeasurement() {
+    if (_pending) {
+        return false;  // One request in flight at a time
+    }
+
+    bool queued = _serialDevices.submitJob(
+        SerialDevices::RANGEFINDER, "DIST\r\n",
+        [this](SerialDevices::JobStatus status, const char *response) {
+            handleResponse(status, response);
+        },
+        RANGEFINDER_JOB_PRIORITY, 0, MEASUREMENT_TIMEOUT_MS);
+
+    if (!queued) {
+        EventLogger.log(SOURCE_RANGEFINDER, EVENT_WARNING, EVT_RANGE_QUEUE_FULL);
+        return false;
+    }
+
+    _pending = true;
+    return true;
+}
+
+// Run the COM1 scheduler; returns true when a reading finished during this call
+bool Rangefinder::poll() {
+    _newResult = false;
+    _serialDevices.update();
+    return _newResult;
+}
+
+// Scheduler callback for a DIST request
+void Rangefinder::handleResponse(SerialDevices::JobStatus status, const char *response) {
+    _pending = false;
+
+    float distance = status == SerialDevices::JOB_OK ? parseDistance(response) : 0.0f;
+
+    if (distance > 0) {
+        _lastMeasurement = distance;
+        pushResult(distance, true);
+    } else {
+        EventLogger.log(SOURCE_RANGEFINDER, EVENT_WARNING, EVT_RANGE_FAILED, status);
+        pushResult(0.0f, false);
+    }
+    _newResult = true;
+
+    // Continuous mode polls: re-queue DIST as soon as the previous reading is done
+    if (_continuous) {
+        startMeasurement();
+    }
+}
+
+bool Rangefinder::isReady() const {
+    return _resultCount > 0;
+}
+
+// Pop the oldest buffered result
+bool Rangefinder::readResult(Measurement &result) {
+    if (_resultCount == 0) {
+        return false;
+    }
+
+    result = _results[_resultHead];
+    _resultHead = (_resultHead + 1) % RESULT_BUFFER_SIZE;
+    _resultCount--;
+
+    return true;
+}
+
+void Rangefinder::clearResults() {
+    _resultHead = 0;
+    _resultCount = 0;
+}
+
+bool Rangefinder::isBusy() const {
+    return _pending;
+}
+
+uint8_t Rangefinder::getResultCount() const {
+    return _resultCount;
+}
+
+uint32_t Rangefinder::getDroppedResults() const {
+    return _droppedResults;
+}
+
+void Rangefinder::setContinuous(bool enable) {
+    _continuous = enable;
+    if (enable) {
+        startMeasurement();
+    } else {
+        _serialDevices.cancelJobs(SerialDevices::RANGEFINDER);
+        clearResults();
+    }
+}
+
+bool Rangefinder::isContinuous() const {
+    return _continuous;
 }
 
 float Rangefinder::getLastMeasurement() const {
@@ -85,7 +166,7 @@ float Rangefinder::parseDistance(const char *buffer) {
     float distance = 0.0f;
 
     // Check for expected prefix (if any)
-    if (strstr(buffer, "DIST:") == buffer) {
+    if (strncmp(buffer, "DIST:", 5) == 0) {
         // Parse after "DIST:" prefix
         distance = atof(buffer + 5);
     } else {
@@ -102,13 +183,27 @@ float Rangefinder::parseDistance(const char *buffer) {
     return distance;
 }
 
+// Store a finished reading, overwriting the oldest when the buffer is full
+void Rangefinder::pushResult(float distance, bool valid) {
+    if (_resultCount == RESULT_BUFFER_SIZE) {
+        _resultHead = (_resultHead + 1) % RESULT_BUFFER_SIZE;
+        _resultCount--;
+        _droppedResults++;
+    }
+
+    Measurement &result = _results[(_resultHead + _resultCount) % RESULT_BUFFER_SIZE];
+    result.distance = distance;
+    result.timestamp = millis();
+    result.valid = valid;
+    _resultCount++;
+
+    if (_debugEnabled && valid) {
+        EventLogger.log(SOURCE_RANGEFINDER, EVENT_DEBUG, EVT_RANGE_MEASURED, 0,
+                        static_cast<int32_t>(lroundf(distance * 10.0f)));
+    }
+}
+
 void Rangefinder::setDebug(bool enable) {
     _debugEnabled = enable;
 }
 
-void Rangefinder::log(const String &message) {
-    if (_debugEnabled) {
-        Serial.print("[Rangefinder] ");
-        Serial.println(message);
-    }
-}
\ No newline at end of file
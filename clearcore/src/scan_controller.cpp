@@ -0,0 +1,240 @@
+/**
+ * Space Maquette - Scan Controller Implementation
+ */
+
+#include "scan_controller.h"
+
+ScanController::ScanController(MotionControl& motion, Rangefinder& rangefinder,
+                               CommandParser& parser)
+    : _motion(motion),
+      _rangefinder(rangefinder),
+      _parser(parser),
+      _state(SCAN_IDLE),
+      _pauseRequested(false),
+      _settleStart(0),
+      _settleMs(SCAN_DEFAULT_SETTLE_MS),
+      _x1(0),
+      _y1(0),
+      _stepX(0),
+      _stepY(0),
+      _columns(0),
+      _rows(0),
+      _pointCount(0),
+      _pointIndex(0),
+      _pointX(0),
+      _pointY(0),
+      _batchCount(0),
+      _batchFirstIndex(0) {}
+
+// Start a new scan
+bool ScanController::start(int32_t x1, int32_t y1, int32_t x2, int32_t y2, int32_t step) {
+    if (_state != SCAN_IDLE || step <= 0) {
+        return false;
+    }
+
+    _x1 = x1;
+    _y1 = y1;
+    _stepX = (x2 >= x1) ? step : -step;
+    _stepY = (y2 >= y1) ? step : -step;
+    _columns = static_cast<uint32_t>(abs(x2 - x1) / step) + 1;
+    _rows = static_cast<uint32_t>(abs(y2 - y1) / step) + 1;
+    _pointCount = _columns * _rows;
+    _pointIndex = 0;
+    _batchCount = 0;
+    _batchFirstIndex = 0;
+    _pauseRequested = false;
+
+    if (!moveToPoint(0)) {
+        _state = SCAN_IDLE;
+        return false;
+    }
+
+#ifdef DEBUG
+    Serial.print("Scan started: ");
+    Serial.print(_columns);
+    Serial.print(" x ");
+    Serial.print(_rows);
+    Serial.println(" points");
+#endif
+
+    return true;
+}
+
+// Request a pause once the current point has been measured
+bool ScanController::pause() {
+    if (_state == SCAN_IDLE || _state == SCAN_PAUSED) {
+        return false;
+    }
+
+    _pauseRequested = true;
+    return true;
+}
+
+// Resume a paused scan with the next grid point
+bool ScanController::resume() {
+    if (_state != SCAN_PAUSED) {
+        _pauseRequested = false;
+        return _state != SCAN_IDLE;
+    }
+
+    _pauseRequested = false;
+    if (!moveToPoint(_pointIndex)) {
+        finish("SCAN_FAILED");
+        return false;
+    }
+
+    return true;
+}
+
+// Abort the scan, stopping any move in progress
+void ScanController::abort() {
+    if (_state == SCAN_IDLE) {
+        return;
+    }
+
+    if (_state == SCAN_MOVING) {
+        _motion.stop();
+    }
+
+    finish("SCAN_ABORTED");
+}
+
+// Advance the scan state machine
+void ScanController::update() {
+    switch (_state) {
+        case SCAN_MOVING:
+            if (_motion.isMoving()) {
+                return;
+            }
+            if (_motion.lastMoveFailed()) {
+                finish("SCAN_FAILED");
+                return;
+            }
+            _settleStart = millis();
+            _state = SCAN_SETTLING;
+            break;
+
+        case SCAN_SETTLING:
+            // Request the reading once settled; retried while an old request drains
+            if (millis() - _settleStart >= _settleMs) {
+                _rangefinder.clearResults();
+                if (_rangefinder.startMeasurement()) {
+                    _state = SCAN_MEASURING;
+                }
+            }
+            break;
+
+        case SCAN_MEASURING: {
+            // The COM1 scheduler delivers the reading from the main loop
+            Rangefinder::Measurement result;
+            if (!_rangefinder.readResult(result)) {
+                return;
+            }
+
+            recordPoint(result.valid ? result.distance : -1.0f);
+            _pointIndex++;
+
+            if (_pointIndex >= _pointCount) {
+                finish("SCAN_COMPLETE");
+            } else if (_pauseRequested) {
+                // Send what we have so the host sees everything up to the pause
+                flushBatch();
+                _state = SCAN_PAUSED;
+                _parser.sendFormattedResponse("INFO", "SCAN_PAUSED,%lu/%lu",
+                                              (unsigned long)_pointIndex,
+                                              (unsigned long)_pointCount);
+            } else if (!moveToPoint(_pointIndex)) {
+                finish("SCAN_FAILED");
+            }
+            break;
+        }
+
+        case SCAN_IDLE:
+        case SCAN_PAUSED:
+        default:
+            break;
+    }
+}
+
+// Get the scan state as a string
+const char* ScanController::getStateString() const {
+    switch (_state) {
+        case SCAN_IDLE:
+            return "IDLE";
+        case SCAN_MOVING:
+            return "MOVING";
+        case SCAN_SETTLING:
+            return "SETTLING";
+        case SCAN_MEASURING:
+            return "MEASURING";
+        case SCAN_PAUSED:
+            return "PAUSED";
+        default:
+            return "UNKNOWN";
+    }
+}
+
+// Start the move to a grid point (serpentine order to avoid long return moves)
+bool ScanController::moveToPoint(uint32_t index) {
+    uint32_t row = index / _columns;
+    uint32_t column = index % _columns;
+    if (row % 2 == 1) {
+        column = _columns - 1 - column;
+    }
+
+    _pointX = _x1 + static_cast<int32_t>(column) * _stepX;
+    _pointY = _y1 + static_cast<int32_t>(row) * _stepY;
+
+    if (!_motion.moveCoordinated(_pointX, _pointY, -1, -1)) {
+        return false;
+    }
+
+    _state = SCAN_MOVING;
+    return true;
+}
+
+// Add a measured point to the current batch
+void ScanController::recordPoint(float distance) {
+    if (_batchCount == 0) {
+        _batchFirstIndex = _pointIndex;
+    }
+
+    ScanPoint& point = _batch[_batchCount++];
+    point.x = _pointX;
+    point.y = _pointY;
+    point.distance = distance;
+
+    if (_batchCount >= SCAN_BATCH_POINTS) {
+        flushBatch();
+    }
+}
+
+// Send the batched points as one DATA frame
+// Format: DATA:SCAN,<first index>,<count>,<total>;<x>,<y>,<distance>;...
+void ScanController::flushBatch() {
+    if (_batchCount == 0) {
+        return;
+    }
+
+    static char frame[48 + SCAN_BATCH_POINTS * 32];
+    int length = snprintf(frame, sizeof(frame), "SCAN,%lu,%u,%lu", (unsigned long)_batchFirstIndex,
+                          (unsigned)_batchCount, (unsigned long)_pointCount);
+
+    for (uint8_t i = 0; i < _batchCount && length < (int)sizeof(frame); i++) {
+        length += snprintf(frame + length, sizeof(frame) - length, ";%ld,%ld,%.3f",
+                           (long)_batch[i].x, (long)_batch[i].y, _batch[i].distance);
+    }
+
+    _parser.sendResponse("DATA", frame);
+    _batchCount = 0;
+}
+
+// End the scan and report the outcome
+void ScanController::finish(const char* event) {
+    flushBatch();
+    _state = SCAN_IDLE;
+    _pauseRequested = false;
+
+    _parser.sendFormattedResponse("INFO", "%s,%lu/%lu", event, (unsigned long)_pointIndex,
+                                  (unsigned long)_pointCount);
+}
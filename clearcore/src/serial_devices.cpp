@@ -6,7 +6,20 @@ SerialDevices::SerialDevices(ClearCorePins serialPin)
       _relayPin(-1),
       _currentDevice(NONE),
       _baudRate(115200),
-      _serialPin(serialPin) {}
+      _deviceBaud(),
+      _lineBaud(0),
+      _serialPin(serialPin),
+      _jobSequence(0),
+      _activeJob(-1),
+      _schedState(SCHED_IDLE),
+      _stateTime(0),
+      _batchCount(0),
+      _relaySwitches(0),
+      _responseIndex(0) {
+    for (int i = 0; i < SERIAL_JOB_QUEUE_SIZE; i++) {
+        _jobs[i].inUse = false;
+    }
+}
 
 // Constructor with HardwareSerial
 SerialDevices::SerialDevices(HardwareSerial &serial, int relayPin)
@@ -14,13 +27,27 @@ SerialDevices::SerialDevices(HardwareSerial &serial, int relayPin)
       _relayPin(relayPin),
       _currentDevice(NONE),
       _baudRate(115200),
-      _serialPin(static_cast<ClearCorePins>(-1)) {}
+      _deviceBaud(),
+      _lineBaud(0),
+      _serialPin(static_cast<ClearCorePins>(-1)),
+      _jobSequence(0),
+      _activeJob(-1),
+      _schedState(SCHED_IDLE),
+      _stateTime(0),
+      _batchCount(0),
+      _relaySwitches(0),
+      _responseIndex(0) {
+    for (int i = 0; i < SERIAL_JOB_QUEUE_SIZE; i++) {
+        _jobs[i].inUse = false;
+    }
+}
 
 bool SerialDevices::init(unsigned long baudRate) {
     _baudRate = baudRate;
 
     if (_serial != nullptr) {
         _serial->begin(baudRate);
+        _lineBaud = baudRate;
     } else {
         // Initialize using ClearCorePins if that's what was provided
         // Add appropriate initialization code here
@@ -40,6 +67,7 @@ void SerialDevices::begin(unsigned long baudRate) {
 
     if (_serial != nullptr) {
         _serial->begin(baudRate);
+        _lineBaud = baudRate;
     } else {
         // Initialize using ClearCorePins if that's what was provided
         // Add appropriate initialization code here
@@ -75,6 +103,7 @@ bool SerialDevices::switchToDevice(DeviceType device) {
     }
 
     _currentDevice = device;
+    _relaySwitches++;
     return true;
 }
 
@@ -133,4 +162,239 @@ void SerialDevices::flush() {
     if (_serial != nullptr) {
         _serial->flush();
     }
-}
\ No newline at end of file
+}
+
+// Queue a request/response transaction
+bool SerialDevices::submitJob(DeviceType device, const char *request, JobCallback callback,
+                              uint8_t priority, unsigned long deadlineMs,
+                              unsigned long timeoutMs) {
+    return submitJob(device, reinterpret_cast<const uint8_t *>(request), strlen(request),
+                     callback, priority, deadlineMs, timeoutMs);
+}
+
+// Queue a transaction with a binary request
+bool SerialDevices::submitJob(DeviceType device, const uint8_t *request, size_t length,
+                              JobCallback callback, uint8_t priority,
+                              unsigned long deadlineMs, unsigned long timeoutMs) {
+    if (length >= SERIAL_JOB_REQUEST_SIZE) {
+        return false;
+    }
+
+    for (int i = 0; i < SERIAL_JOB_QUEUE_SIZE; i++) {
+        Job &job = _jobs[i];
+        if (job.inUse) {
+            continue;
+        }
+
+        job.inUse = true;
+        job.device = device;
+        job.priority = priority;
+        job.sequence = _jobSequence++;
+        job.deadline = deadlineMs > 0 ? millis() + deadlineMs : 0;
+        job.timeoutMs = timeoutMs;
+        memcpy(job.request, request, length);
+        job.requestLength = length;
+        job.callback = callback;
+        return true;
+    }
+
+    return false;  // Queue full
+}
+
+void SerialDevices::setDeviceBaud(DeviceType device, unsigned long baudRate) {
+    if (device >= NONE && device <= TILT_SERVO) {
+        _deviceBaud[device] = baudRate;
+    }
+}
+
+unsigned long SerialDevices::getDeviceBaud(DeviceType device) const {
+    if (device >= NONE && device <= TILT_SERVO && _deviceBaud[device] != 0) {
+        return _deviceBaud[device];
+    }
+    return _baudRate;
+}
+
+// Re-open the UART at the device's speed; true if it changed
+bool SerialDevices::applyDeviceBaud(DeviceType device) {
+    unsigned long baud = getDeviceBaud(device);
+    if (_serial == nullptr || baud == _lineBaud) {
+        return false;
+    }
+
+    _serial->flush();
+    _serial->begin(baud);
+    _lineBaud = baud;
+    return true;
+}
+
+// Drop queued jobs for a device (the running job, if any, completes normally)
+void SerialDevices::cancelJobs(DeviceType device) {
+    for (int i = 0; i < SERIAL_JOB_QUEUE_SIZE; i++) {
+        Job &job = _jobs[i];
+        if (job.inUse && i != _activeJob && job.device == device) {
+            JobCallback callback = job.callback;
+            job.inUse = false;
+            job.callback = nullptr;
+            if (callback) {
+                callback(JOB_CANCELLED, "");
+            }
+        }
+    }
+}
+
+// Run the scheduler state machine
+void SerialDevices::update() {
+    switch (_schedState) {
+        case SCHED_IDLE: {
+            int next = selectNextJob();
+            if (next >= 0) {
+                startJob(next);
+            }
+            break;
+        }
+
+        case SCHED_SETTLING:
+            if (millis() - _stateTime >= SERIAL_RELAY_SETTLE_MS) {
+                // Drop anything received while the relay was moving
+                while (available() > 0) {
+                    read();
+                }
+                write(reinterpret_cast<const uint8_t *>(_jobs[_activeJob].request),
+                      _jobs[_activeJob].requestLength);
+                _responseIndex = 0;
+                _stateTime = millis();
+                _schedState = SCHED_WAITING;
+            }
+            break;
+
+        case SCHED_WAITING:
+            while (available() > 0) {
+                char c = read();
+
+                if (c == '\n' || c == '\r') {
+                    if (_responseIndex > 0) {
+                        _response[_responseIndex] = '\0';
+                        completeJob(JOB_OK, _response);
+                        return;
+                    }
+                } else if (_responseIndex < sizeof(_response) - 1) {
+                    _response[_responseIndex++] = c;
+                }
+            }
+
+            if (millis() - _stateTime >= _jobs[_activeJob].timeoutMs) {
+                completeJob(JOB_TIMEOUT, "");
+            }
+            break;
+    }
+}
+
+// Pick the next job: highest priority first, then the device already selected
+// (saves a relay toggle, up to SERIAL_MAX_BATCH in a row), then oldest first
+int SerialDevices::selectNextJob() {
+    unsigned long now = millis();
+    int best = -1;
+
+    for (int i = 0; i < SERIAL_JOB_QUEUE_SIZE; i++) {
+        Job &job = _jobs[i];
+        if (!job.inUse) {
+            continue;
+        }
+
+        // Expire jobs whose deadline passed while they waited
+        if (job.deadline != 0 && (long)(now - job.deadline) > 0) {
+            JobCallback callback = job.callback;
+            job.inUse = false;
+            job.callback = nullptr;
+            if (callback) {
+                callback(JOB_EXPIRED, "");
+            }
+            continue;
+        }
+
+        if (best < 0) {
+            best = i;
+            continue;
+        }
+
+        Job &current = _jobs[best];
+        if (job.priority != current.priority) {
+            if (job.priority > current.priority) {
+                best = i;
+            }
+            continue;
+        }
+
+        bool batchOpen = _batchCount < SERIAL_MAX_BATCH;
+        bool jobSame = batchOpen && job.device == _currentDevice;
+        bool currentSame = batchOpen && current.device == _currentDevice;
+        if (jobSame != currentSame) {
+            if (jobSame) {
+                best = i;
+            }
+            continue;
+        }
+
+        if ((int32_t)(job.sequence - current.sequence) < 0) {
+            best = i;
+        }
+    }
+
+    return best;
+}
+
+// Select the job's device and send its request (after relay settle if needed)
+void SerialDevices::startJob(int index) {
+    Job &job = _jobs[index];
+    _activeJob = index;
+
+    // A speed change gets the full settle time, like a relay switch
+    bool settle = applyDeviceBaud(job.device);
+
+    if (job.device == _currentDevice) {
+        _batchCount++;
+    } else {
+        switchToDevice(job.device);
+        _batchCount = 1;
+        settle = true;
+    }
+
+    _schedState = SCHED_SETTLING;
+    _stateTime = settle ? millis() : millis() - SERIAL_RELAY_SETTLE_MS;  // Relay already in place
+
+    update();
+}
+
+// Finish the running job and notify its owner
+void SerialDevices::completeJob(JobStatus status, const char *response) {
+    Job &job = _jobs[_activeJob];
+    JobCallback callback = job.callback;
+
+    // Free the slot first so the callback can submit a follow-up job
+    job.inUse = false;
+    job.callback = nullptr;
+    _activeJob = -1;
+    _schedState = SCHED_IDLE;
+
+    if (callback) {
+        callback(status, response);
+    }
+}
+
+bool SerialDevices::isBusy() const {
+    return _schedState != SCHED_IDLE;
+}
+
+uint8_t SerialDevices::getPendingJobs() const {
+    uint8_t count = 0;
+    for (int i = 0; i < SERIAL_JOB_QUEUE_SIZE; i++) {
+        if (_jobs[i].inUse) {
+            count++;
+        }
+    }
+    return count;
+}
+
+uint32_t SerialDevices::getRelaySwitches() const {
+    return _relaySwitches;
+}
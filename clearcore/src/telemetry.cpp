@@ -0,0 +1,149 @@
+/**
+ * Space Maquette - Telemetry Implementation
+ */
+
+#include "telemetry.h"
+
+// Field names accepted by SUBSCRIBE, in field order
+static const char* const FIELD_NAMES[TLM_FIELD_COUNT] = {
+    "X", "Y", "Z", "PAN", "MOVING", "HLFB", "ALERTS", "ESTOP", "RANGE", "QUEUE"};
+
+Telemetry::Telemetry(CommandParser& parser, MotionControl& motion, Rangefinder& rangefinder,
+                     EmergencyStop& estop)
+    : _parser(parser),
+      _motion(motion),
+      _rangefinder(rangefinder),
+      _estop(estop),
+      _fieldMask(0),
+      _rateHz(0),
+      _interval(0),
+      _lastFrame(0),
+      _sequence(0),
+      _sendAll(false),
+      _framesSent(0) {
+    memset(_lastValues, 0, sizeof(_lastValues));
+}
+
+// Start streaming; the first frame carries every subscribed field
+bool Telemetry::subscribe(int rateHz, uint16_t fieldMask) {
+    fieldMask &= TELEMETRY_ALL_FIELDS;
+    if (rateHz < 1 || rateHz > TELEMETRY_MAX_RATE_HZ || fieldMask == 0) {
+        return false;
+    }
+
+    _fieldMask = fieldMask;
+    _rateHz = rateHz;
+    _interval = 1000 / rateHz;
+    _lastFrame = millis() - _interval;  // First frame on the next update()
+    _sequence = 0;
+    _sendAll = true;
+
+#ifdef DEBUG
+    Serial.print("Telemetry subscribed: ");
+    Serial.print(rateHz);
+    Serial.print(" Hz, fields 0x");
+    Serial.println(fieldMask, HEX);
+#endif
+
+    return true;
+}
+
+void Telemetry::unsubscribe() {
+    _fieldMask = 0;
+    _rateHz = 0;
+}
+
+int Telemetry::fieldFromName(const char* name) {
+    for (int i = 0; i < TLM_FIELD_COUNT; i++) {
+        if (strcmp(name, FIELD_NAMES[i]) == 0) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+// Send the changed fields once per interval
+void Telemetry::update() {
+    if (_fieldMask == 0) {
+        return;
+    }
+
+    unsigned long now = millis();
+    if (now - _lastFrame < _interval) {
+        return;
+    }
+    _lastFrame = now;
+
+    int32_t values[TLM_FIELD_COUNT];
+    sample(values);
+
+    uint16_t changed = 0;
+    for (int i = 0; i < TLM_FIELD_COUNT; i++) {
+        if ((_fieldMask & (1 << i)) && (_sendAll || values[i] != _lastValues[i])) {
+            changed |= 1 << i;
+            _lastValues[i] = values[i];
+        }
+    }
+
+    // Nothing new: skip the frame (the host keeps the last values)
+    if (changed == 0) {
+        return;
+    }
+
+    _sendAll = false;
+    sendFrame(changed, values);
+}
+
+void Telemetry::sample(int32_t values[]) {
+    // Only query what is subscribed; HLFB and alert reads touch every motor
+    values[TLM_X] = _motion.getCurrentPosition('X');
+    values[TLM_Y] = _motion.getCurrentPosition('Y');
+    values[TLM_Z] = _motion.getCurrentPosition('Z');
+    values[TLM_PAN] = _motion.getCurrentPosition('P');
+    values[TLM_MOVING] = _motion.isMoving() ? 1 : 0;
+    values[TLM_HLFB] = (_fieldMask & (1 << TLM_HLFB)) ? _motion.getHlfbMask() : 0;
+    values[TLM_ALERTS] = (_fieldMask & (1 << TLM_ALERTS)) ? _motion.getAlertMask() : 0;
+    values[TLM_ESTOP] = _estop.isActive() ? 1 : 0;
+    values[TLM_RANGE] = static_cast<int32_t>(lroundf(_rangefinder.getLastMeasurement() * 10.0f));
+    values[TLM_QUEUE] = _motion.getQueueDepth();
+}
+
+void Telemetry::sendFrame(uint16_t mask, const int32_t values[]) {
+    uint16_t sequence = _sequence++;
+    _framesSent++;
+
+    if (_parser.getProtocol() == CommandParser::PROTOCOL_BINARY) {
+        uint8_t payload[4 + 4 * TLM_FIELD_COUNT];
+        size_t length = 0;
+        payload[length++] = sequence & 0xFF;
+        payload[length++] = sequence >> 8;
+        payload[length++] = mask & 0xFF;
+        payload[length++] = mask >> 8;
+
+        for (int i = 0; i < TLM_FIELD_COUNT; i++) {
+            if (mask & (1 << i)) {
+                uint32_t value = static_cast<uint32_t>(values[i]);
+                payload[length++] = value & 0xFF;
+                payload[length++] = (value >> 8) & 0xFF;
+                payload[length++] = (value >> 16) & 0xFF;
+                payload[length++] = value >> 24;
+            }
+        }
+
+        _parser.sendFrame(CommandParser::OP_RESP_TELEMETRY, payload, length);
+        return;
+    }
+
+    // "TLM,<seq>,<mask>" plus up to 12 characters per value
+    char frame[16 + 12 * TLM_FIELD_COUNT];
+    int length = snprintf(frame, sizeof(frame), "TLM,%u,%X", sequence, mask);
+
+    for (int i = 0; i < TLM_FIELD_COUNT; i++) {
+        if (mask & (1 << i)) {
+            length += snprintf(frame + length, sizeof(frame) - length, ",%ld",
+                               static_cast<long>(values[i]));
+        }
+    }
+
+    _parser.sendResponse("DATA", frame);
+}
@@ -1,11 +1,28 @@
 #include "tilt_servo.h"
 
+#include "crc16.h"
+
 TiltServo::TiltServo(SerialDevices &serialDevices, float minAngle, float maxAngle)
     : _serialDevices(serialDevices),
       _minAngle(minAngle),
       _maxAngle(maxAngle),
       _currentAngle(0.0f),
       _targetAngle(0.0f),
+      _commandPending(false),
+      _commandAcked(false),
+      _asyncEnabled(false),
+      _nextPending(false),
+      _nextAngle(0.0f),
+      _coalescedCount(0),
+      _fastRequested(false),
+      _fastActive(false),
+      _fastBaud(TILT_FAST_BAUD),
+      _negotiateAttempts(0),
+      _negotiatePending(false),
+      _slewPending(false),
+      _slewRate(0.0f),
+      _slewUntil(0),
+      _linkCommandPending(false),
       _debugEnabled(false) {
     // Initialization
 }
@@ -25,37 +42,194 @@ bool TiltServo::setAngle(float angle) {
     float constrainedAngle = constrain(angle, _minAngle, _maxAngle);
 
     if (constrainedAngle != angle) {
-        log("Angle " + String(angle, 2) + " constrained to " + String(constrainedAngle, 2));
+        EventLogger.log(SOURCE_TILT, EVENT_WARNING, EVT_TILT_CONSTRAINED, centiDegrees(angle),
+                        centiDegrees(constrainedAngle));
     }
 
     _targetAngle = constrainedAngle;
 
-    // Switch to tilt servo device
-    if (!_serialDevices.switchToDevice(SerialDevices::TILT_SERVO)) {
-        log("Failed to switch to tilt servo device");
+    if (_debugEnabled) {
+        EventLogger.log(SOURCE_TILT, EVENT_DEBUG, EVT_TILT_SET, 0, centiDegrees(constrainedAngle));
+    }
+
+    if (_asyncEnabled) {
+        // Latest wins: replace the target waiting behind the in-flight command
+        if (_commandPending) {
+            if (_nextPending) {
+                _coalescedCount++;
+            }
+            _nextAngle = constrainedAngle;
+            _nextPending = true;
+            return true;
+        }
+
+        if (!sendAngle(constrainedAngle)) {
+            EventLogger.log(SOURCE_TILT, EVENT_WARNING, EVT_TILT_QUEUE_FULL);
+            return false;
+        }
+        return true;
+    }
+
+    // Blocking: let an async command finish first; this target supersedes any waiting one
+    _nextPending = false;
+    while (_commandPending) {
+        _serialDevices.update();
+    }
+
+    if (!sendAngle(constrainedAngle)) {
+        EventLogger.log(SOURCE_TILT, EVENT_WARNING, EVT_TILT_QUEUE_FULL);
         return false;
     }
 
-    log("Set angle to " + String(constrainedAngle, 2));
+    // Wait for acknowledgment (bounded by the job deadline and timeout)
+    while (_commandPending) {
+        _serialDevices.update();
+    }
+
+    return _commandAcked;
+}
 
-    // Clear any pending data
-    while (_serialDevices.available()) {
-        _serialDevices.read();
+// Send the angle command to the Arduino through the COM1 scheduler
+bool TiltServo::sendAngle(float angle) {
+    SerialDevices::JobCallback callback = [this, angle](SerialDevices::JobStatus status,
+                                                        const char *response) {
+        handleAck(status, response, angle);
+    };
+    bool queued;
+
+    if (_fastActive) {
+        // Binary frame: sync, opcode, centidegrees, CRC over opcode and payload
+        uint16_t centi = static_cast<uint16_t>(centiDegrees(angle));
+        uint8_t frame[TILT_FRAME_SIZE] = {TILT_FRAME_SYNC, TILT_FRAME_ANGLE,
+                                          static_cast<uint8_t>(centi & 0xFF),
+                                          static_cast<uint8_t>(centi >> 8), 0, 0};
+        uint16_t crc = crc16Modbus(&frame[1], 3);
+        frame[4] = crc & 0xFF;
+        frame[5] = crc >> 8;
+        queued = _serialDevices.submitJob(SerialDevices::TILT_SERVO, frame, sizeof(frame),
+                                          callback, TILT_JOB_PRIORITY, TILT_JOB_DEADLINE_MS,
+                                          TILT_FAST_ACK_TIMEOUT_MS);
+    } else {
+        // Format: "ANGLE:XX.XX\r\n"
+        char command[SERIAL_JOB_REQUEST_SIZE];
+        snprintf(command, sizeof(command), "ANGLE:%.2f\r\n", angle);
+        queued = _serialDevices.submitJob(SerialDevices::TILT_SERVO, command, callback,
+                                          TILT_JOB_PRIORITY, TILT_JOB_DEADLINE_MS,
+                                          TILT_ACK_TIMEOUT_MS);
     }
 
-    // Send the angle command to the Arduino
-    // Format: "ANGLE:XX.XX\r\n"
-    String command = "ANGLE:" + String(constrainedAngle, 2) + "\r\n";
-    _serialDevices.write(command.c_str());
+    if (queued) {
+        _commandPending = true;
+        _commandAcked = false;
+    }
+    return queued;
+}
 
-    // Wait for acknowledgment with timeout
-    if (waitForAck()) {
-        _currentAngle = constrainedAngle;
-        return true;
+// Send a BAUD (baudRate != 0) or SLEW command
+bool TiltServo::sendLinkCommand(const char *command, unsigned long baudRate) {
+    bool queued = _serialDevices.submitJob(
+        SerialDevices::TILT_SERVO, command,
+        [this, baudRate](SerialDevices::JobStatus status, const char *response) {
+            handleLinkAck(status, response, baudRate);
+        },
+        TILT_JOB_PRIORITY, TILT_JOB_DEADLINE_MS, TILT_ACK_TIMEOUT_MS);
+
+    _linkCommandPending = queued;
+    return queued;
+}
+
+void TiltServo::handleLinkAck(SerialDevices::JobStatus status, const char *response,
+                              unsigned long baudRate) {
+    _linkCommandPending = false;
+    bool acked = status == SerialDevices::JOB_OK && strcmp(response, "OK") == 0;
+
+    if (!acked && status == SerialDevices::JOB_TIMEOUT && _fastActive) {
+        // The Arduino may have gone back to the power-on speed
+        fallBackToText();
+        return;
     }
 
-    log("Failed to set angle - no acknowledgment");
-    return false;
+    if (baudRate == 0) {
+        // SLEW: the servo keeps its previous rate
+        if (!acked) {
+            EventLogger.log(SOURCE_TILT, EVENT_WARNING, EVT_TILT_NO_ACK, 1,
+                            centiDegrees(_slewRate));
+        }
+        return;
+    }
+
+    if (acked) {
+        // The Arduino switched right after its OK; the next job starts at the new speed
+        _serialDevices.setDeviceBaud(SerialDevices::TILT_SERVO, baudRate);
+        _fastActive = baudRate != TILT_BAUD_RATE;
+        _negotiateAttempts = 0;
+        EventLogger.log(SOURCE_TILT, EVENT_INFO, EVT_TILT_LINK_SPEED, _fastActive ? 1 : 0,
+                        baudRate);
+        return;
+    }
+
+    if (_fastRequested && ++_negotiateAttempts < TILT_NEGOTIATE_RETRIES) {
+        _negotiatePending = true;
+    } else {
+        EventLogger.log(SOURCE_TILT, EVENT_WARNING, EVT_TILT_LINK_FALLBACK, 0, baudRate);
+    }
+}
+
+void TiltServo::fallBackToText() {
+    _serialDevices.setDeviceBaud(SerialDevices::TILT_SERVO, TILT_BAUD_RATE);
+    _fastActive = false;
+    EventLogger.log(SOURCE_TILT, EVENT_WARNING, EVT_TILT_LINK_FALLBACK, 1, _fastBaud);
+
+    if (_fastRequested && _negotiateAttempts < TILT_NEGOTIATE_RETRIES) {
+        _negotiatePending = true;
+    }
+}
+
+void TiltServo::setFastMode(bool enable, unsigned long baudRate) {
+    _fastRequested = enable;
+    _fastBaud = baudRate;
+    _negotiateAttempts = 0;
+
+    // Disabling while fast switches the Arduino back to the power-on speed
+    _negotiatePending = enable || _fastActive;
+}
+
+void TiltServo::setSlewRate(float degreesPerSecond) {
+    _slewRate = degreesPerSecond > 0.0f ? degreesPerSecond : 0.0f;
+    _slewPending = true;
+}
+
+void TiltServo::setAsync(bool enable) {
+    _asyncEnabled = enable;
+}
+
+void TiltServo::update() {
+    // Link settings go out between angle commands, one at a time
+    if (!_commandPending && !_linkCommandPending) {
+        char command[SERIAL_JOB_REQUEST_SIZE];
+
+        if (_negotiatePending) {
+            unsigned long baud = _fastRequested ? _fastBaud : TILT_BAUD_RATE;
+            snprintf(command, sizeof(command), "BAUD:%lu\r\n", baud);
+            if (sendLinkCommand(command, baud)) {
+                _negotiatePending = false;
+            }
+        } else if (_slewPending) {
+            snprintf(command, sizeof(command), "SLEW:%.1f\r\n", _slewRate);
+            if (sendLinkCommand(command, 0)) {
+                _slewPending = false;
+            }
+        }
+    }
+
+    // Retried each loop while the scheduler queue is full
+    if (_nextPending && !_commandPending && sendAngle(_nextAngle)) {
+        _nextPending = false;
+    }
+}
+
+bool TiltServo::isSettled() const {
+    return !_commandPending && !_nextPending && static_cast<long>(millis() - _slewUntil) >= 0;
 }
 
 float TiltServo::getCurrentAngle() const {
@@ -70,56 +244,50 @@ void TiltServo::setLimits(float minAngle, float maxAngle) {
     _minAngle = minAngle;
     _maxAngle = maxAngle;
 
-    // If current angle is outside new limits, adjust it
-    if (_currentAngle < _minAngle) {
+    // If the commanded angle is outside new limits, adjust it
+    if (_targetAngle < _minAngle) {
         setAngle(_minAngle);
-    } else if (_currentAngle > _maxAngle) {
+    } else if (_targetAngle > _maxAngle) {
         setAngle(_maxAngle);
     }
 }
 
-bool TiltServo::waitForAck() {
-    unsigned long startTime = millis();
-    const unsigned long timeout = 1000;  // 1 second timeout
-
-    // Buffer for response
-    char buffer[32];
-    size_t bufferIndex = 0;
-
-    while (millis() - startTime < timeout) {
-        if (_serialDevices.available()) {
-            char c = _serialDevices.read();
+// Scheduler callback: the Arduino answers "OK" once the servo is commanded
+void TiltServo::handleAck(SerialDevices::JobStatus status, const char *response, float angle) {
+    _commandPending = false;
+    _commandAcked = status == SerialDevices::JOB_OK && strcmp(response, "OK") == 0;
 
-            if (c == '\n' || c == '\r') {
-                if (bufferIndex > 0) {
-                    // Null terminate the string
-                    buffer[bufferIndex] = '\0';
+    if (!_commandAcked) {
+        EventLogger.log(SOURCE_TILT, EVENT_ERROR, EVT_TILT_NO_ACK, 0, centiDegrees(angle));
 
-                    // Check for "OK" response
-                    if (strcmp(buffer, "OK") == 0) {
-                        log("Received ACK");
-                        return true;
-                    }
-                }
-                // Reset buffer for next line
-                bufferIndex = 0;
-            } else if (bufferIndex < sizeof(buffer) - 1) {
-                // Add character to buffer
-                buffer[bufferIndex++] = c;
+        // A silent servo in fast mode: back to text, resending this angle unless a newer one waits
+        if (status == SerialDevices::JOB_TIMEOUT && _fastActive) {
+            fallBackToText();
+            if (_asyncEnabled && !_nextPending) {
+                _nextAngle = angle;
+                _nextPending = true;
             }
         }
+        return;
     }
 
-    log("ACK timeout");
-    return false;
+    // The Arduino is still slewing after the ACK: settled once it could have arrived
+    if (_slewRate > 0.0f) {
+        float travel = fabsf(angle - _currentAngle);
+        _slewUntil = millis() + static_cast<unsigned long>(travel / _slewRate * 1000.0f);
+    }
+
+    _currentAngle = angle;
+    if (_debugEnabled) {
+        EventLogger.log(SOURCE_TILT, EVENT_DEBUG, EVT_TILT_ACK);
+    }
 }
+
 void TiltServo::setDebug(bool enable) {
     _debugEnabled = enable;
 }
 
-void TiltServo::log(const String &message) {
-    if (_debugEnabled) {
-        Serial.print("[TiltServo] ");
-        Serial.println(message);
-    }
+// Angle in 0.01 degree units for log records
+int32_t TiltServo::centiDegrees(float angle) {
+    return static_cast<int32_t>(lroundf(angle * 100.0f));
 }
\ No newline at end of file
@@ -1,9 +1,25 @@
 #include "web_server.h"
 
+#include "motion_trace.h"
+#include "perf_monitor.h"
+
 // Constructor
-WebServer::WebServer(uint16_t port) : _server(port), _initialized(false), _port(port) {
+WebServer::WebServer(uint16_t port)
+    : _server(port),
+      _initialized(false),
+      _port(port),
+      _sendBudget(DEFAULT_SEND_BUDGET),
+      _nextConnection(0),
+      _trace(nullptr) {
     // Initialize IP string buffer
     _ipString[0] = '\0';
+
+    for (int i = 0; i < MAX_CONNECTIONS; i++) {
+        _connections[i].state = CONN_IDLE;
+        _connections[i].sendingFile = false;
+        _connections[i].sendingListing = false;
+        _connections[i].sendingTrace = false;
+    }
 }
 
 // Initialize the web server
@@ -33,12 +49,39 @@ bool WebServer::init() {
 
 // Update method (called in main loop)
 void WebServer::update() {
-    // Check for new client connections
-    _client = _server.Available();
+    if (!_initialized) {
+        return;
+    }
+
+    acceptConnections();
 
-    if (_client.Connected()) {
-        handleClient();
+    // Share the send budget round-robin so one download can't starve the others
+    size_t budget = _sendBudget;
+    for (int i = 0; i < MAX_CONNECTIONS; i++) {
+        Connection& conn = _connections[(_nextConnection + i) % MAX_CONNECTIONS];
+        if (conn.state != CONN_IDLE) {
+            budget -= serviceConnection(conn, budget);
+        }
     }
+    _nextConnection = (_nextConnection + 1) % MAX_CONNECTIONS;
+}
+
+void WebServer::setSendBudget(size_t bytes) {
+    _sendBudget = bytes > 0 ? bytes : DEFAULT_SEND_BUDGET;
+}
+
+void WebServer::setMotionTrace(MotionTrace* trace) {
+    _trace = trace;
+}
+
+int WebServer::getActiveConnections() const {
+    int active = 0;
+    for (int i = 0; i < MAX_CONNECTIONS; i++) {
+        if (_connections[i].state != CONN_IDLE) {
+            active++;
+        }
+    }
+    return active;
 }
 
 // Get server's IP address
@@ -46,80 +89,304 @@ const char* WebServer::getIpAddressString() {
     return _ipString;
 }
 
-// Handle client connection
-void WebServer::handleClient() {
-    // Buffer to store the HTTP request
-    String request = "";
-    unsigned long startTime = millis();
-
-    // Read the HTTP request line by line
-    while (_client.Connected() && (millis() - startTime < 1000)) {
-        if (_client.BytesAvailable() > 0) {
-            char c = _client.Read();
-            request += c;
-
-            // If we've reached the end of the HTTP request headers
-            if (request.indexOf("\r\n\r\n") != -1) {
-                break;
+// Take new clients while a slot is free (others wait in the TCP backlog)
+void WebServer::acceptConnections() {
+    for (int i = 0; i < MAX_CONNECTIONS; i++) {
+        Connection& conn = _connections[i];
+        if (conn.state != CONN_IDLE) {
+            continue;
+        }
+
+        conn.client = _server.Accept();
+        if (!conn.client.Connected()) {
+            return;
+        }
+
+        conn.state = CONN_READING;
+        conn.lastActivity = millis();
+        conn.requestLength = 0;
+        conn.headerMatch = 0;
+        conn.chunkLength = 0;
+        conn.chunkSent = 0;
+        conn.text = "";
+        conn.textSent = 0;
+        conn.sendingFile = false;
+        conn.fileRemaining = 0;
+        conn.chunked = false;
+        conn.sendingListing = false;
+        conn.sendingTrace = false;
+    }
+}
+
+// Advance one connection; returns the bytes sent
+size_t WebServer::serviceConnection(Connection& conn, size_t budget) {
+    if (conn.state == CONN_CLOSING || !conn.client.Connected()) {
+        closeConnection(conn);
+        return 0;
+    }
+
+    if (millis() - conn.lastActivity > CONNECTION_TIMEOUT_MS) {
+#ifdef DEBUG
+        Serial.println("Web client timed out");
+#endif
+        closeConnection(conn);
+        return 0;
+    }
+
+    if (conn.state == CONN_READING) {
+        if (!readRequest(conn)) {
+            return 0;
+        }
+        parseRequest(conn);
+        conn.state = CONN_SENDING;
+    }
+
+    return sendPending(conn, budget);
+}
+
+// Collect request bytes; true once the blank line ending the headers has arrived
+bool WebServer::readRequest(Connection& conn) {
+    int16_t available = conn.client.BytesAvailable();
+    if (available <= 0) {
+        return false;
+    }
+    conn.lastActivity = millis();
+
+    // The end-of-headers search is incremental, so each byte is looked at once
+    static const char HEADER_END[] = "\r\n\r\n";
+    uint8_t data[64];
+    while (available > 0) {
+        int16_t count = conn.client.Read(data, available < (int16_t)sizeof(data) ? available
+                                                                                 : sizeof(data));
+        if (count <= 0) {
+            break;
+        }
+        available -= count;
+
+        for (int16_t i = 0; i < count; i++) {
+            char c = static_cast<char>(data[i]);
+            if (conn.requestLength < REQUEST_BUFFER_SIZE - 1) {
+                conn.request[conn.requestLength++] = c;
+            }
+
+            if (c == HEADER_END[conn.headerMatch]) {
+                conn.headerMatch++;
+            } else {
+                conn.headerMatch = (c == '\r') ? 1 : 0;
+            }
+
+            if (conn.headerMatch == 4) {
+                conn.request[conn.requestLength] = '\0';
+                conn.client.FlushInput();  // No request bodies are accepted
+                return true;
             }
         }
     }
 
-    // If we got a valid request, parse and handle it
-    if (request.length() > 0) {
-        parseRequest(request);
+    // Headers too large for the buffer: answer what we have with an error
+    if (conn.requestLength >= REQUEST_BUFFER_SIZE - 1) {
+        conn.request[0] = '\0';
+        return true;
     }
 
-    // Close the connection
-    _client.Close();
+    return false;
+}
+
+// Send up to budget bytes of the pending response; returns the bytes sent
+size_t WebServer::sendPending(Connection& conn, size_t budget) {
+    size_t sent = 0;
+
+    while (sent < budget) {
+        if (conn.chunkSent >= conn.chunkLength && !fillChunk(conn)) {
+            conn.state = CONN_CLOSING;
+            break;
+        }
+
+        size_t length = conn.chunkLength - conn.chunkSent;
+        if (length > budget - sent) {
+            length = budget - sent;
+        }
+        size_t written = conn.client.Send(conn.chunk + conn.chunkSent, length);
+        if (written == 0) {
+            // TCP window full: try again next update (the timeout covers dead peers)
+            break;
+        }
+
+        conn.chunkSent += written;
+        sent += written;
+        conn.lastActivity = millis();
+    }
+
+    return sent;
+}
+
+// Stage the next chunk of the response; false when the response is complete
+bool WebServer::fillChunk(Connection& conn) {
+    conn.chunkLength = 0;
+    conn.chunkSent = 0;
+
+    while (conn.chunkLength == 0) {
+        // Generated text (headers, pages, listing rows) first
+        if (conn.textSent < conn.text.length()) {
+            size_t length = conn.text.length() - conn.textSent;
+            if (length > SEND_CHUNK_SIZE) {
+                length = SEND_CHUNK_SIZE;
+            }
+            memcpy(conn.chunk, conn.text.c_str() + conn.textSent, length);
+            conn.textSent += length;
+            conn.chunkLength = length;
+        } else if (conn.sendingFile) {
+            uint16_t length = conn.fileRemaining < SEND_CHUNK_SIZE ? conn.fileRemaining
+                                                                   : SEND_CHUNK_SIZE;
+            int bytesRead = length > 0 ? conn.file.read(conn.chunk, length) : 0;
+            if (bytesRead > 0) {
+                conn.chunkLength = bytesRead;
+                conn.fileRemaining -= bytesRead;
+            } else {
+                conn.file.close();
+                conn.sendingFile = false;
+            }
+        } else if (conn.sendingListing) {
+            conn.text = "";
+            conn.textSent = 0;
+            conn.sendingListing = nextListingEntry(conn);
+        } else if (conn.sendingTrace) {
+            conn.sendingTrace = nextTraceChunk(conn);
+        } else {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+void WebServer::closeConnection(Connection& conn) {
+    if (conn.sendingFile) {
+        conn.file.close();
+        conn.sendingFile = false;
+    }
+    if (conn.sendingListing) {
+        conn.dir.close();
+        conn.sendingListing = false;
+    }
+    conn.sendingTrace = false;
+
+    conn.client.Close();
+    conn.text = "";
+    conn.state = CONN_IDLE;
 }
 
 // Parse HTTP request
-void WebServer::parseRequest(const String& request) {
+void WebServer::parseRequest(Connection& conn) {
+    if (conn.request[0] == '\0') {
+        sendResponse(conn, "431 Request Header Fields Too Large", "text/plain",
+                     "Request too large");
+        return;
+    }
+
+    // Chunked bodies need HTTP/1.1; older clients get close-delimited listings
+    const char* lineEnd = strchr(conn.request, '\r');
+    conn.chunked = lineEnd && lineEnd - conn.request >= 8 && strncmp(lineEnd - 8, "HTTP/1.1", 8) == 0;
+
     // Check if it's a GET request
-    if (request.startsWith("GET")) {
+    if (strncmp(conn.request, "GET ", 4) == 0) {
         // Extract the requested path
-        String path = getPath(request);
+        String path = getPath(conn.request);
 
         // Decode URL-encoded characters
         path = urlDecode(path);
 
         // If the path is empty or root, show the root directory
         if (path.length() == 0 || path == "/") {
-            sendDirectoryListing("/");
+            sendDirectoryListing(conn, "/");
+            return;
+        }
+
+#ifdef PERF_MONITORING_ENABLED
+        // Profiler report (not an SD path)
+        if (path == "/perf" || path == "/perf/reset" || path == "/perf?reset") {
+            sendPerfPage(conn, path != "/perf");
+            return;
+        }
+#endif
+
+        // Motion trace, from RAM
+        if (path == "/trace.bin" || path == "/trace.csv") {
+            sendTrace(conn, path == "/trace.csv");
             return;
         }
 
         // Check if the path is a directory or file
         if (path.endsWith("/")) {
             // It's a directory, show listing
-            sendDirectoryListing(path);
+            sendDirectoryListing(conn, path);
         } else {
             // It's a file, try to send it
             String contentType = getContentType(path);
-            sendFile(path, contentType);
+            sendFile(conn, path, contentType);
         }
     } else {
         // Only support GET requests for read-only access
-        sendResponse("405 Method Not Allowed", "text/plain", "Only GET method is supported");
+        sendResponse(conn, "405 Method Not Allowed", "text/plain",
+                     "Only GET method is supported");
     }
 }
 
-// Send HTTP response
-void WebServer::sendResponse(const String& status, const String& contentType,
+// Queue a complete HTTP response
+void WebServer::sendResponse(Connection& conn, const String& status, const String& contentType,
                              const String& content) {
-    String response = "HTTP/1.1 " + status + "\r\n";
-    response += "Content-Type: " + contentType + "\r\n";
-    response += "Connection: close\r\n";
-    response += "Content-Length: " + String(content.length()) + "\r\n";
-    response += "\r\n";
-    response += content;
-
-    _client.Send((const uint8_t*)response.c_str(), response.length());
+    conn.text = "HTTP/1.1 " + status + "\r\n";
+    conn.text += "Content-Type: " + contentType + "\r\n";
+    conn.text += "Connection: close\r\n";
+    conn.text += "Content-Length: " + String(content.length()) + "\r\n";
+    conn.text += "\r\n";
+    conn.text += content;
+    conn.textSent = 0;
+}
+
+#ifdef PERF_MONITORING_ENABLED
+// Plain-text profiler report: one row per timed section, then its histogram
+void WebServer::sendPerfPage(Connection& conn, bool reset) {
+    if (reset) {
+        Profiler.reset();
+        sendResponse(conn, "200 OK", "text/plain", "Performance counters reset\n");
+        return;
+    }
+
+    String content = "section        count     min_us    mean_us     max_us\n";
+    char line[96];
+
+    for (int i = 0; i < Profiler.getStatCount(); i++) {
+        const PerfMonitor::Stat* stat = Profiler.getStat(i);
+        if (stat->count == 0) {
+            continue;
+        }
+
+        snprintf(line, sizeof(line), "%-12s %7lu %10.1f %10.1f %10.1f\n", Profiler.getStatName(i),
+                 (unsigned long)stat->count, PerfMonitor::cyclesToMicros(stat->minCycles),
+                 PerfMonitor::cyclesToMicros(stat->totalCycles) / stat->count,
+                 PerfMonitor::cyclesToMicros(stat->maxCycles));
+        content += line;
+
+        // Non-empty buckets as "<2^n cycles>:<count>"
+        content += "  hist";
+        for (int bucket = 0; bucket < PERF_HISTOGRAM_BUCKETS; bucket++) {
+            if (stat->histogram[bucket]) {
+                snprintf(line, sizeof(line), " 2^%d:%lu", bucket,
+                         (unsigned long)stat->histogram[bucket]);
+                content += line;
+            }
+        }
+        content += "\n";
+    }
+
+    content += "\nReset: /perf/reset\n";
+    sendResponse(conn, "200 OK", "text/plain", content);
 }
+#endif
 
-// Send a file from SD card
-void WebServer::sendFile(const String& path, const String& contentType) {
+// Queue a file from the SD card (whole, a byte range, or 304); the body is streamed by update()
+void WebServer::sendFile(Connection& conn, const String& path, const String& contentType) {
     // Remove leading slash
     String sdPath = path;
     if (sdPath.startsWith("/")) {
@@ -128,42 +395,71 @@ void WebServer::sendFile(const String& path, const String& contentType) {
 
     // Check if file exists
     if (!SD.exists(sdPath.c_str())) {
-        send404();
+        send404(conn);
         return;
     }
 
     // Open the file
-    File file = SD.open(sdPath.c_str());
-    if (!file) {
-        send404();
+    conn.file = SD.open(sdPath.c_str());
+    if (!conn.file) {
+        send404(conn);
         return;
     }
 
-    // Send HTTP header
-    String header = "HTTP/1.1 200 OK\r\n";
-    header += "Content-Type: " + contentType + "\r\n";
-    header += "Connection: close\r\n";
-    header += "Content-Length: " + String(file.size()) + "\r\n";
-    header += "\r\n";
-
-    _client.Send((const uint8_t*)header.c_str(), header.length());
-
-    // Send file content in chunks
-    const size_t bufferSize = 512;
-    uint8_t buffer[bufferSize];
+    uint32_t size = conn.file.size();
+    String tag = fileTag(conn.file);
+    char value[64];
+
+    // Unchanged since the client's copy: no body, no further SD reads
+    if (getHeader(conn.request, "If-None-Match", value, sizeof(value)) && tag == value) {
+        conn.file.close();
+        conn.text = "HTTP/1.1 304 Not Modified\r\n";
+        conn.text += "ETag: " + tag + "\r\n";
+        conn.text += "Connection: close\r\n";
+        conn.text += "\r\n";
+        conn.textSent = 0;
+        return;
+    }
 
-    while (file.available()) {
-        size_t bytesRead = file.read(buffer, bufferSize);
-        if (bytesRead > 0) {
-            _client.Send(buffer, bytesRead);
+    uint32_t first = 0;
+    uint32_t last = size ? size - 1 : 0;
+    bool partial = false;
+
+    if (getHeader(conn.request, "Range", value, sizeof(value))) {
+        if (!parseRange(value, size, first, last)) {
+            conn.file.close();
+            conn.text = "HTTP/1.1 416 Range Not Satisfiable\r\n";
+            conn.text += "Content-Range: bytes */" + String(size) + "\r\n";
+            conn.text += "Connection: close\r\n";
+            conn.text += "Content-Length: 0\r\n";
+            conn.text += "\r\n";
+            conn.textSent = 0;
+            return;
         }
+        partial = true;
     }
 
-    file.close();
+    // HTTP header
+    conn.text = partial ? "HTTP/1.1 206 Partial Content\r\n" : "HTTP/1.1 200 OK\r\n";
+    conn.text += "Content-Type: " + contentType + "\r\n";
+    conn.text += "Connection: close\r\n";
+    conn.text += "Accept-Ranges: bytes\r\n";
+    conn.text += "ETag: " + tag + "\r\n";
+    if (partial) {
+        conn.text += "Content-Range: bytes " + String(first) + "-" + String(last) + "/" +
+                     String(size) + "\r\n";
+    }
+    conn.fileRemaining = size ? last - first + 1 : 0;
+    conn.text += "Content-Length: " + String(conn.fileRemaining) + "\r\n";
+    conn.text += "\r\n";
+    conn.textSent = 0;
+
+    conn.file.seek(first);
+    conn.sendingFile = true;
 }
 
-// Send directory listing
-void WebServer::sendDirectoryListing(const String& path) {
+// Queue a directory listing; rows are generated one entry per chunk
+void WebServer::sendDirectoryListing(Connection& conn, const String& path) {
     // Remove leading slash for SD card path
     String sdPath = path;
     if (sdPath.startsWith("/")) {
@@ -176,19 +472,31 @@ void WebServer::sendDirectoryListing(const String& path) {
     }
 
     // Open the directory
-    File dir;
     if (sdPath == "/") {
-        dir = SD.open("/");
+        conn.dir = SD.open("/");
     } else {
-        dir = SD.open(sdPath.c_str());
+        conn.dir = SD.open(sdPath.c_str());
     }
 
     // Check if it's a valid directory
-    if (!dir || !dir.isDirectory()) {
-        send404();
+    if (!conn.dir || !conn.dir.isDirectory()) {
+        if (conn.dir) {
+            conn.dir.close();
+        }
+        send404(conn);
         return;
     }
 
+    // Length unknown until the last entry: chunked for HTTP/1.1, otherwise the
+    // body ends when the connection closes
+    conn.text = "HTTP/1.1 200 OK\r\n";
+    conn.text += "Content-Type: text/html\r\n";
+    conn.text += "Connection: close\r\n";
+    if (conn.chunked) {
+        conn.text += "Transfer-Encoding: chunked\r\n";
+    }
+    conn.text += "\r\n";
+
     // Start creating HTML content
     String content = "<!DOCTYPE html>\n";
     content += "<html><head><title>SD Card Browser - " + path + "</title>\n";
@@ -215,43 +523,55 @@ void WebServer::sendDirectoryListing(const String& path) {
     }
 
     content += "<ul>\n";
+    appendChunk(conn, content);
+    conn.textSent = 0;
+    conn.listingPath = path;
+    conn.sendingListing = true;
+}
 
-    // List all files and directories
-    File entry;
-    while (entry = dir.openNextFile()) {
-        String name = entry.name();
-        String entryPath;
-
-        // Handle root directory special case
-        if (path == "/") {
-            entryPath = "/" + name;
-        } else {
-            entryPath = path + name;
+// Put the next listing row in conn.text; false (after queuing the footer) at the end
+bool WebServer::nextListingEntry(Connection& conn) {
+    conn.text = "";
+
+    File entry = conn.dir.openNextFile();
+    if (!entry) {
+        String footer = "</ul>\n";
+        footer += "<p><small>Space Maquette SD Card Browser</small></p>\n";
+        footer += "</body></html>";
+        appendChunk(conn, footer);
+        if (conn.chunked) {
+            conn.text += "0\r\n\r\n";  // Last chunk
         }
+        conn.dir.close();
+        return false;
+    }
 
-        if (entry.isDirectory()) {
-            content += "<li class=\"directory\"><a href=\"" + entryPath + "/\">[DIR] " + name +
-                       "/</a></li>\n";
-        } else {
-            content += "<li class=\"file\"><a href=\"" + entryPath + "\">" + name + "</a> (" +
-                       entry.size() + " bytes)</li>\n";
-        }
+    String name = entry.name();
+    String entryPath;
 
-        entry.close();
+    // Handle root directory special case
+    if (conn.listingPath == "/") {
+        entryPath = "/" + name;
+    } else {
+        entryPath = conn.listingPath + name;
     }
 
-    content += "</ul>\n";
-    content += "<p><small>Space Maquette SD Card Browser</small></p>\n";
-    content += "</body></html>";
-
-    dir.close();
+    String row;
+    if (entry.isDirectory()) {
+        row = "<li class=\"directory\"><a href=\"" + entryPath + "/\">[DIR] " + name +
+              "/</a></li>\n";
+    } else {
+        row = "<li class=\"file\"><a href=\"" + entryPath + "\">" + name + "</a> (" +
+              entry.size() + " bytes)</li>\n";
+    }
+    appendChunk(conn, row);
 
-    // Send the response
-    sendResponse("200 OK", "text/html", content);
+    entry.close();
+    return true;
 }
 
 // Send 404 Not Found response
-void WebServer::send404() {
+void WebServer::send404(Connection& conn) {
     String content = "<!DOCTYPE html>\n";
     content += "<html><head><title>404 Not Found</title></head><body>\n";
     content += "<h1>404 Not Found</h1>\n";
@@ -259,7 +579,80 @@ void WebServer::send404() {
     content += "<p><a href=\"/\">Return to home</a></p>\n";
     content += "</body></html>";
 
-    sendResponse("404 Not Found", "text/html", content);
+    sendResponse(conn, "404 Not Found", "text/html", content);
+}
+
+// Queue the frozen motion trace: the blob with its length, or CSV rows like a listing
+void WebServer::sendTrace(Connection& conn, bool csv) {
+    if (!_trace) {
+        send404(conn);
+        return;
+    }
+
+    if (_trace->getState() != MotionTrace::TRACE_DONE) {
+        sendResponse(conn, "503 Service Unavailable", "text/plain",
+                     String("Motion trace not captured yet (") +
+                         MotionTrace::getStateName(_trace->getState()) + ")\n");
+        return;
+    }
+
+    conn.sendingTrace = true;
+    conn.traceCsv = csv;
+    conn.traceOffset = 0;
+    conn.traceCapture = _trace->getCaptureId();
+
+    conn.text = "HTTP/1.1 200 OK\r\n";
+    conn.text += "Connection: close\r\n";
+    if (csv) {
+        conn.text += "Content-Type: text/csv\r\n";
+        if (conn.chunked) {
+            conn.text += "Transfer-Encoding: chunked\r\n";
+        }
+        conn.text += "\r\n";
+        appendChunk(conn, MotionTrace::getCsvHeader());
+    } else {
+        conn.text += "Content-Type: application/octet-stream\r\n";
+        conn.text += "Content-Length: " + String(_trace->getBlobSize()) + "\r\n";
+        conn.text += "\r\n";
+    }
+    conn.textSent = 0;
+}
+
+// Blob bytes straight into the chunk, or a chunk's worth of CSV rows as text
+bool WebServer::nextTraceChunk(Connection& conn) {
+    // Re-armed since the request: end the response short rather than mix captures
+    if (_trace->getState() != MotionTrace::TRACE_DONE ||
+        _trace->getCaptureId() != conn.traceCapture) {
+        return false;
+    }
+
+    if (!conn.traceCsv) {
+        size_t length = _trace->readBlob(conn.traceOffset, conn.chunk, SEND_CHUNK_SIZE);
+        conn.traceOffset += length;
+        conn.chunkLength = length;
+        return length > 0;
+    }
+
+    String rows;
+    char row[96];
+    while (rows.length() + sizeof(row) <= SEND_CHUNK_SIZE) {
+        if (_trace->getCsvRow(conn.traceOffset, row, sizeof(row)) == 0) {
+            break;
+        }
+        rows += row;
+        conn.traceOffset++;
+    }
+
+    conn.text = "";
+    conn.textSent = 0;
+    if (rows.length() == 0) {
+        if (conn.chunked) {
+            conn.text = "0\r\n\r\n";  // Last chunk
+        }
+        return false;
+    }
+    appendChunk(conn, rows);
+    return true;
 }
 
 // Get MIME content type from file extension
@@ -322,14 +715,115 @@ String WebServer::urlDecode(const String& text) {
     return decoded;
 }
 
-// Extract path from HTTP request
-String WebServer::getPath(const String& request) {
-    int startPos = request.indexOf("GET ") + 4;
-    int endPos = request.indexOf(" HTTP/");
+// Append body data to the pending text, framed as one chunk when the response is chunked
+void WebServer::appendChunk(Connection& conn, const String& data) {
+    if (conn.chunked) {
+        conn.text += String(data.length(), HEX) + "\r\n";
+        conn.text += data;
+        conn.text += "\r\n";
+    } else {
+        conn.text += data;
+    }
+}
+
+// Copy a request header's value (case-insensitive name); false if absent
+bool WebServer::getHeader(const char* request, const char* name, char* value, size_t size) {
+    size_t nameLength = strlen(name);
+    const char* line = strstr(request, "\r\n");
+
+    while (line && line[2] != '\r' && line[2] != '\0') {
+        line += 2;
+        if (strncasecmp(line, name, nameLength) == 0 && line[nameLength] == ':') {
+            const char* start = line + nameLength + 1;
+            while (*start == ' ') {
+                start++;
+            }
+
+            size_t length = 0;
+            while (start[length] && start[length] != '\r' && length < size - 1) {
+                value[length] = start[length];
+                length++;
+            }
+            value[length] = '\0';
+            return true;
+        }
+        line = strstr(line, "\r\n");
+    }
+
+    return false;
+}
+
+// Parse "bytes=<first>-<last>", "bytes=<first>-" or "bytes=-<suffix>" against the file size
+bool WebServer::parseRange(const char* value, uint32_t size, uint32_t& first, uint32_t& last) {
+    if (strncmp(value, "bytes=", 6) != 0 || size == 0 || strchr(value, ',')) {
+        return false;  // Multipart ranges are not supported
+    }
+    const char* spec = value + 6;
+    char* end;
+
+    if (*spec == '-') {
+        // Last n bytes (tail)
+        uint32_t suffix = strtoul(spec + 1, &end, 10);
+        if (end == spec + 1 || suffix == 0) {
+            return false;
+        }
+        first = suffix < size ? size - suffix : 0;
+        last = size - 1;
+        return true;
+    }
+
+    first = strtoul(spec, &end, 10);
+    if (end == spec || *end != '-' || first >= size) {
+        return false;
+    }
+
+    const char* lastSpec = end + 1;
+    last = *lastSpec ? strtoul(lastSpec, &end, 10) : size - 1;
+    if (*lastSpec && end == lastSpec) {
+        return false;
+    }
+    if (last >= size) {
+        last = size - 1;
+    }
+    return last >= first;
+}
+
+// ETag from the size and an FNV-1a hash of the last sector (the SD library exposes no
+// modification time; appends change the size, rewrites change the tail)
+String WebServer::fileTag(File& file) {
+    uint32_t size = file.size();
+    uint32_t hash = 2166136261UL;
+
+    uint8_t buffer[64];
+    file.seek(size > SEND_CHUNK_SIZE ? size - SEND_CHUNK_SIZE : 0);
+    int bytesRead;
+    while ((bytesRead = file.read(buffer, sizeof(buffer))) > 0) {
+        for (int i = 0; i < bytesRead; i++) {
+            hash = (hash ^ buffer[i]) * 16777619UL;
+        }
+    }
+    file.seek(0);
+
+    char tag[24];
+    snprintf(tag, sizeof(tag), "\"%lx-%08lx\"", (unsigned long)size, (unsigned long)hash);
+    return String(tag);
+}
+
+// Extract path from the request line ("GET <path> HTTP/1.x")
+String WebServer::getPath(const char* request) {
+    const char* start = request + 4;
+    const char* end = strstr(start, " HTTP/");
+    const char* lineEnd = strchr(start, '\r');
 
-    if (startPos < 4 || endPos < 0 || startPos >= endPos) {
+    if (!end || (lineEnd && end > lineEnd) || end == start ||
+        (size_t)(end - start) > MAX_PATH_LENGTH) {
         return "/";
     }
 
-    return request.substring(startPos, endPos);
+    String path;
+    path.reserve(end - start);
+    for (const char* c = start; c < end; c++) {
+        path += *c;
+    }
+    return path;
 }
@@ -0,0 +1,154 @@
+/**
+ * Space Maquette - Benchmark Harness
+ *
+ * Timing and regression tracking for the native benchmark suite. Each
+ * benchmark is run BENCH_REPEATS times for at least BENCH_MIN_TIME_MS and
+ * the best run is kept, which filters most scheduler noise on a shared host.
+ *
+ * Results are compared with a per-machine baseline file (host speeds differ
+ * too much for a checked-in one):
+ *   BENCH_BASELINE   baseline path (default .pio/bench_baseline.txt)
+ *   BENCH_TOLERANCE  allowed slowdown in percent (default 15)
+ *   BENCH_UPDATE=1   record this run as the new baseline
+ * The first run on a machine records the baseline. Later runs report every
+ * metric against it and fail the regression check when one got slower by
+ * more than the tolerance.
+ */
+
+#pragma once
+
+// Standard headers first: Arduino.h defines min/max as macros
+#include <chrono>
+#include <functional>
+#include <map>
+#include <string>
+#include <vector>
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#define BENCH_REPEATS 5
+#define BENCH_MIN_TIME_MS 100
+#define BENCH_DEFAULT_TOLERANCE 15.0
+#define BENCH_DEFAULT_BASELINE ".pio/bench_baseline.txt"
+
+class BenchHarness {
+public:
+    struct Result {
+        std::string name;
+        double value;       // Operations (or bytes) per second
+        std::string unit;
+        double baseline;    // 0 when there is no baseline entry
+        double change;      // Percent, negative = slower
+    };
+
+    BenchHarness() : _tolerance(BENCH_DEFAULT_TOLERANCE), _baselinePath(BENCH_DEFAULT_BASELINE) {
+        if (const char* path = getenv("BENCH_BASELINE")) {
+            _baselinePath = path;
+        }
+        if (const char* tolerance = getenv("BENCH_TOLERANCE")) {
+            _tolerance = atof(tolerance);
+        }
+        const char* update = getenv("BENCH_UPDATE");
+        _update = update && update[0] == '1';
+        loadBaseline();
+    }
+
+    // Time body(), which performs opsPerCall operations per call; records and
+    // returns operations per second
+    double run(const char* name, const char* unit, double opsPerCall,
+               const std::function<void()>& body) {
+        double best = 0.0;
+
+        for (int repeat = 0; repeat < BENCH_REPEATS; repeat++) {
+            uint64_t calls = 0;
+            auto start = std::chrono::steady_clock::now();
+            double elapsed = 0.0;
+
+            while (elapsed < BENCH_MIN_TIME_MS / 1000.0) {
+                body();
+                calls++;
+                elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start)
+                              .count();
+            }
+
+            double rate = calls * opsPerCall / elapsed;
+            if (rate > best) {
+                best = rate;
+            }
+        }
+
+        record(name, unit, best);
+        return best;
+    }
+
+    // Record a figure derived from another run (e.g. bytes/s from commands/s)
+    void record(const char* name, const char* unit, double value) {
+        Result result = {name, value, unit, 0.0, 0.0};
+        auto entry = _baseline.find(name);
+        if (entry != _baseline.end() && entry->second > 0.0) {
+            result.baseline = entry->second;
+            result.change = (value - entry->second) * 100.0 / entry->second;
+        }
+        _results.push_back(result);
+
+        printf("BENCH %-24s %14.0f %-8s", name, value, unit);
+        if (result.baseline > 0.0) {
+            printf(" %+7.1f%%%s\n", result.change,
+                   result.change < -_tolerance ? "  REGRESSION" : "");
+        } else {
+            printf("    (new)\n");
+        }
+    }
+
+    // Names of the metrics that got slower than the tolerance allows
+    std::vector<std::string> regressions() const {
+        std::vector<std::string> names;
+        for (const Result& result : _results) {
+            if (result.baseline > 0.0 && result.change < -_tolerance) {
+                names.push_back(result.name);
+            }
+        }
+        return names;
+    }
+
+    // Write the baseline when asked to or when none exists yet
+    void finish() {
+        if (!_update && !_baseline.empty()) {
+            return;
+        }
+
+        FILE* file = fopen(_baselinePath.c_str(), "w");
+        if (!file) {
+            printf("BENCH baseline not written: %s\n", _baselinePath.c_str());
+            return;
+        }
+        for (const Result& result : _results) {
+            fprintf(file, "%s %.0f\n", result.name.c_str(), result.value);
+        }
+        fclose(file);
+        printf("BENCH baseline written to %s\n", _baselinePath.c_str());
+    }
+
+    double getTolerance() const { return _tolerance; }
+
+private:
+    std::map<std::string, double> _baseline;
+    std::vector<Result> _results;
+    double _tolerance;
+    std::string _baselinePath;
+    bool _update;
+
+    void loadBaseline() {
+        FILE* file = fopen(_baselinePath.c_str(), "r");
+        if (!file) {
+            return;
+        }
+        char name[64];
+        double value;
+        while (fscanf(file, "%63s %lf", name, &value) == 2) {
+            _baseline[name] = value;
+        }
+        fclose(file);
+    }
+};
@@ -0,0 +1,310 @@
+/**
+ * Space Maquette - Host Benchmarks
+ *
+ * Throughput of the hot paths that do not depend on hardware timing: command
+ * parsing (text and binary), dispatch through the full command handler,
+ * configuration lookups, CRC and motion planning. Runs under the native
+ * environment only (pio test -e native -f test_benchmark); see
+ * bench_harness.h for the baseline and tolerance settings.
+ */
+
+#include "bench_harness.h"
+
+#include "command_handler.h"
+#include "command_parser.h"
+#include "configuration_manager.h"
+#include "crc16.h"
+#include "emergency.h"
+#include "motion_control.h"
+#include "native_shims.h"
+#include "rangefinder.h"
+#include "scan_controller.h"
+#include "serial_devices.h"
+#include "telemetry.h"
+#include "tilt_servo.h"
+#include "unity.h"
+
+#define ESTOP_PIN DI6
+#define RELAY_PIN IO0
+
+// Commands per parser benchmark call
+#define COMMANDS_PER_CALL 64
+
+static BenchHarness bench;
+
+// Host connection stand-in: received bytes come from a buffer the benchmark
+// refills, responses are counted (errors separately) and dropped
+class BenchStream : public BulkStream {
+public:
+    void feed(const std::string& data) { _rx.append(data); }
+    bool drained() const { return _position >= _rx.size(); }
+    size_t getBytesWritten() const { return _written; }
+    size_t getErrors() const { return _errors; }
+
+    int readAvailable(uint8_t* buffer, size_t size) override {
+        size_t count = _rx.size() - _position;
+        if (count > size) {
+            count = size;
+        }
+        memcpy(buffer, _rx.data() + _position, count);
+        _position += count;
+        if (drained()) {
+            _rx.clear();
+            _position = 0;
+        }
+        return (int)count;
+    }
+
+    int available() override { return (int)(_rx.size() - _position); }
+    int read() override {
+        uint8_t c;
+        return readAvailable(&c, 1) == 1 ? c : -1;
+    }
+    int peek() override { return drained() ? -1 : (uint8_t)_rx[_position]; }
+    size_t write(uint8_t data) override {
+        (void)data;
+        _written++;
+        return 1;
+    }
+    size_t write(const uint8_t* buffer, size_t size) override {
+        if (size >= 5 && memcmp(buffer, "ERROR", 5) == 0) {
+            _errors++;
+        }
+        _written += size;
+        return size;
+    }
+    using Print::write;
+
+private:
+    std::string _rx;
+    size_t _position = 0;
+    size_t _written = 0;
+    size_t _errors = 0;
+};
+
+// Binary frame: sync, length (LE), opcode + int32 LE parameters, CRC16 (LE)
+static std::string binaryFrame(uint8_t opcode, const int32_t* params, int count) {
+    std::string body(1, (char)opcode);
+    for (int i = 0; i < count; i++) {
+        for (int shift = 0; shift < 32; shift += 8) {
+            body += (char)((params[i] >> shift) & 0xFF);
+        }
+    }
+
+    uint16_t crc = crc16Modbus((const uint8_t*)body.data(), body.size());
+    std::string frame;
+    frame += (char)0xA5;
+    frame += (char)(body.size() & 0xFF);
+    frame += (char)(body.size() >> 8);
+    frame += body;
+    frame += (char)(crc & 0xFF);
+    frame += (char)(crc >> 8);
+    return frame;
+}
+
+// Parse everything fed so far
+static void drain(CommandParser& parser, BenchStream& stream) {
+    do {
+        parser.update();
+    } while (!stream.drained());
+}
+
+// The firmware's module graph, wired as in main.cpp
+struct BenchSystem {
+    BenchStream stream;
+    CommandParser parser;
+    SerialDevices serialDevices;
+    Rangefinder rangefinder;
+    TiltServo tiltServo;
+    MotionControl motion;
+    EmergencyStop estop;
+    ConfigurationManager config;
+    ScanController scanner;
+    Telemetry telemetry;
+    CommandHandler handler;
+
+    BenchSystem()
+        : parser(stream),
+          serialDevices(Serial1, RELAY_PIN),
+          rangefinder(serialDevices),
+          tiltServo(serialDevices),
+          estop(ESTOP_PIN),
+          scanner(motion, rangefinder, parser),
+          telemetry(parser, motion, rangefinder, estop),
+          handler(parser, motion, rangefinder, estop, config, scanner, telemetry) {
+        native::setInput(ESTOP_PIN, HIGH);  // Released
+        estop.init(true);
+        serialDevices.init(9600);
+        tiltServo.begin();
+        motion.setTiltServo(&tiltServo);
+        motion.init();
+        motion.enableAllMotors();
+        rangefinder.begin();
+        parser.init();
+        handler.init();
+        config.setInt("velocity_x", 2500);
+    }
+
+    // Send one command line and run the loop stages that answer it
+    void command(const std::string& line) {
+        stream.feed(line);
+        drain(parser, stream);
+        motion.update();
+    }
+};
+
+void setUp(void) {
+    native::reset();
+}
+
+void test_bench_parser_text(void) {
+    BenchStream stream;
+    CommandParser parser(stream);
+    int handled = 0;
+    parser.init();
+    parser.setCommandHandler([&handled](CommandParser& p) -> void {
+        handled += p.getParamCount();
+    });
+
+    const std::string line = "MOVE:1000,2000,3000,90,45\r\n";
+    std::string block;
+    for (int i = 0; i < COMMANDS_PER_CALL; i++) {
+        block += line;
+    }
+
+    double rate = bench.run("parser_text", "cmd/s", COMMANDS_PER_CALL, [&]() {
+        stream.feed(block);
+        drain(parser, stream);
+    });
+    bench.record("parser_text_bytes", "B/s", rate * line.size());
+    TEST_ASSERT_TRUE(handled > 0);
+}
+
+void test_bench_parser_binary(void) {
+    BenchStream stream;
+    CommandParser parser(stream);
+    int handled = 0;
+    parser.init();
+    parser.setProtocol(CommandParser::PROTOCOL_BINARY);
+    parser.setCommandHandler([&handled](CommandParser& p) -> void {
+        handled += p.getParamCount();
+    });
+
+    const int32_t params[5] = {1000, 2000, 3000, 90, 45};
+    const std::string frame = binaryFrame(CommandParser::OP_MOVE, params, 5);
+    std::string block;
+    for (int i = 0; i < COMMANDS_PER_CALL; i++) {
+        block += frame;
+    }
+
+    double rate = bench.run("parser_binary", "cmd/s", COMMANDS_PER_CALL, [&]() {
+        stream.feed(block);
+        drain(parser, stream);
+    });
+    bench.record("parser_binary_bytes", "B/s", rate * frame.size());
+    TEST_ASSERT_TRUE(handled > 0);
+}
+
+void test_bench_dispatch(void) {
+    BenchSystem system;
+
+    // Every command must be answered, or the figures measure an error path
+    size_t before = system.stream.getBytesWritten();
+    system.command("PING\r\n");
+    TEST_ASSERT_TRUE(system.stream.getBytesWritten() > before);
+
+    bench.run("dispatch_ping", "cmd/s", 1, [&]() { system.command("PING\r\n"); });
+    bench.run("dispatch_status", "cmd/s", 1, [&]() { system.command("STATUS\r\n"); });
+    bench.run("dispatch_get", "cmd/s", 1, [&]() { system.command("GET:velocity_x\r\n"); });
+
+    // Each queued move completes on the next update (shim motors land instantly)
+    int32_t target = 0;
+    bench.run("dispatch_moveq", "cmd/s", 1, [&]() {
+        target = (target + 100) % 10000;
+        char line[48];
+        snprintf(line, sizeof(line), "MOVEQ:%ld,%ld,%ld\r\n", (long)target, (long)target,
+                 (long)target);
+        system.command(line);
+        system.motion.update();
+    });
+    size_t errors = system.stream.getErrors();
+    TEST_ASSERT_EQUAL(0, errors);
+}
+
+void test_bench_config_lookup(void) {
+    ConfigurationManager config;
+    char key[24];
+
+    // A realistically sized table, looked up near its end
+    for (int i = 0; i < 40; i++) {
+        snprintf(key, sizeof(key), "setting_%02d", i);
+        config.setInt(key, i);
+    }
+    ConfigKey handle = config.bind("setting_39");
+    volatile int sink = 0;
+
+    bench.run("config_by_name", "get/s", 1, [&]() { sink += config.getInt("setting_39", 0); });
+    bench.run("config_by_handle", "get/s", 1, [&]() { sink += config.getInt(handle, 0); });
+    int value = config.getInt(handle, 0);
+    TEST_ASSERT_EQUAL(39, value);
+}
+
+void test_bench_crc16(void) {
+    uint8_t data[512];
+    for (size_t i = 0; i < sizeof(data); i++) {
+        data[i] = (uint8_t)(i * 31);
+    }
+    volatile uint16_t sink = 0;
+
+    bench.run("crc16", "B/s", sizeof(data), [&]() { sink ^= crc16Modbus(data, sizeof(data)); });
+
+    // CRC-16/MODBUS check value
+    uint16_t check = crc16Modbus((const uint8_t*)"123456789", 9);
+    TEST_ASSERT_EQUAL_HEX16(0x4B37, check);
+}
+
+void test_bench_motion(void) {
+    BenchSystem system;
+    MotionControl& motion = system.motion;
+    int32_t target = 0;
+
+    bench.run("motion_queue", "move/s", 1, [&]() {
+        target = (target + 100) % 10000;
+        motion.queueMove(target, target / 2, target / 4);
+        motion.update();
+        motion.update();
+    });
+
+    bench.run("motion_coordinated", "move/s", 1, [&]() {
+        target = (target + 100) % 10000;
+        motion.moveCoordinated(target, 10000 - target, target / 2, target / 4);
+        motion.update();
+    });
+    bool moving = motion.isMoving();
+    TEST_ASSERT_FALSE(moving);
+}
+
+void test_bench_no_regressions(void) {
+    bench.finish();
+
+    std::vector<std::string> slower = bench.regressions();
+    std::string message = "Slower than baseline:";
+    for (const std::string& name : slower) {
+        message += " " + name;
+    }
+    TEST_ASSERT_TRUE_MESSAGE(slower.empty(), message.c_str());
+}
+
+int main(void) {
+    UNITY_BEGIN();
+
+    RUN_TEST(test_bench_parser_text);
+    RUN_TEST(test_bench_parser_binary);
+    RUN_TEST(test_bench_dispatch);
+    RUN_TEST(test_bench_config_lookup);
+    RUN_TEST(test_bench_crc16);
+    RUN_TEST(test_bench_motion);
+    RUN_TEST(test_bench_no_regressions);
+
+    return UNITY_END();
+}
@@ -5,7 +5,7 @@
  */
 
  #include <unity.h>
- #include "../include/command_parser.h"
+ #include "command_parser.h"
  
  // Mock serial class for testing
  class MockSerial : public Stream {
@@ -14,8 +14,8 @@
      
      // Add a command to the input buffer
      void addCommand(const char* command) {
-         for (size_t i = 0; command[i] != '\0' && _available < sizeof(_buffer); i++) {
-             _buffer[_available++] = command[i];
+         for (size_t i = 0; command[i] != '\0' && _position + _available < sizeof(_buffer); i++) {
+             _buffer[_position + _available++] = command[i];
          }
      }
      
@@ -74,11 +74,13 @@
  
  // Command handler flag for testing
  bool commandHandlerCalled = false;
+ int commandHandlerCount = 0;
  char lastCommand[32] = "";
  int lastParamCount = 0;
  
  void testCommandHandler(CommandParser& parser) {
      commandHandlerCalled = true;
+     commandHandlerCount++;
      strcpy(lastCommand, parser.getCommand());
      lastParamCount = parser.getParamCount();
  }
@@ -86,6 +88,7 @@
  void setUp(void) {
      // Reset test state
      commandHandlerCalled = false;
+     commandHandlerCount = 0;
      lastCommand[0] = '\0';
      lastParamCount = 0;
  }
@@ -173,6 +176,88 @@
      TEST_ASSERT_TRUE(strstr(serial.getLastResponse(), "OK:Value: 123.46") != NULL);
  }
  
+ void test_parser_multiple_commands_per_update(void) {
+     MockSerial serial;
+     CommandParser parser(serial);
+     
+     parser.init();
+     parser.setCommandHandler(testCommandHandler);
+     
+     // Two complete lines and a partial one arrive together
+     serial.addCommand("PING\r\nHOME:X\nMOV");
+     
+     TEST_ASSERT_TRUE(parser.update());
+     TEST_ASSERT_EQUAL(2, commandHandlerCount);
+     TEST_ASSERT_EQUAL_STRING("HOME", lastCommand);
+     
+     // The partial line completes on the next read
+     serial.addCommand("E:1,2,3\n");
+     
+     TEST_ASSERT_TRUE(parser.update());
+     TEST_ASSERT_EQUAL(3, commandHandlerCount);
+     TEST_ASSERT_EQUAL_STRING("MOVE", lastCommand);
+     TEST_ASSERT_EQUAL(3, lastParamCount);
+ }
+ 
+ // Handler that answers every command with its name, and starts batches
+ void echoCommandHandler(CommandParser& parser) {
+     if (strcmp(parser.getCommand(), "BATCH") == 0) {
+         parser.beginBatch(parser.getParamAsInt(0));
+     } else {
+         parser.sendResponse("OK", parser.getCommand());
+     }
+ }
+ 
+ void test_parser_batch_response(void) {
+     MockSerial serial;
+     CommandParser parser(serial);
+     
+     parser.init();
+     parser.setCommandHandler(echoCommandHandler);
+     
+     // Two commands answered as one aggregated reply
+     serial.addCommand("BATCH:2\nPING\nSTATUS\n");
+     parser.update();
+     
+     TEST_ASSERT_EQUAL_STRING("OK:BATCH=2|OK:PING|OK:STATUS\r\n", serial.getLastResponse());
+     TEST_ASSERT_FALSE(parser.isBatchActive());
+ }
+ 
+ // Feed a line one character at a time (the USB console path)
+ void typeLine(CommandParser& parser, const char* line) {
+     while (*line) {
+         parser.processChar(*line++);
+     }
+ }
+ 
+ void test_parser_checksum(void) {
+     MockSerial serial;
+     CommandParser parser(serial);
+     
+     parser.init();
+     parser.setCommandHandler(testCommandHandler);
+     
+     // CRC-16/MODBUS of "HOME:X" is 0xBE4F
+     typeLine(parser, "HOME:X;BE4F\n");
+     TEST_ASSERT_EQUAL(1, commandHandlerCount);
+     TEST_ASSERT_EQUAL_STRING("HOME", lastCommand);
+     
+     // A backspace into the checksummed part is accounted for
+     typeLine(parser, "HOME:Y\bX;be4f\n");
+     TEST_ASSERT_EQUAL(2, commandHandlerCount);
+     
+     // Mismatch: rejected, not dispatched
+     typeLine(parser, "HOME:Y;BE4F\n");
+     TEST_ASSERT_EQUAL(2, commandHandlerCount);
+     TEST_ASSERT_TRUE(strstr(serial.getLastResponse(), "ERROR:CHECKSUM_MISMATCH") != NULL);
+     
+     // The same check on a received block
+     serial.addCommand("PING;60B5\n");
+     parser.update();
+     TEST_ASSERT_EQUAL(3, commandHandlerCount);
+     TEST_ASSERT_EQUAL_STRING("PING", lastCommand);
+ }
+ 
  int main(void) {
      UNITY_BEGIN();
      
@@ -181,6 +266,9 @@
      RUN_TEST(test_parser_command_with_params);
      RUN_TEST(test_parser_send_response);
      RUN_TEST(test_parser_formatted_response);
+     RUN_TEST(test_parser_multiple_commands_per_update);
+     RUN_TEST(test_parser_batch_response);
+     RUN_TEST(test_parser_checksum);
      
      return UNITY_END();
  }
@@ -0,0 +1,100 @@
+/**
+ * Space Maquette - Configuration Manager Tests
+ *
+ * Unit tests for key interning, bound handles and cached typed values.
+ */
+
+#include "configuration_manager.h"
+#include "unity.h"
+
+void setUp(void) {
+    // Each test builds its own manager
+}
+
+void test_config_typed_values(void) {
+    ConfigurationManager config;
+
+    config.setString("velocity_x", "2500");
+    config.setString("settle", "12.5");
+    config.setString("estop_interrupt", "Off");
+    config.setString("log_file", "EVENTS.LOG");
+
+    TEST_ASSERT_EQUAL(2500, config.getInt("velocity_x", 0));
+    TEST_ASSERT_EQUAL_FLOAT(12.5f, config.getFloat("settle", 0.0f));
+    TEST_ASSERT_FALSE(config.getBool("estop_interrupt", true));
+    TEST_ASSERT_EQUAL_STRING("EVENTS.LOG", config.getString("log_file", "").c_str());
+
+    // Not a boolean word: the default wins
+    TEST_ASSERT_TRUE(config.getBool("log_file", true));
+
+    // Missing keys return the default
+    TEST_ASSERT_EQUAL(42, config.getInt("missing", 42));
+    TEST_ASSERT_FALSE(config.hasKey("missing"));
+}
+
+void test_config_bound_handle(void) {
+    ConfigurationManager config;
+
+    // Bound before it has a value
+    ConfigKey key = config.bind("scan_settle_ms");
+    TEST_ASSERT_NOT_EQUAL(CONFIG_NO_KEY, key);
+    TEST_ASSERT_EQUAL(100, config.getInt(key, 100));
+    TEST_ASSERT_FALSE(config.hasKey("scan_settle_ms"));
+
+    // Later writes through the name are seen through the handle
+    config.setInt("scan_settle_ms", 250);
+    TEST_ASSERT_EQUAL(250, config.getInt(key, 100));
+    TEST_ASSERT_EQUAL(key, config.bind("scan_settle_ms"));
+
+    // clear() drops the value but keeps the handle valid
+    config.clear();
+    TEST_ASSERT_EQUAL(100, config.getInt(key, 100));
+    config.setInt("scan_settle_ms", 300);
+    TEST_ASSERT_EQUAL(300, config.getInt(key, 100));
+    TEST_ASSERT_EQUAL(1, config.getCount());
+}
+
+void test_config_table_full(void) {
+    ConfigurationManager config;
+    char key[16];
+
+    for (int i = 0; i < CONFIG_MAX_ITEMS; i++) {
+        snprintf(key, sizeof(key), "key_%d", i);
+        config.setInt(key, i);
+    }
+
+    // Every key is still found through the index
+    for (int i = 0; i < CONFIG_MAX_ITEMS; i++) {
+        snprintf(key, sizeof(key), "key_%d", i);
+        TEST_ASSERT_EQUAL(i, config.getInt(key, -1));
+    }
+
+    // No room for another key
+    TEST_ASSERT_EQUAL(CONFIG_NO_KEY, config.bind("one_more"));
+    config.setInt("one_more", 1);
+    TEST_ASSERT_FALSE(config.hasKey("one_more"));
+}
+
+void test_config_long_key(void) {
+    ConfigurationManager config;
+    const char* key = "a_key_much_longer_than_the_stored_key_length";
+
+    // Stored truncated, still found by the full name and not interned twice
+    config.setInt(key, 7);
+    config.setInt(key, 8);
+    TEST_ASSERT_EQUAL(8, config.getInt(key, -1));
+    TEST_ASSERT_TRUE(config.hasKey(key));
+    TEST_ASSERT_EQUAL(1, config.getCount());
+    TEST_ASSERT_EQUAL(config.bind(key), config.bind(key));
+}
+
+int main(void) {
+    UNITY_BEGIN();
+
+    RUN_TEST(test_config_typed_values);
+    RUN_TEST(test_config_bound_handle);
+    RUN_TEST(test_config_table_full);
+    RUN_TEST(test_config_long_key);
+
+    return UNITY_END();
+}
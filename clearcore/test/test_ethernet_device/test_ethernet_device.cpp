@@ -0,0 +1,157 @@
+/**
+ * Space Maquette - Ethernet Device Tests
+ *
+ * Control session TX ring: output held back by a full TCP window is dropped
+ * whole responses at a time, never from inside one the client has partly
+ * received. The shim's sendLimit makes Send() short or refuse data.
+ */
+
+#include <string>
+
+#include "ethernet_device.h"
+#include "native_shims.h"
+#include "unity.h"
+
+// Device with the server up, rebuilt for every test
+struct EthernetFixture {
+    EthernetDevice ethernet;
+
+    EthernetFixture() {
+        ethernet.setHeartbeatInterval(0);  // Only responses on the wire
+        ethernet.init();
+        for (int i = 0; i < 50; i++) {
+            ethernet.update();
+            native::advanceMillis(100);
+        }
+    }
+
+    // Connect a client and let the device take it as the control session
+    std::shared_ptr<native::TcpConnection> connect() {
+        std::shared_ptr<native::TcpConnection> connection =
+            native::connect(EthernetDevice::DEFAULT_PORT);
+        for (int i = 0; i < 20 && connection->fromDevice.empty() && !ethernet.isConnected(); i++) {
+            native::advanceMillis(1000);
+            ethernet.update();
+        }
+        return connection;
+    }
+
+    void write(const std::string& text) {
+        ethernet.write(reinterpret_cast<const uint8_t*>(text.data()), text.size());
+    }
+
+    // Queue numbered lines, enough to overflow the ring several times
+    void fillLines(int count) {
+        char line[48];
+        for (int i = 0; i < count; i++) {
+            snprintf(line, sizeof(line), "INFO:LINE_%03d_PADDING_PADDING\r\n", i);
+            write(line);
+        }
+    }
+
+    void drain() {
+        native::advanceMillis(EthernetDevice::TX_FLUSH_INTERVAL_MS);
+        ethernet.update();
+    }
+};
+
+// Every line is one whole response: a numbered line, or the given first one
+static bool wholeLines(const std::string& output, const std::string& first) {
+    size_t position = 0;
+    if (!first.empty()) {
+        if (output.compare(0, first.size(), first) != 0) {
+            return false;
+        }
+        position = first.size();
+    }
+
+    while (position < output.size()) {
+        size_t end = output.find("\r\n", position);
+        if (end == std::string::npos || end - position != 29 ||
+            output.compare(position, 10, "INFO:LINE_") != 0) {
+            return false;
+        }
+        position = end + 2;
+    }
+    return true;
+}
+
+void setUp(void) {
+    // Pins, connections and virtual time offsets left by the last test
+    native::reset();
+}
+
+void test_ethernet_drop_keeps_partial_response(void) {
+    EthernetFixture fixture;
+    std::shared_ptr<native::TcpConnection> client = fixture.connect();
+    bool connected = fixture.ethernet.isConnected();
+    TEST_ASSERT_TRUE(connected);
+
+    // The window takes the first 5 bytes of a response, then nothing
+    client->sendLimit = 5;
+    fixture.write("OK:FIRST_RESPONSE\r\n");
+    client->sendLimit = 0;
+    fixture.fillLines(200);
+
+    client->sendLimit = SIZE_MAX;
+    fixture.drain();
+
+    // The rest of the partly sent response follows its start, then whole lines
+    bool whole = wholeLines(client->fromDevice, "OK:FIRST_RESPONSE\r\n");
+    TEST_ASSERT_TRUE(whole);
+    size_t size = client->fromDevice.size();
+    TEST_ASSERT_TRUE(size > EthernetDevice::TX_RING_SIZE - 64);
+    std::string last = client->fromDevice.substr(size - 31);
+    TEST_ASSERT_EQUAL_STRING("INFO:LINE_199_PADDING_PADDING\r\n", last.c_str());
+}
+
+void test_ethernet_drop_whole_frames(void) {
+    EthernetFixture fixture;
+
+    // Frames whose payload and CRC bytes include 0x0A and 0xA5, queued with no client
+    const uint8_t frame[16] = {0xA5, 11,  0,   0x80, '\n', 0xA5, 0x0A, 0xA5,
+                               '\n', 'x', 'y', 'z',  0xA5, 0x0A, 0xA5, 0x0A};
+    for (int i = 0; i < 300; i++) {
+        fixture.ethernet.write(frame, sizeof(frame));
+    }
+
+    std::shared_ptr<native::TcpConnection> client = fixture.connect();
+    fixture.drain();
+
+    size_t size = client->fromDevice.size();
+    TEST_ASSERT_EQUAL(0, size % sizeof(frame));
+    TEST_ASSERT_TRUE(size > 0);
+    bool frames = true;
+    for (size_t i = 0; i < size; i += sizeof(frame)) {
+        frames = frames && client->fromDevice.compare(i, sizeof(frame),
+                                                      reinterpret_cast<const char*>(frame),
+                                                      sizeof(frame)) == 0;
+    }
+    TEST_ASSERT_TRUE(frames);
+}
+
+void test_ethernet_new_client_skips_partial_response(void) {
+    EthernetFixture fixture;
+    std::shared_ptr<native::TcpConnection> first = fixture.connect();
+
+    first->sendLimit = 5;
+    fixture.write("OK:FIRST_RESPONSE\r\n");
+    first->sendLimit = 0;
+    fixture.write("OK:SECOND\r\n");
+    first->open = false;
+
+    // The next client gets the unsent responses from a boundary
+    std::shared_ptr<native::TcpConnection> second = fixture.connect();
+    fixture.drain();
+    TEST_ASSERT_EQUAL_STRING("OK:SECOND\r\n", second->fromDevice.c_str());
+}
+
+int main(void) {
+    UNITY_BEGIN();
+
+    RUN_TEST(test_ethernet_drop_keeps_partial_response);
+    RUN_TEST(test_ethernet_drop_whole_frames);
+    RUN_TEST(test_ethernet_new_client_skips_partial_response);
+
+    return UNITY_END();
+}
@@ -0,0 +1,97 @@
+/**
+ * Space Maquette - Event Log Tests
+ *
+ * Sector writes to the log file: full sectors are appended, timed flushes
+ * rewrite the padded tail sector in place. Runs under the native environment
+ * only (the SD shim keeps files in memory).
+ */
+
+#include "event_log.h"
+#include "native_shims.h"
+#include "unity.h"
+
+#define TEST_LOG_FILE "TEST.LOG"
+
+static const size_t SECTOR = EVENT_LOG_SECTOR_SIZE;
+
+static size_t logSize() {
+    return SD.files()[TEST_LOG_FILE]->size();
+}
+
+// Count the records of a level other than EVENT_PADDING
+static int countRecords() {
+    const std::string& data = *SD.files()[TEST_LOG_FILE];
+    int count = 0;
+    for (size_t i = 0; i + sizeof(EventLog::Record) <= data.size();
+         i += sizeof(EventLog::Record)) {
+        const EventLog::Record* record =
+            reinterpret_cast<const EventLog::Record*>(data.data() + i);
+        if (record->level != EVENT_PADDING) {
+            count++;
+        }
+    }
+    return count;
+}
+
+static void logAndFlush(EventLog& log, int32_t value) {
+    log.log(SOURCE_SYSTEM, EVENT_WARNING, EVT_SYS_MEMORY_LOW, 0, value);
+    native::advanceMillis(EVENT_LOG_FLUSH_MS);
+    log.update();
+}
+
+void setUp(void) {
+    SD.clear();
+}
+
+void test_event_log_trickle_rewrites_tail(void) {
+    static EventLog log;
+    TEST_ASSERT_TRUE(log.begin(TEST_LOG_FILE));
+
+    // One record per flush stays within one sector until it is full
+    for (int i = 0; i < EventLog::RECORDS_PER_SECTOR; i++) {
+        logAndFlush(log, i);
+        size_t size = logSize();
+        TEST_ASSERT_EQUAL(SECTOR, size);
+        TEST_ASSERT_EQUAL(i + 1, countRecords());
+    }
+
+    // The next record opens the second sector
+    logAndFlush(log, EventLog::RECORDS_PER_SECTOR);
+    size_t size = logSize();
+    TEST_ASSERT_EQUAL(2 * SECTOR, size);
+    TEST_ASSERT_EQUAL(EventLog::RECORDS_PER_SECTOR + 1, countRecords());
+
+    // Records keep their order across the rewrites
+    const EventLog::Record* records =
+        reinterpret_cast<const EventLog::Record*>(SD.files()[TEST_LOG_FILE]->data());
+    for (int i = 0; i <= EventLog::RECORDS_PER_SECTOR; i++) {
+        int32_t value = records[i].value;
+        TEST_ASSERT_EQUAL(i, value);
+    }
+    uint32_t written = log.getWritten();
+    TEST_ASSERT_EQUAL(EventLog::RECORDS_PER_SECTOR + 1, written);
+}
+
+void test_event_log_reopen_appends(void) {
+    static EventLog log;
+    TEST_ASSERT_TRUE(log.begin(TEST_LOG_FILE));
+    logAndFlush(log, 1);
+
+    // A reopened log leaves the earlier (padded) sector alone
+    static EventLog reopened;
+    TEST_ASSERT_TRUE(reopened.begin(TEST_LOG_FILE));
+    logAndFlush(reopened, 2);
+    logAndFlush(reopened, 3);
+    size_t size = logSize();
+    TEST_ASSERT_EQUAL(2 * SECTOR, size);
+    TEST_ASSERT_EQUAL(3, countRecords());
+}
+
+int main(void) {
+    UNITY_BEGIN();
+
+    RUN_TEST(test_event_log_trickle_rewrites_tail);
+    RUN_TEST(test_event_log_reopen_appends);
+
+    return UNITY_END();
+}
@@ -0,0 +1,266 @@
+/**
+ * Space Maquette - Motion Trace Tests
+ *
+ * Triggers, post-trigger capture and the blob layout of the motion trace.
+ * Alerts are raised on the shim's motor connectors and time is stepped with
+ * native::advanceMillis(), so captures run without a board.
+ */
+
+#include <math.h>
+
+#include <vector>
+
+#include "crc16.h"
+#include "emergency.h"
+#include "motion_control.h"
+#include "motion_trace.h"
+#include "native_shims.h"
+#include "unity.h"
+
+#define ESTOP_PIN DI6
+
+// Motion engine and recorder, rebuilt for every test
+struct TraceFixture {
+    MotionControl motion;
+    EmergencyStop estop;
+    MotionTrace trace;
+
+    TraceFixture() : estop(ESTOP_PIN), trace(motion, estop) {
+        native::setInput(ESTOP_PIN, HIGH);  // Released
+        estop.init(true);
+        motion.init();
+        motion.enableAllMotors();
+        trace.setPeriod(TRACE_DEFAULT_PERIOD_MS);
+        trace.setPostSamples(4);
+    }
+
+    // One loop pass
+    void step() {
+        motion.update();
+        trace.update();
+    }
+
+    // Run until the capture freezes (bounded so a broken trigger fails the test)
+    void runPostTrigger() {
+        for (int i = 0; i < 100 && trace.getState() != MotionTrace::TRACE_DONE; i++) {
+            native::advanceMillis(TRACE_DEFAULT_PERIOD_MS);
+            step();
+        }
+    }
+
+    std::vector<uint8_t> blob() {
+        std::vector<uint8_t> bytes(trace.getBlobSize());
+        trace.readBlob(0, bytes.data(), bytes.size());
+        return bytes;
+    }
+};
+
+static uint16_t getU16(const std::vector<uint8_t>& bytes, size_t offset) {
+    return bytes[offset] | (bytes[offset + 1] << 8);
+}
+
+// Peak residual vibration of a lightly damped 50 Hz mount driven by the
+// acceleration of the X commanded position (1 ms samples), after the axis stops
+static double residualVibration(const std::vector<uint8_t>& blob) {
+    uint16_t count = getU16(blob, 6);
+    std::vector<double> x;
+    for (uint16_t i = 0; i < count; i++) {
+        const uint8_t* sample = &blob[MotionTrace::HEADER_SIZE + i * MotionTrace::SAMPLE_SIZE + 4];
+        x.push_back(static_cast<int32_t>(sample[0] | (sample[1] << 8) | (sample[2] << 16) |
+                                         (static_cast<uint32_t>(sample[3]) << 24)));
+    }
+
+    size_t stopped = x.size() - 1;
+    while (stopped > 0 && x[stopped - 1] == x.back()) {
+        stopped--;
+    }
+
+    const double omega = 2.0 * M_PI * 50.0;
+    const double zeta = 0.05;
+    const double slice = 1e-4;
+    double offset = 0.0;
+    double rate = 0.0;
+    double peak = 0.0;
+    for (size_t i = 1; i + 1 < x.size(); i++) {
+        double accel = (x[i + 1] - 2.0 * x[i] + x[i - 1]) / 1e-6;
+        for (int k = 0; k < 10; k++) {
+            rate += (-accel - 2.0 * zeta * omega * rate - omega * omega * offset) * slice;
+            offset += rate * slice;
+        }
+        if (i > stopped && fabs(offset) > peak) {
+            peak = fabs(offset);
+        }
+    }
+    return peak;
+}
+
+// Record the commanded profile of one X move at 1 ms; returns the blob
+static std::vector<uint8_t> traceMove(int32_t jerk, int32_t target) {
+    native::reset();
+    TraceFixture fixture;
+    ConnectorM0.simulateProfile(true);
+    fixture.motion.setAxisProfile('X', 20000, 400000, jerk);
+    fixture.trace.setPeriod(1);
+    fixture.trace.setPostSamples(TRACE_CAPACITY - 1);
+    fixture.trace.arm(TRACE_TRIG_MOVE);
+
+    fixture.motion.moveAbsolute('X', target);
+    for (int i = 0; i < 400 && fixture.trace.getState() != MotionTrace::TRACE_DONE; i++) {
+        native::advanceMillis(1);
+        fixture.step();
+    }
+    return fixture.blob();
+}
+
+void setUp(void) {
+    // Pins, motor alerts and virtual time offsets left by the last test
+    native::reset();
+}
+
+void test_trace_quiet_without_motion(void) {
+    TraceFixture fixture;
+    fixture.trace.arm(TRACE_TRIG_ALERT);
+
+    for (int i = 0; i < 20; i++) {
+        native::advanceMillis(TRACE_DEFAULT_PERIOD_MS);
+        fixture.step();
+    }
+
+    int state = fixture.trace.getState();
+    int samples = fixture.trace.getSampleCount();
+    TEST_ASSERT_EQUAL(MotionTrace::TRACE_ARMED, state);
+    TEST_ASSERT_EQUAL(0, samples);
+}
+
+void test_trace_alert_trigger(void) {
+    TraceFixture fixture;
+    fixture.trace.arm(TRACE_TRIG_ALERT | TRACE_TRIG_ESTOP);
+    fixture.step();
+
+    ConnectorM1.setAlerts(0x0004);
+    fixture.step();
+    int state = fixture.trace.getState();
+    int cause = fixture.trace.getCause();
+    TEST_ASSERT_EQUAL(MotionTrace::TRACE_TRIGGERED, state);
+    TEST_ASSERT_EQUAL(TRACE_TRIG_ALERT, cause);
+
+    // The trigger sample plus the post-trigger samples
+    fixture.runPostTrigger();
+    state = fixture.trace.getState();
+    int samples = fixture.trace.getSampleCount();
+    TEST_ASSERT_EQUAL(MotionTrace::TRACE_DONE, state);
+    TEST_ASSERT_EQUAL(5, samples);
+
+    // Frozen: later alerts are not recorded
+    ConnectorM2.setAlerts(0x0001);
+    native::advanceMillis(TRACE_DEFAULT_PERIOD_MS);
+    fixture.step();
+    samples = fixture.trace.getSampleCount();
+    TEST_ASSERT_EQUAL(5, samples);
+}
+
+void test_trace_blob_layout(void) {
+    TraceFixture fixture;
+    fixture.trace.arm(TRACE_TRIG_ALERT);
+    fixture.step();
+    ConnectorM1.setAlerts(0x0004);
+    fixture.step();
+    fixture.runPostTrigger();
+
+    std::vector<uint8_t> blob = fixture.blob();
+    size_t size = blob.size();
+    TEST_ASSERT_EQUAL(MotionTrace::HEADER_SIZE + 5 * MotionTrace::SAMPLE_SIZE + 2, size);
+    TEST_ASSERT_EQUAL_MEMORY("MTRC", blob.data(), 4);
+    TEST_ASSERT_EQUAL(MotionTrace::BLOB_VERSION, blob[4]);
+    TEST_ASSERT_EQUAL(MotionTrace::SAMPLE_SIZE, blob[5]);
+
+    uint16_t count = getU16(blob, 6);
+    uint16_t period = getU16(blob, 8);
+    uint16_t triggerIndex = getU16(blob, 10);
+    TEST_ASSERT_EQUAL(5, count);
+    TEST_ASSERT_EQUAL(TRACE_DEFAULT_PERIOD_MS, period);
+    TEST_ASSERT_EQUAL(0, triggerIndex);
+    TEST_ASSERT_EQUAL(TRACE_TRIG_ALERT, blob[13]);
+
+    // Y axis alert register in the trigger sample
+    uint16_t alertY = getU16(blob, MotionTrace::HEADER_SIZE + 22);
+    TEST_ASSERT_EQUAL_HEX16(0x0004, alertY);
+
+    // Trailing CRC covers everything before it
+    uint16_t crc = crc16Modbus(blob.data(), size - 2);
+    uint16_t stored = getU16(blob, size - 2);
+    uint16_t reported = fixture.trace.getBlobCRC();
+    TEST_ASSERT_EQUAL_HEX16(crc, stored);
+    TEST_ASSERT_EQUAL_HEX16(crc, reported);
+
+    // Reads at odd offsets and sizes give the same bytes
+    std::vector<uint8_t> pieces;
+    uint8_t chunk[7];
+    size_t length;
+    while ((length = fixture.trace.readBlob(pieces.size(), chunk, sizeof(chunk))) > 0) {
+        pieces.insert(pieces.end(), chunk, chunk + length);
+    }
+    bool same = pieces == blob;
+    TEST_ASSERT_TRUE(same);
+}
+
+void test_trace_manual_trigger_csv(void) {
+    TraceFixture fixture;
+    fixture.trace.arm(0);
+
+    bool triggered = fixture.trace.trigger();
+    TEST_ASSERT_TRUE(triggered);
+    fixture.runPostTrigger();
+
+    char row[96];
+    int length = fixture.trace.getCsvRow(0, row, sizeof(row));
+    TEST_ASSERT_TRUE(length > 0);
+    TEST_ASSERT_EQUAL_STRING_LEN("0,", row, 2);  // Trigger sample at t = 0
+    length = fixture.trace.getCsvRow(5, row, sizeof(row));
+    TEST_ASSERT_EQUAL(0, length);
+
+    int cause = fixture.trace.getCause();
+    TEST_ASSERT_EQUAL(TRACE_TRIG_MANUAL, cause);
+}
+
+void test_trace_parse_triggers(void) {
+    int mask = MotionTrace::parseTriggers(TRACE_DEFAULT_TRIGGERS);
+    TEST_ASSERT_EQUAL(TRACE_TRIG_ALERT | TRACE_TRIG_ESTOP | TRACE_TRIG_FAIL, mask);
+    mask = MotionTrace::parseTriggers("MOVE");
+    TEST_ASSERT_EQUAL(TRACE_TRIG_MOVE, mask);
+    mask = MotionTrace::parseTriggers("MOVE,BOGUS");
+    TEST_ASSERT_EQUAL(-1, mask);
+}
+
+void test_trace_jerk_limited_stop(void) {
+    // Same move as a trapezoid and with a jerk limit (20 ms jerk phases)
+    std::vector<uint8_t> trapezoid = traceMove(0, 3000);
+    std::vector<uint8_t> shaped = traceMove(20000000, 3000);
+    size_t size = shaped.size();
+    size_t full = MotionTrace::HEADER_SIZE + TRACE_CAPACITY * MotionTrace::SAMPLE_SIZE + 2;
+    TEST_ASSERT_EQUAL(full, size);
+
+    // The tapered stop still lands on the target
+    int32_t last;
+    memcpy(&last, &shaped[size - 2 - MotionTrace::SAMPLE_SIZE + 4], sizeof(last));
+    TEST_ASSERT_EQUAL(3000, last);
+
+    // and leaves a fraction of the trapezoid's residual vibration
+    double before = residualVibration(trapezoid);
+    double after = residualVibration(shaped);
+    TEST_ASSERT_TRUE(before > 1.0);
+    TEST_ASSERT_TRUE(after < 0.25 * before);
+}
+
+int main(void) {
+    UNITY_BEGIN();
+
+    RUN_TEST(test_trace_quiet_without_motion);
+    RUN_TEST(test_trace_alert_trigger);
+    RUN_TEST(test_trace_blob_layout);
+    RUN_TEST(test_trace_manual_trigger_csv);
+    RUN_TEST(test_trace_parse_triggers);
+    RUN_TEST(test_trace_jerk_limited_stop);
+
+    return UNITY_END();
+}
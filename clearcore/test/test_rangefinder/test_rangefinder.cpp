@@ -0,0 +1,124 @@
+/**
+ * Space Maquette - Rangefinder Tests
+ *
+ * Unit tests for the rangefinder module. Readings go through the COM1
+ * scheduler, so the tests answer the DIST request on Serial1 through the
+ * native shim and step the scheduler with poll().
+ */
+
+#include "native_shims.h"
+#include "rangefinder.h"
+#include "serial_devices.h"
+#include "unity.h"
+
+#define RELAY_PIN IO0
+
+// COM1 scheduler and rangefinder, rebuilt for every test
+struct RangefinderFixture {
+    SerialDevices serialDevices;
+    Rangefinder rangefinder;
+
+    RangefinderFixture() : serialDevices(Serial1, RELAY_PIN), rangefinder(serialDevices) {
+        serialDevices.init(9600);
+    }
+
+    // Start a reading and let the relay settle; returns what was sent on COM1
+    std::string requestReading() {
+        Serial1.clearOutput();
+        if (!rangefinder.startMeasurement()) {
+            return "";
+        }
+        rangefinder.poll();  // Relay switched
+        native::advanceMillis(SERIAL_RELAY_SETTLE_MS);
+        rangefinder.poll();  // Request sent
+        return Serial1.output();
+    }
+};
+
+void setUp(void) {
+    // Clear serial buffers, pins and virtual time offsets left by the last test
+    native::reset();
+}
+
+void test_rangefinder_request(void) {
+    RangefinderFixture fixture;
+    Rangefinder* rangefinder = &fixture.rangefinder;
+    std::string sent = fixture.requestReading();
+
+    TEST_ASSERT_EQUAL_STRING("DIST\r\n", sent.c_str());
+    TEST_ASSERT_EQUAL(LOW, native::getOutput(RELAY_PIN));  // Relay on the rangefinder
+    TEST_ASSERT_TRUE(rangefinder->isBusy());
+}
+
+void test_rangefinder_valid_measurement(void) {
+    RangefinderFixture fixture;
+    Rangefinder* rangefinder = &fixture.rangefinder;
+    fixture.requestReading();
+    Serial1.inject("123.5\r\n");
+    TEST_ASSERT_TRUE(rangefinder->poll());
+
+    Rangefinder::Measurement result;
+    TEST_ASSERT_TRUE(rangefinder->readResult(result));
+    TEST_ASSERT_TRUE(result.valid);
+    TEST_ASSERT_FLOAT_WITHIN(0.001, 123.5, result.distance);
+    TEST_ASSERT_FLOAT_WITHIN(0.001, 123.5, rangefinder->getLastMeasurement());
+    TEST_ASSERT_FALSE(rangefinder->isBusy());
+}
+
+void test_rangefinder_prefixed_measurement(void) {
+    RangefinderFixture fixture;
+    Rangefinder* rangefinder = &fixture.rangefinder;
+    fixture.requestReading();
+    Serial1.inject("DIST:250.25\r\n");
+    rangefinder->poll();
+
+    Rangefinder::Measurement result;
+    TEST_ASSERT_TRUE(rangefinder->readResult(result));
+    TEST_ASSERT_TRUE(result.valid);
+    TEST_ASSERT_FLOAT_WITHIN(0.001, 250.25, result.distance);
+}
+
+void test_rangefinder_out_of_range(void) {
+    RangefinderFixture fixture;
+    Rangefinder* rangefinder = &fixture.rangefinder;
+    fixture.requestReading();
+    Serial1.inject("123.5\r\n");
+    rangefinder->poll();
+
+    fixture.requestReading();
+    Serial1.inject("9999\r\n");
+    rangefinder->poll();
+
+    Rangefinder::Measurement result;
+    TEST_ASSERT_TRUE(rangefinder->readResult(result));  // The first reading
+    TEST_ASSERT_TRUE(rangefinder->readResult(result));
+    TEST_ASSERT_FALSE(result.valid);
+
+    // The last good reading is kept
+    TEST_ASSERT_FLOAT_WITHIN(0.001, 123.5, rangefinder->getLastMeasurement());
+}
+
+void test_rangefinder_timeout(void) {
+    RangefinderFixture fixture;
+    Rangefinder* rangefinder = &fixture.rangefinder;
+    fixture.requestReading();
+    native::advanceMillis(Rangefinder::MEASUREMENT_TIMEOUT_MS);
+    TEST_ASSERT_TRUE(rangefinder->poll());
+
+    Rangefinder::Measurement result;
+    TEST_ASSERT_TRUE(rangefinder->readResult(result));
+    TEST_ASSERT_FALSE(result.valid);
+    TEST_ASSERT_FALSE(rangefinder->isBusy());
+}
+
+int main(void) {
+    UNITY_BEGIN();
+
+    RUN_TEST(test_rangefinder_request);
+    RUN_TEST(test_rangefinder_valid_measurement);
+    RUN_TEST(test_rangefinder_prefixed_measurement);
+    RUN_TEST(test_rangefinder_out_of_range);
+    RUN_TEST(test_rangefinder_timeout);
+
+    return UNITY_END();
+}
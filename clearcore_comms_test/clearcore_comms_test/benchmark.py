@@ -0,0 +1,470 @@
+"""
+Benchmark mode for a live ClearCore controller.
+
+Measures round-trip latency, sustained command throughput (pipelined and
+batched), telemetry frame rate and jitter, scan speed and reconnect recovery
+time. The firmware's BENCH command stamps each reply with the controller's
+clock and the time the command spent inside the firmware, so network time and
+firmware time can be told apart. Results can be written as CSV or JSON to
+compare firmware builds.
+"""
+import csv
+import json
+import logging
+import statistics
+import time
+from dataclasses import dataclass, asdict
+from typing import Callable, Dict, List, Optional, Sequence, Tuple
+
+from clearcore_comms_test.client.ethernet_client import ClearCoreClient
+
+logger = logging.getLogger(__name__)
+
+# Tests run when none are named (MOVE latency and SCAN need coordinates)
+DEFAULT_TESTS = ["echo", "latency", "pipeline", "batch", "telemetry", "reconnect"]
+ALL_TESTS = DEFAULT_TESTS + ["scan"]
+
+# BATCH accepts 1-16 commands
+MAX_BATCH = 16
+
+# The controller clock is a free-running 32-bit counter
+CLOCK_WRAP = 1 << 32
+
+
+@dataclass
+class BenchResult:
+    """One measured figure."""
+    test: str
+    metric: str
+    value: float
+    unit: str
+
+
+def percentile(samples: Sequence[float], pct: float) -> float:
+    """
+    Percentile with linear interpolation between the closest ranks.
+
+    Args:
+        samples: Measured values (need not be sorted)
+        pct: Percentile, 0-100
+
+    Returns:
+        The percentile value (0.0 for no samples)
+    """
+    if not samples:
+        return 0.0
+
+    ordered = sorted(samples)
+    rank = (len(ordered) - 1) * pct / 100.0
+    low = int(rank)
+    high = min(low + 1, len(ordered) - 1)
+    return ordered[low] + (ordered[high] - ordered[low]) * (rank - low)
+
+
+def summarize(test: str, name: str, samples: Sequence[float], unit: str) -> List[BenchResult]:
+    """
+    Count, min, mean, p50, p90, p99 and max of a set of samples.
+
+    Args:
+        test: Test name
+        name: Metric prefix (e.g., "rtt")
+        samples: Measured values
+        unit: Unit of the samples
+
+    Returns:
+        List of results, empty if there are no samples
+    """
+    if not samples:
+        return []
+
+    return [
+        BenchResult(test, f"{name}_count", len(samples), "samples"),
+        BenchResult(test, f"{name}_min", min(samples), unit),
+        BenchResult(test, f"{name}_mean", statistics.mean(samples), unit),
+        BenchResult(test, f"{name}_p50", percentile(samples, 50), unit),
+        BenchResult(test, f"{name}_p90", percentile(samples, 90), unit),
+        BenchResult(test, f"{name}_p99", percentile(samples, 99), unit),
+        BenchResult(test, f"{name}_max", max(samples), unit),
+    ]
+
+
+def parse_fields(message: str) -> Dict[str, str]:
+    """
+    Split a reply such as "OK:BENCH=7,CLK=123,HZ=1000000,RX_US=40" into its fields.
+
+    Args:
+        message: Full response line
+
+    Returns:
+        Dictionary of KEY=VALUE pairs after the status
+    """
+    _, _, body = message.partition(":")
+    fields = {}
+    for part in body.split(","):
+        key, sep, value = part.partition("=")
+        if sep:
+            fields[key] = value
+    return fields
+
+
+def write_csv(results: Sequence[BenchResult], path: str, label: str = "") -> None:
+    """
+    Write results as CSV (one row per figure, label first so runs can be concatenated).
+
+    Args:
+        results: Benchmark results
+        path: Output file path
+        label: Build label for every row
+    """
+    with open(path, "w", newline="") as f:
+        writer = csv.writer(f)
+        writer.writerow(["label", "test", "metric", "value", "unit"])
+        for result in results:
+            writer.writerow([label, result.test, result.metric, f"{result.value:.6g}", result.unit])
+
+
+def write_json(results: Sequence[BenchResult], path: str, metadata: Dict[str, object]) -> None:
+    """
+    Write results as JSON along with the run's metadata.
+
+    Args:
+        results: Benchmark results
+        path: Output file path
+        metadata: Host, port, label, settings, start time
+    """
+    with open(path, "w") as f:
+        json.dump({**metadata, "results": [asdict(r) for r in results]}, f, indent=2)
+
+
+class BenchmarkError(Exception):
+    """A benchmark could not be completed (error reply, timeout or lost connection)."""
+
+
+class ClearCoreBenchmark:
+    """Runs benchmarks over a connected ClearCoreClient."""
+
+    def __init__(self, client: ClearCoreClient, count: int = 200, duration: float = 5.0,
+                 window: int = 8, batch: int = 8, reply_timeout: float = 2.0):
+        """
+        Initialize the benchmark runner.
+
+        Args:
+            client: Connected ClearCoreClient
+            count: Samples per latency measurement
+            duration: Seconds per throughput and telemetry measurement
+            window: Commands kept in flight by the pipelined test
+            batch: Commands per BATCH in the batched test (1-16)
+            reply_timeout: Seconds to wait for any single reply
+        """
+        self.client = client
+        self.count = count
+        self.duration = duration
+        self.window = max(1, window)
+        self.batch = max(1, min(batch, MAX_BATCH))
+        self.reply_timeout = reply_timeout
+
+    # Helpers
+
+    def _read_reply(self, timeout: Optional[float] = None) -> str:
+        """Read the next OK/ERROR line, skipping asynchronous INFO and DATA messages."""
+        deadline = time.perf_counter() + (self.reply_timeout if timeout is None else timeout)
+
+        while True:
+            line = self.client.read_line(max(0.0, deadline - time.perf_counter()))
+            if line is None:
+                raise BenchmarkError("Timed out waiting for a reply")
+            if line.startswith("OK") or line.startswith("ERROR"):
+                return line
+
+    def _command(self, line: str, timeout: Optional[float] = None) -> str:
+        """Send a command and return its reply, raising on an ERROR reply."""
+        self.client.send_line(line)
+        reply = self._read_reply(timeout)
+        if reply.startswith("ERROR"):
+            raise BenchmarkError(f"{line} answered {reply}")
+        return reply
+
+    def _wait_for(self, predicate: Callable[[str], bool], timeout: float) -> str:
+        """Read lines until one matches (INFO and DATA included)."""
+        deadline = time.perf_counter() + timeout
+
+        while True:
+            line = self.client.read_line(max(0.0, deadline - time.perf_counter()))
+            if line is None:
+                raise BenchmarkError("Timed out waiting for the controller")
+            if predicate(line):
+                return line
+
+    def _round_trips(self, line: str, count: int,
+                     after: Optional[Callable[[], None]] = None) -> List[Tuple[float, str]]:
+        """Time count sequential round trips; returns (seconds, reply) pairs."""
+        samples = []
+        for _ in range(count):
+            start = time.perf_counter()
+            reply = self._command(line)
+            samples.append((time.perf_counter() - start, reply))
+            if after:
+                after()
+        return samples
+
+    # Benchmarks
+
+    def echo(self) -> List[BenchResult]:
+        """
+        BENCH round trips, split into firmware time (RX_US, read to reply) and the rest
+        (network, TCP stacks and the wait for the controller loop to read the command).
+        """
+        rtt_ms = []
+        firmware_ms = []
+        network_ms = []
+
+        for seq in range(self.count):
+            start = time.perf_counter()
+            reply = self._command(f"BENCH:{seq}")
+            rtt = (time.perf_counter() - start) * 1e3
+
+            fields = parse_fields(reply)
+            if fields.get("BENCH") != str(seq):
+                raise BenchmarkError(f"Out of order BENCH reply: {reply}")
+
+            inside = float(fields.get("RX_US", 0)) / 1e3
+            rtt_ms.append(rtt)
+            firmware_ms.append(inside)
+            network_ms.append(max(0.0, rtt - inside))
+
+        return (summarize("echo", "rtt", rtt_ms, "ms") +
+                summarize("echo", "firmware", firmware_ms, "ms") +
+                summarize("echo", "network", network_ms, "ms"))
+
+    def latency(self, move: Optional[Tuple[float, float, float]] = None) -> List[BenchResult]:
+        """
+        Round-trip latency of PING and STATUS, and of MOVE when a target is given.
+
+        Args:
+            move: (x, y, z) target; every sample moves there, so only the first one travels
+        """
+        results = []
+        for command in ["PING", "STATUS"]:
+            samples = self._round_trips(command, self.count)
+            results += summarize("latency", command.lower(), [s * 1e3 for s, _ in samples], "ms")
+
+        if move:
+            line = "MOVE:" + ",".join(f"{v:g}" for v in move)
+            done = lambda l: l.startswith("INFO:MOVE_DONE") or l.startswith("INFO:MOVE_FAILED")
+
+            # Reach the target first, then time moves that finish at once
+            self._command(line)
+            self._wait_for(done, 60.0)
+            samples = self._round_trips(line, self.count, lambda: self._wait_for(done, 5.0))
+            results += summarize("latency", "move", [s * 1e3 for s, _ in samples], "ms")
+
+        return results
+
+    def pipeline(self) -> List[BenchResult]:
+        """Sustained BENCH commands/s with `window` commands always in flight."""
+        sent = 0
+        received = 0
+        clocks = []
+        hz = 0
+
+        start = time.perf_counter()
+        end = start + self.duration
+
+        while sent < self.window:
+            self.client.send_line(f"BENCH:{sent}")
+            sent += 1
+
+        while received < sent:
+            fields = parse_fields(self._read_reply())
+            received += 1
+            clocks.append(int(fields.get("CLK", 0)))
+            hz = int(fields.get("HZ", 0))
+
+            if time.perf_counter() < end:
+                self.client.send_line(f"BENCH:{sent}")
+                sent += 1
+
+        elapsed = time.perf_counter() - start
+        results = [
+            BenchResult("pipeline", "commands", received, "commands"),
+            BenchResult("pipeline", "rate", received / elapsed, "cmd/s"),
+            BenchResult("pipeline", "window", self.window, "commands"),
+        ]
+
+        # The controller's own view of the run, unaffected by the network
+        if hz and len(clocks) > 1:
+            ticks = sum((b - a) % CLOCK_WRAP for a, b in zip(clocks, clocks[1:]))
+            if ticks:
+                rate = (len(clocks) - 1) * hz / ticks
+                results.append(BenchResult("pipeline", "controller_rate", rate, "cmd/s"))
+
+        return results
+
+    def batched(self) -> List[BenchResult]:
+        """Sustained commands/s sending BATCH:n followed by n PINGs in one write."""
+        block = "\n".join([f"BATCH:{self.batch}"] + ["PING"] * self.batch)
+        batches = 0
+        round_trips = []
+
+        start = time.perf_counter()
+        while time.perf_counter() - start < self.duration:
+            sent = time.perf_counter()
+            reply = self._command(block)
+            round_trips.append((time.perf_counter() - sent) * 1e3)
+            if not reply.startswith(f"OK:BATCH={self.batch}"):
+                raise BenchmarkError(f"Unexpected batch reply: {reply}")
+            batches += 1
+
+        elapsed = time.perf_counter() - start
+        return [
+            BenchResult("batch", "batch_size", self.batch, "commands"),
+            BenchResult("batch", "rate", batches * self.batch / elapsed, "cmd/s"),
+        ] + summarize("batch", "rtt", round_trips, "ms")
+
+    def telemetry(self, rate_hz: int = 50, fields: str = "ALL") -> List[BenchResult]:
+        """
+        Telemetry frame rate, interval jitter and lost frames at the requested rate.
+
+        Args:
+            rate_hz: Subscription rate (1-100)
+            fields: SUBSCRIBE field list (e.g., "ALL" or "X,Y,Z")
+        """
+        self._command(f"SUBSCRIBE:{rate_hz},{fields}")
+
+        arrivals = []
+        sequences = []
+        end = time.perf_counter() + self.duration
+        try:
+            while time.perf_counter() < end:
+                line = self.client.read_line(max(0.0, end - time.perf_counter()))
+                if line and line.startswith("DATA:TLM,"):
+                    arrivals.append(time.perf_counter())
+                    sequences.append(int(line.split(",")[1]))
+        finally:
+            self.client.send_line("UNSUBSCRIBE")
+            self._wait_for(lambda l: l.startswith("OK:UNSUBSCRIBED"), self.reply_timeout)
+
+        if len(arrivals) < 2:
+            raise BenchmarkError("No telemetry frames received")
+
+        intervals = [(b - a) * 1e3 for a, b in zip(arrivals, arrivals[1:])]
+        lost = sum(((b - a) % 65536) - 1 for a, b in zip(sequences, sequences[1:]))
+
+        return [
+            BenchResult("telemetry", "requested_rate", rate_hz, "Hz"),
+            BenchResult("telemetry", "rate", (len(arrivals) - 1) / (arrivals[-1] - arrivals[0]), "Hz"),
+            BenchResult("telemetry", "jitter_stdev", statistics.pstdev(intervals), "ms"),
+            BenchResult("telemetry", "lost_frames", lost, "frames"),
+        ] + summarize("telemetry", "interval", intervals, "ms")
+
+    def scan(self, area: Tuple[float, float, float, float, float],
+             timeout: float = 600.0) -> List[BenchResult]:
+        """
+        Points/s of a full scan, from SCAN to INFO:SCAN_COMPLETE.
+
+        Args:
+            area: (x1, y1, x2, y2, step)
+            timeout: Seconds allowed for the whole scan
+        """
+        start = time.perf_counter()
+        self._command("SCAN:" + ",".join(f"{v:g}" for v in area))
+
+        points = 0
+        first_point = None
+        deadline = start + timeout
+        while True:
+            line = self.client.read_line(max(0.0, deadline - time.perf_counter()))
+            if line is None:
+                self.client.send_line("SCAN_ABORT")
+                raise BenchmarkError("Scan timed out")
+            if line.startswith("DATA:SCAN,"):
+                if first_point is None:
+                    first_point = time.perf_counter() - start
+                points += int(line.split(";", 1)[0].split(",")[2])
+            elif line.startswith("INFO:SCAN_COMPLETE"):
+                break
+            elif line.startswith("INFO:SCAN_ABORTED") or line.startswith("INFO:SCAN_FAILED"):
+                raise BenchmarkError(line)
+
+        elapsed = time.perf_counter() - start
+        return [
+            BenchResult("scan", "points", points, "points"),
+            BenchResult("scan", "rate", points / elapsed, "points/s"),
+            BenchResult("scan", "first_data", (first_point or 0.0) * 1e3, "ms"),
+            BenchResult("scan", "duration", elapsed, "s"),
+        ]
+
+    def reconnect(self, attempts: int = 5, give_up: float = 30.0) -> List[BenchResult]:
+        """
+        Time from dropping the connection to the first PONG on a new one.
+
+        Args:
+            attempts: Number of disconnect/reconnect cycles
+            give_up: Seconds to keep retrying each reconnect
+        """
+        recovery_ms = []
+        retries = 0
+
+        for _ in range(attempts):
+            self.client.disconnect()
+            start = time.perf_counter()
+
+            while True:
+                if self.client.connect():
+                    try:
+                        self._command("PING")
+                        break
+                    except (BenchmarkError, ConnectionError, OSError):
+                        self.client.disconnect()
+                retries += 1
+                if time.perf_counter() - start > give_up:
+                    raise BenchmarkError("Controller did not accept a new connection")
+                time.sleep(0.05)
+
+            recovery_ms.append((time.perf_counter() - start) * 1e3)
+
+        return ([BenchResult("reconnect", "retries", retries, "attempts")] +
+                summarize("reconnect", "recovery", recovery_ms, "ms"))
+
+    def run(self, tests: Sequence[str], move: Optional[Tuple[float, float, float]] = None,
+            area: Optional[Tuple[float, float, float, float, float]] = None,
+            telemetry_rate: int = 50) -> Tuple[List[BenchResult], Dict[str, str]]:
+        """
+        Run the named tests in order. A failing test is recorded and the rest still run.
+
+        Returns:
+            (results, errors by test name)
+        """
+        results = []
+        errors = {}
+
+        for test in tests:
+            logger.info(f"Running benchmark: {test}")
+            try:
+                if test == "echo":
+                    results += self.echo()
+                elif test == "latency":
+                    results += self.latency(move)
+                elif test == "pipeline":
+                    results += self.pipeline()
+                elif test == "batch":
+                    results += self.batched()
+                elif test == "telemetry":
+                    results += self.telemetry(telemetry_rate)
+                elif test == "scan":
+                    if not area:
+                        raise BenchmarkError("The scan test needs an area (--scan)")
+                    results += self.scan(area)
+                elif test == "reconnect":
+                    results += self.reconnect()
+                else:
+                    raise BenchmarkError(f"Unknown test: {test}")
+            except (BenchmarkError, ConnectionError, OSError) as e:
+                logger.error(f"Benchmark {test} failed: {e}")
+                errors[test] = str(e)
+
+                # Leave a usable connection for the next test
+                if not self.client.is_connected():
+                    self.client.connect()
+
+        return results, errors
@@ -15,6 +15,8 @@ from rich.syntax import Syntax
 
 from clearcore_comms_test.client.ethernet_client import ClearCoreClient
 from clearcore_comms_test.client.command_handler import ClearCoreCommandHandler
+from clearcore_comms_test.benchmark import (ClearCoreBenchmark, DEFAULT_TESTS, ALL_TESTS,
+                                            write_csv, write_json)
 
 # Configure logging
 logging.basicConfig(level=logging.INFO, format='%(asctime)s - %(name)s - %(levelname)s - %(message)s')
@@ -288,6 +290,93 @@ def raw(command, params, checksum):
     success, response = client.send_command(command, param_list, checksum)
     print_response(success, response)
 
+# Benchmark mode
+
+def parse_numbers(text: Optional[str], count: int, name: str) -> Optional[tuple]:
+    """Parse a comma-separated list of exactly `count` numbers (None if not given)."""
+    if text is None:
+        return None
+    try:
+        values = tuple(float(v) for v in text.split(","))
+    except ValueError:
+        values = ()
+    if len(values) != count:
+        raise click.BadParameter(f"expected {count} comma-separated numbers", param_hint=name)
+    return values
+
+@cli.command()
+@click.argument('host')
+@click.option('--port', '-p', default=8080, help='TCP port (default: 8080)')
+@click.option('--tests', '-t', default=",".join(DEFAULT_TESTS),
+              help=f'Comma-separated tests to run, from: {", ".join(ALL_TESTS)}')
+@click.option('--count', '-n', default=200, help='Samples per latency measurement (default: 200)')
+@click.option('--duration', '-d', default=5.0, help='Seconds per throughput/telemetry test (default: 5)')
+@click.option('--window', '-w', default=8, help='Commands in flight for the pipeline test (default: 8)')
+@click.option('--batch', '-b', default=8, help='Commands per BATCH for the batch test (1-16, default: 8)')
+@click.option('--telemetry-rate', default=50, help='Telemetry subscription rate in Hz (default: 50)')
+@click.option('--move', help='X,Y,Z target for MOVE latency (moves the machine)')
+@click.option('--scan', 'scan_area', help='X1,Y1,X2,Y2,STEP area for the scan test (moves the machine)')
+@click.option('--label', default='', help='Firmware build label stored with the results')
+@click.option('--json', 'json_path', type=click.Path(dir_okay=False), help='Write results as JSON')
+@click.option('--csv', 'csv_path', type=click.Path(dir_okay=False), help='Write results as CSV')
+def bench(host, port, tests, count, duration, window, batch, telemetry_rate, move, scan_area,
+          label, json_path, csv_path):
+    """Benchmark latency, throughput, telemetry and reconnects against a live controller."""
+    test_list = [t.strip().lower() for t in tests.split(",") if t.strip()]
+    unknown = [t for t in test_list if t not in ALL_TESTS]
+    if unknown:
+        raise click.BadParameter(f"unknown test(s): {', '.join(unknown)}", param_hint='--tests')
+    move_target = parse_numbers(move, 3, '--move')
+    area = parse_numbers(scan_area, 5, '--scan')
+    if area and "scan" not in test_list:
+        test_list.append("scan")
+
+    bench_client = ClearCoreClient(host, port)
+    if not bench_client.connect():
+        console.print(f"[red]Failed to connect to ClearCore at {host}:{port}[/red]")
+        sys.exit(1)
+
+    console.print(f"Benchmarking ClearCore at {host}:{port}: {', '.join(test_list)}")
+    started = time.strftime("%Y-%m-%dT%H:%M:%S")
+    runner = ClearCoreBenchmark(bench_client, count=count, duration=duration, window=window,
+                                batch=batch)
+    try:
+        results, errors = runner.run(test_list, move=move_target, area=area,
+                                     telemetry_rate=telemetry_rate)
+    finally:
+        bench_client.disconnect()
+
+    table = Table(title="Benchmark Results")
+    table.add_column("Test", style="cyan")
+    table.add_column("Metric", style="cyan")
+    table.add_column("Value", style="green", justify="right")
+    table.add_column("Unit")
+    for result in results:
+        table.add_row(result.test, result.metric, f"{result.value:.6g}", result.unit)
+    console.print(table)
+
+    for test, error in errors.items():
+        console.print(f"[red]{test}: {error}[/red]")
+
+    metadata = {
+        "host": host,
+        "port": port,
+        "label": label,
+        "started": started,
+        "settings": {"count": count, "duration": duration, "window": window, "batch": batch,
+                     "telemetry_rate": telemetry_rate},
+        "errors": errors,
+    }
+    if json_path:
+        write_json(results, json_path, metadata)
+        console.print(f"Results written to {json_path}")
+    if csv_path:
+        write_csv(results, csv_path, label)
+        console.print(f"Results written to {csv_path}")
+
+    if errors:
+        sys.exit(1)
+
 # Interactive mode
 
 @cli.command()
@@ -54,6 +54,7 @@ class ClearCoreClient:
             self.socket.close()
             self.socket = None
         self.connected = False
+        self._buffer = b""
         logger.info("Disconnected from ClearCore")
     
     def is_connected(self) -> bool:
@@ -138,14 +139,58 @@ class ClearCoreClient:
                     self.connected = False
                     return "ERROR:CONNECTION_CLOSED"
                 
-                # Debug: Print raw received bytes
-                print(f"Received raw bytes: {data.hex()}")
+                logger.debug(f"Received raw bytes: {data.hex()}")
                 
                 self._buffer += data
             except socket.timeout:
                 # Timeout waiting for data
                 return "ERROR:TIMEOUT"
     
+    def send_line(self, line: str) -> None:
+        """
+        Send one command line without waiting for the response.
+        
+        Args:
+            line: Command line without the newline (e.g., "MOVE:100,200,50")
+        """
+        self.socket.sendall(f"{line}\n".encode('utf-8'))
+    
+    def read_line(self, timeout: Optional[float] = None) -> Optional[str]:
+        """
+        Read one line from the controller, whatever it is (responses, INFO and DATA).
+        
+        Args:
+            timeout: Seconds to wait (default: the client timeout)
+            
+        Returns:
+            The line without its line ending, or None on timeout
+            
+        Raises:
+            ConnectionError: If the controller closed the connection
+        """
+        deadline = time.perf_counter() + (self.timeout if timeout is None else timeout)
+        
+        while b'\n' not in self._buffer:
+            remaining = deadline - time.perf_counter()
+            if remaining <= 0:
+                return None
+            
+            self.socket.settimeout(remaining)
+            try:
+                data = self.socket.recv(4096)
+            except socket.timeout:
+                return None
+            finally:
+                self.socket.settimeout(self.timeout)
+            
+            if not data:
+                self.connected = False
+                raise ConnectionError("Connection closed by ClearCore")
+            self._buffer += data
+        
+        line, self._buffer = self._buffer.split(b'\n', 1)
+        return line.decode('utf-8', errors='replace').rstrip('\r')
+    
     def _calculate_crc16(self, data: str) -> int:
         """
         Calculate CRC-16 checksum for the given data.
@@ -0,0 +1,85 @@
+"""
+Tests for the benchmark module.
+"""
+import json
+import pytest
+from unittest.mock import MagicMock
+
+from clearcore_comms_test.benchmark import (ClearCoreBenchmark, BenchResult, percentile,
+                                            parse_fields, summarize, write_csv, write_json)
+from clearcore_comms_test.client.ethernet_client import ClearCoreClient
+
+class TestBenchmark:
+    """Test cases for the benchmark helpers and runner."""
+    
+    @pytest.fixture
+    def mock_client(self):
+        """Create a mock client for testing."""
+        client = MagicMock(spec=ClearCoreClient)
+        client.is_connected.return_value = True
+        return client
+    
+    def test_percentile(self):
+        """Test percentile interpolation."""
+        samples = [4.0, 1.0, 3.0, 2.0]
+        assert percentile(samples, 0) == 1.0
+        assert percentile(samples, 50) == 2.5
+        assert percentile(samples, 100) == 4.0
+        assert percentile([], 50) == 0.0
+    
+    def test_parse_fields(self):
+        """Test splitting a BENCH reply into fields."""
+        fields = parse_fields("OK:BENCH=7,CLK=123,HZ=1000000,RX_US=40")
+        assert fields == {"BENCH": "7", "CLK": "123", "HZ": "1000000", "RX_US": "40"}
+    
+    def test_summarize(self):
+        """Test the summary metrics of a sample set."""
+        results = {r.metric: r.value for r in summarize("echo", "rtt", [1.0, 2.0, 3.0], "ms")}
+        assert results["rtt_count"] == 3
+        assert results["rtt_min"] == 1.0
+        assert results["rtt_p50"] == 2.0
+        assert results["rtt_max"] == 3.0
+        assert summarize("echo", "rtt", [], "ms") == []
+    
+    def test_echo_separates_firmware_time(self, mock_client):
+        """Test that the BENCH echo reports firmware time from RX_US."""
+        mock_client.read_line.side_effect = [
+            "INFO:MOVE_DONE",  # Asynchronous messages are skipped
+            "OK:BENCH=0,CLK=100,HZ=1000000,RX_US=250",
+            "OK:BENCH=1,CLK=900,HZ=1000000,RX_US=250",
+        ]
+        runner = ClearCoreBenchmark(mock_client, count=2)
+        
+        results = {r.metric: r for r in runner.echo()}
+        
+        assert results["firmware_p50"].value == pytest.approx(0.25)
+        assert results["firmware_p50"].unit == "ms"
+        mock_client.send_line.assert_any_call("BENCH:0")
+        mock_client.send_line.assert_any_call("BENCH:1")
+    
+    def test_failed_test_is_reported(self, mock_client):
+        """Test that an error reply fails one test without stopping the run."""
+        mock_client.read_line.side_effect = ["ERROR:UNKNOWN_COMMAND"] + [
+            f"OK:BENCH={i},CLK={i},HZ=1000000,RX_US=1" for i in range(2)]
+        runner = ClearCoreBenchmark(mock_client, count=2)
+        
+        results, errors = runner.run(["latency", "echo"])
+        
+        assert "latency" in errors
+        assert any(r.test == "echo" for r in results)
+    
+    def test_write_results(self, tmp_path):
+        """Test CSV and JSON output."""
+        results = [BenchResult("pipeline", "rate", 1234.5, "cmd/s")]
+        csv_path = tmp_path / "bench.csv"
+        json_path = tmp_path / "bench.json"
+        
+        write_csv(results, str(csv_path), "v1.2")
+        write_json(results, str(json_path), {"label": "v1.2"})
+        
+        assert csv_path.read_text().splitlines() == [
+            "label,test,metric,value,unit", "v1.2,pipeline,rate,1234.5,cmd/s"]
+        data = json.loads(json_path.read_text())
+        assert data["label"] == "v1.2"
+        assert data["results"][0] == {"test": "pipeline", "metric": "rate", "value": 1234.5,
+                                      "unit": "cmd/s"}